@@ -0,0 +1,54 @@
+#ifndef BENCHMARKUTILS_H
+#define BENCHMARKUTILS_H
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace BenchmarkUtils{
+
+// reads a whole file, benchmarks are run from the project directory
+inline std::string LoadFile(const std::string &filename){
+    std::ifstream Input(filename, std::ios::binary);
+    std::stringstream Contents;
+    Contents << Input.rdbuf();
+    return Contents.str();
+}
+
+inline bool SaveFile(const std::string &filename, const std::string &contents){
+    std::ofstream Output(filename, std::ios::binary | std::ios::trunc);
+    Output.write(contents.data(), contents.size());
+    return bool(Output);
+}
+
+// data/davis.osm with the body of the <osm> element repeated copies times
+inline std::string ScaledDavisOSM(std::size_t copies){
+    std::string Original = LoadFile("data/davis.osm");
+    std::size_t BodyStart = Original.find('>', Original.find("<osm")) + 1;
+    std::size_t BodyEnd = Original.rfind("</osm>");
+    std::string Body = Original.substr(BodyStart, BodyEnd - BodyStart);
+    std::string Result = Original.substr(0, BodyStart);
+    Result.reserve(BodyStart + Body.size() * copies + 16);
+    for(std::size_t Index = 0; Index < copies; Index++){
+        Result += Body;
+    }
+    Result += "</osm>\n";
+    return Result;
+}
+
+// wall clock seconds since construction
+class CStopwatch{
+    private:
+        std::chrono::steady_clock::time_point DStart;
+    public:
+        CStopwatch() : DStart(std::chrono::steady_clock::now()){}
+
+        double Seconds() const{
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - DStart).count();
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "CSVBusSystem.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+#include "BenchmarkUtils.h"
+#include <iostream>
+#include <malloc.h>
+#include <random>
+#include <unordered_map>
+
+// the loader as it was before the column loader: strings per row, stoul
+// inside try/catch and one shared_ptr per stop
+struct SReferenceStop{
+    uint64_t StopID;
+    uint64_t NodeID;
+};
+
+struct SReferenceRoute{
+    std::string Name;
+    std::vector<uint64_t> Stops;
+};
+
+struct SReferenceBusSystem{
+    std::vector<std::shared_ptr<SReferenceStop>> StopsByIndex;
+    std::unordered_map<uint64_t, std::shared_ptr<SReferenceStop>> Stops;
+    std::vector<std::shared_ptr<SReferenceRoute>> RoutesByIndex;
+    std::unordered_map<std::string, std::shared_ptr<SReferenceRoute>> Routes;
+
+    SReferenceBusSystem(CDSVReader &stopsrc, CDSVReader &routesrc){
+        std::vector<std::string> Row;
+        while(stopsrc.ReadRow(Row)){
+            if(Row.size() >= 2){
+                try{
+                    auto Stop = std::make_shared<SReferenceStop>();
+                    Stop->StopID = std::stoul(Row[0]);
+                    Stop->NodeID = std::stoul(Row[1]);
+                    Stops[Stop->StopID] = Stop;
+                    StopsByIndex.push_back(Stop);
+                }
+                catch(const std::exception &){
+                }
+            }
+        }
+        while(routesrc.ReadRow(Row)){
+            if(Row.size() >= 2){
+                try{
+                    uint64_t StopID = std::stoul(Row[1]);
+                    auto &Route = Routes[Row[0]];
+                    if(!Route){
+                        Route = std::make_shared<SReferenceRoute>();
+                        Route->Name = Row[0];
+                        RoutesByIndex.push_back(Route);
+                    }
+                    Route->Stops.push_back(StopID);
+                }
+                catch(const std::exception &){
+                }
+            }
+        }
+    }
+};
+
+static std::size_t HeapInUse(){
+    return mallinfo2().uordblks;
+}
+
+int main(){
+    const std::size_t StopCount = 500000;
+    const std::size_t RouteCount = 2000;
+    const std::size_t StopsPerRoute = 1000;
+    std::mt19937_64 Generator(3);
+
+    std::string Stops = "stop_id,node_id\n";
+    for(std::size_t Index = 0; Index < StopCount; Index++){
+        Stops += std::to_string(100000 + Index) + "," + std::to_string(2849810514ULL + Generator() % 10000000) + "\n";
+    }
+    std::string Routes = "route,stop_id\n";
+    for(std::size_t Route = 0; Route < RouteCount; Route++){
+        std::string Name = "Route " + std::to_string(Route);
+        for(std::size_t Stop = 0; Stop < StopsPerRoute; Stop++){
+            Routes += Name + "," + std::to_string(100000 + Generator() % StopCount) + "\n";
+        }
+    }
+
+    std::cout << "CCSVBusSystem load, " << StopCount << " stops, " << RouteCount * StopsPerRoute << " route rows" << std::endl;
+    std::cout << "loader\tms\theap MB" << std::endl;
+    {
+        CDSVReader StopReader(std::make_shared<CStringDataSource>(Stops), ',');
+        CDSVReader RouteReader(std::make_shared<CStringDataSource>(Routes), ',');
+        std::size_t HeapBefore = HeapInUse();
+        BenchmarkUtils::CStopwatch Stopwatch;
+        SReferenceBusSystem BusSystem(StopReader, RouteReader);
+        double Milliseconds = Stopwatch.Seconds() * 1000.0;
+        std::cout << "stoul/shared_ptr\t" << Milliseconds << "\t" << (HeapInUse() - HeapBefore) / (1024.0 * 1024.0) << std::endl;
+    }
+    {
+        auto StopReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(Stops), ',');
+        auto RouteReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(Routes), ',');
+        std::size_t HeapBefore = HeapInUse();
+        BenchmarkUtils::CStopwatch Stopwatch;
+        CCSVBusSystem BusSystem(StopReader, RouteReader);
+        double Milliseconds = Stopwatch.Seconds() * 1000.0;
+        std::cout << "CCSVBusSystem\t" << Milliseconds << "\t" << (HeapInUse() - HeapBefore) / (1024.0 * 1024.0) << std::endl;
+    }
+    return 0;
+}
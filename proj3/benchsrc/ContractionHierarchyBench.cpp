@@ -0,0 +1,61 @@
+#include "ContractionHierarchy.h"
+#include "ContractionHierarchySearch.h"
+#include "ShortestPathSearch.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "BenchmarkUtils.h"
+#include "GridMap.h"
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+static void Report(const std::string &label, const CStreetMap &map, std::size_t querycount){
+    auto Graph = std::make_shared<CRoutingGraph>(map);
+    BenchmarkUtils::CStopwatch BuildStopwatch;
+    auto Hierarchy = std::make_shared<CContractionHierarchy>(*Graph);
+    double BuildMS = BuildStopwatch.Seconds() * 1000.0;
+
+    std::string Filename = "/tmp/ContractionHierarchyBench.ch";
+    Hierarchy->Save(Filename);
+    BenchmarkUtils::CStopwatch LoadStopwatch;
+    CContractionHierarchy Loaded(Filename);
+    double LoadMS = LoadStopwatch.Seconds() * 1000.0;
+    std::remove(Filename.c_str());
+
+    std::cout << label << "\t" << Graph->VertexCount() << " vertices\t" << Graph->EdgeCount() << " edges\t" << Hierarchy->ShortcutCount() << " shortcuts\tbuild " << BuildMS << " ms\tload " << LoadMS << " ms" << std::endl;
+
+    std::mt19937 Generator(5);
+    std::uniform_int_distribution<CRoutingGraph::TVertexID> Pick(0, Graph->VertexCount() - 1);
+    std::vector<std::pair<CRoutingGraph::TVertexID, CRoutingGraph::TVertexID>> Queries;
+    for(std::size_t Index = 0; Index < querycount; Index++){
+        Queries.push_back({Pick(Generator), Pick(Generator)});
+    }
+    std::vector<CRoutingGraph::TVertexID> Path;
+    CShortestPathSearch Reference(Graph);
+    CContractionHierarchySearch Search(Hierarchy);
+    auto Time = [&](const std::string &name, auto query, auto settled){
+        std::size_t Settled = 0;
+        double Total = 0.0;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        for(auto &Query : Queries){
+            double Distance = query(Query.first, Query.second);
+            Total += Distance == CShortestPathSearch::NoPathExists ? 0.0 : Distance;
+            Settled += settled();
+        }
+        double Seconds = Stopwatch.Seconds();
+        std::cout << "\t" << name << "\t" << Seconds * 1e6 / querycount << "\t" << Settled / querycount << "\t(total " << Total << " m)" << std::endl;
+    };
+    Time("Dijkstra", [&](auto src, auto dest){ return Reference.Dijkstra(src, dest, Path); }, [&]{ return Reference.SettledCount(); });
+    Time("A*", [&](auto src, auto dest){ return Reference.AStar(src, dest, Path); }, [&]{ return Reference.SettledCount(); });
+    Time("CH path", [&](auto src, auto dest){ return Search.FindShortestPath(src, dest, Path); }, [&]{ return Search.SettledCount(); });
+    Time("CH distance", [&](auto src, auto dest){ return Search.FindDistance(src, dest); }, [&]{ return Search.SettledCount(); });
+}
+
+int main(){
+    std::cout << "search\tus/query\tsettled/query" << std::endl;
+    COpenStreetMap Davis(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    Report("davis", Davis, 2000);
+    Report("grid 300x300", CGridMap(300), 200);
+    return 0;
+}
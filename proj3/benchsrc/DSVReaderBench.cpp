@@ -0,0 +1,118 @@
+#include "DSVReader.h"
+#include "MappedFileDataSource.h"
+#include "BenchmarkUtils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+// the reader as it was before the block scanner, one virtual Get per
+// character and one append per cell character, kept as the baseline
+static bool ReferenceReadRow(CDataSource &source, char delimiter, std::vector<std::string> &row){
+    row.clear();
+    std::string Cell;
+    bool InQuotes = false;
+    bool Data = false;
+    char Current;
+    while(!source.End()){
+        if(!source.Get(Current)){
+            return false;
+        }
+        Data = true;
+        if(Current == '"'){
+            char Next;
+            if(!source.End() && source.Peek(Next) && Next == '"'){
+                source.Get(Next);
+                Cell += '"';
+            }
+            else{
+                InQuotes = !InQuotes;
+            }
+        }
+        else if(Current == delimiter && !InQuotes){
+            row.push_back(Cell);
+            Cell.clear();
+        }
+        else if((Current == '\n' || Current == '\r') && !InQuotes){
+            if(!Cell.empty() || !row.empty()){
+                row.push_back(Cell);
+            }
+            char Next;
+            if(Current == '\r' && !source.End() && source.Peek(Next) && Next == '\n'){
+                source.Get(Next);
+            }
+            return true;
+        }
+        else{
+            Cell += Current;
+        }
+    }
+    if(!Cell.empty() || Data){
+        row.push_back(Cell);
+    }
+    return Data;
+}
+
+// GTFS-like rows, every tenth name is quoted with an embedded delimiter and quote
+static std::string BuildCSV(std::size_t targetbytes){
+    std::mt19937 Generator(7);
+    std::string Result = "stop_id,node_id,stop_name,stop_lat,stop_lon\n";
+    Result.reserve(targetbytes + 256);
+    std::size_t Row = 0;
+    while(Result.size() < targetbytes){
+        Result += std::to_string(20000 + Row) + "," + std::to_string(2849810514ULL + Generator() % 100000) + ",";
+        if(Row % 10 == 0){
+            Result += "\"Russell Blvd, \"\"West\"\" & Sycamore Ln\",";
+        }
+        else{
+            Result += "Russell Blvd & Sycamore Ln,";
+        }
+        Result += "38." + std::to_string(Generator() % 10000000) + ",-121." + std::to_string(Generator() % 10000000) + "\n";
+        Row++;
+    }
+    return Result;
+}
+
+int main(int argc, char *argv[]){
+    std::size_t Megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+    const std::string TempFilename = "/tmp/DSVReaderBench.csv";
+    BenchmarkUtils::SaveFile(TempFilename, BuildCSV(Megabytes * 1024 * 1024));
+
+    std::cout << "CDSVReader on " << Megabytes << " MB of CSV" << std::endl;
+    std::cout << "reader\trows\tcells\tMB/s" << std::endl;
+    {
+        CMappedFileDataSource Source(TempFilename);
+        std::vector<std::string> Row;
+        std::size_t RowCount = 0, CellCount = 0;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        while(ReferenceReadRow(Source, ',', Row)){
+            RowCount++;
+            CellCount += Row.size();
+        }
+        std::cout << "per-char\t" << RowCount << "\t" << CellCount << "\t" << Megabytes / Stopwatch.Seconds() << std::endl;
+    }
+    {
+        CDSVReader Reader(std::make_shared<CMappedFileDataSource>(TempFilename), ',');
+        std::vector<std::string> Row;
+        std::size_t RowCount = 0, CellCount = 0;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        while(Reader.ReadRow(Row)){
+            RowCount++;
+            CellCount += Row.size();
+        }
+        std::cout << "ReadRow\t" << RowCount << "\t" << CellCount << "\t" << Megabytes / Stopwatch.Seconds() << std::endl;
+    }
+    {
+        CDSVReader Reader(std::make_shared<CMappedFileDataSource>(TempFilename), ',');
+        std::vector<std::string_view> Row;
+        std::size_t RowCount = 0, CellCount = 0;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        while(Reader.ReadRowView(Row)){
+            RowCount++;
+            CellCount += Row.size();
+        }
+        std::cout << "ReadRowView\t" << RowCount << "\t" << CellCount << "\t" << Megabytes / Stopwatch.Seconds() << std::endl;
+    }
+    std::remove(TempFilename.c_str());
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "StringDataSink.h"
+#include "BufferedDataSink.h"
+#include "FileDataSink.h"
+#include "DSVWriter.h"
+#include "XMLWriter.h"
+#include "BenchmarkUtils.h"
+#include <cstdio>
+#include <iostream>
+
+// wraps a sink and forwards every span one byte per virtual Put, the way the
+// writers fed their sinks before they switched to span writes
+class CPerCharDataSink : public CDataSink{
+    private:
+        std::shared_ptr<CDataSink> DSink;
+    public:
+        CPerCharDataSink(std::shared_ptr<CDataSink> sink) : DSink(sink){}
+
+        using CDataSink::Write;
+        bool Put(const char &ch) noexcept override{
+            return DSink->Put(ch);
+        }
+        bool Write(const std::vector<char> &buf) noexcept override{
+            return Write(buf.data(), buf.size());
+        }
+        bool Write(const char *buf, std::size_t count) noexcept override{
+            for(std::size_t Index = 0; Index < count; Index++){
+                if(!DSink->Put(buf[Index])){
+                    return false;
+                }
+            }
+            return true;
+        }
+};
+
+static const std::size_t RowCount = 500000;
+
+static std::size_t WriteDSV(std::shared_ptr<CDataSink> sink){
+    CDSVWriter Writer(sink, ',');
+    std::vector<std::string> Row = {"", "2849810514", "Russell Blvd & \"Sycamore\" Ln", "38.5449", "-121.7405"};
+    std::size_t Bytes = 0;
+    for(std::size_t Index = 0; Index < RowCount; Index++){
+        Row[0] = std::to_string(Index);
+        Writer.WriteRow(Row);
+        Bytes += 60;
+    }
+    return Bytes;
+}
+
+static std::size_t WriteXML(std::shared_ptr<CDataSink> sink){
+    CXMLWriter Writer(sink);
+    SXMLEntity Node{SXMLEntity::EType::CompleteElement, "node", {{"id", ""}, {"lat", "38.5449"}, {"lon", "-121.7405"}, {"name", "A & B"}}};
+    std::size_t Bytes = 0;
+    Writer.WriteEntity({SXMLEntity::EType::StartElement, "osm", {}});
+    for(std::size_t Index = 0; Index < RowCount; Index++){
+        Node.DAttributes[0].second = std::to_string(Index);
+        Writer.WriteEntity(Node);
+        Bytes += 70;
+    }
+    Writer.Flush();
+    return Bytes;
+}
+
+template <typename TWrite>
+static void Report(const std::string &label, TWrite write, std::shared_ptr<CDataSink> sink){
+    BenchmarkUtils::CStopwatch Stopwatch;
+    std::size_t Bytes = write(sink);
+    if(auto Buffered = std::dynamic_pointer_cast<CBufferedDataSink>(sink)){
+        Buffered->Flush();
+    }
+    if(auto File = std::dynamic_pointer_cast<CFileDataSink>(sink)){
+        File->Flush();
+    }
+    double Seconds = Stopwatch.Seconds();
+    std::cout << label << "\t" << Seconds * 1000.0 << " ms\t~" << Bytes / Seconds / 1e6 << " MB/s" << std::endl;
+}
+
+int main(){
+    const std::string FileName = "/tmp/DataSinkBench.out";
+    for(auto Format : {std::string("DSV"), std::string("XML")}){
+        auto Write = Format == "DSV" ? WriteDSV : WriteXML;
+        std::cout << Format << " writer, " << RowCount << " records" << std::endl;
+        Report("per-char string", Write, std::make_shared<CPerCharDataSink>(std::make_shared<CStringDataSink>()));
+        Report("span string    ", Write, std::make_shared<CStringDataSink>());
+        std::remove(FileName.c_str());
+        Report("per-char file  ", Write, std::make_shared<CPerCharDataSink>(std::make_shared<CFileDataSink>(FileName)));
+        std::remove(FileName.c_str());
+        Report("span file      ", Write, std::make_shared<CFileDataSink>(FileName));
+        std::remove(FileName.c_str());
+        Report("buffered file  ", Write, std::make_shared<CBufferedDataSink>(std::make_shared<CFileDataSink>(FileName, CFileDataSink::EFlushPolicy::EveryWrite)));
+        std::remove(FileName.c_str());
+    }
+    return 0;
+}
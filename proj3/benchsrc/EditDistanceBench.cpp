@@ -0,0 +1,69 @@
+#include "StringUtils.h"
+#include "BenchmarkUtils.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+// the full table dynamic program EditDistance used before
+static int TableEditDistance(const std::string &left, const std::string &right){
+    std::vector<std::vector<int>> Table(left.size() + 1, std::vector<int>(right.size() + 1));
+    for(std::size_t Row = 0; Row <= left.size(); Row++){
+        Table[Row][0] = Row;
+    }
+    for(std::size_t Column = 0; Column <= right.size(); Column++){
+        Table[0][Column] = Column;
+    }
+    for(std::size_t Row = 1; Row <= left.size(); Row++){
+        for(std::size_t Column = 1; Column <= right.size(); Column++){
+            int Cost = left[Row - 1] == right[Column - 1] ? 0 : 1;
+            Table[Row][Column] = std::min({Table[Row - 1][Column] + 1, Table[Row][Column - 1] + 1, Table[Row - 1][Column - 1] + Cost});
+        }
+    }
+    return Table[left.size()][right.size()];
+}
+
+int main(){
+    std::mt19937 Generator(18);
+    std::uniform_int_distribution<int> Letter('a', 'z');
+    std::cout << "length\tpairs\ttable us/pair\tbit us/pair\tbounded(2) us/pair\tbatch us/pair" << std::endl;
+    for(std::size_t Length : {8, 20, 64, 200}){
+        const std::size_t PairCount = Length < 64 ? 20000 : 2000;
+        std::vector<std::string> Words;
+        for(std::size_t Index = 0; Index < PairCount + 1; Index++){
+            std::uniform_int_distribution<std::size_t> Size(Length / 2, Length + Length / 2);
+            std::string Word(Size(Generator), ' ');
+            for(auto &Ch : Word){
+                Ch = Letter(Generator);
+            }
+            Words.push_back(Word);
+        }
+        long Checksum[4] = {0, 0, 0, 0};
+        BenchmarkUtils::CStopwatch TableStopwatch;
+        for(std::size_t Index = 0; Index < PairCount; Index++){
+            Checksum[0] += TableEditDistance(Words[0], Words[Index + 1]);
+        }
+        double TableSeconds = TableStopwatch.Seconds();
+        BenchmarkUtils::CStopwatch BitStopwatch;
+        for(std::size_t Index = 0; Index < PairCount; Index++){
+            Checksum[1] += StringUtils::EditDistance(Words[0], Words[Index + 1]);
+        }
+        double BitSeconds = BitStopwatch.Seconds();
+        BenchmarkUtils::CStopwatch BoundedStopwatch;
+        for(std::size_t Index = 0; Index < PairCount; Index++){
+            Checksum[2] += StringUtils::EditDistance(Words[0], Words[Index + 1], false, 2);
+        }
+        double BoundedSeconds = BoundedStopwatch.Seconds();
+        std::vector<std::string> Candidates(Words.begin() + 1, Words.end());
+        BenchmarkUtils::CStopwatch BatchStopwatch;
+        for(int Distance : StringUtils::EditDistances(Words[0], Candidates)){
+            Checksum[3] += Distance;
+        }
+        double BatchSeconds = BatchStopwatch.Seconds();
+        if(Checksum[0] != Checksum[1] || Checksum[0] != Checksum[3]){
+            std::cerr << "distances differ at length " << Length << std::endl;
+            return 1;
+        }
+        std::cout << Length << "\t" << PairCount << "\t" << TableSeconds * 1e6 / PairCount << "\t" << BitSeconds * 1e6 / PairCount << "\t" << BoundedSeconds * 1e6 / PairCount << "\t" << BatchSeconds * 1e6 / PairCount << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef GRIDMAP_H
+#define GRIDMAP_H
+
+#include "StreetMap.h"
+
+// a Side x Side grid of streets about 100 m apart, computed on the fly. Each
+// row and each column is one way
+class CGridMap : public CStreetMap{
+    private:
+        std::size_t DSide;
+
+        struct SGridNode : public SNode{
+            TNodeID DID;
+            TLocation DLocation;
+            SGridNode(TNodeID id, TLocation location) : DID(id), DLocation(location){}
+            TNodeID ID() const noexcept override{ return DID; }
+            TLocation Location() const noexcept override{ return DLocation; }
+            std::size_t AttributeCount() const noexcept override{ return 0; }
+            std::string GetAttributeKey(std::size_t) const noexcept override{ return ""; }
+            bool HasAttribute(const std::string &) const noexcept override{ return false; }
+            std::string GetAttribute(const std::string &) const noexcept override{ return ""; }
+        };
+
+        struct SGridWay : public SWay{
+            TWayID DID;
+            std::size_t DSide;
+            SGridWay(TWayID id, std::size_t side) : DID(id), DSide(side){}
+            TWayID ID() const noexcept override{ return DID; }
+            std::size_t NodeCount() const noexcept override{ return DSide; }
+            // ways below Side are rows, the rest are columns
+            TNodeID GetNodeID(std::size_t index) const noexcept override{
+                return DID < DSide ? DID * DSide + index : index * DSide + (DID - DSide);
+            }
+            std::size_t AttributeCount() const noexcept override{ return 0; }
+            std::string GetAttributeKey(std::size_t) const noexcept override{ return ""; }
+            bool HasAttribute(const std::string &) const noexcept override{ return false; }
+            std::string GetAttribute(const std::string &) const noexcept override{ return ""; }
+        };
+
+    public:
+        CGridMap(std::size_t side) : DSide(side){}
+
+        std::size_t NodeCount() const noexcept override{ return DSide * DSide; }
+        std::size_t WayCount() const noexcept override{ return DSide * 2; }
+        std::shared_ptr<SNode> NodeByIndex(std::size_t index) const noexcept override{
+            if(index >= NodeCount()){
+                return nullptr;
+            }
+            return std::make_shared<SGridNode>(index, TLocation(38.0 + (index / DSide) * 0.0009, -121.0 + (index % DSide) * 0.00115));
+        }
+        std::shared_ptr<SNode> NodeByID(TNodeID id) const noexcept override{ return NodeByIndex(id); }
+        std::shared_ptr<SWay> WayByIndex(std::size_t index) const noexcept override{
+            if(index >= WayCount()){
+                return nullptr;
+            }
+            return std::make_shared<SGridWay>(index, DSide);
+        }
+        std::shared_ptr<SWay> WayByID(TWayID id) const noexcept override{ return WayByIndex(id); }
+};
+
+#endif
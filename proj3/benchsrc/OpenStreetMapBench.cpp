@@ -0,0 +1,152 @@
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "BenchmarkUtils.h"
+#include <chrono>
+#include <iostream>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// the storage as it was before the arrays: one shared_ptr per node and way,
+// each with its own attribute map
+struct SReferenceNode{
+    CStreetMap::TNodeID NodeID;
+    CStreetMap::TLocation NodeLocation;
+    std::unordered_map<std::string, std::string> Attributes;
+};
+
+struct SReferenceWay{
+    CStreetMap::TWayID WayID;
+    std::vector<CStreetMap::TNodeID> NodeIDs;
+    std::unordered_map<std::string, std::string> Attributes;
+};
+
+static std::size_t HeapInUse(){
+    return mallinfo2().uordblks;
+}
+
+// heap used by the map and by the old layout holding the same nodes
+static void ReportStorage(std::size_t copies){
+    std::string Document = BenchmarkUtils::ScaledDavisOSM(copies);
+    auto Source = std::make_shared<CStringDataSource>(Document);
+    auto Reader = std::make_shared<CXMLReader>(Source);
+    std::size_t HeapBefore = HeapInUse();
+    BenchmarkUtils::CStopwatch Stopwatch;
+    COpenStreetMap Map(Reader);
+    double LoadMS = Stopwatch.Seconds() * 1000.0;
+    double MapMB = (HeapInUse() - HeapBefore) / (1024.0 * 1024.0);
+
+    HeapBefore = HeapInUse();
+    std::vector<std::shared_ptr<SReferenceNode>> Reference;
+    for(std::size_t Index = 0; Index < Map.NodeCount(); Index++){
+        auto Node = Map.NodeByIndex(Index);
+        auto Copy = std::make_shared<SReferenceNode>();
+        Copy->NodeID = Node->ID();
+        Copy->NodeLocation = Node->Location();
+        for(std::size_t Attribute = 0; Attribute < Node->AttributeCount(); Attribute++){
+            auto Key = Node->GetAttributeKey(Attribute);
+            Copy->Attributes[Key] = Node->GetAttribute(Key);
+        }
+        Reference.push_back(Copy);
+    }
+    std::vector<std::shared_ptr<SReferenceWay>> ReferenceWays;
+    for(std::size_t Index = 0; Index < Map.WayCount(); Index++){
+        auto Way = Map.WayByIndex(Index);
+        auto Copy = std::make_shared<SReferenceWay>();
+        Copy->WayID = Way->ID();
+        for(std::size_t Node = 0; Node < Way->NodeCount(); Node++){
+            Copy->NodeIDs.push_back(Way->GetNodeID(Node));
+        }
+        for(std::size_t Attribute = 0; Attribute < Way->AttributeCount(); Attribute++){
+            auto Key = Way->GetAttributeKey(Attribute);
+            Copy->Attributes[Key] = Way->GetAttribute(Key);
+        }
+        ReferenceWays.push_back(Copy);
+    }
+    double ReferenceMB = (HeapInUse() - HeapBefore) / (1024.0 * 1024.0);
+
+    // sequential pass over every coordinate, the old layout chases a pointer per node
+    Stopwatch = BenchmarkUtils::CStopwatch();
+    double Sum = 0.0;
+    for(auto &Node : Reference){
+        Sum += Node->NodeLocation.first + Node->NodeLocation.second;
+    }
+    double ReferenceScanMS = Stopwatch.Seconds() * 1000.0;
+    std::cout << Map.NodeCount() << "\t" << LoadMS << "\t" << MapMB << "\t" << ReferenceMB << "\t" << ReferenceMB / MapMB << "x\t" << ReferenceScanMS << "\t(sum " << Sum << ")" << std::endl;
+}
+
+// builds a synthetic OSM document with mostly ascending node IDs, every
+// hundredth node is swapped with its neighbour like real extracts sometimes are
+static std::string BuildMap(std::size_t nodecount, std::vector<CStreetMap::TNodeID> &ids){
+    std::string Document = "<?xml version='1.0' encoding='UTF-8'?>\n<osm version=\"0.6\">\n";
+    ids.clear();
+    for(std::size_t Index = 0; Index < nodecount; Index++){
+        ids.push_back(1000 + Index * 3);
+    }
+    for(std::size_t Index = 1; Index < nodecount; Index += 100){
+        std::swap(ids[Index - 1], ids[Index]);
+    }
+    for(auto ID : ids){
+        Document += "\t<node id=\"" + std::to_string(ID) + "\" lat=\"38.5\" lon=\"-121.7\"/>\n";
+    }
+    for(std::size_t Index = 0; Index + 1 < nodecount; Index += 2){
+        Document += "\t<way id=\"" + std::to_string(Index) + "\">\n";
+        Document += "\t\t<nd ref=\"" + std::to_string(ids[Index]) + "\"/>\n";
+        Document += "\t\t<nd ref=\"" + std::to_string(ids[Index + 1]) + "\"/>\n";
+        Document += "\t</way>\n";
+    }
+    Document += "</osm>\n";
+    return Document;
+}
+
+int main(){
+    const std::size_t LookupCount = 200000;
+    std::mt19937_64 Generator(42);
+
+    std::cout << "COpenStreetMap ID lookup" << std::endl;
+    std::cout << "nodes\tload ms\tNodeByID ns\tWayByID ns" << std::endl;
+    for(std::size_t NodeCount : {1000, 10000, 100000, 400000}){
+        std::vector<CStreetMap::TNodeID> IDs;
+        auto Source = std::make_shared<CStringDataSource>(BuildMap(NodeCount, IDs));
+        auto LoadStart = std::chrono::steady_clock::now();
+        COpenStreetMap Map(std::make_shared<CXMLReader>(Source));
+        auto LoadEnd = std::chrono::steady_clock::now();
+
+        std::vector<CStreetMap::TNodeID> Queries(LookupCount);
+        std::uniform_int_distribution<std::size_t> Pick(0, IDs.size() - 1);
+        for(auto &Query : Queries){
+            Query = IDs[Pick(Generator)];
+        }
+        std::size_t Found = 0;
+        auto NodeStart = std::chrono::steady_clock::now();
+        for(auto Query : Queries){
+            Found += Map.NodeByID(Query) ? 1 : 0;
+        }
+        auto NodeEnd = std::chrono::steady_clock::now();
+
+        std::uniform_int_distribution<std::size_t> PickWay(0, Map.WayCount() - 1);
+        for(auto &Query : Queries){
+            Query = PickWay(Generator) * 2;
+        }
+        auto WayStart = std::chrono::steady_clock::now();
+        for(auto Query : Queries){
+            Found += Map.WayByID(Query) ? 1 : 0;
+        }
+        auto WayEnd = std::chrono::steady_clock::now();
+
+        double LoadMS = std::chrono::duration<double, std::milli>(LoadEnd - LoadStart).count();
+        double NodeNS = std::chrono::duration<double, std::nano>(NodeEnd - NodeStart).count() / LookupCount;
+        double WayNS = std::chrono::duration<double, std::nano>(WayEnd - WayStart).count() / LookupCount;
+        std::cout << NodeCount << "\t" << LoadMS << "\t" << NodeNS << "\t" << WayNS << "\t(found " << Found << ")" << std::endl;
+    }
+
+    std::cout << "COpenStreetMap storage, davis.osm repeated" << std::endl;
+    std::cout << "nodes\tload ms\tmap MB\tshared_ptr MB\tratio\tshared_ptr scan ms" << std::endl;
+    for(std::size_t Copies : {1, 10, 40}){
+        ReportStorage(Copies);
+    }
+    return 0;
+}
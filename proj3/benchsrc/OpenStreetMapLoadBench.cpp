@@ -0,0 +1,162 @@
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "MappedFileDataSource.h"
+#include "OSMXMLScanner.h"
+#include "BenchmarkUtils.h"
+#include <iostream>
+
+// hides the data source of a real reader so COpenStreetMap has to go through
+// ReadEntity, the way it loaded before CXMLReader::Parse
+class CEntityOnlyReader : public CXMLReader{
+    private:
+        CXMLReader DReader;
+    public:
+        CEntityOnlyReader(std::shared_ptr<CDataSource> src) : CXMLReader(nullptr), DReader(src){}
+
+        bool End() const override{
+            return DReader.End();
+        }
+        bool ReadEntity(SXMLEntity &entity, bool skipcdata = false) override{
+            return DReader.ReadEntity(entity, skipcdata);
+        }
+};
+
+// counts the callbacks and looks at every attribute like a loader would
+class CCountingVisitor : public CXMLVisitor{
+    public:
+        std::size_t Elements = 0;
+        std::size_t AttributeBytes = 0;
+
+        void StartElement(std::string_view name, SXMLEntity::TAtom atom, const SXMLAttributes &attributes) override{
+            Elements++;
+            for(std::size_t Index = 0; Index < attributes.Count(); Index++){
+                AttributeBytes += attributes.Value(Index).size();
+            }
+        }
+        void EndElement(std::string_view name, SXMLEntity::TAtom atom) override{}
+};
+
+// counts what the scanner finds without building a map
+class CCountingScanVisitor : public COSMXMLVisitor{
+    public:
+        std::size_t Elements = 0;
+        std::size_t TagBytes = 0;
+
+        void BeginNode(uint64_t id, double latitude, double longitude) override{
+            Elements++;
+        }
+        void EndNode() override{}
+        void BeginWay(uint64_t id) override{
+            Elements++;
+        }
+        void EndWay() override{}
+        void WayNode(uint64_t ref) override{
+            Elements++;
+        }
+        void Tag(std::string_view key, std::string_view value) override{
+            TagBytes += value.size();
+        }
+};
+
+int main(){
+    const std::size_t Copies = 20;
+    std::string Document = BenchmarkUtils::ScaledDavisOSM(Copies);
+    double MB = Document.size() / (1024.0 * 1024.0);
+    std::cout << "data/davis.osm x" << Copies << " (" << MB << " MB)" << std::endl;
+    std::cout << "reader\tms\tMB/s" << std::endl;
+    auto Report = [&](const std::string &label, double seconds){
+        std::cout << label << "\t" << seconds * 1000.0 << "\t" << MB / seconds << std::endl;
+    };
+
+    {
+        CXMLReader Reader(std::make_shared<CStringDataSource>(Document), 65536);
+        SXMLEntity Entity;
+        std::size_t Elements = 0, AttributeBytes = 0;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        while(Reader.ReadEntity(Entity, true)){
+            if(Entity.DType == SXMLEntity::EType::StartElement){
+                Elements++;
+                for(auto &Attribute : Entity.DAttributes){
+                    AttributeBytes += Attribute.second.size();
+                }
+            }
+        }
+        Report("ReadEntity", Stopwatch.Seconds());
+        std::cout << "\t(" << Elements << " elements, " << AttributeBytes << " attribute bytes)" << std::endl;
+    }
+    // picking the OSM elements and their IDs out of the entities by name and by atom
+    for(bool ByAtom : {false, true}){
+        CXMLReader Reader(std::make_shared<CStringDataSource>(Document), 65536);
+        auto NodeAtom = Reader.NameAtom("node"), WayAtom = Reader.NameAtom("way"), IDAtom = Reader.NameAtom("id");
+        SXMLEntity Entity;
+        std::size_t IDBytes = 0;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        while(Reader.ReadEntity(Entity, true)){
+            if(Entity.DType != SXMLEntity::EType::StartElement){
+                continue;
+            }
+            if(ByAtom){
+                if(Entity.DNameAtom == NodeAtom || Entity.DNameAtom == WayAtom){
+                    IDBytes += Entity.AttributeValue(IDAtom).size();
+                }
+            }
+            else if(Entity.DNameData == "node" || Entity.DNameData == "way"){
+                IDBytes += Entity.AttributeValue("id").size();
+            }
+        }
+        Report(ByAtom ? "ReadEntity, IDs by atom" : "ReadEntity, IDs by name", Stopwatch.Seconds());
+        std::cout << "	(" << IDBytes << " ID bytes)" << std::endl;
+    }
+    for(bool Filtered : {false, true}){
+        CXMLReader Reader(std::make_shared<CStringDataSource>(Document), 65536);
+        CCountingVisitor Visitor;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        if(Filtered){
+            Reader.Parse(Visitor, {"node", "way", "nd", "tag"});
+        }
+        else{
+            Reader.Parse(Visitor);
+        }
+        Report(Filtered ? "Parse, OSM elements" : "Parse", Stopwatch.Seconds());
+        std::cout << "\t(" << Visitor.Elements << " elements, " << Visitor.AttributeBytes << " attribute bytes)" << std::endl;
+    }
+    // the scanner works on the mapped file in place
+    const std::string TempFilename = "/tmp/OpenStreetMapLoadBench.osm";
+    BenchmarkUtils::SaveFile(TempFilename, Document);
+    {
+        COSMXMLScanner Scanner(std::make_shared<CMappedFileDataSource>(TempFilename));
+        CCountingScanVisitor Visitor;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        Scanner.Scan(Visitor);
+        Report("COSMXMLScanner", Stopwatch.Seconds());
+        std::cout << "\t(" << Visitor.Elements << " nodes, ways and nds, " << Visitor.TagBytes << " tag value bytes)" << std::endl;
+    }
+
+    std::cout << "COpenStreetMap load" << std::endl;
+    for(int Round = 0; Round < 2; Round++){
+        BenchmarkUtils::CStopwatch EntityStopwatch;
+        COpenStreetMap EntityMap(std::make_shared<CEntityOnlyReader>(std::make_shared<CStringDataSource>(Document)));
+        Report("through ReadEntity", EntityStopwatch.Seconds());
+        BenchmarkUtils::CStopwatch ParseStopwatch;
+        COpenStreetMap ParseMap(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(Document), 65536));
+        Report("through Parse", ParseStopwatch.Seconds());
+        BenchmarkUtils::CStopwatch ScanStopwatch;
+        COpenStreetMap ScanMap(std::make_shared<COSMXMLScanner>(std::make_shared<CMappedFileDataSource>(TempFilename)), 1);
+        Report("through COSMXMLScanner", ScanStopwatch.Seconds());
+        for(std::size_t Threads : {2, 4}){
+            BenchmarkUtils::CStopwatch ThreadStopwatch;
+            COpenStreetMap ThreadMap(std::make_shared<COSMXMLScanner>(std::make_shared<CMappedFileDataSource>(TempFilename)), Threads);
+            Report("through COSMXMLScanner, " + std::to_string(Threads) + " threads", ThreadStopwatch.Seconds());
+            if(ThreadMap.NodeCount() != ScanMap.NodeCount() || ThreadMap.WayCount() != ScanMap.WayCount()){
+                std::cerr << "maps differ" << std::endl;
+                return 1;
+            }
+        }
+        if(EntityMap.NodeCount() != ParseMap.NodeCount() || EntityMap.WayCount() != ParseMap.WayCount() || ScanMap.NodeCount() != ParseMap.NodeCount() || ScanMap.WayCount() != ParseMap.WayCount()){
+            std::cerr << "maps differ" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "OpenStreetMap.h"
+#include "PBFReader.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "BenchmarkUtils.h"
+#include <iostream>
+#include <thread>
+
+static uint64_t ReadVarint(const std::string &data, std::size_t &position){
+    uint64_t Value = 0;
+    for(int Shift = 0; position < data.size(); Shift += 7){
+        uint8_t Byte = data[position++];
+        Value |= uint64_t(Byte & 0x7F) << Shift;
+        if(!(Byte & 0x80)){
+            break;
+        }
+    }
+    return Value;
+}
+
+// data/davis.osm.pbf with its data blobs repeated copies times, the blobs
+// are independent so the result is the same map as ScaledDavisOSM(copies)
+static std::string ScaledDavisPBF(std::size_t copies){
+    std::string Original = BenchmarkUtils::LoadFile("data/davis.osm.pbf");
+    // the first blob is the OSMHeader, find where it ends from the datasize in its BlobHeader
+    std::size_t HeaderLength = 0;
+    for(std::size_t Index = 0; Index < 4; Index++){
+        HeaderLength = (HeaderLength << 8) | uint8_t(Original[Index]);
+    }
+    std::size_t Position = 4;
+    uint64_t DataSize = 0;
+    while(Position < 4 + HeaderLength){
+        uint64_t Key = ReadVarint(Original, Position);
+        uint64_t Value = ReadVarint(Original, Position);
+        if((Key & 7) == 2){
+            Position += Value;
+        }
+        else if((Key >> 3) == 3){
+            DataSize = Value;
+        }
+    }
+    std::size_t BodyStart = Position + DataSize;
+    std::string Result = Original.substr(0, BodyStart);
+    for(std::size_t Copy = 0; Copy < copies; Copy++){
+        Result.append(Original, BodyStart, std::string::npos);
+    }
+    return Result;
+}
+
+int main(){
+    std::size_t HardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "COpenStreetMap load, davis repeated (" << HardwareThreads << " hardware threads)" << std::endl;
+    std::cout << "nodes\tXML MB\tPBF MB\tXML ms\tPBF 1 thread ms\tPBF all threads ms" << std::endl;
+    for(std::size_t Copies : {1, 10, 40}){
+        std::string XML = BenchmarkUtils::ScaledDavisOSM(Copies);
+        std::string PBF = ScaledDavisPBF(Copies);
+
+        BenchmarkUtils::CStopwatch XMLStopwatch;
+        COpenStreetMap XMLMap(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(XML)));
+        double XMLMS = XMLStopwatch.Seconds() * 1000.0;
+
+        BenchmarkUtils::CStopwatch SingleStopwatch;
+        COpenStreetMap SingleMap(std::make_shared<CPBFReader>(std::make_shared<CStringDataSource>(PBF), 1));
+        double SingleMS = SingleStopwatch.Seconds() * 1000.0;
+
+        BenchmarkUtils::CStopwatch ParallelStopwatch;
+        COpenStreetMap ParallelMap(std::make_shared<CPBFReader>(std::make_shared<CStringDataSource>(PBF)));
+        double ParallelMS = ParallelStopwatch.Seconds() * 1000.0;
+
+        bool Same = XMLMap.NodeCount() == ParallelMap.NodeCount() && XMLMap.WayCount() == ParallelMap.WayCount() && SingleMap.NodeCount() == ParallelMap.NodeCount();
+        std::cout << XMLMap.NodeCount() << "\t" << XML.size() / 1e6 << "\t" << PBF.size() / 1e6 << "\t" << XMLMS << "\t" << SingleMS << "\t" << ParallelMS << (Same ? "" : "\t(mismatch)") << std::endl;
+    }
+    return 0;
+}
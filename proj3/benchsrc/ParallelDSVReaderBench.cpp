@@ -0,0 +1,60 @@
+#include "DSVReader.h"
+#include "ParallelDSVReader.h"
+#include "MappedFileDataSource.h"
+#include "BenchmarkUtils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+
+// rows with a quoted cell containing delimiters and line breaks every so
+// often, so chunk boundaries regularly land inside quotes
+static std::string BuildCSV(std::size_t targetbytes){
+    std::mt19937 Generator(11);
+    std::string Result = "route,stop_id,note\n";
+    Result.reserve(targetbytes + 256);
+    std::size_t Row = 0;
+    while(Result.size() < targetbytes){
+        Result += std::string(1, 'A' + Row % 26) + "," + std::to_string(22000 + Generator() % 1000) + ",";
+        if(Row % 7 == 0){
+            Result += "\"detour, see\nnotice \"\"" + std::to_string(Row) + "\"\"\"\n";
+        }
+        else{
+            Result += "regular service\n";
+        }
+        Row++;
+    }
+    return Result;
+}
+
+template <typename TReader>
+static double Throughput(TReader &reader, std::size_t megabytes, std::size_t &rows){
+    std::vector<std::string_view> Row;
+    rows = 0;
+    BenchmarkUtils::CStopwatch Stopwatch;
+    while(reader.ReadRowView(Row)){
+        rows++;
+    }
+    return megabytes / Stopwatch.Seconds();
+}
+
+int main(int argc, char *argv[]){
+    std::size_t Megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 512;
+    const std::string TempFilename = "/tmp/ParallelDSVReaderBench.csv";
+    BenchmarkUtils::SaveFile(TempFilename, BuildCSV(Megabytes * 1024 * 1024));
+
+    std::cout << "CParallelDSVReader scaling on " << Megabytes << " MB of CSV (" << std::thread::hardware_concurrency() << " hardware threads)" << std::endl;
+    std::cout << "reader\tthreads\trows\tMB/s\tspeedup" << std::endl;
+    std::size_t Rows;
+    CDSVReader SequentialReader(std::make_shared<CMappedFileDataSource>(TempFilename), ',');
+    double Baseline = Throughput(SequentialReader, Megabytes, Rows);
+    std::cout << "CDSVReader\t1\t" << Rows << "\t" << Baseline << "\t1" << std::endl;
+    for(std::size_t Threads : {1, 2, 4, 8, 16}){
+        CParallelDSVReader Reader(std::make_shared<CMappedFileDataSource>(TempFilename), ',', Threads);
+        double Rate = Throughput(Reader, Megabytes, Rows);
+        std::cout << "parallel\t" << Threads << "\t" << Rows << "\t" << Rate << "\t" << Rate / Baseline << std::endl;
+    }
+    std::remove(TempFilename.c_str());
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "RoutingGraph.h"
+#include "ShortestPathSearch.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "BenchmarkUtils.h"
+#include "GridMap.h"
+#include <iostream>
+#include <random>
+
+static void Report(const std::string &label, const CStreetMap &map, std::size_t querycount){
+    BenchmarkUtils::CStopwatch BuildStopwatch;
+    auto Graph = std::make_shared<CRoutingGraph>(map);
+    double BuildMS = BuildStopwatch.Seconds() * 1000.0;
+    CShortestPathSearch Search(Graph);
+    std::mt19937 Generator(5);
+    std::uniform_int_distribution<CRoutingGraph::TVertexID> Pick(0, Graph->VertexCount() - 1);
+    std::vector<std::pair<CRoutingGraph::TVertexID, CRoutingGraph::TVertexID>> Queries;
+    for(std::size_t Index = 0; Index < querycount; Index++){
+        Queries.push_back({Pick(Generator), Pick(Generator)});
+    }
+    std::vector<CRoutingGraph::TVertexID> Path;
+    for(bool UseAStar : {false, true}){
+        std::size_t Settled = 0;
+        double Total = 0.0;
+        BenchmarkUtils::CStopwatch Stopwatch;
+        for(auto &Query : Queries){
+            double Distance = UseAStar ? Search.AStar(Query.first, Query.second, Path) : Search.Dijkstra(Query.first, Query.second, Path);
+            Total += Distance == CShortestPathSearch::NoPathExists ? 0.0 : Distance;
+            Settled += Search.SettledCount();
+        }
+        double Seconds = Stopwatch.Seconds();
+        std::cout << label << "\t" << Graph->VertexCount() << "\t" << Graph->EdgeCount() << "\t" << BuildMS << "\t" << (UseAStar ? "A*" : "Dijkstra") << "\t" << querycount / Seconds << "\t" << Settled / querycount << "\t(total " << Total << " m)" << std::endl;
+    }
+}
+
+int main(){
+    std::cout << "map\tvertices\tedges\tbuild ms\tsearch\tqueries/s\tsettled/query" << std::endl;
+    COpenStreetMap Davis(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    Report("davis", Davis, 5000);
+    Report("grid 1000x1000", CGridMap(1000), 100);
+    return 0;
+}
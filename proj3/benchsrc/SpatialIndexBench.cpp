@@ -0,0 +1,84 @@
+#include "SpatialIndex.h"
+#include "RoutingGraph.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "BenchmarkUtils.h"
+#include "GridMap.h"
+#include <iostream>
+#include <random>
+
+// the nearest node by scanning every node of the map
+static std::size_t ScanNearest(const CStreetMap &map, const CStreetMap::TLocation &location){
+    std::size_t Best = 0;
+    double BestDistance = std::numeric_limits<double>::max();
+    for(std::size_t Index = 0; Index < map.NodeCount(); Index++){
+        double Distance = CRoutingGraph::Haversine(location, map.NodeByIndex(Index)->Location());
+        if(Distance < BestDistance){
+            BestDistance = Distance;
+            Best = Index;
+        }
+    }
+    return Best;
+}
+
+static void Report(const std::string &label, const CStreetMap &map, double latitude, double longitude, double span){
+    BenchmarkUtils::CStopwatch BuildStopwatch;
+    CSpatialIndex Index(map);
+    double BuildMS = BuildStopwatch.Seconds() * 1000.0;
+    std::cout << label << ", " << Index.NodeCount() << " nodes, build " << BuildMS << " ms" << std::endl;
+
+    std::mt19937 Generator(9);
+    std::uniform_real_distribution<double> Latitude(latitude, latitude + span), Longitude(longitude, longitude + span);
+    std::vector<CStreetMap::TLocation> Locations;
+    for(int Query = 0; Query < 100000; Query++){
+        Locations.push_back({Latitude(Generator), Longitude(Generator)});
+    }
+    std::vector<CSpatialIndex::SResult> Results;
+    std::size_t Checksum = 0;
+
+    std::size_t ScanQueries = 20;
+    BenchmarkUtils::CStopwatch ScanStopwatch;
+    for(std::size_t Query = 0; Query < ScanQueries; Query++){
+        Checksum += ScanNearest(map, Locations[Query]);
+    }
+    std::cout << "\tfull scan nearest\t" << ScanStopwatch.Seconds() * 1e6 / ScanQueries << " us" << std::endl;
+
+    auto Time = [&](const std::string &name, auto query){
+        BenchmarkUtils::CStopwatch Stopwatch;
+        for(auto &Location : Locations){
+            Checksum += query(Location);
+        }
+        std::cout << "\t" << name << "\t" << Stopwatch.Seconds() * 1e6 / Locations.size() << " us" << std::endl;
+    };
+    Time("nearest", [&](const CStreetMap::TLocation &location){
+        CSpatialIndex::SResult Result;
+        Index.Nearest(location, Result);
+        return Result.Index;
+    });
+    Time("nearest routable", [&](const CStreetMap::TLocation &location){
+        CSpatialIndex::SResult Result;
+        Index.Nearest(location, Result, true);
+        return Result.Index;
+    });
+    Time("10 nearest", [&](const CStreetMap::TLocation &location){
+        Index.Nearest(location, 10, Results);
+        return Results.size();
+    });
+    Time("within 200 m", [&](const CStreetMap::TLocation &location){
+        Index.WithinRadius(location, 200.0, Results);
+        return Results.size();
+    });
+    Time("0.01 deg box", [&](const CStreetMap::TLocation &location){
+        Index.InBoundingBox(location, {location.first + 0.01, location.second + 0.01}, Results);
+        return Results.size();
+    });
+    std::cout << "\t(checksum " << Checksum << ")" << std::endl;
+}
+
+int main(){
+    COpenStreetMap Davis(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    Report("davis", Davis, 38.50, -121.80, 0.08);
+    Report("grid 1000x1000", CGridMap(1000), 38.0, -121.0, 0.9);
+    return 0;
+}
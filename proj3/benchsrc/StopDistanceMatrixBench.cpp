@@ -0,0 +1,78 @@
+#include "StopDistanceMatrix.h"
+#include "ShortestPathSearch.h"
+#include "CSVBusSystem.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "StringDataSource.h"
+#include "BenchmarkUtils.h"
+#include "GridMap.h"
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+
+// a stop at every spacing'th vertex of the graph
+static std::shared_ptr<CCSVBusSystem> SyntheticBusSystem(const CRoutingGraph &graph, std::size_t spacing){
+    std::string Stops = "stop_id,node_id\n";
+    for(std::size_t Vertex = 0; Vertex < graph.VertexCount(); Vertex += spacing){
+        Stops += std::to_string(Vertex + 1) + "," + std::to_string(graph.NodeID(Vertex)) + "\n";
+    }
+    return std::make_shared<CCSVBusSystem>(std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(Stops), ','),
+                                           std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("route,stop_id\n"), ','));
+}
+
+static void Report(const std::string &label, const CBusSystem &bussystem, std::shared_ptr<const CRoutingGraph> graph){
+    std::size_t StopCount = bussystem.StopCount();
+    std::cout << label << ", " << StopCount << " stops, " << graph->VertexCount() << " vertices" << std::endl;
+
+    // one point to point Dijkstra per pair, timed on a sample of rows
+    std::vector<CRoutingGraph::TVertexID> Vertices;
+    for(std::size_t Index = 0; Index < StopCount; Index++){
+        Vertices.push_back(graph->VertexByNodeID(bussystem.StopByIndex(Index)->NodeID()));
+    }
+    std::size_t SampleRows = std::min<std::size_t>(StopCount, 2);
+    CShortestPathSearch Search(graph);
+    std::vector<CRoutingGraph::TVertexID> Path;
+    BenchmarkUtils::CStopwatch PairStopwatch;
+    for(std::size_t Row = 0; Row < SampleRows; Row++){
+        for(std::size_t Column = 0; Column < StopCount; Column++){
+            Search.Dijkstra(Vertices[Row], Vertices[Column], Path);
+        }
+    }
+    std::cout << "pairwise Dijkstra\t" << PairStopwatch.Seconds() / SampleRows * StopCount * 1000.0 << " ms (estimated)" << std::endl;
+
+    std::size_t HardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    for(std::size_t Threads : {std::size_t(1), HardwareThreads}){
+        BenchmarkUtils::CStopwatch Stopwatch;
+        CStopDistanceMatrix Matrix(bussystem, graph, Threads);
+        std::cout << "matrix, " << Threads << " threads\t" << Stopwatch.Seconds() * 1000.0 << " ms" << std::endl;
+        if(Threads == HardwareThreads){
+            std::string Filename = "/tmp/StopDistanceMatrixBench.dist";
+            BenchmarkUtils::CStopwatch SaveStopwatch;
+            Matrix.Save(Filename);
+            double SaveMS = SaveStopwatch.Seconds() * 1000.0;
+            BenchmarkUtils::CStopwatch LoadStopwatch;
+            CStopDistanceMatrix Loaded(Filename);
+            double LoadMS = LoadStopwatch.Seconds() * 1000.0;
+            BenchmarkUtils::CStopwatch RowStopwatch;
+            Loaded.RecomputeRows({0}, graph);
+            std::cout << "save\t" << SaveMS << " ms\tload\t" << LoadMS << " ms\trecompute one row\t" << RowStopwatch.Seconds() * 1000.0 << " ms" << std::endl;
+            std::remove(Filename.c_str());
+        }
+        if(Threads == HardwareThreads || HardwareThreads == 1){
+            break;
+        }
+    }
+}
+
+int main(){
+    COpenStreetMap Davis(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    auto DavisGraph = std::make_shared<CRoutingGraph>(Davis);
+    CCSVBusSystem DavisStops(std::make_shared<CDSVReader>(std::make_shared<CMappedFileDataSource>("data/stops.csv"), ','),
+                             std::make_shared<CDSVReader>(std::make_shared<CMappedFileDataSource>("data/routes.csv"), ','));
+    Report("davis", DavisStops, DavisGraph);
+    auto GridGraph = std::make_shared<CRoutingGraph>(CGridMap(200));
+    Report("grid 200x200", *SyntheticBusSystem(*GridGraph, 80), GridGraph);
+    return 0;
+}
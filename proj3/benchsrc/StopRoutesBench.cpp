@@ -0,0 +1,60 @@
+#include "CSVBusSystem.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+#include "BenchmarkUtils.h"
+#include <iostream>
+#include <random>
+
+// the routes stopping at a stop found by walking every stop of every route
+static std::size_t ScanRoutes(const CBusSystem &bussystem, CBusSystem::TStopID id, std::vector<CBusSystem::SRouteStop> &routes){
+    routes.clear();
+    for(std::size_t RouteIndex = 0; RouteIndex < bussystem.RouteCount(); RouteIndex++){
+        auto Route = bussystem.RouteByIndex(RouteIndex);
+        for(std::size_t Position = 0; Position < Route->StopCount(); Position++){
+            if(Route->GetStopID(Position) == id){
+                routes.push_back({RouteIndex, Position});
+            }
+        }
+    }
+    return routes.size();
+}
+
+int main(){
+    const std::size_t StopCount = 20000;
+    std::mt19937_64 Generator(11);
+    std::string Stops = "stop_id,node_id\n";
+    for(std::size_t Index = 0; Index < StopCount; Index++){
+        Stops += std::to_string(100000 + Index) + "," + std::to_string(Index) + "\n";
+    }
+
+    std::cout << "routes\troute stops\tscan us/lookup\tindex us/lookup\troutes/lookup" << std::endl;
+    for(std::size_t RouteCount : {100, 1000, 5000}){
+        std::string Routes = "route,stop_id\n";
+        for(std::size_t Route = 0; Route < RouteCount; Route++){
+            for(std::size_t Stop = 0; Stop < 50; Stop++){
+                Routes += "R" + std::to_string(Route) + "," + std::to_string(100000 + Generator() % StopCount) + "\n";
+            }
+        }
+        CCSVBusSystem BusSystem(std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(Stops), ','),
+                                std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(Routes), ','));
+        std::vector<CBusSystem::TStopID> Lookups;
+        for(int Index = 0; Index < 100000; Index++){
+            Lookups.push_back(100000 + Generator() % StopCount);
+        }
+        std::vector<CBusSystem::SRouteStop> Found;
+        std::size_t ScanLookups = 200, ScanTotal = 0, IndexTotal = 0;
+        BenchmarkUtils::CStopwatch ScanStopwatch;
+        for(std::size_t Index = 0; Index < ScanLookups; Index++){
+            ScanTotal += ScanRoutes(BusSystem, Lookups[Index], Found);
+        }
+        double ScanSeconds = ScanStopwatch.Seconds();
+        BenchmarkUtils::CStopwatch IndexStopwatch;
+        for(auto Lookup : Lookups){
+            BusSystem.RoutesByStopID(Lookup, Found);
+            IndexTotal += Found.size();
+        }
+        double IndexSeconds = IndexStopwatch.Seconds();
+        std::cout << RouteCount << "\t" << RouteCount * 50 << "\t" << ScanSeconds * 1e6 / ScanLookups << "\t" << IndexSeconds * 1e6 / Lookups.size() << "\t" << double(IndexTotal) / Lookups.size() << "\t(scan " << double(ScanTotal) / ScanLookups << ")" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include "StreetMapSnapshot.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "BenchmarkUtils.h"
+#include <cstdio>
+#include <iostream>
+
+int main(){
+    const std::string XMLName = "/tmp/StreetMapSnapshotBench.osm";
+    const std::string SnapshotName = "/tmp/StreetMapSnapshotBench.snap";
+
+    std::cout << "Cold start, davis.osm repeated" << std::endl;
+    std::cout << "nodes\tXML load ms\tsave ms\topen ms\tfirst lookup us\tverify ms" << std::endl;
+    for(std::size_t Copies : {1, 10, 40}){
+        BenchmarkUtils::SaveFile(XMLName, BenchmarkUtils::ScaledDavisOSM(Copies));
+
+        BenchmarkUtils::CStopwatch LoadStopwatch;
+        COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>(XMLName)));
+        double LoadMS = LoadStopwatch.Seconds() * 1000.0;
+
+        BenchmarkUtils::CStopwatch SaveStopwatch;
+        CStreetMapSnapshot::Save(Map, SnapshotName);
+        double SaveMS = SaveStopwatch.Seconds() * 1000.0;
+
+        BenchmarkUtils::CStopwatch OpenStopwatch;
+        CStreetMapSnapshot Snapshot(SnapshotName);
+        double OpenMS = OpenStopwatch.Seconds() * 1000.0;
+
+        BenchmarkUtils::CStopwatch LookupStopwatch;
+        auto Node = Snapshot.NodeByID(Map.NodeByIndex(Map.NodeCount() / 2)->ID());
+        double LookupUS = LookupStopwatch.Seconds() * 1e6;
+
+        BenchmarkUtils::CStopwatch VerifyStopwatch;
+        bool Verified = Snapshot.Verify();
+        double VerifyMS = VerifyStopwatch.Seconds() * 1000.0;
+
+        std::cout << Snapshot.NodeCount() << "\t" << LoadMS << "\t" << SaveMS << "\t" << OpenMS << "\t" << LookupUS << "\t" << VerifyMS << (Verified && Node ? "" : "\t(failed)") << std::endl;
+    }
+    std::remove(XMLName.c_str());
+    std::remove(SnapshotName.c_str());
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "StreetNameIndex.h"
+#include "StringUtils.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "StringDataSource.h"
+#include "BenchmarkUtils.h"
+#include <iostream>
+#include <random>
+
+// the closest way by scanning every name of every way
+static std::size_t ScanSearch(const CStreetMap &map, const std::string &name, int maxdistance){
+    std::size_t Found = 0;
+    for(std::size_t Index = 0; Index < map.WayCount(); Index++){
+        auto Way = map.WayByIndex(Index);
+        for(const char *Key : {"name", "name_1", "ref"}){
+            if(Way->HasAttribute(Key) && StringUtils::EditDistance(name, Way->GetAttribute(Key), true) <= maxdistance){
+                Found++;
+                break;
+            }
+        }
+    }
+    return Found;
+}
+
+// waycount ways named from a vocabulary of made up words with a street type
+static std::string SyntheticOSM(std::size_t waycount, std::mt19937 &generator, std::vector<std::string> &names){
+    const std::vector<std::string> Syllables = {"ar", "bel", "cor", "dan", "el", "fair", "glen", "har", "is", "jon", "kel", "lin", "mar", "nor", "ol", "pen", "quin", "ros", "san", "tor", "val", "wil", "york", "zan"};
+    const std::vector<std::string> Types = {"Street", "Avenue", "Road", "Lane", "Drive", "Court", "Way", "Boulevard"};
+    std::uniform_int_distribution<std::size_t> Syllable(0, Syllables.size() - 1), Type(0, Types.size() - 1), Parts(2, 4);
+    std::string Result = "<osm>\n";
+    for(std::size_t Index = 0; Index < waycount; Index++){
+        std::string Name;
+        for(std::size_t Part = Parts(generator); Part > 0; Part--){
+            Name += Syllables[Syllable(generator)];
+        }
+        Name[0] = std::toupper(Name[0]);
+        Name += " " + Types[Type(generator)];
+        names.push_back(Name);
+        Result += "<way id=\"" + std::to_string(Index + 1) + "\"><tag k=\"name\" v=\"" + Name + "\"/></way>\n";
+    }
+    return Result + "</osm>\n";
+}
+
+static void Report(const std::string &label, const CStreetMap &map, const std::vector<std::string> &names, std::mt19937 &generator){
+    BenchmarkUtils::CStopwatch BuildStopwatch;
+    CStreetNameIndex Index(map);
+    double BuildMS = BuildStopwatch.Seconds() * 1000.0;
+    std::cout << label << ", " << Index.WayCount() << " named ways, " << Index.NameCount() << " names, build " << BuildMS << " ms" << std::endl;
+
+    // names with a typo or two
+    std::uniform_int_distribution<std::size_t> PickName(0, names.size() - 1);
+    std::uniform_int_distribution<int> Letter('a', 'z');
+    std::vector<std::string> Queries;
+    for(int Query = 0; Query < 2000; Query++){
+        std::string Name = names[PickName(generator)];
+        for(int Typo = 0; Typo <= Query % 2; Typo++){
+            Name[std::uniform_int_distribution<std::size_t>(0, Name.size() - 1)(generator)] = Letter(generator);
+        }
+        Queries.push_back(Name);
+    }
+    std::size_t Checksum = 0;
+    std::size_t ScanQueries = 10;
+    BenchmarkUtils::CStopwatch ScanStopwatch;
+    for(std::size_t Query = 0; Query < ScanQueries; Query++){
+        Checksum += ScanSearch(map, Queries[Query], 2);
+    }
+    std::cout << "\tscan, distance 2\t" << ScanStopwatch.Seconds() * 1e6 / ScanQueries << " us" << std::endl;
+    std::vector<CStreetNameIndex::SResult> Results;
+    for(int MaxDistance : {1, 2, 3}){
+        BenchmarkUtils::CStopwatch Stopwatch;
+        for(auto &Query : Queries){
+            Index.Search(Query, MaxDistance, 10, Results);
+            Checksum += Results.size();
+        }
+        std::cout << "\tindex, distance " << MaxDistance << "\t" << Stopwatch.Seconds() * 1e6 / Queries.size() << " us" << std::endl;
+    }
+    std::cout << "\t(checksum " << Checksum << ")" << std::endl;
+}
+
+int main(){
+    std::mt19937 Generator(19);
+    COpenStreetMap Davis(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    std::vector<std::string> DavisNames;
+    for(std::size_t Index = 0; Index < Davis.WayCount(); Index++){
+        auto Way = Davis.WayByIndex(Index);
+        if(Way->HasAttribute("name")){
+            DavisNames.push_back(Way->GetAttribute("name"));
+        }
+    }
+    Report("davis", Davis, DavisNames, Generator);
+
+    std::vector<std::string> Names;
+    COpenStreetMap Region(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(SyntheticOSM(200000, Generator, Names))));
+    Report("synthetic 200000 ways", Region, Names, Generator);
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "StringUtils.h"
+#include "BenchmarkUtils.h"
+#include <iostream>
+#include <random>
+
+// Replace as it was, replacing in place and shifting the tail every match
+static std::string InPlaceReplace(const std::string &str, const std::string &old, const std::string &rep){
+    std::string Result = str;
+    std::size_t Position = 0;
+    while((Position = Result.find(old, Position)) != std::string::npos){
+        Result.replace(Position, old.length(), rep);
+        Position += rep.length();
+    }
+    return Result;
+}
+
+// Join as it was, growing the result one piece at a time
+static std::string AppendJoin(const std::string &str, const std::vector<std::string> &vect){
+    if(vect.empty()){
+        return "";
+    }
+    std::string Result = vect[0];
+    for(std::size_t Index = 1; Index < vect.size(); Index++){
+        Result += str + vect[Index];
+    }
+    return Result;
+}
+
+template <typename TFunction>
+static void Time(const std::string &label, std::size_t repeats, TFunction function){
+    std::size_t Checksum = 0;
+    BenchmarkUtils::CStopwatch Stopwatch;
+    for(std::size_t Repeat = 0; Repeat < repeats; Repeat++){
+        Checksum += function();
+    }
+    std::cout << label << "\t" << Stopwatch.Seconds() * 1e6 / repeats << " us\t(checksum " << Checksum << ")" << std::endl;
+}
+
+int main(){
+    // semicolon separated tag values with padding, like OSM refs
+    std::mt19937 Generator(20);
+    std::uniform_int_distribution<int> Letter('a', 'z'), Length(1, 12);
+    std::string Tags;
+    std::vector<std::string> Words;
+    for(int Index = 0; Index < 20000; Index++){
+        std::string Word(Length(Generator), ' ');
+        for(auto &Ch : Word){
+            Ch = Letter(Generator);
+        }
+        Words.push_back(Word);
+        Tags += (Index ? "; " : "  ") + Word;
+    }
+    Tags += "  ";
+
+    std::cout << "operation\ttime per call" << std::endl;
+    Time("Replace in place", 5, [&](){ return InPlaceReplace(Tags, "; ", ",").size(); });
+    Time("Replace", 5, [&](){ return StringUtils::Replace(Tags, "; ", ",").size(); });
+    Time("Split", 20, [&](){ return StringUtils::Split(Tags, ";").size(); });
+    Time("SplitView", 20, [&](){ return StringUtils::SplitView(Tags, ";").size(); });
+    Time("SplitView + StripView callback", 20, [&](){
+        std::size_t Total = 0;
+        StringUtils::SplitView(Tags, ";", [&Total](std::string_view piece){
+            Total += StringUtils::StripView(piece).size();
+        });
+        return Total;
+    });
+    Time("Split + Strip", 20, [&](){
+        std::size_t Total = 0;
+        for(auto &Piece : StringUtils::Split(Tags, ";")){
+            Total += StringUtils::Strip(Piece).size();
+        }
+        return Total;
+    });
+    Time("Join appending", 20, [&](){ return AppendJoin(", ", Words).size(); });
+    Time("Join", 20, [&](){ return StringUtils::Join(", ", Words).size(); });
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "TransitPlanner.h"
+#include "CSVBusSystem.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "StringDataSource.h"
+#include "BenchmarkUtils.h"
+#include "GridMap.h"
+#include <iostream>
+#include <random>
+
+// a stop at every third intersection of a Side x Side grid map, a route
+// each way along every row and column of stops and some meandering routes
+static std::shared_ptr<CCSVBusSystem> GridBusSystem(std::size_t side, std::size_t meandering){
+    std::size_t StopSide = (side + 2) / 3;
+    auto StopID = [&](std::size_t row, std::size_t column){
+        return std::to_string(row * StopSide + column + 1);
+    };
+    std::string Stops = "stop_id,node_id\n";
+    for(std::size_t Row = 0; Row < StopSide; Row++){
+        for(std::size_t Column = 0; Column < StopSide; Column++){
+            Stops += StopID(Row, Column) + "," + std::to_string(Row * 3 * side + Column * 3) + "\n";
+        }
+    }
+    std::string Routes = "route,stop_id\n";
+    for(std::size_t Line = 0; Line < StopSide; Line++){
+        for(std::size_t Step = 0; Step < StopSide; Step++){
+            Routes += "E" + std::to_string(Line) + "," + StopID(Line, Step) + "\n";
+            Routes += "N" + std::to_string(Line) + "," + StopID(Step, Line) + "\n";
+        }
+        for(std::size_t Step = StopSide; Step-- > 0;){
+            Routes += "W" + std::to_string(Line) + "," + StopID(Line, Step) + "\n";
+            Routes += "S" + std::to_string(Line) + "," + StopID(Step, Line) + "\n";
+        }
+    }
+    std::mt19937 Generator(2);
+    for(std::size_t Route = 0; Route < meandering; Route++){
+        std::size_t Row = Generator() % StopSide, Column = Generator() % StopSide;
+        for(int Step = 0; Step < 40; Step++){
+            Routes += "M" + std::to_string(Route) + "," + StopID(Row, Column) + "\n";
+            if(Generator() % 2){
+                Row = std::min(StopSide - 1, Row + 1);
+            }
+            else{
+                Column = std::min(StopSide - 1, Column + 1);
+            }
+        }
+    }
+    return std::make_shared<CCSVBusSystem>(std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(Stops), ','),
+                                           std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(Routes), ','));
+}
+
+static void Report(const std::string &label, const CBusSystem &bussystem, const CStreetMap &map, std::size_t querycount){
+    BenchmarkUtils::CStopwatch BuildStopwatch;
+    CTransitPlanner Planner(bussystem, map);
+    double BuildMS = BuildStopwatch.Seconds() * 1000.0;
+    std::mt19937 Generator(6);
+    std::uniform_int_distribution<std::size_t> Pick(0, bussystem.StopCount() - 1);
+    std::vector<std::pair<CBusSystem::TStopID, CBusSystem::TStopID>> Queries;
+    for(std::size_t Index = 0; Index < querycount; Index++){
+        Queries.push_back({bussystem.StopByIndex(Pick(Generator))->ID(), bussystem.StopByIndex(Pick(Generator))->ID()});
+    }
+    std::vector<CTransitPlanner::SJourney> Journeys;
+    std::size_t Found = 0, JourneyCount = 0;
+    BenchmarkUtils::CStopwatch Stopwatch;
+    for(auto &Query : Queries){
+        Found += Planner.FindJourneys(Query.first, Query.second, Journeys);
+        JourneyCount += Journeys.size();
+    }
+    double Seconds = Stopwatch.Seconds();
+    std::cout << label << "\t" << Planner.StopCount() << "\t" << bussystem.RouteCount() << "\t" << Planner.FootpathCount() << "\t" << BuildMS << "\t" << Seconds * 1e6 / querycount << "\t" << double(JourneyCount) / querycount << "\t(" << Found << " found)" << std::endl;
+}
+
+int main(){
+    std::cout << "network\tstops\troutes\tfootpaths\tbuild ms\tus/query\tjourneys/query" << std::endl;
+    COpenStreetMap Davis(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    CCSVBusSystem DavisBus(std::make_shared<CDSVReader>(std::make_shared<CMappedFileDataSource>("data/stops.csv"), ','),
+                           std::make_shared<CDSVReader>(std::make_shared<CMappedFileDataSource>("data/routes.csv"), ','));
+    Report("davis", DavisBus, Davis, 10000);
+    CGridMap Grid(150);
+    Report("grid 50x50 stops", *GridBusSystem(150, 200), Grid, 2000);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "MappedFileDataSource.h"
+#include "BenchmarkUtils.h"
+#include <iostream>
+#include <cstdio>
+
+// wraps a source and hands out one byte per virtual Get, the way the
+// reader used to fill its buffer before it switched to block reads
+class CPerCharDataSource : public CDataSource{
+    private:
+        std::shared_ptr<CDataSource> DSource;
+    public:
+        CPerCharDataSource(std::shared_ptr<CDataSource> src) : DSource(src){}
+
+        bool End() const noexcept override{
+            return DSource->End();
+        }
+        bool Get(char &ch) noexcept override{
+            return DSource->Get(ch);
+        }
+        bool Peek(char &ch) noexcept override{
+            return DSource->Peek(ch);
+        }
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            buf.clear();
+            char TempChar;
+            while(buf.size() < count && DSource->Get(TempChar)){
+                buf.push_back(TempChar);
+            }
+            return !buf.empty();
+        }
+};
+
+static void Report(const std::string &label, std::shared_ptr<CDataSource> src, std::size_t chunksize, std::size_t bytes){
+    CXMLReader Reader(src, chunksize);
+    SXMLEntity Entity;
+    std::size_t EntityCount = 0;
+    BenchmarkUtils::CStopwatch Stopwatch;
+    while(Reader.ReadEntity(Entity, true)){
+        EntityCount++;
+    }
+    double Seconds = Stopwatch.Seconds();
+    std::cout << label << "\t" << chunksize << "\t" << EntityCount << "\t"
+              << EntityCount / Seconds << "\t" << bytes / Seconds / (1024.0 * 1024.0) << std::endl;
+}
+
+int main(){
+    const std::size_t Copies = 20;
+    const std::string TempFilename = "/tmp/XMLReaderBench.osm";
+    std::string Document = BenchmarkUtils::ScaledDavisOSM(Copies);
+    BenchmarkUtils::SaveFile(TempFilename, Document);
+
+    std::cout << "CXMLReader on data/davis.osm x" << Copies << " (" << Document.size() / (1024 * 1024) << " MB)" << std::endl;
+    std::cout << "source\tchunk\tentities\tentities/s\tMB/s" << std::endl;
+    Report("per-char", std::make_shared<CPerCharDataSource>(std::make_shared<CStringDataSource>(Document)), 4096, Document.size());
+    for(std::size_t ChunkSize : {4096, 65536, 1048576}){
+        Report("string", std::make_shared<CStringDataSource>(Document), ChunkSize, Document.size());
+    }
+    for(std::size_t ChunkSize : {4096, 65536, 1048576}){
+        Report("mmap", std::make_shared<CMappedFileDataSource>(TempFilename), ChunkSize, Document.size());
+    }
+    std::remove(TempFilename.c_str());
+    return 0;
+}
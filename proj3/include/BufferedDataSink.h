@@ -0,0 +1,30 @@
+#ifndef BUFFEREDDATASINK_H
+#define BUFFEREDDATASINK_H
+
+#include "DataSink.h"
+#include <memory>
+
+// collects bytes into a fixed size block and hands each full block to the
+// wrapped sink with a single Write, the remainder is written by Flush or
+// when the buffered sink is destroyed
+class CBufferedDataSink : public CDataSink{
+    private:
+        std::shared_ptr< CDataSink > DSink;
+        std::vector<char> DBlock;
+        std::size_t DBlockSize;
+        bool DFailed;
+    public:
+        CBufferedDataSink(std::shared_ptr< CDataSink > sink, std::size_t blocksize = 65536);
+        ~CBufferedDataSink();
+
+        // writes anything buffered to the wrapped sink, returns false if any
+        // write to the wrapped sink has failed
+        bool Flush() noexcept;
+
+        using CDataSink::Write;
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *buf, std::size_t count) noexcept override;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define BUSROUTE_H
 
 #include "StreetMap.h"
+#include <vector>
 
 class CBusSystem{
     public:
@@ -22,6 +23,12 @@ class CBusSystem{
             virtual TStopID GetStopID(std::size_t index) const noexcept = 0;
         };
 
+        // a place a route stops, GetStopID(Position) of the route at RouteIndex
+        struct SRouteStop{
+            std::size_t RouteIndex;
+            std::size_t Position;
+        };
+
         virtual ~CBusSystem(){};
 
         virtual std::size_t StopCount() const noexcept = 0;
@@ -30,6 +37,9 @@ class CBusSystem{
         virtual std::shared_ptr<SStop> StopByID(TStopID id) const noexcept = 0;
         virtual std::shared_ptr<SRoute> RouteByIndex(std::size_t index) const noexcept = 0;
         virtual std::shared_ptr<SRoute> RouteByName(const std::string &name) const noexcept = 0;
+        // fills routes with every place a route stops at the stop, ordered by
+        // route index and then position, returns false if no route stops there
+        virtual bool RoutesByStopID(TStopID id, std::vector<SRouteStop> &routes) const noexcept = 0;
 };
 
 #endif
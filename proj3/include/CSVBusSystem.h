@@ -18,6 +18,10 @@ public:
     std::shared_ptr<CBusSystem::SStop> StopByID(TStopID id) const noexcept override;
     std::shared_ptr<CBusSystem::SRoute> RouteByIndex(std::size_t index) const noexcept override;
     std::shared_ptr<CBusSystem::SRoute> RouteByName(const std::string &name) const noexcept override;
+    bool RoutesByStopID(TStopID id, std::vector<SRouteStop> &routes) const noexcept override;
+
+    // number of rows in either file that were skipped because they didn't parse
+    std::size_t ErrorCount() const noexcept;
 
 private:
     struct SStop;
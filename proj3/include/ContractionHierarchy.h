@@ -0,0 +1,57 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include "RoutingGraph.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// contraction hierarchy over a CRoutingGraph. Vertices are contracted one at
+// a time in order of importance, adding a shortcut wherever removing a vertex
+// would lengthen a shortest path between its neighbors. Every edge then leads
+// either up or down the order, so a query only has to search upward from both
+// ends, which CContractionHierarchySearch does
+class CContractionHierarchy{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        // edges from lower to higher ranked vertices in compressed sparse row
+        // form, sorted by target. Middle is the vertex a shortcut skips, or
+        // InvalidVertexID for an edge of the original graph
+        struct SUpwardGraph{
+            std::vector<uint32_t> Offsets;
+            std::vector<CRoutingGraph::TVertexID> Targets;
+            std::vector<double> Weights;
+            std::vector<CRoutingGraph::TVertexID> Middles;
+        };
+
+        static const uint32_t Version = 1;
+
+        // contracts the graph, threads of 0 uses one per hardware thread
+        CContractionHierarchy(const CRoutingGraph &graph, std::size_t threads = 0);
+        // loads a hierarchy written by Save
+        CContractionHierarchy(const std::string &filename);
+        ~CContractionHierarchy();
+
+        // false if the file couldn't be loaded
+        bool IsValid() const noexcept;
+        bool Save(const std::string &filename) const;
+
+        std::size_t VertexCount() const noexcept;
+        std::size_t ShortcutCount() const noexcept;
+        // position of the vertex in the contraction order, 0 was contracted first
+        uint32_t Rank(CRoutingGraph::TVertexID vertex) const noexcept;
+
+        // edges u -> v with Rank(u) < Rank(v), stored at u
+        const SUpwardGraph &ForwardGraph() const noexcept;
+        // edges u -> v with Rank(u) > Rank(v), stored at v with target u
+        const SUpwardGraph &BackwardGraph() const noexcept;
+
+        // appends the original graph vertices after src along the edge src -> dest,
+        // expanding shortcuts, returns false if there is no such edge
+        bool UnpackEdge(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest, std::vector<CRoutingGraph::TVertexID> &path) const;
+};
+
+#endif
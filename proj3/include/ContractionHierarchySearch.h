@@ -0,0 +1,33 @@
+#ifndef CONTRACTIONHIERARCHYSEARCH_H
+#define CONTRACTIONHIERARCHYSEARCH_H
+
+#include "ContractionHierarchy.h"
+#include <limits>
+#include <memory>
+#include <vector>
+
+// bidirectional upward search over a contraction hierarchy, the per vertex
+// state is allocated once and stamped per query like CShortestPathSearch. A
+// search object is not thread safe, use one per thread
+class CContractionHierarchySearch{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        static constexpr double NoPathExists = std::numeric_limits<double>::max();
+
+        CContractionHierarchySearch(std::shared_ptr<const CContractionHierarchy> hierarchy);
+        ~CContractionHierarchySearch();
+
+        // returns the length of the shortest path in meters and fills path with
+        // the original graph vertices from src to dest, NoPathExists leaves path empty
+        double FindShortestPath(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest, std::vector<CRoutingGraph::TVertexID> &path);
+        // distance only, skips unpacking the path
+        double FindDistance(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest);
+
+        // vertices settled by the last query in both directions
+        std::size_t SettledCount() const noexcept;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef DSVCOLUMNLOADER_H
+#define DSVCOLUMNLOADER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DSVReader.h"
+
+// loads selected columns of a DSV file into typed, contiguous arrays.
+// Columns are picked by their header name, or by position when the first
+// row isn't a header. Cells are parsed straight from the reader's views,
+// columns that weren't asked for are never copied, and rows that are too
+// short or don't parse are counted in ErrorCount and skipped
+class CDSVColumnLoader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CDSVColumnLoader(std::shared_ptr< CDSVReader > src);
+        ~CDSVColumnLoader();
+
+        // both return the index of the new column, position is used when
+        // the file has no header row naming the column
+        std::size_t AddUIntColumn(const std::string &name, std::size_t position);
+        // strings are dictionary encoded, each row holds the index of its
+        // value in Categories, which are in order of first appearance
+        std::size_t AddCategoryColumn(const std::string &name, std::size_t position);
+
+        // reads every remaining row, returns false if there was no data
+        bool Load();
+
+        std::size_t RowCount() const noexcept;
+        std::size_t ErrorCount() const noexcept;
+        // true if the first row was taken as a header
+        bool HasHeader() const noexcept;
+        const std::vector<uint64_t> &UIntColumn(std::size_t column) const noexcept;
+        const std::vector<uint32_t> &CategoryColumn(std::size_t column) const noexcept;
+        const std::vector<std::string> &Categories(std::size_t column) const noexcept;
+};
+
+#endif
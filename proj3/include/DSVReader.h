@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include "DataSource.h"
 
 class CDSVReader{
@@ -16,6 +17,9 @@ class CDSVReader{
 
         bool End() const;
         bool ReadRow(std::vector<std::string> &row);
+        // same row semantics as ReadRow, but the cells are views into storage
+        // owned by the reader that stay valid until the next read
+        bool ReadRowView(std::vector<std::string_view> &row);
 };
 
 #endif
@@ -0,0 +1,49 @@
+#ifndef DSVSCANNER_H
+#define DSVSCANNER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// structural character search used by the DSV readers, each call looks at
+// 16 (SSE2) or 32 (AVX2) bytes at a time and falls back to a scalar loop
+// on other targets
+namespace DSVScanner{
+
+// first delimiter, quote, '\r' or '\n' in [begin, end), end if there is none
+const char *FindStructural(const char *begin, const char *end, char delimiter) noexcept;
+// first quote in [begin, end), end if there is none
+const char *FindQuote(const char *begin, const char *end) noexcept;
+
+// a cell of a scanned row, either a span of the input or, when the cell had
+// to be unescaped, a span of the scratch string
+struct SField{
+    const char *Data = nullptr;
+    std::size_t Offset = 0;
+    std::size_t Length = 0;
+    bool InScratch = false;
+};
+
+enum class EScanResult{Row, NoRow, NeedMore};
+
+// scans the row starting at current and appends its cells to fields, cells
+// that aren't a single span of the input are unescaped onto the end of
+// scratch. atend says whether end is the end of the whole input. Returns
+// NeedMore (leaving current alone) if the row, or a quote/\r that needs the
+// following character, runs past end, the caller then rescans the row once
+// more input is available. On Row current is moved past the row.
+EScanResult ScanRow(const char *&current, const char *end, char delimiter, bool atend, std::vector<SField> &fields, std::string &scratch);
+
+// returns true if the quotes in [begin, end) flip the quoted state an odd
+// number of times. Pairs of quotes are escapes and don't flip it, so begin
+// and end must not split a run of quotes
+bool QuoteParity(const char *begin, const char *end) noexcept;
+
+// returns the start of the first row that begins at or after position,
+// given whether position is inside a quoted section. begin is the start
+// of the input and position must not split a run of quotes or a \r\n
+const char *NextRowStart(const char *begin, const char *position, const char *end, char delimiter, bool inquotes) noexcept;
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef DATASINK_H
 #define DATASINK_H
 
+#include <cstddef>
 #include <vector>
 
 class CDataSink{
@@ -8,6 +9,16 @@ class CDataSink{
         virtual ~CDataSink(){};
         virtual bool Put(const char &ch) noexcept = 0;
         virtual bool Write(const std::vector<char> &buf) noexcept = 0;
+        // writes count bytes at once, sinks that can take a whole span in one
+        // step should override this instead of relying on one Put per byte
+        virtual bool Write(const char *buf, std::size_t count) noexcept{
+            for(std::size_t Index = 0; Index < count; Index++){
+                if(!Put(buf[Index])){
+                    return false;
+                }
+            }
+            return true;
+        };
 };
 
 #endif
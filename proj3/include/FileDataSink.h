@@ -0,0 +1,52 @@
+#ifndef FILEDATASINK_H
+#define FILEDATASINK_H
+
+#include "DataSink.h"
+#include <string>
+#include <string_view>
+
+// appends to a file, creating it if needed
+class CFileDataSink : public CDataSink{
+    public:
+        enum class EFlushPolicy{
+            // write to the file when the buffer fills, on Flush and when destroyed
+            WhenFull,
+            // write every Put/Write call through to the file
+            EveryWrite,
+            // like WhenFull, but also fsync the file each time it is written
+            Sync
+        };
+
+    private:
+        int DFileDescriptor;
+        EFlushPolicy DPolicy;
+        std::vector<char> DBuffer;
+        std::size_t DBufferSize;
+        bool DFailed;
+
+        bool WriteFile(const char *buf, std::size_t count) noexcept;
+
+    public:
+        CFileDataSink(const std::string &filename, EFlushPolicy policy = EFlushPolicy::WhenFull, std::size_t buffersize = 65536);
+        ~CFileDataSink();
+
+        CFileDataSink(const CFileDataSink &) = delete;
+        CFileDataSink &operator=(const CFileDataSink &) = delete;
+
+        bool IsOpen() const noexcept;
+        // writes anything buffered to the file, returns false if any write has failed
+        bool Flush() noexcept;
+
+        using CDataSink::Write;
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *buf, std::size_t count) noexcept override;
+
+        // writes the pieces to a new temporary file next to filename, fsyncs
+        // it and renames it over filename, then fsyncs the directory, so
+        // filename is never left half written even after a crash. Returns
+        // false and removes the temporary file if any step fails
+        static bool ReplaceFile(const std::string &filename, const std::vector< std::string_view > &pieces);
+};
+
+#endif
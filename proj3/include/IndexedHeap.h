@@ -0,0 +1,119 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <cstdint>
+#include <vector>
+
+// min heap of item indices below a fixed capacity keyed by double, with the
+// position of every item kept so its key can be lowered in place. Nothing is
+// allocated after Resize and Clear is constant time. A wider heap is
+// shallower and the children of a node share cache lines
+template <std::size_t Arity = 4> class CIndexedHeap{
+    private:
+        struct SEntry{
+            double Key;
+            uint32_t Item;
+        };
+
+        std::vector<SEntry> DEntries;
+        // valid only for items currently in the heap
+        std::vector<uint32_t> DPositions;
+        std::size_t DSize = 0;
+
+        void Place(std::size_t position, const SEntry &entry){
+            DEntries[position] = entry;
+            DPositions[entry.Item] = position;
+        }
+
+        void SiftUp(std::size_t position){
+            SEntry Entry = DEntries[position];
+            while(position){
+                std::size_t Parent = (position - 1) / Arity;
+                if(DEntries[Parent].Key <= Entry.Key){
+                    break;
+                }
+                Place(position, DEntries[Parent]);
+                position = Parent;
+            }
+            Place(position, Entry);
+        }
+
+        void SiftDown(std::size_t position){
+            SEntry Entry = DEntries[position];
+            while(true){
+                std::size_t FirstChild = position * Arity + 1;
+                if(FirstChild >= DSize){
+                    break;
+                }
+                std::size_t LastChild = FirstChild + Arity < DSize ? FirstChild + Arity : DSize;
+                std::size_t Smallest = FirstChild;
+                for(std::size_t Child = FirstChild + 1; Child < LastChild; Child++){
+                    if(DEntries[Child].Key < DEntries[Smallest].Key){
+                        Smallest = Child;
+                    }
+                }
+                if(Entry.Key <= DEntries[Smallest].Key){
+                    break;
+                }
+                Place(position, DEntries[Smallest]);
+                position = Smallest;
+            }
+            Place(position, Entry);
+        }
+
+    public:
+        CIndexedHeap(std::size_t capacity = 0){
+            Resize(capacity);
+        };
+
+        // items must be below capacity, each can be in the heap once
+        void Resize(std::size_t capacity){
+            DEntries.resize(capacity);
+            DPositions.resize(capacity);
+            DSize = 0;
+        };
+
+        void Clear() noexcept{
+            DSize = 0;
+        };
+
+        bool Empty() const noexcept{
+            return !DSize;
+        };
+
+        std::size_t Size() const noexcept{
+            return DSize;
+        };
+
+        double MinKey() const noexcept{
+            return DEntries[0].Key;
+        };
+
+        uint32_t Top() const noexcept{
+            return DEntries[0].Item;
+        };
+
+        void Push(uint32_t item, double key){
+            DEntries[DSize] = {key, item};
+            DPositions[item] = DSize;
+            SiftUp(DSize++);
+        };
+
+        // item must be in the heap and key no larger than its current key
+        void Decrease(uint32_t item, double key){
+            DEntries[DPositions[item]].Key = key;
+            SiftUp(DPositions[item]);
+        };
+
+        uint32_t Pop(){
+            uint32_t Top = DEntries[0].Item;
+            DSize--;
+            if(DSize){
+                DEntries[0] = DEntries[DSize];
+                SiftDown(0);
+            }
+            return Top;
+        };
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef MAPPEDFILEDATASOURCE_H
+#define MAPPEDFILEDATASOURCE_H
+
+#include "DataSource.h"
+#include <string>
+
+// data source over a read-only memory mapped file, the pages are shared
+// through the page cache so nothing is copied until it is read
+class CMappedFileDataSource : public CDataSource{
+    public:
+        // how the mapping will be read, passed on to the kernel with madvise
+        enum class EAccessPattern{
+            // front to back, read ahead aggressively and start reading the whole file now
+            Sequential,
+            // scattered lookups, don't read ahead
+            Random,
+            // leave the kernel's default read ahead alone
+            None
+        };
+
+    private:
+        const char *DData;
+        std::size_t DSize;
+        std::size_t DIndex;
+        bool DOpen;
+    public:
+        CMappedFileDataSource(const std::string &filename, EAccessPattern pattern = EAccessPattern::Sequential);
+        ~CMappedFileDataSource();
+
+        CMappedFileDataSource(const CMappedFileDataSource &) = delete;
+        CMappedFileDataSource &operator=(const CMappedFileDataSource &) = delete;
+
+        // true if the file could be opened, empty files open but map nothing
+        bool IsOpen() const noexcept;
+        // whole mapped region, valid for the lifetime of the source
+        const char *Data() const noexcept;
+        std::size_t Size() const noexcept;
+        // offset of the next character Get/Read will return
+        std::size_t Position() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+};
+
+#endif
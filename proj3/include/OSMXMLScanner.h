@@ -0,0 +1,60 @@
+#ifndef OSMXMLSCANNER_H
+#define OSMXMLSCANNER_H
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "DataSource.h"
+
+// receives the OSM elements COSMXMLScanner finds, in document order. The
+// views are only valid during the call
+class COSMXMLVisitor{
+    public:
+        virtual ~COSMXMLVisitor(){};
+
+        virtual void BeginNode(uint64_t id, double latitude, double longitude) = 0;
+        virtual void EndNode() = 0;
+        virtual void BeginWay(uint64_t id) = 0;
+        virtual void EndWay() = 0;
+        // the ref of an nd element
+        virtual void WayNode(uint64_t ref) = 0;
+        // a tag element with a key, or an attribute of a node or way other
+        // than its id, lat and lon, in the order they appear
+        virtual void Tag(std::string_view key, std::string_view value) = 0;
+};
+
+// reads OpenStreetMap XML without a general XML parser. Only the node, way,
+// nd and tag elements are looked at, wherever they are, and everything else
+// is skipped. A memory mapped source is scanned in place, any other source
+// is read into memory first. The numbers are read the way std::from_chars
+// reads them, so a map loaded through the scanner is the same as one loaded
+// through CXMLReader
+class COSMXMLScanner{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+        COSMXMLScanner(std::unique_ptr<SImplementation> implementation);
+
+    public:
+        COSMXMLScanner(std::shared_ptr< CDataSource > src);
+        ~COSMXMLScanner();
+
+        bool End() const;
+        // scans the rest of the document, false if it is malformed. The
+        // visitor has been given everything up to the error
+        bool Scan(COSMXMLVisitor &visitor);
+        // splits what is left to scan into at most count parts, each after the
+        // first starting at a node or way start tag, that can be scanned at
+        // the same time. Scanning them in order gives the same elements as
+        // scanning this one, unless a part other than the last fails, which
+        // happens when a boundary is inside a comment or CDATA section. This
+        // scanner is left as it is, so it can still scan the input in one go
+        std::vector< std::shared_ptr< COSMXMLScanner > > Split(std::size_t count) const;
+        // moves to the end without scanning the rest, for when the parts from
+        // Split have been scanned in its place
+        void Skip();
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include "StreetMap.h"
 #include "XMLReader.h"
+#include "PBFReader.h"
+#include "OSMXMLScanner.h"
 #include <memory>
 #include <vector>
 #include <string>
@@ -10,8 +12,18 @@
 class COpenStreetMap : public CStreetMap {
 public:
     COpenStreetMap(std::shared_ptr<CXMLReader> src);
+    COpenStreetMap(std::shared_ptr<CPBFReader> src);
+    // with more than one thread the input is split at node and way elements
+    // and the parts are loaded at the same time, the nodes and ways keep
+    // their indices from a load on one thread. threads of 0 uses one per
+    // hardware thread. src is read to its end either way
+    COpenStreetMap(std::shared_ptr<COSMXMLScanner> src, std::size_t threads = 1);
     ~COpenStreetMap();
 
+    // false if the source was malformed or truncated, the map then only has
+    // the nodes and ways read before the error
+    bool IsValid() const noexcept;
+
     std::size_t NodeCount() const noexcept override;
     std::size_t WayCount() const noexcept override;
     std::shared_ptr<CStreetMap::SNode> NodeByIndex(std::size_t index) const noexcept override;
@@ -0,0 +1,54 @@
+#ifndef PBFREADER_H
+#define PBFREADER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DataSource.h"
+
+// reads OpenStreetMap PBF files. The raw blobs are read from the source in
+// order, then inflated and decoded on several threads at once and handed out
+// as blocks in file order. Only zlib compressed and uncompressed blobs are
+// supported, relations are skipped
+class CPBFReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        // the nodes and ways of one primitive block. Tags are pairs of indices
+        // into Strings, element i owns the entries from Offsets[i] up to
+        // Offsets[i + 1]. Node and way metadata (version, timestamp, changeset,
+        // uid and user) is turned into tags ahead of the real ones, the way the
+        // XML attributes of the same element would be
+        struct SBlock{
+            std::vector<std::string> Strings;
+
+            std::vector<uint64_t> NodeIDs;
+            std::vector<double> NodeLatitudes;
+            std::vector<double> NodeLongitudes;
+            std::vector<std::size_t> NodeTagOffsets;
+            std::vector<std::pair<uint32_t, uint32_t>> NodeTags;
+
+            std::vector<uint64_t> WayIDs;
+            std::vector<std::size_t> WayNodeOffsets;
+            std::vector<uint64_t> WayNodeIDs;
+            std::vector<std::size_t> WayTagOffsets;
+            std::vector<std::pair<uint32_t, uint32_t>> WayTags;
+        };
+
+        // threads of 0 uses one per hardware thread
+        CPBFReader(std::shared_ptr< CDataSource > src, std::size_t threads = 0);
+        ~CPBFReader();
+
+        bool End() const;
+        // true once a malformed or unsupported blob has been found
+        bool Failed() const;
+        // decodes up to count blocks, count of 0 reads a few blocks per thread.
+        // Returns false if there was nothing left or the file was malformed
+        bool ReadBlocks(std::vector<SBlock> &blocks, std::size_t count = 0);
+};
+
+#endif
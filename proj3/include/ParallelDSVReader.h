@@ -0,0 +1,31 @@
+#ifndef PARALLELDSVREADER_H
+#define PARALLELDSVREADER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DataSource.h"
+
+// reads the same rows as CDSVReader, but splits the input into chunks that
+// are parsed on several threads at once. The whole input has to be in
+// memory, a CMappedFileDataSource is scanned in place and any other source
+// is read completely up front
+class CParallelDSVReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        // threads of 0 uses one per hardware thread, chunksize is the number of
+        // bytes each thread parses per batch
+        CParallelDSVReader(std::shared_ptr< CDataSource > src, char delimiter, std::size_t threads = 0, std::size_t chunksize = 4 * 1024 * 1024);
+        ~CParallelDSVReader();
+
+        bool End() const;
+        bool ReadRow(std::vector<std::string> &row);
+        // views stay valid until the next read
+        bool ReadRowView(std::vector<std::string_view> &row);
+};
+
+#endif
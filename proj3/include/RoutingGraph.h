@@ -0,0 +1,54 @@
+#ifndef ROUTINGGRAPH_H
+#define ROUTINGGRAPH_H
+
+#include "StreetMap.h"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// directed graph of the way segments of a street map in compressed sparse
+// row form. Every node referenced by a way becomes a vertex, numbered densely
+// in ascending node ID order, and every pair of consecutive way nodes becomes
+// an edge each way unless the way is one way. Edge lengths are great circle
+// distances in meters
+class CRoutingGraph{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TVertexID = uint32_t;
+        using TEdgeID = uint32_t;
+
+        static constexpr TVertexID InvalidVertexID = std::numeric_limits<TVertexID>::max();
+        // mean earth radius used for the edge lengths
+        static constexpr double EarthRadiusMeters = 6371008.8;
+
+        CRoutingGraph(const CStreetMap &map);
+        ~CRoutingGraph();
+
+        std::size_t VertexCount() const noexcept;
+        std::size_t EdgeCount() const noexcept;
+
+        // InvalidVertexID if no way references the node
+        TVertexID VertexByNodeID(CStreetMap::TNodeID id) const noexcept;
+        CStreetMap::TNodeID NodeID(TVertexID vertex) const noexcept;
+        CStreetMap::TLocation Location(TVertexID vertex) const noexcept;
+
+        // the edges leaving vertex v are EdgeTargets()[EdgeOffsets()[v]] up to
+        // EdgeTargets()[EdgeOffsets()[v + 1]], sorted by target. Parallel
+        // edges are merged into the shortest one
+        const std::vector<TEdgeID> &EdgeOffsets() const noexcept;
+        const std::vector<TVertexID> &EdgeTargets() const noexcept;
+        const std::vector<double> &EdgeLengths() const noexcept;
+
+        // straight line distance through the earth between two vertices in
+        // meters, never more than the length of any path between them
+        double ChordDistance(TVertexID left, TVertexID right) const noexcept;
+
+        // great circle distance in meters
+        static double Haversine(const CStreetMap::TLocation &left, const CStreetMap::TLocation &right) noexcept;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SHORTESTPATHSEARCH_H
+#define SHORTESTPATHSEARCH_H
+
+#include "RoutingGraph.h"
+#include <memory>
+#include <vector>
+
+// point to point shortest paths over a CRoutingGraph. All the per vertex
+// search state is allocated once and stamped with a query number, so a new
+// query doesn't clear anything and queries don't allocate. A search object
+// is not thread safe, use one per thread
+class CShortestPathSearch{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        static constexpr double NoPathExists = std::numeric_limits<double>::max();
+
+        CShortestPathSearch(std::shared_ptr<const CRoutingGraph> graph);
+        ~CShortestPathSearch();
+
+        // returns the length of the shortest path in meters and fills path with
+        // its vertices from src to dest, NoPathExists leaves path empty
+        double Dijkstra(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest, std::vector<CRoutingGraph::TVertexID> &path);
+        // same result as Dijkstra, guided toward dest by the chord distance
+        double AStar(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest, std::vector<CRoutingGraph::TVertexID> &path);
+        // fills distances with the length of the shortest path from src to each
+        // of targets, NoPathExists where there is none. The search stops as soon
+        // as every target is settled
+        void OneToMany(CRoutingGraph::TVertexID src, const std::vector<CRoutingGraph::TVertexID> &targets, std::vector<double> &distances);
+
+        // vertices settled by the last query
+        std::size_t SettledCount() const noexcept;
+};
+
+#endif
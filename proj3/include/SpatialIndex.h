@@ -0,0 +1,45 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "StreetMap.h"
+#include <vector>
+
+// uniform grid over the nodes of a street map for nearest node, radius and
+// bounding box queries. Cells are sized to hold a couple of nodes each and
+// stored in compressed sparse row form, with the nodes referenced by ways
+// first in every cell so routable only queries skip the rest. The index
+// doesn't change after it is built, so any number of threads can query it
+// at once. Longitudes don't wrap around at the antimeridian
+class CSpatialIndex{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        struct SResult{
+            // index of the node for CStreetMap::NodeByIndex
+            std::size_t Index;
+            CStreetMap::TNodeID NodeID;
+            // great circle distance in meters, 0 for bounding box results
+            double Distance;
+        };
+
+        CSpatialIndex(const CStreetMap &map);
+        ~CSpatialIndex();
+
+        // nodes in the index, all of the map's nodes
+        std::size_t NodeCount() const noexcept;
+        // nodes referenced by at least one way, the vertices of a CRoutingGraph
+        std::size_t RoutableNodeCount() const noexcept;
+
+        // the count nearest nodes, nearest first with ties broken by index
+        void Nearest(const CStreetMap::TLocation &location, std::size_t count, std::vector<SResult> &results, bool routableonly = false) const;
+        // the nearest node, false if there are none
+        bool Nearest(const CStreetMap::TLocation &location, SResult &result, bool routableonly = false) const;
+        // nodes no more than meters away, nearest first with ties broken by index
+        void WithinRadius(const CStreetMap::TLocation &location, double meters, std::vector<SResult> &results, bool routableonly = false) const;
+        // nodes with latitude and longitude inside the box, edges included, in no particular order
+        void InBoundingBox(const CStreetMap::TLocation &southwest, const CStreetMap::TLocation &northeast, std::vector<SResult> &results, bool routableonly = false) const;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef STOPDISTANCEMATRIX_H
+#define STOPDISTANCEMATRIX_H
+
+#include "BusSystem.h"
+#include "RoutingGraph.h"
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// street network distances in meters between every pair of stops of a bus
+// system, stored row major as floats in stop index order. Each row is one
+// one-to-many search from the stop's node, and rows are handed out to the
+// threads one at a time. A saved matrix is mapped back in place instead of
+// being read
+class CStopDistanceMatrix{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        // also used for a stop whose node isn't on the graph
+        static constexpr float NoPathExists = std::numeric_limits<float>::infinity();
+        static constexpr std::size_t InvalidIndex = std::numeric_limits<std::size_t>::max();
+        static const uint32_t Version = 1;
+
+        // threads of 0 uses one per hardware thread
+        CStopDistanceMatrix(const CBusSystem &bussystem, std::shared_ptr<const CRoutingGraph> graph, std::size_t threads = 0);
+        // maps a matrix written by Save, it has no graph until one is passed to RecomputeRows
+        CStopDistanceMatrix(const std::string &filename);
+        ~CStopDistanceMatrix();
+
+        // false if the file couldn't be loaded
+        bool IsValid() const noexcept;
+        bool Save(const std::string &filename) const;
+
+        std::size_t StopCount() const noexcept;
+        CBusSystem::TStopID StopID(std::size_t index) const noexcept;
+        CStreetMap::TNodeID StopNodeID(std::size_t index) const noexcept;
+        // InvalidIndex if the stop isn't in the matrix
+        std::size_t StopIndex(CBusSystem::TStopID id) const noexcept;
+
+        // distance from stop src to stop dest by index, NoPathExists if either is out of range
+        float Distance(std::size_t src, std::size_t dest) const noexcept;
+        // the StopCount() distances from stop src, nullptr if it is out of range
+        const float *Row(std::size_t src) const noexcept;
+
+        // recomputes the rows of the given stops in parallel, after the street
+        // network changed for example. A graph replaces the one the matrix was
+        // built with and the stops are found on it again by node ID. Returns
+        // false if there is no graph or an index is out of range
+        bool RecomputeRows(const std::vector<std::size_t> &indices, std::shared_ptr<const CRoutingGraph> graph = nullptr);
+        bool RecomputeRow(std::size_t index);
+};
+
+#endif
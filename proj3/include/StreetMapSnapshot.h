@@ -0,0 +1,49 @@
+#ifndef STREETMAPSNAPSHOT_H
+#define STREETMAPSNAPSHOT_H
+
+#include "StreetMap.h"
+#include <memory>
+#include <string>
+
+// street map backed by a memory mapped snapshot file, the arrays in the file
+// are used in place so opening a snapshot doesn't parse anything.
+//
+// The file is little-endian. It starts with a fixed header holding the magic
+// "STMAPSNP", the format version, the offset and byte size of every section,
+// the file size, a checksum of the section data and a checksum of the header
+// itself. Sections start on 8 byte boundaries and are, in order: node IDs
+// (u64), node latitudes and longitudes (f64), node tag offsets (u64, one per
+// node plus one), node tags (u32 key and value string indices), node ID order
+// (u64, empty when the IDs are ascending), the same six tables for ways with
+// the coordinates replaced by way node offsets and way node IDs, then the
+// string offsets (u64, one per string plus one) and string characters.
+class CStreetMapSnapshot : public CStreetMap{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        static const uint32_t Version = 1;
+
+        CStreetMapSnapshot(const std::string &filename);
+        ~CStreetMapSnapshot();
+
+        // writes map to filename, the file is replaced only once the new
+        // snapshot has been written completely
+        static bool Save(const CStreetMap &map, const std::string &filename);
+
+        // true if the file was mapped and its header and section table check out
+        bool IsOpen() const noexcept;
+        // reads every section and compares it with the stored checksum, opening
+        // only checks the header so that startup doesn't touch the whole file
+        bool Verify() const noexcept;
+
+        std::size_t NodeCount() const noexcept override;
+        std::size_t WayCount() const noexcept override;
+        std::shared_ptr<CStreetMap::SNode> NodeByIndex(std::size_t index) const noexcept override;
+        std::shared_ptr<CStreetMap::SNode> NodeByID(TNodeID id) const noexcept override;
+        std::shared_ptr<CStreetMap::SWay> WayByIndex(std::size_t index) const noexcept override;
+        std::shared_ptr<CStreetMap::SWay> WayByID(TWayID id) const noexcept override;
+};
+
+#endif
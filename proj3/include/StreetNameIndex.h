@@ -0,0 +1,47 @@
+#ifndef STREETNAMEINDEX_H
+#define STREETNAMEINDEX_H
+
+#include "StreetMap.h"
+#include <string_view>
+#include <vector>
+
+// fuzzy search over the name, name_1 and ref tags of a street map's ways.
+// Every tag value, split at semicolons, is normalized and the distinct names
+// get a trigram inverted index. A search takes the names sharing enough
+// trigrams with the query to possibly be within the edit distance and checks
+// them with a bounded EditDistance. The index doesn't change after it is
+// built, so any number of threads can search it at once
+class CStreetNameIndex{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        struct SResult{
+            // index of the way for CStreetMap::WayByIndex
+            std::size_t Index;
+            CStreetMap::TWayID WayID;
+            // edit distance from the normalized query to the closest name of the way
+            int Distance;
+            // that closest name, normalized
+            std::string Name;
+        };
+
+        CStreetNameIndex(const CStreetMap &map);
+        ~CStreetNameIndex();
+
+        // distinct normalized names in the index
+        std::size_t NameCount() const noexcept;
+        // ways with at least one name
+        std::size_t WayCount() const noexcept;
+
+        // lower case with every run of characters other than letters and
+        // digits turned into one space, and no spaces at either end
+        static std::string Normalize(std::string_view name);
+
+        // ways with a name within maxdistance edits of the normalized name,
+        // closest first with ties broken by index, at most count of them
+        void Search(const std::string &name, int maxdistance, std::size_t count, std::vector<SResult> &results) const;
+};
+
+#endif
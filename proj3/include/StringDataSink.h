@@ -10,8 +10,10 @@ class CStringDataSink : public CDataSink{
     public:
         const std::string &String() const;
 
+        using CDataSink::Write;
         bool Put(const char &ch) noexcept override;
         bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *buf, std::size_t count) noexcept override;
 };
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// interned strings stored back to back in one buffer, each distinct string
+// is kept once and referred to by its 32 bit index
+class CStringPool{
+    private:
+        // characters of every string in the order they were interned
+        std::string DCharacters;
+        // start of each string in DCharacters, with one extra entry for the end
+        std::vector<uint64_t> DOffsets{0};
+        // open addressing hash table of string index + 1, zero marks an empty slot
+        std::vector<uint32_t> DSlots;
+
+        std::size_t Slot(std::string_view str) const noexcept;
+        void Grow();
+
+    public:
+        std::size_t Count() const noexcept{
+            return DOffsets.size() - 1;
+        };
+
+        std::string_view String(uint32_t index) const noexcept{
+            return std::string_view(DCharacters.data() + DOffsets[index], DOffsets[index + 1] - DOffsets[index]);
+        };
+
+        const std::string &Characters() const noexcept{
+            return DCharacters;
+        };
+
+        const std::vector<uint64_t> &Offsets() const noexcept{
+            return DOffsets;
+        };
+
+        // returns the index of the string, adding it if it hasn't been seen yet
+        uint32_t Intern(std::string_view str);
+        // releases spare capacity and the lookup table once interning is done,
+        // Intern rebuilds the table if it is called again
+        void Shrink();
+};
+
+#endif
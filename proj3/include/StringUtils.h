@@ -1,7 +1,10 @@
 #ifndef STRINGUTILS_H
 #define STRINGUTILS_H
 
+#include <cctype>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace StringUtils{
@@ -21,6 +24,54 @@ std::vector< std::string > Split(const std::string &str, const std::string &splt
 std::string Join(const std::string &str, const std::vector< std::string > &vect) noexcept;
 std::string ExpandTabs(const std::string &str, int tabsize = 4) noexcept;
 int EditDistance(const std::string &left, const std::string &right, bool ignorecase=false) noexcept;
+// returns maxdistance + 1 once the distance is known to be more than maxdistance
+int EditDistance(const std::string &left, const std::string &right, bool ignorecase, int maxdistance) noexcept;
+// the distance from pattern to each of the candidates, capped like EditDistance
+std::vector< int > EditDistances(const std::string &pattern, const std::vector< std::string > &candidates, bool ignorecase=false, int maxdistance=std::numeric_limits<int>::max() - 1) noexcept;
+
+// views into str that don't copy, str has to outlive them. Slice clamps
+// out of range indices instead of failing
+std::string_view SliceView(std::string_view str, ssize_t start, ssize_t end=0) noexcept;
+std::string_view LStripView(std::string_view str) noexcept;
+std::string_view RStripView(std::string_view str) noexcept;
+std::string_view StripView(std::string_view str) noexcept;
+std::vector< std::string_view > SplitView(std::string_view str, std::string_view splt = "") noexcept;
+// Join for pieces that are views, the result is a new string
+std::string JoinView(std::string_view str, const std::vector< std::string_view > &vect) noexcept;
+
+// calls callback with each piece Split would return, in order, without
+// allocating anything
+template <typename TCallback>
+void SplitView(std::string_view str, std::string_view splt, TCallback &&callback) {
+    if (str.empty()) {
+        return;
+    }
+    // runs of whitespace separate the pieces and there are no empty ones
+    if (splt.empty()) {
+        size_t start = 0;
+        while (start < str.size()) {
+            while (start < str.size() && std::isspace(static_cast<unsigned char>(str[start]))) {
+                start++;
+            }
+            size_t end = start;
+            while (end < str.size() && !std::isspace(static_cast<unsigned char>(str[end]))) {
+                end++;
+            }
+            if (end > start) {
+                callback(str.substr(start, end - start));
+            }
+            start = end;
+        }
+        return;
+    }
+    size_t start = 0;
+    size_t end;
+    while ((end = str.find(splt, start)) != std::string_view::npos) {
+        callback(str.substr(start, end - start));
+        start = end + splt.size();
+    }
+    callback(str.substr(start));
+}
 
 }
 
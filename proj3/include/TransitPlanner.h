@@ -0,0 +1,72 @@
+#ifndef TRANSITPLANNER_H
+#define TRANSITPLANNER_H
+
+#include "BusSystem.h"
+#include "StreetMap.h"
+#include <limits>
+#include <memory>
+#include <vector>
+
+// round based (RAPTOR) journey planning over the routes of a bus system.
+// Round k finds the best journeys with k rides by scanning only the routes
+// through stops improved in round k - 1, then walks from the stops it
+// improved to the stops nearby. The routes have no timetables, so journeys
+// are compared by an estimated travel time: riding at a fixed speed plus a
+// dwell at every stop passed, a wait at every boarding and walking at a
+// fixed speed. A planner keeps its query state between queries, so it is
+// not thread safe, use one per thread
+class CTransitPlanner{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        static constexpr std::size_t InvalidRouteIndex = std::numeric_limits<std::size_t>::max();
+
+        struct SOptions{
+            // stops whose nodes are at most this far apart get a footpath
+            double MaxWalkMeters = 400.0;
+            double WalkMetersPerSecond = 1.3;
+            double BusMetersPerSecond = 6.0;
+            // added for every stop a ride passes
+            double DwellSeconds = 20.0;
+            // added for every boarding, the expected wait
+            double BoardSeconds = 120.0;
+        };
+
+        struct SLeg{
+            // InvalidRouteIndex for a walk
+            std::size_t RouteIndex;
+            CBusSystem::TStopID FromStopID;
+            CBusSystem::TStopID ToStopID;
+            // positions in the route the ride boards and alights at, 0 for a walk
+            std::size_t BoardPosition;
+            std::size_t AlightPosition;
+            double Seconds;
+        };
+
+        struct SJourney{
+            std::size_t Rides;
+            // stops passed while riding
+            std::size_t StopCount;
+            double Seconds;
+            std::vector<SLeg> Legs;
+        };
+
+        // stops whose node isn't in the map have no footpaths and add no
+        // riding distance
+        CTransitPlanner(const CBusSystem &bussystem, const CStreetMap &map, const SOptions &options);
+        CTransitPlanner(const CBusSystem &bussystem, const CStreetMap &map);
+        ~CTransitPlanner();
+
+        std::size_t StopCount() const noexcept;
+        std::size_t FootpathCount() const noexcept;
+
+        // fills journeys with the Pareto optimal journeys from src to dest with
+        // at most maxtransfers transfers, so maxtransfers + 1 rides, fewest
+        // rides first and each faster than the one before. Returns false if
+        // there is none or a stop is unknown
+        bool FindJourneys(CBusSystem::TStopID src, CBusSystem::TStopID dest, std::vector<SJourney> &journeys, std::size_t maxtransfers = 3);
+};
+
+#endif
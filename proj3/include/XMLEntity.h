@@ -1,16 +1,25 @@
 #ifndef XMLENTITY_H
 #define XMLENTITY_H
 
+#include <cstdint>
+#include <limits>
 #include <utility>
 #include <string>
 #include <vector>
 
 struct SXMLEntity{
     using TAttribute = std::pair< std::string, std::string >;
+    // interned element or attribute name, see CXMLReader::NameAtom
+    using TAtom = uint32_t;
+    static constexpr TAtom InvalidAtom = std::numeric_limits<TAtom>::max();
     enum class EType{StartElement, EndElement, CharData, CompleteElement};
     EType DType;
     std::string DNameData;
     std::vector< TAttribute > DAttributes;
+    // atoms of the name and of each attribute name from the reader that read
+    // the entity, InvalidAtom for entities put together some other way
+    TAtom DNameAtom = InvalidAtom;
+    std::vector< TAtom > DAttributeAtoms;
     
     bool AttributeExists(const std::string &name) const{
         for(auto &Attribute : DAttributes){
@@ -21,13 +30,37 @@ struct SXMLEntity{
         return false;
     };
     
-    std::string AttributeValue(const std::string &name) const{
+    const std::string &AttributeValue(const std::string &name) const{
         for(auto &Attribute : DAttributes){
             if(std::get<0>(Attribute) == name){
                 return std::get<1>(Attribute);   
             }
         }
-        return std::string();
+        return EmptyValue();
+    };
+
+    bool AttributeExists(TAtom atom) const{
+        for(std::size_t Index = 0; Index < DAttributeAtoms.size() && Index < DAttributes.size(); Index++){
+            if(DAttributeAtoms[Index] == atom){
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // looks the attribute up by atom without comparing or copying strings
+    const std::string &AttributeValue(TAtom atom) const{
+        for(std::size_t Index = 0; Index < DAttributeAtoms.size() && Index < DAttributes.size(); Index++){
+            if(DAttributeAtoms[Index] == atom){
+                return std::get<1>(DAttributes[Index]);
+            }
+        }
+        return EmptyValue();
+    };
+
+    static const std::string &EmptyValue(){
+        static const std::string Empty;
+        return Empty;
     };
     
     bool SetAttribute(const std::string &name, const std::string &value){
@@ -40,6 +73,10 @@ struct SXMLEntity{
                 return true;
             }
         }
+        // keep the atoms lined up with the attributes
+        if(DAttributeAtoms.size() == DAttributes.size()){
+            DAttributeAtoms.push_back(InvalidAtom);
+        }
         DAttributes.push_back(std::make_pair(name,value));
         return true;
     };
@@ -2,7 +2,11 @@
 #define XMLREADER_H
 
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "XMLEntity.h"
+#include "XMLVisitor.h"
 #include "DataSource.h"
 
 class CXMLReader {
@@ -11,11 +15,30 @@ private:
     std::unique_ptr<SImplementation> DImplementation;
 
 public:
-    CXMLReader(std::shared_ptr<CDataSource> src);
+    // chunksize is the number of bytes read from src for each expat parse call
+    CXMLReader(std::shared_ptr<CDataSource> src, std::size_t chunksize = 4096);
     virtual ~CXMLReader();
     
     virtual bool End() const;
     virtual bool ReadEntity(SXMLEntity &entity, bool skipcdata = false); // Ensure virtual
+    // hands the rest of the document to visitor. Given element names, only
+    // start and end tags with those names are passed on and character data is
+    // skipped. Returns false on a parse error. A CXMLReader goes straight from
+    // the parser to the visitor without building entities, a subclass goes
+    // through its ReadEntity unless it calls ParseSource itself
+    virtual bool Parse(CXMLVisitor &visitor, const std::vector<std::string> &elements = {});
+
+protected:
+    // the fast path of Parse, reading the data source given to the
+    // constructor and bypassing ReadEntity
+    bool ParseSource(CXMLVisitor &visitor, const std::vector<std::string> &elements);
+
+public:
+
+    // element and attribute names are interned as they are read, atoms are
+    // handed out from 0 in the order names are first seen here or in the input
+    SXMLEntity::TAtom NameAtom(std::string_view name);
+    std::string_view AtomName(SXMLEntity::TAtom atom) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef XMLVISITOR_H
+#define XMLVISITOR_H
+
+#include "XMLEntity.h"
+#include <cstddef>
+#include <string_view>
+
+// the attributes of a start element as expat hands them over, name and value
+// pairs in one array ending with a null pointer, and the atom of each name
+struct SXMLAttributes{
+    using TAtom = SXMLEntity::TAtom;
+    const char **DAttributes;
+    const TAtom *DAtoms = nullptr;
+
+    std::size_t Count() const noexcept{
+        std::size_t Index = 0;
+        while(DAttributes && DAttributes[Index * 2]){
+            Index++;
+        }
+        return Index;
+    };
+
+    std::string_view Name(std::size_t index) const noexcept{
+        return DAttributes[index * 2];
+    };
+
+    std::string_view Value(std::size_t index) const noexcept{
+        return DAttributes[index * 2 + 1];
+    };
+
+    TAtom Atom(std::size_t index) const noexcept{
+        return DAtoms ? DAtoms[index] : SXMLEntity::InvalidAtom;
+    };
+
+    bool AttributeExists(std::string_view name) const noexcept{
+        for(auto Attribute = DAttributes; Attribute && *Attribute; Attribute += 2){
+            if(name == *Attribute){
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // the value of name, empty if it isn't there
+    std::string_view AttributeValue(std::string_view name) const noexcept{
+        for(auto Attribute = DAttributes; Attribute && *Attribute; Attribute += 2){
+            if(name == *Attribute){
+                return Attribute[1];
+            }
+        }
+        return std::string_view();
+    };
+
+    bool AttributeExists(TAtom atom) const noexcept{
+        for(std::size_t Index = 0; DAtoms && DAttributes[Index * 2]; Index++){
+            if(DAtoms[Index] == atom){
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // the value of the attribute with the name atom, empty if it isn't there
+    std::string_view AttributeValue(TAtom atom) const noexcept{
+        for(std::size_t Index = 0; DAtoms && DAttributes[Index * 2]; Index++){
+            if(DAtoms[Index] == atom){
+                return DAttributes[Index * 2 + 1];
+            }
+        }
+        return std::string_view();
+    };
+};
+
+// receives the elements of a document from CXMLReader::Parse as the parser
+// finds them. The views point into the parser's buffers and are only valid
+// during the call, copy anything that has to be kept
+class CXMLVisitor{
+    public:
+        virtual ~CXMLVisitor(){};
+
+        // atom is the interned name, see CXMLReader::NameAtom
+        virtual void StartElement(std::string_view name, SXMLEntity::TAtom atom, const SXMLAttributes &attributes) = 0;
+        virtual void EndElement(std::string_view name, SXMLEntity::TAtom atom) = 0;
+        // character data may come in several pieces, ignored by default
+        virtual void CharData(std::string_view data){};
+};
+
+#endif
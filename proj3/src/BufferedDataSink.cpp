@@ -0,0 +1,48 @@
+#include "BufferedDataSink.h"
+
+CBufferedDataSink::CBufferedDataSink(std::shared_ptr<CDataSink> sink, std::size_t blocksize) : DSink(sink), DBlockSize(blocksize ? blocksize : 1), DFailed(false){
+    DBlock.reserve(DBlockSize);
+}
+
+CBufferedDataSink::~CBufferedDataSink(){
+    Flush();
+}
+
+bool CBufferedDataSink::Flush() noexcept{
+    if(!DBlock.empty()){
+        if(!DSink || !DSink->Write(DBlock)){
+            DFailed = true;
+        }
+        DBlock.clear();
+    }
+    return !DFailed;
+}
+
+bool CBufferedDataSink::Put(const char &ch) noexcept{
+    if(DBlock.size() >= DBlockSize && !Flush()){
+        return false;
+    }
+    DBlock.push_back(ch);
+    return !DFailed;
+}
+
+bool CBufferedDataSink::Write(const std::vector<char> &buf) noexcept{
+    return Write(buf.data(), buf.size());
+}
+
+bool CBufferedDataSink::Write(const char *buf, std::size_t count) noexcept{
+    if(DBlock.size() + count > DBlockSize){
+        if(!Flush()){
+            return false;
+        }
+        // spans at least a block long skip the copy and go straight through
+        if(count >= DBlockSize){
+            if(!DSink || !DSink->Write(buf, count)){
+                DFailed = true;
+            }
+            return !DFailed;
+        }
+    }
+    DBlock.insert(DBlock.end(), buf, buf + count);
+    return !DFailed;
+}
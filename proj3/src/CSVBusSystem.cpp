@@ -1,10 +1,12 @@
 #include "CSVBusSystem.h"  //this includes the class definition for CCSVBusSystem
 #include "DSVReader.h"    //reading CSV (or other DSV) formatted input files
+#include "DSVColumnLoader.h" //loads the ID and route columns straight into typed arrays
 #include <memory>           //provides std::shared_ptr and std::make_shared for memory management
 #include <vector>           //used to store lists of stops and routes
 #include <string>           //enables usage of std::string for the route name and attribute
 #include <unordered_map>    //lookup of stops and routes by ID or name using unordered_map
 #include <iostream>         //i need to print bus system details using operator <<
+#include <algorithm>        //std::stable_sort and std::upper_bound for the stop ID index
 
 //defines the SStop class, representing a bus stop, inheriting from CBusSystem::SStop can be seen in header file
 class CCSVBusSystem::SStop : public CBusSystem::SStop {
@@ -53,81 +55,119 @@ public:
 
 // defines the internl impl structure
 struct CCSVBusSystem::SImplementation {
-    // stores stops in order of input
-    std::vector<std::shared_ptr<SStop>> StopsByIndex;  
-    // maps stop IDs to stop objs
-    std::unordered_map<TStopID, std::shared_ptr<SStop>> Stops;  
+    // stores stops contiguously in order of input, StopByIndex hands out
+    // shared_ptrs that share ownership of the whole array
+    std::shared_ptr<std::vector<SStop>> Stops = std::make_shared<std::vector<SStop>>();
+    // stop indices sorted by stop ID for StopByID, empty when Stops is already in ID order
+    std::vector<std::size_t> StopIDOrder;
      //stores routs in order of input
     std::vector<std::shared_ptr<SRoute>> RoutesByIndex; 
     //maps routs names to route objs
     std::unordered_map<std::string, std::shared_ptr<SRoute>> Routes;  
+    // rows of either file that were skipped because they didn't parse
+    std::size_t ErrorCount = 0;
+    // reverse index from stops to routes in compressed sparse row form, the
+    // routes stopping at RouteStopIDs[i] are RouteStops[RouteStopOffsets[i]]
+    // up to RouteStops[RouteStopOffsets[i + 1]]. It covers every stop ID a
+    // route names, whether or not the stop is in the stop file
+    std::vector<TStopID> RouteStopIDs;
+    std::vector<std::size_t> RouteStopOffsets;
+    std::vector<SRouteStop> RouteStops;
+
+    // returns a shared_ptr to a stop that keeps the stop array alive
+    std::shared_ptr<CBusSystem::SStop> StopPointer(std::size_t index) const {
+        return std::shared_ptr<CBusSystem::SStop>(Stops, &(*Stops)[index]);
+    }
 };
 
 // constructor for the bus system
 CCSVBusSystem::CCSVBusSystem(std::shared_ptr<CDSVReader> stopsrc, std::shared_ptr<CDSVReader> routesrc) {
     DImplementation = std::make_unique<SImplementation>();
-    // tmp storage for row data
-    std::vector<std::string> row;  
     
-    //read stops data
+    //read stops data, the columns are found by their header names and
+    //fall back to the first two columns when there is no header
     if (stopsrc) {
-        //read each row of the stop file with a while loop
-        while (stopsrc->ReadRow(row)) {
-            // ensure sufficient columns exists
-            if (row.size() >= 2) {  
-                try {
-                    auto stop = std::make_shared<SStop>();
-                    //convert first column to StopID(0 is first in index)
-                    stop->StopID = std::stoul(row[0]);  
-                    //convert second column to NodeID(1 is second in index)
-                    stop->NodeIDValue = std::stoul(row[1]);  
-                    //store in map for quick lookup
-                    DImplementation->Stops[stop->StopID] = stop; 
-                    //store in list for indexed access 
-                    DImplementation->StopsByIndex.push_back(stop);  
-                } catch (const std::exception& e) {
-                    //handle error by 
-                    std::cerr << "Exception caught: " << e.what() << "\n";
-                }
+        CDSVColumnLoader loader(stopsrc);
+        std::size_t stopColumn = loader.AddUIntColumn("stop_id", 0);
+        std::size_t nodeColumn = loader.AddUIntColumn("node_id", 1);
+        loader.Load();
+        DImplementation->ErrorCount += loader.ErrorCount();
+
+        const auto &stopIDs = loader.UIntColumn(stopColumn);
+        const auto &nodeIDs = loader.UIntColumn(nodeColumn);
+        auto &stops = *DImplementation->Stops;
+        stops.resize(stopIDs.size());
+        for (std::size_t index = 0; index < stops.size(); index++) {
+            stops[index].StopID = stopIDs[index];
+            stops[index].NodeIDValue = nodeIDs[index];
+        }
+
+        //sort the stop indices by ID once for quick lookup, skipped when the
+        //file is already in ID order. The sort is stable so the last of any
+        //duplicate IDs can be found like the map used to keep
+        bool sorted = std::is_sorted(stops.begin(), stops.end(), [](const SStop &left, const SStop &right) {
+            return left.StopID < right.StopID;
+        });
+        if (!sorted) {
+            auto &order = DImplementation->StopIDOrder;
+            order.resize(stops.size());
+            for (std::size_t index = 0; index < order.size(); index++) {
+                order[index] = index;
             }
+            std::stable_sort(order.begin(), order.end(), [&stops](std::size_t left, std::size_t right) {
+                return stops[left].StopID < stops[right].StopID;
+            });
         }
     }
 
     // read routes data
     if (routesrc) {
-        // tmp storage for routes
-        std::unordered_map<std::string, std::shared_ptr<SRoute>> tempRoutes;  
-       // read each row of the route file
-        while (routesrc->ReadRow(row)) {  
-            // ensure sufficient columns exist
-            if (row.size() >= 2) {  
-                try {
-                    //first column is route name
-                    std::string routeName = row[0];  
-                    //second column is StopID
-                    TStopID stopID = std::stoul(row[1]);  
-                 // retrieve or create route entry
-                    auto& route = tempRoutes[routeName];  
-                    if (!route) {
-                        route = std::make_shared<SRoute>();
-                        route->RouteName = routeName;
-                    }
-                    // Append stop to route by push_back
-                    route->RouteStops.push_back(stopID);  
-                } catch (const std::exception& e) {
-                    //handle error by 
-                    std::cerr << "Exception caught: " << e.what() << "\n";
-                }
-            }
+        CDSVColumnLoader loader(routesrc);
+        std::size_t routeColumn = loader.AddCategoryColumn("route", 0);
+        std::size_t stopColumn = loader.AddUIntColumn("stop_id", 1);
+        loader.Load();
+        DImplementation->ErrorCount += loader.ErrorCount();
+
+        // route names come back in order of first appearance, which is the route order
+        for (const auto &name : loader.Categories(routeColumn)) {
+            auto route = std::make_shared<SRoute>();
+            route->RouteName = name;
+            DImplementation->Routes[name] = route;
+            DImplementation->RoutesByIndex.push_back(route);
+        }
+        const auto &routeCodes = loader.CategoryColumn(routeColumn);
+        const auto &stopIDs = loader.UIntColumn(stopColumn);
+        for (std::size_t index = 0; index < routeCodes.size(); index++) {
+            // Append stop to route by push_back
+            DImplementation->RoutesByIndex[routeCodes[index]]->RouteStops.push_back(stopIDs[index]);
         }
+    }
 
-        for (const auto& pair : tempRoutes) {
-            // store in route map
-            DImplementation->Routes[pair.first] = pair.second; 
-            // store in index list 
-            DImplementation->RoutesByIndex.push_back(pair.second);  
+    //build the reverse index once, a stable sort by stop ID of the route
+    //stops in route order keeps each stop's entries in route then position order
+    std::vector<std::pair<TStopID, SRouteStop>> entries;
+    const auto &routes = DImplementation->RoutesByIndex;
+    for (std::size_t routeIndex = 0; routeIndex < routes.size(); routeIndex++) {
+        const auto &routeStops = routes[routeIndex]->RouteStops;
+        for (std::size_t position = 0; position < routeStops.size(); position++) {
+            entries.push_back({routeStops[position], {routeIndex, position}});
         }
     }
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &left, const auto &right) {
+        return left.first < right.first;
+    });
+    auto &stopIDs = DImplementation->RouteStopIDs;
+    auto &offsets = DImplementation->RouteStopOffsets;
+    auto &routeStops = DImplementation->RouteStops;
+    routeStops.reserve(entries.size());
+    for (const auto &entry : entries) {
+        if (stopIDs.empty() || stopIDs.back() != entry.first) {
+            stopIDs.push_back(entry.first);
+            offsets.push_back(routeStops.size());
+        }
+        routeStops.push_back(entry.second);
+    }
+    offsets.push_back(routeStops.size());
 }
 
 // destructor
@@ -135,7 +175,7 @@ CCSVBusSystem::~CCSVBusSystem() = default;
 
 // return the total number of stops
 std::size_t CCSVBusSystem::StopCount() const noexcept {
-    return DImplementation->StopsByIndex.size();
+    return DImplementation->Stops->size();
 }
 
 // return the total number of routes
@@ -145,17 +185,31 @@ std::size_t CCSVBusSystem::RouteCount() const noexcept {
 
 // return a stop by index
 std::shared_ptr<CBusSystem::SStop> CCSVBusSystem::StopByIndex(std::size_t index) const noexcept {
-    if (index < DImplementation->StopsByIndex.size()) {
-        return DImplementation->StopsByIndex[index];
+    if (index < DImplementation->Stops->size()) {
+        return DImplementation->StopPointer(index);
     }
     return nullptr;
 }
 
 // return a stop by its ID
 std::shared_ptr<CBusSystem::SStop> CCSVBusSystem::StopByID(TStopID id) const noexcept {
-    auto it = DImplementation->Stops.find(id);
-    if (it != DImplementation->Stops.end()) {
-        return it->second;
+    const auto &stops = *DImplementation->Stops;
+    const auto &order = DImplementation->StopIDOrder;
+    // find the last stop with this ID
+    if (order.empty()) {
+        auto it = std::upper_bound(stops.begin(), stops.end(), id, [](TStopID value, const SStop &stop) {
+            return value < stop.StopID;
+        });
+        if (it != stops.begin() && (it - 1)->StopID == id) {
+            return DImplementation->StopPointer(it - 1 - stops.begin());
+        }
+        return nullptr;
+    }
+    auto it = std::upper_bound(order.begin(), order.end(), id, [&stops](TStopID value, std::size_t index) {
+        return value < stops[index].StopID;
+    });
+    if (it != order.begin() && stops[*(it - 1)].StopID == id) {
+        return DImplementation->StopPointer(*(it - 1));
     }
     return nullptr;
 }
@@ -177,6 +231,26 @@ std::shared_ptr<CBusSystem::SRoute> CCSVBusSystem::RouteByName(const std::string
     return nullptr;
 }
 
+// return the routes stopping at a stop, found with a binary search over the
+// stop IDs of the reverse index so the cost is the number of routes there
+bool CCSVBusSystem::RoutesByStopID(TStopID id, std::vector<SRouteStop> &routes) const noexcept {
+    routes.clear();
+    const auto &stopIDs = DImplementation->RouteStopIDs;
+    auto it = std::lower_bound(stopIDs.begin(), stopIDs.end(), id);
+    if (it == stopIDs.end() || *it != id) {
+        return false;
+    }
+    std::size_t index = it - stopIDs.begin();
+    const auto &offsets = DImplementation->RouteStopOffsets;
+    routes.assign(DImplementation->RouteStops.begin() + offsets[index], DImplementation->RouteStops.begin() + offsets[index + 1]);
+    return true;
+}
+
+// return the number of rows that were skipped
+std::size_t CCSVBusSystem::ErrorCount() const noexcept {
+    return DImplementation->ErrorCount;
+}
+
 //overloads operator<< in order to print the bus system details
 std::ostream &operator<<(std::ostream &os, const CCSVBusSystem &bussystem) {
     os << "StopCount: " << std::to_string(bussystem.StopCount()) << "\n";
@@ -0,0 +1,485 @@
+#include "ContractionHierarchy.h"
+#include "IndexedHeap.h"
+#include "FileDataSink.h"
+#include "MappedFileDataSource.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <thread>
+
+namespace{
+
+using TVertexID = CRoutingGraph::TVertexID;
+
+const char HierarchyMagic[8] = {'C', 'O', 'N', 'T', 'R', 'H', 'I', 'E'};
+
+struct SFileHeader{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t HeaderSize;
+    uint64_t VertexCount;
+    uint64_t ForwardEdgeCount;
+    uint64_t BackwardEdgeCount;
+};
+
+// edge of the graph while it is being contracted
+struct SDynamicEdge{
+    TVertexID Target;
+    double Weight;
+    TVertexID Middle;
+};
+
+// a shortcut found while simulating or contracting a vertex
+struct SShortcut{
+    TVertexID Source;
+    TVertexID Target;
+    double Weight;
+};
+
+// local Dijkstra from one in-neighbor of the vertex being contracted that
+// looks for paths avoiding it. The search gives up after SettleLimit
+// vertices, which at worst adds a shortcut that wasn't needed
+struct SWitnessSearch{
+    static const std::size_t SettleLimit = 500;
+
+    std::vector<uint32_t> Stamp;
+    std::vector<double> Distance;
+    uint32_t CurrentStamp = 0;
+    CIndexedHeap<4> Heap;
+
+    SWitnessSearch(std::size_t vertexcount) : Stamp(vertexcount, 0), Distance(vertexcount), Heap(vertexcount){
+    }
+
+    double DistanceTo(TVertexID vertex) const{
+        return Stamp[vertex] == CurrentStamp ? Distance[vertex] : std::numeric_limits<double>::infinity();
+    }
+
+    void Run(const std::vector<std::vector<SDynamicEdge>> &out, const std::vector<char> &contracted, TVertexID src, TVertexID excluded, double limit){
+        if(++CurrentStamp == 0){
+            std::fill(Stamp.begin(), Stamp.end(), 0);
+            CurrentStamp = 1;
+        }
+        Heap.Clear();
+        Stamp[src] = CurrentStamp;
+        Distance[src] = 0.0;
+        Heap.Push(src, 0.0);
+        std::size_t Settled = 0;
+        while(!Heap.Empty() && Heap.MinKey() <= limit && Settled < SettleLimit){
+            TVertexID Current = Heap.Pop();
+            Settled++;
+            double CurrentDistance = Distance[Current];
+            for(auto &Edge : out[Current]){
+                if(Edge.Target == excluded || contracted[Edge.Target]){
+                    continue;
+                }
+                double TargetDistance = CurrentDistance + Edge.Weight;
+                if(Stamp[Edge.Target] != CurrentStamp){
+                    Stamp[Edge.Target] = CurrentStamp;
+                    Distance[Edge.Target] = TargetDistance;
+                    Heap.Push(Edge.Target, TargetDistance);
+                }
+                else if(TargetDistance < Distance[Edge.Target]){
+                    // settled vertices can't improve, so this is always still in the heap
+                    Distance[Edge.Target] = TargetDistance;
+                    Heap.Decrease(Edge.Target, TargetDistance);
+                }
+            }
+        }
+    }
+};
+
+template <typename T> void AppendArray(std::string &buffer, const std::vector<T> &values){
+    buffer.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+// copies count values out of the file, returns false if it is too short
+template <typename T> bool ReadArray(const char *&current, const char *end, std::size_t count, std::vector<T> &values){
+    if(static_cast<std::size_t>(end - current) / sizeof(T) < count){
+        return false;
+    }
+    values.resize(count);
+    std::memcpy(values.data(), current, count * sizeof(T));
+    current += count * sizeof(T);
+    return true;
+}
+
+}
+
+struct CContractionHierarchy::SImplementation{
+    bool Valid = false;
+    std::vector<uint32_t> Ranks;
+    SUpwardGraph Forward;
+    SUpwardGraph Backward;
+
+    // graph state used only while contracting
+    std::vector<std::vector<SDynamicEdge>> Out;
+    std::vector<std::vector<SDynamicEdge>> In;
+    std::vector<char> Contracted;
+    std::vector<uint32_t> DeletedNeighbors;
+    // upward edges captured when each vertex is contracted
+    std::vector<std::vector<SDynamicEdge>> ForwardUp;
+    std::vector<std::vector<SDynamicEdge>> BackwardUp;
+
+    SImplementation(const CRoutingGraph &graph, std::size_t threads){
+        std::size_t VertexCount = graph.VertexCount();
+        const auto &Offsets = graph.EdgeOffsets();
+        const auto &Targets = graph.EdgeTargets();
+        const auto &Lengths = graph.EdgeLengths();
+        Out.resize(VertexCount);
+        In.resize(VertexCount);
+        for(TVertexID Vertex = 0; Vertex < VertexCount; Vertex++){
+            for(auto Edge = Offsets[Vertex]; Edge < Offsets[Vertex + 1]; Edge++){
+                if(Targets[Edge] != Vertex){
+                    Out[Vertex].push_back({Targets[Edge], Lengths[Edge], CRoutingGraph::InvalidVertexID});
+                    In[Targets[Edge]].push_back({Vertex, Lengths[Edge], CRoutingGraph::InvalidVertexID});
+                }
+            }
+        }
+        Contracted.assign(VertexCount, false);
+        DeletedNeighbors.assign(VertexCount, 0);
+        ForwardUp.resize(VertexCount);
+        BackwardUp.resize(VertexCount);
+        Ranks.assign(VertexCount, 0);
+
+        Contract(threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+
+        BuildUpwardGraph(ForwardUp, Forward);
+        BuildUpwardGraph(BackwardUp, Backward);
+        Out = {};
+        In = {};
+        ForwardUp = {};
+        BackwardUp = {};
+        Valid = true;
+    }
+
+    SImplementation(const std::string &filename){
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        // copied out once, the kernel's default read ahead is enough for that
+        CMappedFileDataSource Source(filename, CMappedFileDataSource::EAccessPattern::None);
+        SFileHeader Header;
+        if(!Source.IsOpen() || Source.Size() < sizeof(SFileHeader)){
+            return;
+        }
+        std::memcpy(&Header, Source.Data(), sizeof(SFileHeader));
+        if(std::memcmp(Header.Magic, HierarchyMagic, sizeof(HierarchyMagic)) || Header.Version != Version || Header.HeaderSize != sizeof(SFileHeader)){
+            return;
+        }
+        const char *Current = Source.Data() + sizeof(SFileHeader);
+        const char *End = Source.Data() + Source.Size();
+        if(!ReadArray(Current, End, Header.VertexCount, Ranks) ||
+           !ReadUpwardGraph(Current, End, Header.VertexCount, Header.ForwardEdgeCount, Forward) ||
+           !ReadUpwardGraph(Current, End, Header.VertexCount, Header.BackwardEdgeCount, Backward) ||
+           Current != End){
+            return;
+        }
+        for(auto Rank : Ranks){
+            if(Rank >= Header.VertexCount){
+                return;
+            }
+        }
+        if(!ValidMiddles(Forward) || !ValidMiddles(Backward)){
+            return;
+        }
+        Valid = true;
+#endif
+    }
+
+    // a shortcut skips a vertex ranked below both of its ends, anything else
+    // would make UnpackEdge unpack the same edge forever
+    bool ValidMiddles(const SUpwardGraph &graph) const{
+        for(TVertexID Vertex = 0; Vertex + 1 < graph.Offsets.size(); Vertex++){
+            for(auto Edge = graph.Offsets[Vertex]; Edge < graph.Offsets[Vertex + 1]; Edge++){
+                TVertexID Middle = graph.Middles[Edge];
+                if(Middle != CRoutingGraph::InvalidVertexID && Ranks[Middle] >= std::min(Ranks[Vertex], Ranks[graph.Targets[Edge]])){
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static bool ReadUpwardGraph(const char *&current, const char *end, std::size_t vertexcount, std::size_t edgecount, SUpwardGraph &graph){
+        if(!ReadArray(current, end, vertexcount + 1, graph.Offsets) ||
+           !ReadArray(current, end, edgecount, graph.Targets) ||
+           !ReadArray(current, end, edgecount, graph.Weights) ||
+           !ReadArray(current, end, edgecount, graph.Middles)){
+            return false;
+        }
+        if(graph.Offsets[0] != 0 || graph.Offsets[vertexcount] != edgecount){
+            return false;
+        }
+        for(std::size_t Vertex = 0; Vertex < vertexcount; Vertex++){
+            if(graph.Offsets[Vertex] > graph.Offsets[Vertex + 1]){
+                return false;
+            }
+        }
+        for(std::size_t Edge = 0; Edge < edgecount; Edge++){
+            if(graph.Targets[Edge] >= vertexcount || (graph.Middles[Edge] >= vertexcount && graph.Middles[Edge] != CRoutingGraph::InvalidVertexID)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void BuildUpwardGraph(std::vector<std::vector<SDynamicEdge>> &edges, SUpwardGraph &graph){
+        graph.Offsets.assign(1, 0);
+        for(auto &List : edges){
+            std::sort(List.begin(), List.end(), [](const SDynamicEdge &left, const SDynamicEdge &right){
+                return left.Target < right.Target;
+            });
+            for(auto &Edge : List){
+                graph.Targets.push_back(Edge.Target);
+                graph.Weights.push_back(Edge.Weight);
+                graph.Middles.push_back(Edge.Middle);
+            }
+            graph.Offsets.push_back(graph.Targets.size());
+        }
+    }
+
+    // finds the shortcuts contracting vertex would need given the vertices
+    // contracted so far, an edge u -> v -> w is only needed if there is no
+    // path from u to w that avoids v and is no longer
+    void FindShortcuts(TVertexID vertex, SWitnessSearch &witness, std::vector<SShortcut> &shortcuts) const{
+        shortcuts.clear();
+        double MaxOut = 0.0;
+        for(auto &Edge : Out[vertex]){
+            MaxOut = std::max(MaxOut, Edge.Weight);
+        }
+        for(auto &InEdge : In[vertex]){
+            bool NeedsSearch = false;
+            for(auto &OutEdge : Out[vertex]){
+                NeedsSearch = NeedsSearch || OutEdge.Target != InEdge.Target;
+            }
+            if(!NeedsSearch){
+                continue;
+            }
+            witness.Run(Out, Contracted, InEdge.Target, vertex, InEdge.Weight + MaxOut);
+            for(auto &OutEdge : Out[vertex]){
+                double Via = InEdge.Weight + OutEdge.Weight;
+                if(OutEdge.Target != InEdge.Target && witness.DistanceTo(OutEdge.Target) > Via){
+                    shortcuts.push_back({InEdge.Target, OutEdge.Target, Via});
+                }
+            }
+        }
+    }
+
+    // edge difference plus the contracted neighbor count, which spreads the
+    // contraction out over the graph instead of eating into one region
+    int Priority(TVertexID vertex, SWitnessSearch &witness, std::vector<SShortcut> &shortcuts) const{
+        FindShortcuts(vertex, witness, shortcuts);
+        return static_cast<int>(shortcuts.size()) - static_cast<int>(In[vertex].size() + Out[vertex].size()) + static_cast<int>(DeletedNeighbors[vertex]);
+    }
+
+    // adds source -> target or lowers its weight if it is already there
+    void AddShortcut(const SShortcut &shortcut, TVertexID middle){
+        for(auto &Edge : Out[shortcut.Source]){
+            if(Edge.Target == shortcut.Target){
+                if(shortcut.Weight < Edge.Weight){
+                    Edge.Weight = shortcut.Weight;
+                    Edge.Middle = middle;
+                    for(auto &Reverse : In[shortcut.Target]){
+                        if(Reverse.Target == shortcut.Source){
+                            Reverse.Weight = shortcut.Weight;
+                            Reverse.Middle = middle;
+                        }
+                    }
+                }
+                return;
+            }
+        }
+        Out[shortcut.Source].push_back({shortcut.Target, shortcut.Weight, middle});
+        In[shortcut.Target].push_back({shortcut.Source, shortcut.Weight, middle});
+    }
+
+    static void RemoveEdgesTo(std::vector<SDynamicEdge> &edges, TVertexID target){
+        edges.erase(std::remove_if(edges.begin(), edges.end(), [target](const SDynamicEdge &edge){
+            return edge.Target == target;
+        }), edges.end());
+    }
+
+    // contracts the vertices in priority order. Priorities are updated
+    // lazily, a vertex taken off the queue is re-simulated and put back if it
+    // no longer beats the next one. The initial priorities are independent of
+    // each other and are computed on all threads
+    void Contract(std::size_t threads){
+        std::size_t VertexCount = Out.size();
+        std::vector<int> Priorities(VertexCount);
+        {
+            std::atomic<std::size_t> NextBlock(0);
+            const std::size_t BlockSize = 1024;
+            auto Worker = [&](){
+                SWitnessSearch Witness(VertexCount);
+                std::vector<SShortcut> Shortcuts;
+                std::size_t Block;
+                while((Block = NextBlock.fetch_add(BlockSize)) < VertexCount){
+                    for(std::size_t Vertex = Block; Vertex < std::min(VertexCount, Block + BlockSize); Vertex++){
+                        Priorities[Vertex] = Priority(Vertex, Witness, Shortcuts);
+                    }
+                }
+            };
+            std::vector<std::thread> Threads;
+            for(std::size_t Index = 1; Index < threads; Index++){
+                Threads.emplace_back(Worker);
+            }
+            Worker();
+            for(auto &Thread : Threads){
+                Thread.join();
+            }
+        }
+
+        using TQueueEntry = std::pair<int, TVertexID>;
+        std::priority_queue<TQueueEntry, std::vector<TQueueEntry>, std::greater<TQueueEntry>> Queue;
+        for(TVertexID Vertex = 0; Vertex < VertexCount; Vertex++){
+            Queue.push({Priorities[Vertex], Vertex});
+        }
+        SWitnessSearch Witness(VertexCount);
+        std::vector<SShortcut> Shortcuts;
+        std::vector<TVertexID> Neighbors;
+        uint32_t NextRank = 0;
+        while(!Queue.empty()){
+            auto [QueuedPriority, Vertex] = Queue.top();
+            Queue.pop();
+            if(Contracted[Vertex] || QueuedPriority != Priorities[Vertex]){
+                continue;
+            }
+            int CurrentPriority = Priority(Vertex, Witness, Shortcuts);
+            if(!Queue.empty() && CurrentPriority > Queue.top().first){
+                Priorities[Vertex] = CurrentPriority;
+                Queue.push({CurrentPriority, Vertex});
+                continue;
+            }
+
+            // the remaining edges all lead to higher ranked vertices
+            Ranks[Vertex] = NextRank++;
+            Contracted[Vertex] = true;
+            ForwardUp[Vertex] = Out[Vertex];
+            BackwardUp[Vertex] = In[Vertex];
+            for(auto &Shortcut : Shortcuts){
+                AddShortcut(Shortcut, Vertex);
+            }
+            Neighbors.clear();
+            for(auto &Edge : Out[Vertex]){
+                RemoveEdgesTo(In[Edge.Target], Vertex);
+                Neighbors.push_back(Edge.Target);
+            }
+            for(auto &Edge : In[Vertex]){
+                RemoveEdgesTo(Out[Edge.Target], Vertex);
+                Neighbors.push_back(Edge.Target);
+            }
+            Out[Vertex] = {};
+            In[Vertex] = {};
+            std::sort(Neighbors.begin(), Neighbors.end());
+            Neighbors.erase(std::unique(Neighbors.begin(), Neighbors.end()), Neighbors.end());
+            for(auto Neighbor : Neighbors){
+                DeletedNeighbors[Neighbor]++;
+                Priorities[Neighbor] = Priority(Neighbor, Witness, Shortcuts);
+                Queue.push({Priorities[Neighbor], Neighbor});
+            }
+        }
+    }
+
+    // index of the edge to target in the list of vertex, or the end of the list
+    static uint32_t FindEdge(const SUpwardGraph &graph, TVertexID vertex, TVertexID target){
+        auto Begin = graph.Targets.begin() + graph.Offsets[vertex];
+        auto End = graph.Targets.begin() + graph.Offsets[vertex + 1];
+        auto Found = std::lower_bound(Begin, End, target);
+        return Found != End && *Found == target ? Found - graph.Targets.begin() : graph.Offsets[vertex + 1];
+    }
+
+    // an edge is stored at its lower ranked end, so src -> dest is either
+    // a forward edge of src or a backward edge of dest
+    bool UnpackEdge(TVertexID src, TVertexID dest, std::vector<TVertexID> &path) const{
+        if(src >= Ranks.size() || dest >= Ranks.size() || src == dest){
+            return false;
+        }
+        const SUpwardGraph &Graph = Ranks[src] < Ranks[dest] ? Forward : Backward;
+        TVertexID Owner = Ranks[src] < Ranks[dest] ? src : dest;
+        TVertexID Other = Ranks[src] < Ranks[dest] ? dest : src;
+        uint32_t Edge = FindEdge(Graph, Owner, Other);
+        if(Edge == Graph.Offsets[Owner + 1]){
+            return false;
+        }
+        TVertexID Middle = Graph.Middles[Edge];
+        if(Middle == CRoutingGraph::InvalidVertexID){
+            path.push_back(dest);
+            return true;
+        }
+        return UnpackEdge(src, Middle, path) && UnpackEdge(Middle, dest, path);
+    }
+};
+
+CContractionHierarchy::CContractionHierarchy(const CRoutingGraph &graph, std::size_t threads) : DImplementation(std::make_unique<SImplementation>(graph, threads)){
+
+}
+
+CContractionHierarchy::CContractionHierarchy(const std::string &filename) : DImplementation(std::make_unique<SImplementation>(filename)){
+
+}
+
+CContractionHierarchy::~CContractionHierarchy() = default;
+
+bool CContractionHierarchy::IsValid() const noexcept{
+    return DImplementation->Valid;
+}
+
+bool CContractionHierarchy::Save(const std::string &filename) const{
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    return false;
+#else
+    if(!DImplementation->Valid){
+        return false;
+    }
+    const SUpwardGraph &Forward = DImplementation->Forward;
+    const SUpwardGraph &Backward = DImplementation->Backward;
+    SFileHeader Header;
+    std::memset(&Header, 0, sizeof(Header));
+    std::memcpy(Header.Magic, HierarchyMagic, sizeof(HierarchyMagic));
+    Header.Version = Version;
+    Header.HeaderSize = sizeof(SFileHeader);
+    Header.VertexCount = DImplementation->Ranks.size();
+    Header.ForwardEdgeCount = Forward.Targets.size();
+    Header.BackwardEdgeCount = Backward.Targets.size();
+
+    std::string Buffer(reinterpret_cast<const char *>(&Header), sizeof(Header));
+    AppendArray(Buffer, DImplementation->Ranks);
+    for(const SUpwardGraph *Graph : {&Forward, &Backward}){
+        AppendArray(Buffer, Graph->Offsets);
+        AppendArray(Buffer, Graph->Targets);
+        AppendArray(Buffer, Graph->Weights);
+        AppendArray(Buffer, Graph->Middles);
+    }
+    return CFileDataSink::ReplaceFile(filename, {Buffer});
+#endif
+}
+
+std::size_t CContractionHierarchy::VertexCount() const noexcept{
+    return DImplementation->Ranks.size();
+}
+
+std::size_t CContractionHierarchy::ShortcutCount() const noexcept{
+    std::size_t Count = 0;
+    for(const SUpwardGraph *Graph : {&DImplementation->Forward, &DImplementation->Backward}){
+        for(auto Middle : Graph->Middles){
+            Count += Middle != CRoutingGraph::InvalidVertexID;
+        }
+    }
+    return Count;
+}
+
+uint32_t CContractionHierarchy::Rank(CRoutingGraph::TVertexID vertex) const noexcept{
+    return vertex < DImplementation->Ranks.size() ? DImplementation->Ranks[vertex] : 0;
+}
+
+const CContractionHierarchy::SUpwardGraph &CContractionHierarchy::ForwardGraph() const noexcept{
+    return DImplementation->Forward;
+}
+
+const CContractionHierarchy::SUpwardGraph &CContractionHierarchy::BackwardGraph() const noexcept{
+    return DImplementation->Backward;
+}
+
+bool CContractionHierarchy::UnpackEdge(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest, std::vector<CRoutingGraph::TVertexID> &path) const{
+    return DImplementation->UnpackEdge(src, dest, path);
+}
@@ -0,0 +1,158 @@
+#include "ContractionHierarchySearch.h"
+#include "IndexedHeap.h"
+#include <algorithm>
+
+struct CContractionHierarchySearch::SImplementation{
+    using TVertexID = CRoutingGraph::TVertexID;
+    using SUpwardGraph = CContractionHierarchy::SUpwardGraph;
+
+    // state of one direction of the search, a vertex has been reached in the
+    // current query when its Stamp matches
+    struct SDirection{
+        const SUpwardGraph &Graph;
+        std::vector<uint32_t> Stamp;
+        std::vector<double> Distance;
+        std::vector<TVertexID> Parent;
+        CIndexedHeap<4> Heap;
+
+        SDirection(const SUpwardGraph &graph, std::size_t vertexcount)
+            : Graph(graph), Stamp(vertexcount, 0), Distance(vertexcount), Parent(vertexcount), Heap(vertexcount){
+        }
+    };
+
+    std::shared_ptr<const CContractionHierarchy> Hierarchy;
+    // Forward searches up from the source, Backward up from the destination
+    // along reversed edges
+    SDirection Forward;
+    SDirection Backward;
+    uint32_t CurrentStamp = 0;
+    std::size_t SettledCount = 0;
+    std::vector<TVertexID> Chain;
+
+    SImplementation(std::shared_ptr<const CContractionHierarchy> hierarchy)
+        : Hierarchy(std::move(hierarchy)), Forward(Hierarchy->ForwardGraph(), Hierarchy->VertexCount()), Backward(Hierarchy->BackwardGraph(), Hierarchy->VertexCount()){
+    }
+
+    void NewQuery(){
+        if(++CurrentStamp == 0){
+            std::fill(Forward.Stamp.begin(), Forward.Stamp.end(), 0);
+            std::fill(Backward.Stamp.begin(), Backward.Stamp.end(), 0);
+            CurrentStamp = 1;
+        }
+        Forward.Heap.Clear();
+        Backward.Heap.Clear();
+        SettledCount = 0;
+    }
+
+    bool Reached(const SDirection &direction, TVertexID vertex) const{
+        return direction.Stamp[vertex] == CurrentStamp;
+    }
+
+    void Relax(SDirection &direction, TVertexID vertex, TVertexID parent, double distance){
+        if(!Reached(direction, vertex)){
+            direction.Stamp[vertex] = CurrentStamp;
+            direction.Distance[vertex] = distance;
+            direction.Parent[vertex] = parent;
+            direction.Heap.Push(vertex, distance);
+        }
+        else if(distance < direction.Distance[vertex]){
+            // only upward edges are followed and a settled vertex can't be
+            // reached more cheaply, so a shorter distance is still in the heap
+            direction.Distance[vertex] = distance;
+            direction.Parent[vertex] = parent;
+            direction.Heap.Decrease(vertex, distance);
+        }
+    }
+
+    // settles the closest vertex of one direction and checks whether it
+    // joins up with the other one
+    void Step(SDirection &direction, const SDirection &other, double &best, TVertexID &meeting){
+        TVertexID Current = direction.Heap.Pop();
+        SettledCount++;
+        double CurrentDistance = direction.Distance[Current];
+        if(Reached(other, Current) && CurrentDistance + other.Distance[Current] < best){
+            best = CurrentDistance + other.Distance[Current];
+            meeting = Current;
+        }
+        const SUpwardGraph &Graph = direction.Graph;
+        for(auto Edge = Graph.Offsets[Current]; Edge < Graph.Offsets[Current + 1]; Edge++){
+            Relax(direction, Graph.Targets[Edge], Current, CurrentDistance + Graph.Weights[Edge]);
+        }
+    }
+
+    // alternates between the directions, each stops once nothing left in its
+    // heap can beat the best meeting point found so far
+    double Search(TVertexID src, TVertexID dest, TVertexID &meeting){
+        meeting = CRoutingGraph::InvalidVertexID;
+        std::size_t VertexCount = Forward.Stamp.size();
+        if(src >= VertexCount || dest >= VertexCount){
+            return NoPathExists;
+        }
+        NewQuery();
+        Relax(Forward, src, CRoutingGraph::InvalidVertexID, 0.0);
+        Relax(Backward, dest, CRoutingGraph::InvalidVertexID, 0.0);
+        double Best = NoPathExists;
+        bool ForwardTurn = true;
+        while(true){
+            bool ForwardDone = Forward.Heap.Empty() || Forward.Heap.MinKey() >= Best;
+            bool BackwardDone = Backward.Heap.Empty() || Backward.Heap.MinKey() >= Best;
+            if(ForwardDone && BackwardDone){
+                break;
+            }
+            if((ForwardTurn && !ForwardDone) || BackwardDone){
+                Step(Forward, Backward, Best, meeting);
+            }
+            else{
+                Step(Backward, Forward, Best, meeting);
+            }
+            ForwardTurn = !ForwardTurn;
+        }
+        return Best;
+    }
+
+    double FindShortestPath(TVertexID src, TVertexID dest, std::vector<TVertexID> &path){
+        path.clear();
+        TVertexID Meeting;
+        double Distance = Search(src, dest, Meeting);
+        if(Meeting == CRoutingGraph::InvalidVertexID){
+            return NoPathExists;
+        }
+        // the hierarchy path runs up from src to the meeting vertex and then
+        // down to dest, each of its edges is expanded into the original ones
+        Chain.clear();
+        for(TVertexID Vertex = Meeting; Vertex != CRoutingGraph::InvalidVertexID; Vertex = Forward.Parent[Vertex]){
+            Chain.push_back(Vertex);
+        }
+        std::reverse(Chain.begin(), Chain.end());
+        for(TVertexID Vertex = Backward.Parent[Meeting]; Vertex != CRoutingGraph::InvalidVertexID; Vertex = Backward.Parent[Vertex]){
+            Chain.push_back(Vertex);
+        }
+        path.push_back(Chain[0]);
+        for(std::size_t Index = 1; Index < Chain.size(); Index++){
+            if(!Hierarchy->UnpackEdge(Chain[Index - 1], Chain[Index], path)){
+                path.clear();
+                return NoPathExists;
+            }
+        }
+        return Distance;
+    }
+};
+
+CContractionHierarchySearch::CContractionHierarchySearch(std::shared_ptr<const CContractionHierarchy> hierarchy) : DImplementation(std::make_unique<SImplementation>(hierarchy)){
+
+}
+
+CContractionHierarchySearch::~CContractionHierarchySearch() = default;
+
+double CContractionHierarchySearch::FindShortestPath(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest, std::vector<CRoutingGraph::TVertexID> &path){
+    return DImplementation->FindShortestPath(src, dest, path);
+}
+
+double CContractionHierarchySearch::FindDistance(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest){
+    CRoutingGraph::TVertexID Meeting;
+    return DImplementation->Search(src, dest, Meeting);
+}
+
+std::size_t CContractionHierarchySearch::SettledCount() const noexcept{
+    return DImplementation->SettledCount;
+}
@@ -0,0 +1,196 @@
+#include "DSVColumnLoader.h"
+#include <charconv>
+#include <string_view>
+#include <unordered_map>
+
+struct CDSVColumnLoader::SImplementation{
+    enum class EType{UInt, Category};
+
+    struct SColumn{
+        std::string Name;
+        std::size_t Position;
+        EType Type;
+        std::vector<uint64_t> Values;
+        std::vector<uint32_t> Codes;
+        std::vector<std::string> Categories;
+        std::unordered_map<std::string, uint32_t> CategoryCodes;
+        // code of the most recent value, consecutive rows usually repeat it
+        uint32_t LastCode = 0;
+    };
+
+    std::shared_ptr<CDSVReader> Reader;
+    std::vector<SColumn> Columns;
+    std::size_t RowCount = 0;
+    std::size_t ErrorCount = 0;
+    bool HasHeader = false;
+    // values parsed for the row being loaded, only kept if the whole row parses
+    std::vector<uint64_t> RowValues;
+    // reused key for category lookups
+    std::string CategoryKey;
+
+    // empty columns returned for out of range indices
+    static const std::vector<uint64_t> EmptyValues;
+    static const std::vector<uint32_t> EmptyCodes;
+    static const std::vector<std::string> EmptyCategories;
+
+    SImplementation(std::shared_ptr<CDSVReader> src) : Reader(std::move(src)){
+    }
+
+    std::size_t AddColumn(const std::string &name, std::size_t position, EType type){
+        Columns.emplace_back();
+        Columns.back().Name = name;
+        Columns.back().Position = position;
+        Columns.back().Type = type;
+        return Columns.size() - 1;
+    }
+
+    // whole cell as an unsigned integer, surrounding spaces are allowed
+    static bool ParseUInt(std::string_view cell, uint64_t &value){
+        while(!cell.empty() && (cell.front() == ' ' || cell.front() == '\t')){
+            cell.remove_prefix(1);
+        }
+        while(!cell.empty() && (cell.back() == ' ' || cell.back() == '\t')){
+            cell.remove_suffix(1);
+        }
+        auto Result = std::from_chars(cell.data(), cell.data() + cell.size(), value);
+        return Result.ec == std::errc() && Result.ptr == cell.data() + cell.size();
+    }
+
+    uint32_t CategoryCode(SColumn &column, std::string_view cell){
+        if(!column.Categories.empty() && column.Categories[column.LastCode] == cell){
+            return column.LastCode;
+        }
+        CategoryKey.assign(cell);
+        auto Search = column.CategoryCodes.find(CategoryKey);
+        if(Search != column.CategoryCodes.end()){
+            column.LastCode = Search->second;
+        }
+        else{
+            column.LastCode = column.Categories.size();
+            column.CategoryCodes.emplace(CategoryKey, column.LastCode);
+            column.Categories.push_back(CategoryKey);
+        }
+        return column.LastCode;
+    }
+
+    // a header is a first row that names at least one of the columns
+    bool ApplyHeader(const std::vector<std::string_view> &row){
+        bool Found = false;
+        for(auto &Column : Columns){
+            for(std::size_t Index = 0; Index < row.size(); Index++){
+                if(row[Index] == Column.Name){
+                    Column.Position = Index;
+                    Found = true;
+                    break;
+                }
+            }
+        }
+        return Found;
+    }
+
+    void AddRow(const std::vector<std::string_view> &row){
+        // blank lines aren't rows
+        if(row.empty()){
+            return;
+        }
+        // parse every integer first so a bad row leaves no partial values behind
+        RowValues.resize(Columns.size());
+        for(std::size_t Index = 0; Index < Columns.size(); Index++){
+            const SColumn &Column = Columns[Index];
+            if(Column.Position >= row.size()){
+                ErrorCount++;
+                return;
+            }
+            if(Column.Type == EType::UInt && !ParseUInt(row[Column.Position], RowValues[Index])){
+                ErrorCount++;
+                return;
+            }
+        }
+        for(std::size_t Index = 0; Index < Columns.size(); Index++){
+            SColumn &Column = Columns[Index];
+            if(Column.Type == EType::UInt){
+                Column.Values.push_back(RowValues[Index]);
+            }
+            else{
+                Column.Codes.push_back(CategoryCode(Column, row[Column.Position]));
+            }
+        }
+        RowCount++;
+    }
+
+    bool Load(){
+        if(!Reader){
+            return false;
+        }
+        std::vector<std::string_view> Row;
+        bool First = true;
+        bool Data = false;
+        while(Reader->ReadRowView(Row)){
+            Data = true;
+            if(First){
+                First = false;
+                if(ApplyHeader(Row)){
+                    HasHeader = true;
+                    continue;
+                }
+            }
+            AddRow(Row);
+        }
+        return Data;
+    }
+};
+
+const std::vector<uint64_t> CDSVColumnLoader::SImplementation::EmptyValues;
+const std::vector<uint32_t> CDSVColumnLoader::SImplementation::EmptyCodes;
+const std::vector<std::string> CDSVColumnLoader::SImplementation::EmptyCategories;
+
+CDSVColumnLoader::CDSVColumnLoader(std::shared_ptr<CDSVReader> src)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src))){
+}
+
+CDSVColumnLoader::~CDSVColumnLoader() = default;
+
+std::size_t CDSVColumnLoader::AddUIntColumn(const std::string &name, std::size_t position){
+    return DImplementation->AddColumn(name, position, SImplementation::EType::UInt);
+}
+
+std::size_t CDSVColumnLoader::AddCategoryColumn(const std::string &name, std::size_t position){
+    return DImplementation->AddColumn(name, position, SImplementation::EType::Category);
+}
+
+bool CDSVColumnLoader::Load(){
+    return DImplementation->Load();
+}
+
+std::size_t CDSVColumnLoader::RowCount() const noexcept{
+    return DImplementation->RowCount;
+}
+
+std::size_t CDSVColumnLoader::ErrorCount() const noexcept{
+    return DImplementation->ErrorCount;
+}
+
+bool CDSVColumnLoader::HasHeader() const noexcept{
+    return DImplementation->HasHeader;
+}
+
+const std::vector<uint64_t> &CDSVColumnLoader::UIntColumn(std::size_t column) const noexcept{
+    if(column < DImplementation->Columns.size()){
+        return DImplementation->Columns[column].Values;
+    }
+    return SImplementation::EmptyValues;
+}
+
+const std::vector<uint32_t> &CDSVColumnLoader::CategoryColumn(std::size_t column) const noexcept{
+    if(column < DImplementation->Columns.size()){
+        return DImplementation->Columns[column].Codes;
+    }
+    return SImplementation::EmptyCodes;
+}
+
+const std::vector<std::string> &CDSVColumnLoader::Categories(std::size_t column) const noexcept{
+    if(column < DImplementation->Columns.size()){
+        return DImplementation->Columns[column].Categories;
+    }
+    return SImplementation::EmptyCategories;
+}
@@ -1,102 +1,103 @@
 #include "DSVReader.h" // including header file for CDSVReader class usage
+#include "DSVScanner.h" // vectorized search for delimiters, quotes and line endings
+#include <algorithm> // std::max for sizing refills
 
 // implementing details of DSV Reader into struct function
 struct CDSVReader::SImplementation {
+    // number of bytes requested from the data source per refill
+    static constexpr std::size_t BlockSize = 65536;
+
     // shared pointer to datasource in order for reading
     std::shared_ptr<CDataSource> DataSource;
     // char variable used to separate values in the file
     char Delimiter;
+    // bytes read from the data source but not yet returned as rows
+    std::vector<char> Buffer;
+    // offset in Buffer where the next row starts
+    std::size_t Position = 0;
+    // block handed to DataSource->Read, reused between refills
+    std::vector<char> Block;
+
+    // cells of the row most recently scanned
+    std::vector<DSVScanner::SField> Fields;
+    // unescaped copies of the cells that aren't a single span of Buffer
+    std::string Scratch;
+    // views handed out by ReadRow before they are copied into strings
+    std::vector<std::string_view> Views;
 
     // initialize my source and delimiter before moving on any further
     SImplementation(std::shared_ptr<CDataSource> src, char delimiter)
         : DataSource(std::move(src)), Delimiter(delimiter) {}
 
-    // reading the row which is most likely a vector of strings
-    bool ReadRow(std::vector<std::string>& currentRow) {
-        // begin with an empty row
-        currentRow.clear();
-        
-        // a string to get data for each cell
-        std::string currentCell;
-        // a variable to store the character read from the data source
-        char currentChar;
-        // determines if we are inside a quoted string
-        bool isInQuotes = false;
-        // to track whether any data has been read
-        bool data = false;
-    
-        // read characters until reaching the end of the data source
-        while (!DataSource->End()) {
-            // if unable to read a charcter return false
-            if (!DataSource->Get(currentChar)) {
-                return false;
-            }
-    
-            // if a character was successfully read then we've encountered data
-            data = true;
-    
-            // having quotes for the current characters
-            if (currentChar == '"') {
-                // check for double quotes in a row
-                if (!DataSource->End()) {
-                    char nextChar;
-                    // attempt to peek at the next character from the DataSource.
-                    bool peekResult = DataSource->Peek(nextChar);
-                    if (peekResult && nextChar == '"') {
-                        // if the next character is another quote treat it as an escaped quote
-                        DataSource->Get(nextChar); // Takes the second quote
-                        currentCell += '"'; // add a single quote to the current cell
-                    } else if (isInQuotes) {
-                        // we are inside quotes and find another quote, it’s the end of the quoted section
-                        isInQuotes = false;
-                    } else {
-                        // we are starting a new quoted section
-                        isInQuotes = true;
-                    }
-                } else if (isInQuotes) {
-                    // if we are at the end of the file and inside quotes, close quote section
-                    isInQuotes = false;
-                } else {
-                    // if at the end of the file and not inside quotes, begin new quote section
-                    isInQuotes = true;
-                }
-            }
-            // if we hit a delimiter and we're not inside quotes, it marks the end of the current cell
-            else if (currentChar == Delimiter && !isInQuotes) {
-                currentRow.push_back(currentCell); // add the completed cell to the row
-                currentCell.clear(); // prepare for the next cell by clearing the cell
+    // true once the data source and the buffered bytes are both used up
+    bool End() const {
+        return Position >= Buffer.size() && DataSource->End();
+    }
+
+    // drops the rows already returned and appends up to count more bytes
+    // from the data source, returns false if the data source had nothing left
+    bool Fill(std::size_t count) {
+        if (Position) {
+            Buffer.erase(Buffer.begin(), Buffer.begin() + Position);
+            Position = 0;
+        }
+        if (!DataSource->Read(Block, count)) {
+            return false;
+        }
+        Buffer.insert(Buffer.end(), Block.begin(), Block.end());
+        return true;
+    }
+
+    // reads the next row into Fields, refilling the buffer as needed. When a
+    // row runs past the buffered bytes it is scanned again after the refill,
+    // each refill at least doubles what is buffered of the row so a long row
+    // is scanned in linear time overall
+    bool ScanNextRow() {
+        bool atEnd = DataSource->End();
+        while (true) {
+            Fields.clear();
+            Scratch.clear();
+            const char *Current = Buffer.data() + Position;
+            auto Result = DSVScanner::ScanRow(Current, Buffer.data() + Buffer.size(), Delimiter, atEnd, Fields, Scratch);
+            if (Result != DSVScanner::EScanResult::NeedMore) {
+                Position = Current - Buffer.data();
+                return Result == DSVScanner::EScanResult::Row;
             }
-            // end of the row detected (\n or \r return), unless inside quotes
-            else if ((currentChar == '\n' || currentChar == '\r') && !isInQuotes) {
-                if (!currentCell.empty() || !currentRow.empty()) {
-                    currentRow.push_back(currentCell); // Add any remaining data in the cell with this line
-                }
-    
-                // \r\n handling
-                if (currentChar == '\r' && !DataSource->End()) {
-                    char nextChar;
-                    bool peekResult = DataSource->Peek(nextChar);
-                    if (peekResult && nextChar == '\n') {
-                        // if the next character is '\n', take it in to avoid treating it as part of the next row
-                        DataSource->Get(nextChar);
-                    }
-                }
-    
-                return true; // successfully read the row and returns true
+            // the row continues past the buffered bytes, read more and rescan
+            if (!Fill(std::max(BlockSize, Buffer.size() - Position))) {
+                atEnd = true;
             }
-            // adding regular character to the current cell
-            else {
-                currentCell += currentChar;
+        }
+    }
+
+    // reads a row as views into Buffer and Scratch
+    bool ReadRowView(std::vector<std::string_view>& currentRow) {
+        currentRow.clear();
+        if (!ScanNextRow()) {
+            return false;
+        }
+        for (auto &Field : Fields) {
+            if (Field.InScratch) {
+                currentRow.emplace_back(Scratch.data() + Field.Offset, Field.Length);
+            } else {
+                currentRow.emplace_back(Field.Data, Field.Length);
             }
         }
-    
-        // any remaining data in the current cell push it into the row
-        if (!currentCell.empty() || data) {
-            currentRow.push_back(currentCell);
+        return true;
+    }
+
+    // reading the row which is most likely a vector of strings, the strings
+    // already in the row are reused so their storage isn't reallocated
+    bool ReadRow(std::vector<std::string>& currentRow) {
+        if (!ReadRowView(Views)) {
+            currentRow.clear();
+            return false;
+        }
+        currentRow.resize(Views.size());
+        for (std::size_t Index = 0; Index < Views.size(); Index++) {
+            currentRow[Index].assign(Views[Index]);
         }
-    
-        // return true if any content was read
-        return data;
+        return true;
     }
 };
 
@@ -109,10 +110,15 @@ CDSVReader::~CDSVReader() = default;
 
 // check if we've reached the end of data source
 bool CDSVReader::End() const {
-    return DImplementation->DataSource->End();
+    return DImplementation->End();
 }
 
 // read a row of data from the source
 bool CDSVReader::ReadRow(std::vector<std::string> &row) {
     return DImplementation->ReadRow(row);
-}
\ No newline at end of file
+}
+
+// read a row of data from the source without copying the cells
+bool CDSVReader::ReadRowView(std::vector<std::string_view> &row) {
+    return DImplementation->ReadRowView(row);
+}
@@ -0,0 +1,274 @@
+#include "DSVScanner.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DSVSCANNER_X86
+#endif
+
+namespace DSVScanner{
+
+namespace{
+
+const char *FindStructuralScalar(const char *begin, const char *end, char delimiter) noexcept{
+    while(begin < end){
+        char Current = *begin;
+        if(Current == delimiter || Current == '"' || Current == '\n' || Current == '\r'){
+            return begin;
+        }
+        begin++;
+    }
+    return end;
+}
+
+const char *FindQuoteScalar(const char *begin, const char *end) noexcept{
+    while(begin < end){
+        if(*begin == '"'){
+            return begin;
+        }
+        begin++;
+    }
+    return end;
+}
+
+#ifdef DSVSCANNER_X86
+
+__attribute__((target("sse2"))) const char *FindStructuralSSE2(const char *begin, const char *end, char delimiter) noexcept{
+    const __m128i Delimiter = _mm_set1_epi8(delimiter);
+    const __m128i Quote = _mm_set1_epi8('"');
+    const __m128i CarriageReturn = _mm_set1_epi8('\r');
+    const __m128i LineFeed = _mm_set1_epi8('\n');
+    while(end - begin >= 16){
+        __m128i Block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        __m128i Matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(Block, Delimiter), _mm_cmpeq_epi8(Block, Quote)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(Block, CarriageReturn), _mm_cmpeq_epi8(Block, LineFeed)));
+        unsigned Mask = _mm_movemask_epi8(Matches);
+        if(Mask){
+            return begin + __builtin_ctz(Mask);
+        }
+        begin += 16;
+    }
+    return FindStructuralScalar(begin, end, delimiter);
+}
+
+__attribute__((target("sse2"))) const char *FindQuoteSSE2(const char *begin, const char *end) noexcept{
+    const __m128i Quote = _mm_set1_epi8('"');
+    while(end - begin >= 16){
+        __m128i Block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        unsigned Mask = _mm_movemask_epi8(_mm_cmpeq_epi8(Block, Quote));
+        if(Mask){
+            return begin + __builtin_ctz(Mask);
+        }
+        begin += 16;
+    }
+    return FindQuoteScalar(begin, end);
+}
+
+__attribute__((target("avx2"))) const char *FindStructuralAVX2(const char *begin, const char *end, char delimiter) noexcept{
+    const __m256i Delimiter = _mm256_set1_epi8(delimiter);
+    const __m256i Quote = _mm256_set1_epi8('"');
+    const __m256i CarriageReturn = _mm256_set1_epi8('\r');
+    const __m256i LineFeed = _mm256_set1_epi8('\n');
+    while(end - begin >= 32){
+        __m256i Block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        __m256i Matches = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(Block, Delimiter), _mm256_cmpeq_epi8(Block, Quote)),
+                                          _mm256_or_si256(_mm256_cmpeq_epi8(Block, CarriageReturn), _mm256_cmpeq_epi8(Block, LineFeed)));
+        unsigned Mask = _mm256_movemask_epi8(Matches);
+        if(Mask){
+            return begin + __builtin_ctz(Mask);
+        }
+        begin += 32;
+    }
+    return FindStructuralSSE2(begin, end, delimiter);
+}
+
+__attribute__((target("avx2"))) const char *FindQuoteAVX2(const char *begin, const char *end) noexcept{
+    const __m256i Quote = _mm256_set1_epi8('"');
+    while(end - begin >= 32){
+        __m256i Block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        unsigned Mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(Block, Quote));
+        if(Mask){
+            return begin + __builtin_ctz(Mask);
+        }
+        begin += 32;
+    }
+    return FindQuoteSSE2(begin, end);
+}
+
+// picked once at startup from what the CPU supports
+const bool UseAVX2 = __builtin_cpu_supports("avx2");
+
+#endif
+
+}
+
+const char *FindStructural(const char *begin, const char *end, char delimiter) noexcept{
+#ifdef DSVSCANNER_X86
+    if(UseAVX2){
+        return FindStructuralAVX2(begin, end, delimiter);
+    }
+    return FindStructuralSSE2(begin, end, delimiter);
+#else
+    return FindStructuralScalar(begin, end, delimiter);
+#endif
+}
+
+const char *FindQuote(const char *begin, const char *end) noexcept{
+#ifdef DSVSCANNER_X86
+    if(UseAVX2){
+        return FindQuoteAVX2(begin, end);
+    }
+    return FindQuoteSSE2(begin, end);
+#else
+    return FindQuoteScalar(begin, end);
+#endif
+}
+
+namespace{
+
+// appends the span [begin, end) to a cell, the cell stays a span of the
+// input as long as its pieces are contiguous and is copied into scratch the
+// first time they aren't
+void AppendToField(SField &field, const char *begin, const char *end, std::string &scratch){
+    if(begin == end){
+        return;
+    }
+    if(field.Data && field.Data + field.Length == begin){
+        field.Length += end - begin;
+        return;
+    }
+    if(!field.Data && !field.InScratch){
+        field.Data = begin;
+        field.Length = end - begin;
+        return;
+    }
+    if(!field.InScratch){
+        field.Offset = scratch.size();
+        scratch.append(field.Data, field.Length);
+        field.Data = nullptr;
+        field.InScratch = true;
+    }
+    scratch.append(begin, end - begin);
+    field.Length += end - begin;
+}
+
+}
+
+EScanResult ScanRow(const char *&current, const char *end, char delimiter, bool atend, std::vector<SField> &fields, std::string &scratch){
+    const char *Current = current;
+    // nothing left at all, no row
+    if(Current == end){
+        return atend ? EScanResult::NoRow : EScanResult::NeedMore;
+    }
+    std::size_t FirstField = fields.size();
+    SField CurrentField;
+    bool InQuotes = false;
+
+    while(true){
+        // take everything up to the next character that matters in one go,
+        // inside quotes only another quote ends the span
+        const char *Next = InQuotes ? FindQuote(Current, end) : FindStructural(Current, end, delimiter);
+        AppendToField(CurrentField, Current, Next, scratch);
+        Current = Next;
+
+        if(Current == end){
+            if(!atend){
+                return EScanResult::NeedMore;
+            }
+            // at the end of the data the remaining cell is part of the row
+            fields.push_back(CurrentField);
+            current = Current;
+            return EScanResult::Row;
+        }
+
+        char CurrentChar = *Current;
+        if(CurrentChar == '"'){
+            if(Current + 1 == end && !atend){
+                // can't tell if this is an escaped quote yet
+                return EScanResult::NeedMore;
+            }
+            if(Current + 1 != end && Current[1] == '"'){
+                // two quotes in a row are an escaped quote, keep the first one
+                AppendToField(CurrentField, Current, Current + 1, scratch);
+                Current += 2;
+            }
+            else{
+                // otherwise a quote opens or closes a quoted section
+                InQuotes = !InQuotes;
+                Current++;
+            }
+        }
+        else if(CurrentChar == delimiter){
+            fields.push_back(CurrentField);
+            CurrentField = SField();
+            Current++;
+        }
+        else{
+            // end of the row, \n, \r or \r\n
+            if(CurrentChar == '\r' && Current + 1 == end && !atend){
+                // can't tell if this is a \r\n yet
+                return EScanResult::NeedMore;
+            }
+            if(CurrentField.Length || fields.size() != FirstField){
+                fields.push_back(CurrentField);
+            }
+            Current++;
+            if(CurrentChar == '\r' && Current != end && *Current == '\n'){
+                Current++;
+            }
+            current = Current;
+            return EScanResult::Row;
+        }
+    }
+}
+
+bool QuoteParity(const char *begin, const char *end) noexcept{
+    bool Parity = false;
+    const char *Current = FindQuote(begin, end);
+    while(Current != end){
+        const char *RunEnd = Current;
+        while(RunEnd != end && *RunEnd == '"'){
+            RunEnd++;
+        }
+        if((RunEnd - Current) & 1){
+            Parity = !Parity;
+        }
+        Current = FindQuote(RunEnd, end);
+    }
+    return Parity;
+}
+
+const char *NextRowStart(const char *begin, const char *position, const char *end, char delimiter, bool inquotes) noexcept{
+    const char *Current = position;
+    // a line ending outside of quotes just before position means a row starts here
+    if(Current == begin || (!inquotes && (Current[-1] == '\n' || Current[-1] == '\r'))){
+        return Current;
+    }
+    while(true){
+        Current = inquotes ? FindQuote(Current, end) : FindStructural(Current, end, delimiter);
+        if(Current == end){
+            return end;
+        }
+        char CurrentChar = *Current;
+        if(CurrentChar == '"'){
+            if(Current + 1 != end && Current[1] == '"'){
+                Current += 2;
+            }
+            else{
+                inquotes = !inquotes;
+                Current++;
+            }
+        }
+        else if(CurrentChar == delimiter){
+            Current++;
+        }
+        else{
+            Current++;
+            if(CurrentChar == '\r' && Current != end && *Current == '\n'){
+                Current++;
+            }
+            return Current;
+        }
+    }
+}
+
+}
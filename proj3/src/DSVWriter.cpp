@@ -10,47 +10,51 @@ struct CDSVWriter::SImplementation {
     // determine if all values should be quoted, regardless of content
     bool QuoteAll;
 
+    // the row being formatted, handed to the sink with one Write per row
+    std::string Row;
+
     // initialize the data sink, delimiter, and quote-all option
     SImplementation(std::shared_ptr<CDataSink> sink, char delimiter, bool quoteall)
         : Sink(sink), Delimiter(delimiter), QuoteAll(quoteall) {}
     
     // writes a row of data to the sink, ensuring proper DSV formatting
     bool WriteRow(const std::vector<std::string>& row) {
+        Row.clear();
         // iterate through each cell in the row
         for (size_t i = 0; i < row.size(); ++i) {
+            const std::string &cell = row[i];
             // to determine if the cell needs to be enclosed in quotes
             // a cell needs quotes if: QuoteAll is true, the cell contains the delimiter, the cell contains quotes
-            bool quotes = QuoteAll || row[i].find(Delimiter) != std::string::npos || row[i].find('"') != std::string::npos;
+            bool quotes = QuoteAll || cell.find(Delimiter) != std::string::npos || cell.find('"') != std::string::npos;
 
             // create an if statement here if a cell needs quotes
             if (quotes) {
                 // start the quoted cell by writing an opening quote
-                Sink->Put('"');
-                // write each character of the cell with a for loop
-                for (char ch : row[i]) {
-                    // check if the character is a quote and escape it
-                    if (ch == '"') {
-                        Sink->Put('"'); // escape quotes by writing two quotes
-                    }
-                    Sink->Put(ch);
+                Row.push_back('"');
+                // copy the runs between quotes whole, escaping each quote by doubling it
+                size_t start = 0;
+                size_t quote;
+                while ((quote = cell.find('"', start)) != std::string::npos) {
+                    Row.append(cell, start, quote + 1 - start);
+                    Row.push_back('"');
+                    start = quote + 1;
                 }
+                Row.append(cell, start, std::string::npos);
                 // close the quoted cell with a quote
-                Sink->Put('"');
+                Row.push_back('"');
             } else {
                 // if the cell doesn't need quotes, write it directly
-                // use a for loop to iterate through the characters
-                for (const char& ch : row[i]) {
-                    Sink->Put(ch);
-                }
+                Row.append(cell);
             }
 
             // if this is not the last cell, write the delimiter to separate the cells
             if (i < row.size() - 1) {
-                Sink->Put(Delimiter);
+                Row.push_back(Delimiter);
             }
         }
         // write a newline to indicate the end of the row
-        return Sink->Put('\n');
+        Row.push_back('\n');
+        return Sink->Write(Row.data(), Row.size());
     }
 };
 
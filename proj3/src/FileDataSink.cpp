@@ -0,0 +1,128 @@
+#include "FileDataSink.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CFileDataSink::CFileDataSink(const std::string &filename, EFlushPolicy policy, std::size_t buffersize) : DPolicy(policy), DBufferSize(buffersize ? buffersize : 1), DFailed(false){
+    DFileDescriptor = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(DFileDescriptor < 0){
+        DFailed = true;
+    }
+    if(DPolicy != EFlushPolicy::EveryWrite){
+        DBuffer.reserve(DBufferSize);
+    }
+}
+
+CFileDataSink::~CFileDataSink(){
+    Flush();
+    if(DFileDescriptor >= 0){
+        close(DFileDescriptor);
+    }
+}
+
+bool CFileDataSink::IsOpen() const noexcept{
+    return DFileDescriptor >= 0;
+}
+
+// writes the whole span, retrying short writes and interrupted calls
+bool CFileDataSink::WriteFile(const char *buf, std::size_t count) noexcept{
+    if(DFailed){
+        return false;
+    }
+    while(count){
+        ssize_t Written = write(DFileDescriptor, buf, count);
+        if(Written < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            DFailed = true;
+            return false;
+        }
+        buf += Written;
+        count -= Written;
+    }
+    if(DPolicy == EFlushPolicy::Sync && fsync(DFileDescriptor) != 0){
+        DFailed = true;
+    }
+    return !DFailed;
+}
+
+bool CFileDataSink::Flush() noexcept{
+    if(!DBuffer.empty()){
+        WriteFile(DBuffer.data(), DBuffer.size());
+        DBuffer.clear();
+    }
+    return !DFailed;
+}
+
+bool CFileDataSink::Put(const char &ch) noexcept{
+    return Write(&ch, 1);
+}
+
+bool CFileDataSink::Write(const std::vector<char> &buf) noexcept{
+    return Write(buf.data(), buf.size());
+}
+
+bool CFileDataSink::Write(const char *buf, std::size_t count) noexcept{
+    if(DFailed){
+        return false;
+    }
+    if(DPolicy == EFlushPolicy::EveryWrite){
+        return WriteFile(buf, count);
+    }
+    if(DBuffer.size() + count > DBufferSize){
+        if(!Flush()){
+            return false;
+        }
+        // spans at least a buffer long go straight to the file
+        if(count >= DBufferSize){
+            return WriteFile(buf, count);
+        }
+    }
+    DBuffer.insert(DBuffer.end(), buf, buf + count);
+    return true;
+}
+
+// fsyncs the directory holding filename so a rename in it is on disk too
+static bool SyncDirectory(const std::string &filename) noexcept{
+    std::size_t Slash = filename.rfind('/');
+    std::string Directory = Slash == std::string::npos ? "." : Slash == 0 ? "/" : filename.substr(0, Slash);
+    int FileDescriptor = open(Directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(FileDescriptor < 0){
+        return false;
+    }
+    bool Synced = fsync(FileDescriptor) == 0;
+    return close(FileDescriptor) == 0 && Synced;
+}
+
+// the temporary file is made with mkstemp next to filename, so concurrent
+// saves each write their own file and the last rename wins. Its descriptor
+// stays open past the sink so the data can be fsynced and the close checked
+// before the rename makes it visible
+bool CFileDataSink::ReplaceFile(const std::string &filename, const std::vector< std::string_view > &pieces){
+    std::string TemporaryName = filename + ".XXXXXX";
+    int FileDescriptor = mkstemp(TemporaryName.data());
+    if(FileDescriptor < 0){
+        return false;
+    }
+    // mkstemp creates the file readable by its owner only, give it the mode a new sink file gets
+    bool Written = fchmod(FileDescriptor, 0644) == 0;
+    {
+        CFileDataSink Sink(TemporaryName, EFlushPolicy::WhenFull, 1 << 20);
+        Written = Written && Sink.IsOpen();
+        for(auto Piece : pieces){
+            Written = Written && Sink.Write(Piece.data(), Piece.size());
+        }
+        Written = Written && Sink.Flush();
+    }
+    Written = fsync(FileDescriptor) == 0 && Written;
+    Written = close(FileDescriptor) == 0 && Written;
+    if(!Written || std::rename(TemporaryName.c_str(), filename.c_str())){
+        std::remove(TemporaryName.c_str());
+        return false;
+    }
+    return SyncDirectory(filename);
+}
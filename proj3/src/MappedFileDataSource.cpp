@@ -0,0 +1,92 @@
+#include "MappedFileDataSource.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CMappedFileDataSource::CMappedFileDataSource(const std::string &filename, EAccessPattern pattern) : DData(nullptr), DSize(0), DIndex(0), DOpen(false){
+    int FileDescriptor = open(filename.c_str(), O_RDONLY);
+    if(FileDescriptor < 0){
+        return;
+    }
+    struct stat FileStat;
+    if(fstat(FileDescriptor, &FileStat) == 0){
+        DOpen = true;
+        if(FileStat.st_size > 0){
+            void *Mapping = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_SHARED, FileDescriptor, 0);
+            if(Mapping != MAP_FAILED){
+                DData = static_cast<const char *>(Mapping);
+                DSize = FileStat.st_size;
+                if(pattern == EAccessPattern::Sequential){
+                    madvise(Mapping, DSize, MADV_SEQUENTIAL);
+                    madvise(Mapping, DSize, MADV_WILLNEED);
+                }
+                else if(pattern == EAccessPattern::Random){
+                    madvise(Mapping, DSize, MADV_RANDOM);
+                }
+            }
+            else{
+                DOpen = false;
+            }
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(FileDescriptor);
+}
+
+CMappedFileDataSource::~CMappedFileDataSource(){
+    if(DData){
+        munmap(const_cast<char *>(DData), DSize);
+    }
+}
+
+bool CMappedFileDataSource::IsOpen() const noexcept{
+    return DOpen;
+}
+
+const char *CMappedFileDataSource::Data() const noexcept{
+    return DData;
+}
+
+std::size_t CMappedFileDataSource::Size() const noexcept{
+    return DSize;
+}
+
+std::size_t CMappedFileDataSource::Position() const noexcept{
+    return DIndex;
+}
+
+bool CMappedFileDataSource::End() const noexcept{
+    return DIndex >= DSize;
+}
+
+bool CMappedFileDataSource::Get(char &ch) noexcept{
+    if(DIndex < DSize){
+        ch = DData[DIndex];
+        DIndex++;
+        return true;
+    }
+    return false;
+}
+
+bool CMappedFileDataSource::Peek(char &ch) noexcept{
+    if(DIndex < DSize){
+        ch = DData[DIndex];
+        return true;
+    }
+    return false;
+}
+
+bool CMappedFileDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    std::size_t Remaining = DSize - DIndex;
+    if(count > Remaining){
+        count = Remaining;
+    }
+    buf.resize(count);
+    if(count){
+        std::memcpy(buf.data(), DData + DIndex, count);
+        DIndex += count;
+    }
+    return !buf.empty();
+}
@@ -0,0 +1,578 @@
+#include "OSMXMLScanner.h"
+#include "MappedFileDataSource.h"
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// first position in [current, end) holding ch, end if there isn't one
+inline const char *FindChar(const char *current, const char *end, char ch){
+#if defined(__SSE2__)
+    const __m128i Target = _mm_set1_epi8(ch);
+    while(end - current >= 16){
+        __m128i Block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+        int Mask = _mm_movemask_epi8(_mm_cmpeq_epi8(Block, Target));
+        if(Mask){
+            return current + __builtin_ctz(Mask);
+        }
+        current += 16;
+    }
+#endif
+    while(current < end && *current != ch){
+        current++;
+    }
+    return current;
+}
+
+// first position in [current, end) that ends a quoted attribute value or
+// means it has to be decoded: the quote, '&', '<' or a control character
+inline const char *FindValueEnd(const char *current, const char *end, char quote){
+#if defined(__SSE2__)
+    const __m128i Quote = _mm_set1_epi8(quote);
+    const __m128i Ampersand = _mm_set1_epi8('&');
+    const __m128i Less = _mm_set1_epi8('<');
+    const __m128i Control = _mm_set1_epi8(0x1F);
+    while(end - current >= 16){
+        __m128i Block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+        __m128i Found = _mm_or_si128(_mm_cmpeq_epi8(Block, Quote), _mm_cmpeq_epi8(Block, Ampersand));
+        Found = _mm_or_si128(Found, _mm_cmpeq_epi8(Block, Less));
+        // unsigned bytes up to 0x1F are the ones min leaves unchanged
+        Found = _mm_or_si128(Found, _mm_cmpeq_epi8(_mm_min_epu8(Block, Control), Block));
+        int Mask = _mm_movemask_epi8(Found);
+        if(Mask){
+            return current + __builtin_ctz(Mask);
+        }
+        current += 16;
+    }
+#endif
+    while(current < end){
+        unsigned char Ch = *current;
+        if(Ch == quote || Ch == '&' || Ch == '<' || Ch < 0x20){
+            break;
+        }
+        current++;
+    }
+    return current;
+}
+
+inline bool IsSpace(char ch){
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+inline bool IsDigit(char ch){
+    return unsigned(ch - '0') < 10;
+}
+
+// reads an ID like std::from_chars does, 0 if the text doesn't start with one
+uint64_t ParseID(std::string_view text){
+    uint64_t Value = 0;
+    std::size_t Index = 0;
+    // 19 digits always fit, anything longer may not
+    while(Index < text.size() && Index < 19 && IsDigit(text[Index])){
+        Value = Value * 10 + (text[Index] - '0');
+        Index++;
+    }
+    if(Index == 19 && Index < text.size() && IsDigit(text[Index])){
+        Value = 0;
+        std::from_chars(text.data(), text.data() + text.size(), Value);
+    }
+    return Value;
+}
+
+// reads a latitude or longitude like std::from_chars does, 0 if the text
+// doesn't start with a number. Plain decimals with at most 19 digits whose
+// digits fit exactly in a double are divided by an exact power of ten, one
+// correctly rounded operation, so they come out the same as from_chars
+double ParseCoordinate(std::string_view text){
+    static const double Powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char *Current = text.data();
+    const char *End = Current + text.size();
+    bool Negative = Current < End && *Current == '-';
+    Current += Negative ? 1 : 0;
+    uint64_t Mantissa = 0;
+    int Digits = 0, Fraction = 0;
+    while(Current < End && IsDigit(*Current)){
+        Mantissa = Mantissa * 10 + (*Current++ - '0');
+        Digits++;
+    }
+    if(Current < End && *Current == '.'){
+        Current++;
+        while(Current < End && IsDigit(*Current)){
+            Mantissa = Mantissa * 10 + (*Current++ - '0');
+            Digits++;
+            Fraction++;
+        }
+    }
+    // exponents, long numbers and anything odd are left to from_chars
+    bool Exponent = Current < End && (*Current == 'e' || *Current == 'E');
+    if(Digits && Digits <= 19 && Fraction <= 22 && Mantissa <= (uint64_t(1) << 53) && !Exponent){
+        double Value = double(Mantissa) / Powers[Fraction];
+        return Negative ? -Value : Value;
+    }
+    double Value = 0.0;
+    std::from_chars(text.data(), text.data() + text.size(), Value);
+    return Value;
+}
+
+// appends code point as UTF-8, false if XML doesn't allow it
+bool AppendCodePoint(std::string &str, uint32_t code){
+    bool Allowed = code == 0x9 || code == 0xA || code == 0xD || (code >= 0x20 && code <= 0xD7FF) || (code >= 0xE000 && code <= 0xFFFD) || (code >= 0x10000 && code <= 0x10FFFF);
+    if(!Allowed){
+        return false;
+    }
+    if(code < 0x80){
+        str.push_back(char(code));
+    }
+    else if(code < 0x800){
+        str.push_back(char(0xC0 | (code >> 6)));
+        str.push_back(char(0x80 | (code & 0x3F)));
+    }
+    else if(code < 0x10000){
+        str.push_back(char(0xE0 | (code >> 12)));
+        str.push_back(char(0x80 | ((code >> 6) & 0x3F)));
+        str.push_back(char(0x80 | (code & 0x3F)));
+    }
+    else{
+        str.push_back(char(0xF0 | (code >> 18)));
+        str.push_back(char(0x80 | ((code >> 12) & 0x3F)));
+        str.push_back(char(0x80 | ((code >> 6) & 0x3F)));
+        str.push_back(char(0x80 | (code & 0x3F)));
+    }
+    return true;
+}
+
+}
+
+struct COSMXMLScanner::SImplementation{
+    enum class EElement{Other, Node, Way, Nd, Tag};
+
+    // an attribute of the element being scanned. Values that had to be
+    // decoded live in Decoded and are only turned into views once the whole
+    // tag is read, as Decoded may move while it grows
+    struct SAttribute{
+        std::string_view Name;
+        std::string_view Value;
+        std::size_t DecodedOffset;
+        std::size_t DecodedLength;
+    };
+
+    static constexpr std::size_t NotDecoded = std::size_t(-1);
+
+    std::shared_ptr<CDataSource> DataSource;
+    // the document when the source isn't memory mapped, shared with the
+    // parts the scanner is split into
+    std::shared_ptr<std::vector<char>> Buffer;
+    const char *Current = nullptr;
+    const char *End = nullptr;
+    std::vector<SAttribute> Attributes;
+    std::string Decoded;
+
+    SImplementation(std::shared_ptr<CDataSource> src) : DataSource(src){
+        auto Mapped = std::dynamic_pointer_cast<CMappedFileDataSource>(src);
+        if(Mapped){
+            Current = Mapped->Data() + Mapped->Position();
+            End = Mapped->Data() + Mapped->Size();
+            return;
+        }
+        Buffer = std::make_shared<std::vector<char>>();
+        std::vector<char> Chunk;
+        while(src->Read(Chunk, 65536)){
+            Buffer->insert(Buffer->end(), Chunk.begin(), Chunk.end());
+        }
+        Current = Buffer->data();
+        End = Current + Buffer->size();
+    }
+
+    // a part of whole's input, keeping it alive
+    SImplementation(const SImplementation &whole, const char *begin, const char *end)
+        : DataSource(whole.DataSource), Buffer(whole.Buffer), Current(begin), End(end){
+    }
+
+    bool Fail(){
+        Current = End;
+        return false;
+    }
+
+    void SkipSpaces(){
+        while(Current < End && IsSpace(*Current)){
+            Current++;
+        }
+    }
+
+    // an element or attribute name, empty if there isn't one
+    std::string_view ReadName(){
+        const char *Begin = Current;
+        while(Current < End && !IsSpace(*Current) && *Current != '=' && *Current != '/' && *Current != '>' && *Current != '<'){
+            Current++;
+        }
+        return std::string_view(Begin, Current - Begin);
+    }
+
+    static EElement Classify(std::string_view name){
+        if(name == "node"){
+            return EElement::Node;
+        }
+        if(name == "way"){
+            return EElement::Way;
+        }
+        if(name == "nd"){
+            return EElement::Nd;
+        }
+        if(name == "tag"){
+            return EElement::Tag;
+        }
+        return EElement::Other;
+    }
+
+    bool SkipPast(std::string_view terminator){
+        auto Position = std::string_view(Current, End - Current).find(terminator);
+        if(Position == std::string_view::npos){
+            return Fail();
+        }
+        Current += Position + terminator.size();
+        return true;
+    }
+
+    // skips a comment, CDATA section or declaration, Current is on the '!'
+    bool SkipMarkup(){
+        std::string_view Rest(Current, End - Current);
+        if(Rest.substr(0, 3) == "!--"){
+            Current += 3;
+            return SkipPast("-->");
+        }
+        if(Rest.substr(0, 8) == "![CDATA["){
+            Current += 8;
+            return SkipPast("]]>");
+        }
+        // a DOCTYPE may have an internal subset in brackets
+        int Depth = 0;
+        for(; Current < End; Current++){
+            if(*Current == '['){
+                Depth++;
+            }
+            else if(*Current == ']'){
+                Depth--;
+            }
+            else if(*Current == '>' && Depth <= 0){
+                Current++;
+                return true;
+            }
+        }
+        return Fail();
+    }
+
+    // decodes a character or entity reference, Current is on the '&'
+    bool DecodeReference(){
+        // references are short, a long run without a ';' is an error
+        const char *Limit = End - Current > 32 ? Current + 32 : End;
+        const char *Semicolon = FindChar(Current, Limit, ';');
+        if(Semicolon == Limit){
+            return false;
+        }
+        std::string_view Reference(Current + 1, Semicolon - Current - 1);
+        Current = Semicolon + 1;
+        if(Reference == "amp"){
+            Decoded.push_back('&');
+        }
+        else if(Reference == "lt"){
+            Decoded.push_back('<');
+        }
+        else if(Reference == "gt"){
+            Decoded.push_back('>');
+        }
+        else if(Reference == "quot"){
+            Decoded.push_back('"');
+        }
+        else if(Reference == "apos"){
+            Decoded.push_back('\'');
+        }
+        else if(Reference.size() > 1 && Reference[0] == '#'){
+            bool Hex = Reference[1] == 'x';
+            const char *Begin = Reference.data() + (Hex ? 2 : 1);
+            const char *Finish = Reference.data() + Reference.size();
+            uint32_t Code = 0;
+            auto Result = std::from_chars(Begin, Finish, Code, Hex ? 16 : 10);
+            if(Begin == Finish || Result.ec != std::errc() || Result.ptr != Finish){
+                return false;
+            }
+            return AppendCodePoint(Decoded, Code);
+        }
+        else{
+            return false;
+        }
+        return true;
+    }
+
+    // decodes the rest of an attribute value that needs it, Current is on
+    // the first character that has to be decoded. References are replaced
+    // and literal whitespace becomes a space, as the XML spec asks for
+    bool DecodeValue(SAttribute &attribute, const char *begin, char quote){
+        attribute.DecodedOffset = Decoded.size();
+        Decoded.append(begin, Current - begin);
+        while(true){
+            const char *Next = FindValueEnd(Current, End, quote);
+            Decoded.append(Current, Next - Current);
+            Current = Next;
+            if(Current == End){
+                return false;
+            }
+            char Ch = *Current;
+            if(Ch == quote){
+                Current++;
+                break;
+            }
+            if(Ch == '&'){
+                if(!DecodeReference()){
+                    return false;
+                }
+                continue;
+            }
+            if(Ch == '\t' || Ch == '\n' || Ch == '\r'){
+                Current++;
+                // a CR LF line end is one space
+                if(Ch == '\r' && Current < End && *Current == '\n'){
+                    Current++;
+                }
+                Decoded.push_back(' ');
+                continue;
+            }
+            // '<' or another control character
+            return false;
+        }
+        attribute.DecodedLength = Decoded.size() - attribute.DecodedOffset;
+        return true;
+    }
+
+    // reads an end tag and passes it on, Current is on the '/'
+    bool EndTag(COSMXMLVisitor &visitor){
+        Current++;
+        EElement Element = Classify(ReadName());
+        SkipSpaces();
+        if(Current == End || *Current != '>'){
+            return Fail();
+        }
+        Current++;
+        if(Element == EElement::Node){
+            visitor.EndNode();
+        }
+        else if(Element == EElement::Way){
+            visitor.EndWay();
+        }
+        return true;
+    }
+
+    // reads a start or empty element tag and passes it on, Current is on
+    // the first character of the name
+    bool StartTag(COSMXMLVisitor &visitor){
+        auto Name = ReadName();
+        if(Name.empty()){
+            return Fail();
+        }
+        EElement Element = Classify(Name);
+        Attributes.clear();
+        Decoded.clear();
+        bool Empty = false;
+        while(true){
+            SkipSpaces();
+            if(Current == End){
+                return Fail();
+            }
+            if(*Current == '>'){
+                Current++;
+                break;
+            }
+            if(*Current == '/'){
+                if(End - Current < 2 || Current[1] != '>'){
+                    return Fail();
+                }
+                Current += 2;
+                Empty = true;
+                break;
+            }
+            SAttribute Attribute{ReadName(), std::string_view(), NotDecoded, 0};
+            SkipSpaces();
+            if(Attribute.Name.empty() || Current == End || *Current != '='){
+                return Fail();
+            }
+            Current++;
+            SkipSpaces();
+            if(Current == End || (*Current != '"' && *Current != '\'')){
+                return Fail();
+            }
+            char Quote = *Current++;
+            const char *Begin = Current;
+            Current = FindValueEnd(Current, End, Quote);
+            if(Current < End && *Current == Quote){
+                Attribute.Value = std::string_view(Begin, Current - Begin);
+                Current++;
+            }
+            else if(!DecodeValue(Attribute, Begin, Quote)){
+                return Fail();
+            }
+            if(Element != EElement::Other){
+                Attributes.push_back(Attribute);
+            }
+        }
+        for(auto &Attribute : Attributes){
+            if(Attribute.DecodedOffset != NotDecoded){
+                Attribute.Value = std::string_view(Decoded.data() + Attribute.DecodedOffset, Attribute.DecodedLength);
+            }
+        }
+        switch(Element){
+            case EElement::Node:{
+                uint64_t ID = 0;
+                double Latitude = 0.0, Longitude = 0.0;
+                for(auto &Attribute : Attributes){
+                    if(Attribute.Name == "id"){
+                        ID = ParseID(Attribute.Value);
+                    }
+                    else if(Attribute.Name == "lat"){
+                        Latitude = ParseCoordinate(Attribute.Value);
+                    }
+                    else if(Attribute.Name == "lon"){
+                        Longitude = ParseCoordinate(Attribute.Value);
+                    }
+                }
+                visitor.BeginNode(ID, Latitude, Longitude);
+                for(auto &Attribute : Attributes){
+                    if(Attribute.Name != "id" && Attribute.Name != "lat" && Attribute.Name != "lon"){
+                        visitor.Tag(Attribute.Name, Attribute.Value);
+                    }
+                }
+                if(Empty){
+                    visitor.EndNode();
+                }
+                break;
+            }
+            case EElement::Way:{
+                uint64_t ID = 0;
+                for(auto &Attribute : Attributes){
+                    if(Attribute.Name == "id"){
+                        ID = ParseID(Attribute.Value);
+                    }
+                }
+                visitor.BeginWay(ID);
+                for(auto &Attribute : Attributes){
+                    if(Attribute.Name != "id"){
+                        visitor.Tag(Attribute.Name, Attribute.Value);
+                    }
+                }
+                if(Empty){
+                    visitor.EndWay();
+                }
+                break;
+            }
+            case EElement::Nd:
+                for(auto &Attribute : Attributes){
+                    if(Attribute.Name == "ref"){
+                        visitor.WayNode(ParseID(Attribute.Value));
+                    }
+                }
+                break;
+            case EElement::Tag:{
+                std::string_view Key, Value;
+                for(auto &Attribute : Attributes){
+                    if(Attribute.Name == "k"){
+                        Key = Attribute.Value;
+                    }
+                    else if(Attribute.Name == "v"){
+                        Value = Attribute.Value;
+                    }
+                }
+                if(!Key.empty()){
+                    visitor.Tag(Key, Value);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        return true;
+    }
+
+    // the first node or way start tag at or after position, End if there
+    // isn't one
+    const char *NextElementStart(const char *position) const{
+        while((position = FindChar(position, End, '<')) != End){
+            std::string_view Rest(position + 1, End - position - 1);
+            std::size_t Length = Rest.substr(0, 4) == "node" ? 4 : Rest.substr(0, 3) == "way" ? 3 : 0;
+            if(Length && Length < Rest.size() && (IsSpace(Rest[Length]) || Rest[Length] == '>' || Rest[Length] == '/')){
+                return position;
+            }
+            position++;
+        }
+        return End;
+    }
+
+    bool Scan(COSMXMLVisitor &visitor){
+        while(true){
+            Current = FindChar(Current, End, '<');
+            if(Current == End){
+                return true;
+            }
+            Current++;
+            if(Current == End){
+                return Fail();
+            }
+            bool Success;
+            switch(*Current){
+                case '/': Success = EndTag(visitor); break;
+                case '?': Success = SkipPast("?>"); break;
+                case '!': Success = SkipMarkup(); break;
+                default: Success = StartTag(visitor); break;
+            }
+            if(!Success){
+                return false;
+            }
+        }
+    }
+};
+
+COSMXMLScanner::COSMXMLScanner(std::shared_ptr< CDataSource > src){
+    DImplementation = std::make_unique<SImplementation>(src);
+}
+
+COSMXMLScanner::COSMXMLScanner(std::unique_ptr<SImplementation> implementation) : DImplementation(std::move(implementation)){
+}
+
+COSMXMLScanner::~COSMXMLScanner() = default;
+
+bool COSMXMLScanner::End() const{
+    return DImplementation->Current == DImplementation->End;
+}
+
+bool COSMXMLScanner::Scan(COSMXMLVisitor &visitor){
+    return DImplementation->Scan(visitor);
+}
+
+void COSMXMLScanner::Skip(){
+    DImplementation->Current = DImplementation->End;
+}
+
+// the parts are cut at about equal sizes, moved forward to the next node or
+// way. A node or way start drops any unfinished element before it, so the
+// parts don't depend on each other
+std::vector< std::shared_ptr< COSMXMLScanner > > COSMXMLScanner::Split(std::size_t count) const{
+    const SImplementation &Whole = *DImplementation;
+    std::vector< std::shared_ptr< COSMXMLScanner > > Parts;
+    std::size_t Size = Whole.End - Whole.Current;
+    const char *PartBegin = Whole.Current;
+    for(std::size_t Index = 1; Index < count && PartBegin < Whole.End; Index++){
+        const char *Boundary = Whole.NextElementStart(std::max(Whole.Current + Size / count * Index, PartBegin + 1));
+        if(Boundary == Whole.End){
+            break;
+        }
+        Parts.push_back(std::shared_ptr<COSMXMLScanner>(new COSMXMLScanner(std::make_unique<SImplementation>(Whole, PartBegin, Boundary))));
+        PartBegin = Boundary;
+    }
+    Parts.push_back(std::shared_ptr<COSMXMLScanner>(new COSMXMLScanner(std::make_unique<SImplementation>(Whole, PartBegin, Whole.End))));
+    return Parts;
+}
@@ -1,271 +1,648 @@
 #include "OpenStreetMap.h" // header file for COpenStreetMap class
 #include "XMLReader.h" // geader file for XML parsing functionality
+#include "StringPool.h" // interned tag keys and values
 #include <memory> // for smart pointers like std::shared_ptr and std::unique_ptr
 #include <vector>// for storing nodes and ways in dynamic arrays
 #include <string>// for handling string attributes 
-#include <unordered_map> //for storing and searching attributes
+#include <string_view> //for looking up interned strings without copying them
+#include <algorithm> //for std::is_sorted, std::stable_sort and std::lower_bound used by the ID index
+#include <charconv> //for std::from_chars to read numbers straight out of attribute views
+#include <thread> //for loading the parts of a split scanner at the same time
+
+namespace {
+
+//reads an ID, 0 if the text doesn't start with one
+uint64_t ParseID(std::string_view text) {
+    uint64_t value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+//reads a latitude or longitude, 0 if the text doesn't start with a number
+double ParseCoordinate(std::string_view text) {
+    double value = 0.0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+}
 
 
 // defining simplementation structure first using COpenStreetMap
 struct COpenStreetMap::SImplementation {
-    // Forward declarations of implementation classes
-    class SNodeImpl;
-    class SWayImpl;
-   //storing ways and nodes here
-    std::vector<std::shared_ptr<SNodeImpl>> Nodes;
-    std::vector<std::shared_ptr<SWayImpl>> Ways;
+    //a key/value pair of interned strings
+    struct STag {
+        uint32_t Key;
+        uint32_t Value;
+    };
+
+    //everything loaded from the map, stored as parallel arrays indexed by the
+    //node or way index. Tags and way node lists are CSR tables, element i owns
+    //the entries from Offsets[i] up to Offsets[i + 1]. The views handed out
+    //share ownership so they stay valid after the map is gone
+    struct SMapData {
+        std::vector<TNodeID> NodeIDs;
+        std::vector<double> NodeLatitudes;
+        std::vector<double> NodeLongitudes;
+        std::vector<std::size_t> NodeTagOffsets{0};
+        std::vector<STag> NodeTags;
+
+        std::vector<TWayID> WayIDs;
+        std::vector<std::size_t> WayNodeOffsets{0};
+        std::vector<TNodeID> WayNodeIDs;
+        std::vector<std::size_t> WayTagOffsets{0};
+        std::vector<STag> WayTags;
+
+        CStringPool Strings;
+
+        //looks up a key among tags [begin, end), returns end if it isn't there
+        std::size_t FindTag(const std::vector<STag> &tags, std::size_t begin, std::size_t end, const std::string &key) const noexcept {
+            for (std::size_t i = begin; i < end; i++) {
+                if (Strings.String(tags[i].Key) == key) {
+                    return i;
+                }
+            }
+            return end;
+        }
+    };
+
+    //lightweight node handed out on demand, reads straight from the arrays
+    class SNodeView;
+    //lightweight way handed out on demand, reads straight from the arrays
+    class SWayView;
+    //fills the map from the XML reader's callbacks
+    class SXMLLoader;
+    //fills the map from the OSM XML scanner's callbacks
+    class SScanLoader;
+
+    std::shared_ptr<SMapData> Data = std::make_shared<SMapData>();
+    //false if the source turned out to be malformed, the map then only has
+    //what was read before the error
+    bool Valid = true;
+    //indices sorted by ID, left empty when the IDs were already ascending
+    //(the usual case for OSM extracts) so the ID arrays are searched directly
+    std::vector<std::size_t> NodeIDOrder;
+    std::vector<std::size_t> WayIDOrder;
+    //the node or way being read, it is only kept once its end tag is seen
+    bool PendingNode = false;
+    bool PendingWay = false;
+
+    //starts a new node, dropping any node or way that was never finished
+    void BeginNode(TNodeID id, double latitude, double longitude) {
+        DropPending();
+        Data->NodeIDs.push_back(id);
+        Data->NodeLatitudes.push_back(latitude);
+        Data->NodeLongitudes.push_back(longitude);
+        Data->NodeTagOffsets.push_back(Data->NodeTags.size());
+        PendingNode = true;
+    }
+
+    //starts a new way, dropping any node or way that was never finished
+    void BeginWay(TWayID id) {
+        DropPending();
+        Data->WayIDs.push_back(id);
+        Data->WayNodeOffsets.push_back(Data->WayNodeIDs.size());
+        Data->WayTagOffsets.push_back(Data->WayTags.size());
+        PendingWay = true;
+    }
+
+    //adds a node reference to the way being read
+    void AddWayNode(TNodeID id) {
+        if (PendingWay) {
+            Data->WayNodeIDs.push_back(id);
+            Data->WayNodeOffsets.back() = Data->WayNodeIDs.size();
+        }
+    }
+
+    //adds a tag to the node or way being read, a repeated key keeps its
+    //first position but takes the new value
+    void AddTag(std::string_view key, std::string_view value) {
+        std::vector<STag> *tags = nullptr;
+        std::vector<std::size_t> *offsets = nullptr;
+        if (PendingNode) {
+            tags = &Data->NodeTags;
+            offsets = &Data->NodeTagOffsets;
+        } else if (PendingWay) {
+            tags = &Data->WayTags;
+            offsets = &Data->WayTagOffsets;
+        } else {
+            return;
+        }
+        STag tag{Data->Strings.Intern(key), Data->Strings.Intern(value)};
+        for (std::size_t i = (*offsets)[offsets->size() - 2]; i < tags->size(); i++) {
+            if ((*tags)[i].Key == tag.Key) {
+                (*tags)[i].Value = tag.Value;
+                return;
+            }
+        }
+        tags->push_back(tag);
+        offsets->back() = tags->size();
+    }
+
+    //keeps the node or way being read
+    void EndNode() {
+        PendingNode = false;
+    }
+
+    void EndWay() {
+        PendingWay = false;
+    }
+
+    //removes a node or way whose end tag never came
+    void DropPending() {
+        if (PendingNode) {
+            Data->NodeIDs.pop_back();
+            Data->NodeLatitudes.pop_back();
+            Data->NodeLongitudes.pop_back();
+            Data->NodeTagOffsets.pop_back();
+            Data->NodeTags.resize(Data->NodeTagOffsets.back());
+            PendingNode = false;
+        }
+        if (PendingWay) {
+            Data->WayIDs.pop_back();
+            Data->WayNodeOffsets.pop_back();
+            Data->WayNodeIDs.resize(Data->WayNodeOffsets.back());
+            Data->WayTagOffsets.pop_back();
+            Data->WayTags.resize(Data->WayTagOffsets.back());
+            PendingWay = false;
+        }
+    }
+
+    //builds the sorted order for one of the ID arrays, called once after loading
+    static void BuildIDOrder(const std::vector<uint64_t> &ids, std::vector<std::size_t> &order) {
+        order.clear();
+        if (std::is_sorted(ids.begin(), ids.end())) {
+            return;
+        }
+        order.resize(ids.size());
+        for (std::size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        //stable sort so that duplicate IDs still resolve to the first one loaded
+        std::stable_sort(order.begin(), order.end(), [&ids](std::size_t left, std::size_t right) {
+            return ids[left] < ids[right];
+        });
+    }
+
+    //binary search for an ID, returns ids.size() if it isn't found
+    static std::size_t FindID(const std::vector<uint64_t> &ids, const std::vector<std::size_t> &order, uint64_t id) {
+        if (order.empty()) {
+            auto t = std::lower_bound(ids.begin(), ids.end(), id);
+            if (t != ids.end() && *t == id) {
+                return t - ids.begin();
+            }
+            return ids.size();
+        }
+        auto t = std::lower_bound(order.begin(), order.end(), id, [&ids](std::size_t index, uint64_t value) {
+            return ids[index] < value;
+        });
+        if (t != order.end() && ids[*t] == id) {
+            return *t;
+        }
+        return ids.size();
+    }
+
+    //appends the nodes and ways of a map loaded from a later part of the
+    //document, its strings are interned again in the order it first saw them
+    void Append(const SMapData &part);
+
+    //drops unfinished elements, trims the arrays and sorts the ID orders once
+    //everything is loaded
+    void Finish();
 };
 
-// now we define the implementation classes using CStreetMap::SNode
-class COpenStreetMap::SImplementation::SNodeImpl : public CStreetMap::SNode {
+// node view, only an index into the shared arrays
+class COpenStreetMap::SImplementation::SNodeView : public CStreetMap::SNode {
+    std::shared_ptr<const SMapData> Data;
+    std::size_t Index;
+
+    std::size_t TagBegin() const noexcept {
+        return Data->NodeTagOffsets[Index];
+    }
+
+    std::size_t TagEnd() const noexcept {
+        return Data->NodeTagOffsets[Index + 1];
+    }
+
 public:
- // ID of the node
-    TNodeID NodeID;
-//coordinates of the node or the loaction
-    TLocation NodeLocation;
-//key and value attributes using an unordered map
-    std::unordered_map<std::string, std::string> Attributes;
+    SNodeView(std::shared_ptr<const SMapData> data, std::size_t index) : Data(std::move(data)), Index(index) {}
+
 //getting nodes ID
     TNodeID ID() const noexcept override {
-        return NodeID;
+        return Data->NodeIDs[Index];
     }
 //getting nodes location
     TLocation Location() const noexcept override {
-        return NodeLocation;
+        return TLocation(Data->NodeLatitudes[Index], Data->NodeLongitudes[Index]);
     }
 // # of attributes node has
     std::size_t AttributeCount() const noexcept override {
-        return Attributes.size();
+        return TagEnd() - TagBegin();
     }
-//retrieving key of attribute through index
+//retrieving key of attribute through index, attributes keep document order
     std::string GetAttributeKey(std::size_t index) const noexcept override {
-        if (index < Attributes.size()) {
-            auto t = Attributes.begin();
-// iterate to the required position 
-            for (std::size_t i = 0; i < index; i++) {
-                ++t; 
-            }
-// return the key at the index it's at
-            return t->first; 
+        if (index < AttributeCount()) {
+            return std::string(Data->Strings.String(Data->NodeTags[TagBegin() + index].Key));
         }
 // return empty string if index is out of bounds
-        return ""; 
+        return "";
     }
 // checking to see if the node has a attribute using key
     bool HasAttribute(const std::string &key) const noexcept override {
-        return Attributes.find(key) != Attributes.end();
+        return Data->FindTag(Data->NodeTags, TagBegin(), TagEnd(), key) != TagEnd();
     }
    // Retrieve the value of  attribute if the node has an attribute
     std::string GetAttribute(const std::string &key) const noexcept override {
-        auto t = Attributes.find(key);
-        if (t != Attributes.end()) {
-            return t->second;
+        std::size_t t = Data->FindTag(Data->NodeTags, TagBegin(), TagEnd(), key);
+        if (t != TagEnd()) {
+            return std::string(Data->Strings.String(Data->NodeTags[t].Value));
         }
     //if out of bounds return ""
         return "";
     }
 };
-// way class, when using CStreetMap::SWay
-class COpenStreetMap::SImplementation::SWayImpl : public CStreetMap::SWay {
+// way view, only an index into the shared arrays
+class COpenStreetMap::SImplementation::SWayView : public CStreetMap::SWay {
+    std::shared_ptr<const SMapData> Data;
+    std::size_t Index;
+
+    std::size_t TagBegin() const noexcept {
+        return Data->WayTagOffsets[Index];
+    }
+
+    std::size_t TagEnd() const noexcept {
+        return Data->WayTagOffsets[Index + 1];
+    }
+
 public:
-//ID of way
-    TWayID WayID;
-//Nodes IDS
-    std::vector<TNodeID> NodeIDs;
-//attributes for key and value using unordered map
-    std::unordered_map<std::string, std::string> Attributes;
+    SWayView(std::shared_ptr<const SMapData> data, std::size_t index) : Data(std::move(data)), Index(index) {}
+
 //Getting the way's ID
     TWayID ID() const noexcept override {
-        return WayID;
+        return Data->WayIDs[Index];
     }
 //# of nodes in way
     std::size_t NodeCount() const noexcept override {
-        return NodeIDs.size();
+        return Data->WayNodeOffsets[Index + 1] - Data->WayNodeOffsets[Index];
     }
 //Getting Node ID through index
     TNodeID GetNodeID(std::size_t index) const noexcept override {
-        if (index < NodeIDs.size()) {
-            return NodeIDs[index];
+        if (index < NodeCount()) {
+            return Data->WayNodeIDs[Data->WayNodeOffsets[Index] + index];
         }
         return CStreetMap::InvalidNodeID;
     }
 //# of attributes ways has
     std::size_t AttributeCount() const noexcept override {
-        return Attributes.size();
-    }
-//retrieving key of attribute through index
-std::string GetAttributeKey(std::size_t index) const noexcept override {
-    if (index < Attributes.size()) {
-        auto t = Attributes.begin();
-// iterate to the required position 
-        for (std::size_t i = 0; i < index; i++) {
-            ++t; 
-        }
-// return the key at the index it's at
-        return t->first; 
+        return TagEnd() - TagBegin();
     }
+//retrieving key of attribute through index, attributes keep document order
+    std::string GetAttributeKey(std::size_t index) const noexcept override {
+        if (index < AttributeCount()) {
+            return std::string(Data->Strings.String(Data->WayTags[TagBegin() + index].Key));
+        }
 // return empty string if index is out of bounds
-    return ""; 
-}
-// checking to see if the node has a attribute using key
-bool HasAttribute(const std::string &key) const noexcept override {
-    return Attributes.find(key) != Attributes.end();
-}
-// Retrieve the value of  attribute if the node has an attribute
-std::string GetAttribute(const std::string &key) const noexcept override {
-    auto t = Attributes.find(key);
-    if (t != Attributes.end()) {
-        return t->second;
+        return "";
+    }
+// checking to see if the way has a attribute using key
+    bool HasAttribute(const std::string &key) const noexcept override {
+        return Data->FindTag(Data->WayTags, TagBegin(), TagEnd(), key) != TagEnd();
     }
+// Retrieve the value of  attribute if the way has an attribute
+    std::string GetAttribute(const std::string &key) const noexcept override {
+        std::size_t t = Data->FindTag(Data->WayTags, TagBegin(), TagEnd(), key);
+        if (t != TagEnd()) {
+            return std::string(Data->Strings.String(Data->WayTags[t].Value));
+        }
 //if out of bounds return ""
-    return "";
-}
+        return "";
+    }
 };
 
-// Initialize the implementation
-COpenStreetMap::COpenStreetMap(std::shared_ptr<CXMLReader> src) {
-    //std::make_unique ensures exclusive ownership of the SImplementation instance
-    //intializing it to DImplementation
-    DImplementation = std::make_unique<SImplementation>();
-    
-    SXMLEntity entity;
-    //std::shared_ptr is used here to allow multiple 
-    //parts of the program to share ownership of nodes
-    std::shared_ptr<SImplementation::SNodeImpl> currentNode = nullptr;
-    // std::shared_ptr for ways allows for multiple references to the same way 
-    //without worrying about manual memory management
-    std::shared_ptr<SImplementation::SWayImpl> currentWay = nullptr;
-   //memory management for both is now a lot easier when using shared_ptr
-
-    
-    // parsing the XML file
-    while (src->ReadEntity(entity)) {
-        if (entity.DType == SXMLEntity::EType::StartElement) {
-            if (entity.DNameData == "node") {
-                //creating a new node instance
-                //Using std::make_shared optimizes memory allocation and ensures exception safety
-                currentNode = std::make_shared<SImplementation::SNodeImpl>();
-                currentWay = nullptr;
-                
-                // process the node attributes through a for loop
-                for (const auto& attr : entity.DAttributes) {
+// appends a part, its offsets and string indices are moved past this map's
+void COpenStreetMap::SImplementation::Append(const SMapData &part) {
+    SMapData &data = *Data;
+    std::vector<uint32_t> strings(part.Strings.Count());
+    for (std::size_t i = 0; i < strings.size(); i++) {
+        strings[i] = data.Strings.Intern(part.Strings.String(i));
+    }
+    auto appendTags = [&strings](std::vector<STag> &tags, std::vector<std::size_t> &offsets, const std::vector<STag> &parttags, const std::vector<std::size_t> &partoffsets) {
+        std::size_t base = tags.size();
+        for (std::size_t i = 1; i < partoffsets.size(); i++) {
+            offsets.push_back(base + partoffsets[i]);
+        }
+        for (const auto &tag : parttags) {
+            tags.push_back(STag{strings[tag.Key], strings[tag.Value]});
+        }
+    };
+
+    data.NodeIDs.insert(data.NodeIDs.end(), part.NodeIDs.begin(), part.NodeIDs.end());
+    data.NodeLatitudes.insert(data.NodeLatitudes.end(), part.NodeLatitudes.begin(), part.NodeLatitudes.end());
+    data.NodeLongitudes.insert(data.NodeLongitudes.end(), part.NodeLongitudes.begin(), part.NodeLongitudes.end());
+    appendTags(data.NodeTags, data.NodeTagOffsets, part.NodeTags, part.NodeTagOffsets);
+
+    data.WayIDs.insert(data.WayIDs.end(), part.WayIDs.begin(), part.WayIDs.end());
+    std::size_t base = data.WayNodeIDs.size();
+    for (std::size_t i = 1; i < part.WayNodeOffsets.size(); i++) {
+        data.WayNodeOffsets.push_back(base + part.WayNodeOffsets[i]);
+    }
+    data.WayNodeIDs.insert(data.WayNodeIDs.end(), part.WayNodeIDs.begin(), part.WayNodeIDs.end());
+    appendTags(data.WayTags, data.WayTagOffsets, part.WayTags, part.WayTagOffsets);
+}
+
+// drops unfinished elements, trims the arrays and sorts the ID orders
+void COpenStreetMap::SImplementation::Finish() {
+    DropPending();
+    Data->NodeIDs.shrink_to_fit();
+    Data->NodeLatitudes.shrink_to_fit();
+    Data->NodeLongitudes.shrink_to_fit();
+    Data->NodeTagOffsets.shrink_to_fit();
+    Data->NodeTags.shrink_to_fit();
+    Data->WayIDs.shrink_to_fit();
+    Data->WayNodeOffsets.shrink_to_fit();
+    Data->WayNodeIDs.shrink_to_fit();
+    Data->WayTagOffsets.shrink_to_fit();
+    Data->WayTags.shrink_to_fit();
+    Data->Strings.Shrink();
+    BuildIDOrder(Data->NodeIDs, NodeIDOrder);
+    BuildIDOrder(Data->WayIDs, WayIDOrder);
+}
+
+// only the elements below are passed on by the reader, their names and
+// attributes come straight from the parser without being copied. Names are
+// told apart by their atoms so there are no string compares
+class COpenStreetMap::SImplementation::SXMLLoader : public CXMLVisitor {
+    enum class EName {Other, Node, Way, Nd, Tag, ID, Lat, Lon, Ref, K, V};
+
+    SImplementation &Map;
+    // what each atom the reader hands out stands for
+    std::vector<EName> Names;
+
+    EName Name(SXMLEntity::TAtom atom) const {
+        return atom < Names.size() ? Names[atom] : EName::Other;
+    }
+
+public:
+    SXMLLoader(SImplementation &map, CXMLReader &reader) : Map(map) {
+        static const std::pair<const char *, EName> known[] = {
+            {"node", EName::Node}, {"way", EName::Way}, {"nd", EName::Nd}, {"tag", EName::Tag},
+            {"id", EName::ID}, {"lat", EName::Lat}, {"lon", EName::Lon}, {"ref", EName::Ref},
+            {"k", EName::K}, {"v", EName::V}
+        };
+        for (const auto &name : known) {
+            auto atom = reader.NameAtom(name.first);
+            if (atom >= Names.size()) {
+                Names.resize(atom + 1, EName::Other);
+            }
+            Names[atom] = name.second;
+        }
+    }
+
+    void StartElement(std::string_view name, SXMLEntity::TAtom atom, const SXMLAttributes &attributes) override {
+        switch (Name(atom)) {
+            case EName::Node: {
                 //in OSM XML file notes id lat and lon are used as node attributes
-                //in the wikipedia link you sent 
-                    if (attr.first == "id") {
-                        currentNode->NodeID = std::stoull(attr.second);
-                    } else if (attr.first == "lat") {
-                //std::stod is a simpler way of returning a double while
-                //trying to also check for erros such as
-                // std::invalid_argument and std::out_of_range
-                        currentNode->NodeLocation.first = std::stod(attr.second);
-                    } else if (attr.first == "lon") {
-                        currentNode->NodeLocation.second = std::stod(attr.second);
-                    } else {
-                        // store other attributes if needed
-                        currentNode->Attributes[attr.first] = attr.second;
+                TNodeID id = 0;
+                TLocation location(0.0, 0.0);
+                std::size_t count = attributes.Count();
+                for (std::size_t i = 0; i < count; i++) {
+                    switch (Name(attributes.Atom(i))) {
+                        case EName::ID: id = ParseID(attributes.Value(i)); break;
+                        case EName::Lat: location.first = ParseCoordinate(attributes.Value(i)); break;
+                        case EName::Lon: location.second = ParseCoordinate(attributes.Value(i)); break;
+                        default: break;
                     }
                 }
-            } else if (entity.DNameData == "way") {
-                // creating a new way instance
-                currentWay = std::make_shared<SImplementation::SWayImpl>();
-                currentNode = nullptr;
-                
-                // process way attributes
-                for (const auto& attr : entity.DAttributes) {
-                    if (attr.first == "id") {
-                        currentWay->WayID = std::stoull(attr.second);
-                    } else {
-                        // store other attributes again
-                        currentWay->Attributes[attr.first] = attr.second;
+                Map.BeginNode(id, location.first, location.second);
+                // store other attributes with the tags
+                for (std::size_t i = 0; i < count; i++) {
+                    auto kind = Name(attributes.Atom(i));
+                    if (kind != EName::ID && kind != EName::Lat && kind != EName::Lon) {
+                        Map.AddTag(attributes.Name(i), attributes.Value(i));
                     }
                 }
-            } else if (entity.DNameData == "nd" && currentWay) {
-                // Process node reference inside a way
-                //using std::stoull since converting string to unsigned long long
-                //when reading attribute
-                for (const auto& attr : entity.DAttributes) {
-                    if (attr.first == "ref") {
-                        currentWay->NodeIDs.push_back(std::stoull(attr.second));
+                break;
+            }
+            case EName::Way: {
+                TWayID id = 0;
+                std::size_t count = attributes.Count();
+                for (std::size_t i = 0; i < count; i++) {
+                    if (Name(attributes.Atom(i)) == EName::ID) {
+                        id = ParseID(attributes.Value(i));
                     }
                 }
-            } else if (entity.DNameData == "tag") {
-                // Process tag element for both nodes and ways
-                std::string key, value;
-                for (const auto& attr : entity.DAttributes) {
-                    if (attr.first == "k") {
-                        key = attr.second;
-                    } else if (attr.first == "v") {
-                        value = attr.second;
+                Map.BeginWay(id);
+                // store other attributes again
+                for (std::size_t i = 0; i < count; i++) {
+                    if (Name(attributes.Atom(i)) != EName::ID) {
+                        Map.AddTag(attributes.Name(i), attributes.Value(i));
                     }
                 }
-                //pretty self explanatory
-                if (!key.empty()) {
-                    if (currentNode) {
-                        currentNode->Attributes[key] = value;
-                    } else if (currentWay) {
-                        currentWay->Attributes[key] = value;
+                break;
+            }
+            case EName::Nd:
+                // node reference inside a way
+                for (std::size_t i = 0; attributes.DAttributes[i * 2]; i++) {
+                    if (Name(attributes.Atom(i)) == EName::Ref) {
+                        Map.AddWayNode(ParseID(attributes.Value(i)));
+                    }
+                }
+                break;
+            case EName::Tag: {
+                // tag element for both nodes and ways
+                std::string_view key, value;
+                for (std::size_t i = 0; attributes.DAttributes[i * 2]; i++) {
+                    switch (Name(attributes.Atom(i))) {
+                        case EName::K: key = attributes.Value(i); break;
+                        case EName::V: value = attributes.Value(i); break;
+                        default: break;
                     }
                 }
+                if (!key.empty()) {
+                    Map.AddTag(key, value);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void EndElement(std::string_view name, SXMLEntity::TAtom atom) override {
+        switch (Name(atom)) {
+            // Store completed node
+            case EName::Node: Map.EndNode(); break;
+            // Store completed way
+            case EName::Way: Map.EndWay(); break;
+            default: break;
+        }
+    }
+};
+
+// the scanner has already picked out the numbers and tags
+class COpenStreetMap::SImplementation::SScanLoader : public COSMXMLVisitor {
+    SImplementation &Map;
+
+public:
+    SScanLoader(SImplementation &map) : Map(map) {}
+
+    void BeginNode(uint64_t id, double latitude, double longitude) override {
+        Map.BeginNode(id, latitude, longitude);
+    }
+
+    void EndNode() override {
+        Map.EndNode();
+    }
+
+    void BeginWay(uint64_t id) override {
+        Map.BeginWay(id);
+    }
+
+    void EndWay() override {
+        Map.EndWay();
+    }
+
+    void WayNode(uint64_t ref) override {
+        Map.AddWayNode(ref);
+    }
+
+    void Tag(std::string_view key, std::string_view value) override {
+        Map.AddTag(key, value);
+    }
+};
+
+// Initialize the implementation
+COpenStreetMap::COpenStreetMap(std::shared_ptr<CXMLReader> src) {
+    //std::make_unique ensures exclusive ownership of the SImplementation instance
+    //intializing it to DImplementation
+    DImplementation = std::make_unique<SImplementation>();
+    auto &map = *DImplementation;
+
+    // parsing the XML file, skipping every other element and all character data
+    static const std::vector<std::string> elements = {"node", "way", "nd", "tag"};
+    SImplementation::SXMLLoader loader(map, *src);
+    map.Valid = src->Parse(loader, elements);
+    //trim the storage and index the IDs once so NodeByID and WayByID don't have to scan
+    map.Finish();
+}
+
+// load from a PBF file, the blocks come back in file order so the nodes and
+// ways end up in the same order an XML export of the file would give
+COpenStreetMap::COpenStreetMap(std::shared_ptr<CPBFReader> src) {
+    DImplementation = std::make_unique<SImplementation>();
+    auto &map = *DImplementation;
+    std::vector<CPBFReader::SBlock> blocks;
+    while (src->ReadBlocks(blocks)) {
+        for (const auto &block : blocks) {
+            for (std::size_t i = 0; i < block.NodeIDs.size(); i++) {
+                map.BeginNode(block.NodeIDs[i], block.NodeLatitudes[i], block.NodeLongitudes[i]);
+                for (std::size_t t = block.NodeTagOffsets[i]; t < block.NodeTagOffsets[i + 1]; t++) {
+                    map.AddTag(block.Strings[block.NodeTags[t].first], block.Strings[block.NodeTags[t].second]);
+                }
+                map.EndNode();
             }
-        } else if (entity.DType == SXMLEntity::EType::EndElement) {
-            if (entity.DNameData == "node" && currentNode) {
-                // Store completed node
-                DImplementation->Nodes.push_back(currentNode);
-                currentNode = nullptr;
-            } else if (entity.DNameData == "way" && currentWay) {
-                // Store completed way
-                DImplementation->Ways.push_back(currentWay);
-                currentWay = nullptr;
+            for (std::size_t i = 0; i < block.WayIDs.size(); i++) {
+                map.BeginWay(block.WayIDs[i]);
+                for (std::size_t n = block.WayNodeOffsets[i]; n < block.WayNodeOffsets[i + 1]; n++) {
+                    map.AddWayNode(block.WayNodeIDs[n]);
+                }
+                for (std::size_t t = block.WayTagOffsets[i]; t < block.WayTagOffsets[i + 1]; t++) {
+                    map.AddTag(block.Strings[block.WayTags[t].first], block.Strings[block.WayTags[t].second]);
+                }
+                map.EndWay();
             }
         }
     }
+    //a corrupt or truncated blob stops the reader early
+    map.Valid = !src->Failed();
+    map.Finish();
+}
+
+// load through the OSM specific scanner, which gives the same map as the
+// XML reader without going through expat
+COpenStreetMap::COpenStreetMap(std::shared_ptr<COSMXMLScanner> src, std::size_t threads) {
+    DImplementation = std::make_unique<SImplementation>();
+    auto &map = *DImplementation;
+    if (!threads) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    auto parts = threads > 1 ? src->Split(threads) : std::vector<std::shared_ptr<COSMXMLScanner>>();
+    if (parts.size() > 1) {
+        //every part goes into its own map on its own thread, the calling thread takes the first
+        std::vector<SImplementation> partmaps(parts.size());
+        std::vector<char> scanned(parts.size());
+        auto load = [&](std::size_t index) {
+            SImplementation::SScanLoader loader(partmaps[index]);
+            scanned[index] = parts[index]->Scan(loader);
+            partmaps[index].DropPending();
+        };
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < parts.size(); i++) {
+            workers.emplace_back(load, i);
+        }
+        load(0);
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        //only the last part may stop early, otherwise a boundary was inside
+        //something like a comment and the parts don't add up to the document
+        if (std::find(scanned.begin(), scanned.end() - 1, false) == scanned.end() - 1) {
+            for (auto &partmap : partmaps) {
+                map.Append(*partmap.Data);
+                partmap.Data.reset();
+            }
+            map.Valid = scanned.back();
+            //the parts have read everything src had left
+            src->Skip();
+            map.Finish();
+            return;
+        }
+    }
+    SImplementation::SScanLoader loader(map);
+    map.Valid = src->Scan(loader);
+    map.Finish();
 }
 
 // destructor
 COpenStreetMap::~COpenStreetMap() = default;
 
+// check if the whole source was loaded
+bool COpenStreetMap::IsValid() const noexcept {
+    return DImplementation->Valid;
+}
+
 // return the total count of nodes
 std::size_t COpenStreetMap::NodeCount() const noexcept {
-    return DImplementation->Nodes.size();
+    return DImplementation->Data->NodeIDs.size();
 }
 
 // return the total count of ways
 std::size_t COpenStreetMap::WayCount() const noexcept {
-    return DImplementation->Ways.size();
+    return DImplementation->Data->WayIDs.size();
 }
 
 // retrieve node by index
 std::shared_ptr<CStreetMap::SNode> COpenStreetMap::NodeByIndex(std::size_t index) const noexcept {
-    if (index < DImplementation->Nodes.size()) {
-        return DImplementation->Nodes[index];
+    if (index < NodeCount()) {
+        return std::make_shared<SImplementation::SNodeView>(DImplementation->Data, index);
     }
     return nullptr;//if index is out of bounds do this
 }
 
 // retrieve node by ID
 std::shared_ptr<CStreetMap::SNode> COpenStreetMap::NodeByID(TNodeID id) const noexcept {
-    for (auto& node : DImplementation->Nodes) {
-        if (node->ID() == id) {
-            return node;
-        }
-    }
-    return nullptr;//if no node with matching ID do this
+    return NodeByIndex(SImplementation::FindID(DImplementation->Data->NodeIDs, DImplementation->NodeIDOrder, id));
 }
 
 // retrieve way by index
 std::shared_ptr<CStreetMap::SWay> COpenStreetMap::WayByIndex(std::size_t index) const noexcept {
-    if (index < DImplementation->Ways.size()) {
-        return DImplementation->Ways[index];
+    if (index < WayCount()) {
+        return std::make_shared<SImplementation::SWayView>(DImplementation->Data, index);
     }
     return nullptr;//index is out of bounds
 }
 
 // retrieve way by ID
 std::shared_ptr<CStreetMap::SWay> COpenStreetMap::WayByID(TWayID id) const noexcept {
-    for (auto& way : DImplementation->Ways) {
-        if (way->ID() == id) {
-            return way;
-        }
-    }
-    return nullptr;//if no way with matching ID do this
+    return WayByIndex(SImplementation::FindID(DImplementation->Data->WayIDs, DImplementation->WayIDOrder, id));
 }
@@ -0,0 +1,642 @@
+#include "PBFReader.h"
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <thread>
+#include <zlib.h>
+
+namespace {
+
+// largest sizes the PBF format allows for a blob header and a blob
+const std::size_t MaxBlobHeaderSize = 64 * 1024;
+const std::size_t MaxBlobSize = 32 * 1024 * 1024;
+
+enum EWireType : uint32_t{
+    WireVarint = 0,
+    WireFixed64 = 1,
+    WireLengthDelimited = 2,
+    WireFixed32 = 5
+};
+
+// reads protobuf fields out of a byte range, any malformed input sets Error
+// and makes every later read return nothing
+struct SProtoReader{
+    const uint8_t *Current;
+    const uint8_t *End;
+    bool Error = false;
+
+    SProtoReader(const uint8_t *begin, const uint8_t *end) : Current(begin), End(end){}
+
+    bool AtEnd() const{
+        return Error || Current >= End;
+    }
+
+    uint64_t Varint(){
+        uint64_t Value = 0;
+        for(int Shift = 0; Shift < 64; Shift += 7){
+            if(Current >= End){
+                break;
+            }
+            uint8_t Byte = *Current++;
+            Value |= uint64_t(Byte & 0x7F) << Shift;
+            if(!(Byte & 0x80)){
+                return Value;
+            }
+        }
+        Error = true;
+        Current = End;
+        return 0;
+    }
+
+    int64_t SignedVarint(){
+        uint64_t Value = Varint();
+        return int64_t(Value >> 1) ^ -int64_t(Value & 1);
+    }
+
+    // reads the next field key, false at the end of the range
+    bool Next(uint32_t &field, uint32_t &wiretype){
+        if(AtEnd()){
+            return false;
+        }
+        uint64_t Key = Varint();
+        field = uint32_t(Key >> 3);
+        wiretype = uint32_t(Key & 7);
+        return !Error;
+    }
+
+    // the contents of a length delimited field
+    SProtoReader Bytes(){
+        uint64_t Length = Varint();
+        if(Error || Length > uint64_t(End - Current)){
+            Error = true;
+            Current = End;
+            return SProtoReader(End, End);
+        }
+        SProtoReader Result(Current, Current + Length);
+        Current += Length;
+        return Result;
+    }
+
+    std::string String(){
+        SProtoReader Contents = Bytes();
+        return std::string(reinterpret_cast<const char *>(Contents.Current), Contents.End - Contents.Current);
+    }
+
+    void Skip(uint32_t wiretype){
+        std::size_t Size = 0;
+        switch(wiretype){
+            case WireVarint:            Varint();
+                                        return;
+            case WireLengthDelimited:   Bytes();
+                                        return;
+            case WireFixed64:           Size = 8;
+                                        break;
+            case WireFixed32:           Size = 4;
+                                        break;
+            default:                    Error = true;
+                                        Current = End;
+                                        return;
+        }
+        if(Size > std::size_t(End - Current)){
+            Error = true;
+            Current = End;
+            return;
+        }
+        Current += Size;
+    }
+
+    // reads a packed repeated field, delta decoding it if asked to. A field
+    // that isn't packed holds a single value
+    template <typename T> void Repeated(uint32_t wiretype, std::vector<T> &values, bool zigzag, bool delta){
+        auto ReadValue = [&](SProtoReader &reader){
+            int64_t Value = zigzag ? reader.SignedVarint() : int64_t(reader.Varint());
+            if(delta && !values.empty()){
+                Value += int64_t(values.back());
+            }
+            values.push_back(T(Value));
+        };
+        if(wiretype == WireLengthDelimited){
+            SProtoReader Packed = Bytes();
+            while(!Packed.AtEnd()){
+                ReadValue(Packed);
+            }
+            Error |= Packed.Error;
+        }
+        else if(wiretype == WireVarint){
+            ReadValue(*this);
+        }
+        else{
+            Skip(wiretype);
+        }
+    }
+};
+
+// metadata of one element, only present fields are turned into tags
+struct SInfo{
+    int64_t Version = 0;
+    int64_t Timestamp = 0;
+    int64_t Changeset = 0;
+    int64_t UID = 0;
+    int64_t UserString = 0;
+};
+
+}
+
+struct CPBFReader::SImplementation{
+    // a blob as read from the file, before it is inflated and decoded
+    struct SRawBlob{
+        std::vector<char> Data;
+    };
+
+    std::shared_ptr<CDataSource> DataSource;
+    std::size_t ThreadCount;
+    bool Finished = false;
+    bool Error = false;
+    std::vector<char> Buffer;
+
+    SImplementation(std::shared_ptr<CDataSource> src, std::size_t threads) : DataSource(std::move(src)){
+        ThreadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        if(!DataSource){
+            Finished = true;
+        }
+    }
+
+    // reads exactly count bytes, sources may hand out fewer per call
+    bool ReadExactly(std::vector<char> &buf, std::size_t count){
+        buf.clear();
+        while(buf.size() < count && DataSource->Read(Buffer, count - buf.size())){
+            buf.insert(buf.end(), Buffer.begin(), Buffer.end());
+        }
+        return buf.size() == count;
+    }
+
+    // reads the next blob with its type, false at the end of the file or if
+    // the blob header is malformed
+    bool ReadRawBlob(std::string &type, std::vector<char> &blob){
+        std::vector<char> Header;
+        if(!ReadExactly(Header, 4)){
+            if(!Header.empty()){
+                Error = true;
+            }
+            return false;
+        }
+        std::size_t HeaderSize = 0;
+        for(char Byte : Header){
+            HeaderSize = (HeaderSize << 8) | uint8_t(Byte);
+        }
+        if(HeaderSize > MaxBlobHeaderSize || !ReadExactly(Header, HeaderSize)){
+            Error = true;
+            return false;
+        }
+        SProtoReader Reader(reinterpret_cast<const uint8_t *>(Header.data()), reinterpret_cast<const uint8_t *>(Header.data() + Header.size()));
+        uint32_t Field, WireType;
+        uint64_t DataSize = 0;
+        bool HasDataSize = false;
+        type.clear();
+        while(Reader.Next(Field, WireType)){
+            if(Field == 1 && WireType == WireLengthDelimited){
+                type = Reader.String();
+            }
+            else if(Field == 3 && WireType == WireVarint){
+                DataSize = Reader.Varint();
+                HasDataSize = true;
+            }
+            else{
+                Reader.Skip(WireType);
+            }
+        }
+        if(Reader.Error || !HasDataSize || DataSize > MaxBlobSize || !ReadExactly(blob, DataSize)){
+            Error = true;
+            return false;
+        }
+        return true;
+    }
+
+    // unpacks a Blob message, returns false for compressions other than zlib
+    static bool Inflate(const std::vector<char> &blob, std::vector<char> &data){
+        SProtoReader Reader(reinterpret_cast<const uint8_t *>(blob.data()), reinterpret_cast<const uint8_t *>(blob.data() + blob.size()));
+        uint32_t Field, WireType;
+        uint64_t RawSize = 0;
+        SProtoReader Compressed(nullptr, nullptr);
+        bool HasData = false;
+        while(Reader.Next(Field, WireType)){
+            if(Field == 1 && WireType == WireLengthDelimited){
+                SProtoReader Raw = Reader.Bytes();
+                data.assign(Raw.Current, Raw.End);
+                HasData = true;
+            }
+            else if(Field == 2 && WireType == WireVarint){
+                RawSize = Reader.Varint();
+            }
+            else if(Field == 3 && WireType == WireLengthDelimited){
+                Compressed = Reader.Bytes();
+            }
+            else if(Field >= 4 && Field <= 7){
+                // lzma, bzip2, lz4 and zstd data
+                return false;
+            }
+            else{
+                Reader.Skip(WireType);
+            }
+        }
+        if(Reader.Error){
+            return false;
+        }
+        if(HasData){
+            return true;
+        }
+        if(!Compressed.Current || RawSize > MaxBlobSize){
+            return false;
+        }
+        data.resize(RawSize);
+        uLongf Length = RawSize;
+        if(uncompress(reinterpret_cast<Bytef *>(data.data()), &Length, Compressed.Current, Compressed.End - Compressed.Current) != Z_OK || Length != RawSize){
+            return false;
+        }
+        return true;
+    }
+
+    // checks that the file needs nothing beyond what this reader understands
+    static bool CheckHeader(const std::vector<char> &data){
+        SProtoReader Reader(reinterpret_cast<const uint8_t *>(data.data()), reinterpret_cast<const uint8_t *>(data.data() + data.size()));
+        uint32_t Field, WireType;
+        while(Reader.Next(Field, WireType)){
+            if(Field == 4 && WireType == WireLengthDelimited){
+                std::string Feature = Reader.String();
+                if(Feature != "OsmSchema-V0.6" && Feature != "DenseNodes"){
+                    return false;
+                }
+            }
+            else{
+                Reader.Skip(WireType);
+            }
+        }
+        return !Reader.Error;
+    }
+
+    // block wide settings needed to decode coordinates and timestamps
+    struct SBlockSettings{
+        int64_t Granularity = 100;
+        int64_t LatitudeOffset = 0;
+        int64_t LongitudeOffset = 0;
+        int64_t DateGranularity = 1000;
+    };
+
+    // nanodegrees are divided rather than multiplied by 1e-9 so coordinates
+    // with up to nine decimals come out exactly as parsing the decimal would
+    static double Coordinate(int64_t offset, int64_t granularity, int64_t value){
+        return double(offset + granularity * value) / 1e9;
+    }
+
+    // adds a tag whose strings aren't in the block string table
+    static void AddTag(SBlock &block, std::vector<std::pair<uint32_t, uint32_t>> &tags, const std::string &key, const std::string &value){
+        block.Strings.push_back(key);
+        block.Strings.push_back(value);
+        tags.emplace_back(block.Strings.size() - 2, block.Strings.size() - 1);
+    }
+
+    // turns the present metadata fields into tags, in the order XML lists them
+    static void AddInfo(SBlock &block, std::vector<std::pair<uint32_t, uint32_t>> &tags, const SInfo &info, const SBlockSettings &settings, std::size_t stringcount){
+        if(info.Version){
+            AddTag(block, tags, "version", std::to_string(info.Version));
+        }
+        if(info.Timestamp){
+            std::time_t Seconds = info.Timestamp * settings.DateGranularity / 1000;
+            std::tm Time;
+            char Buffer[32];
+            if(gmtime_r(&Seconds, &Time) && std::strftime(Buffer, sizeof(Buffer), "%Y-%m-%dT%H:%M:%SZ", &Time)){
+                AddTag(block, tags, "timestamp", Buffer);
+            }
+        }
+        if(info.Changeset){
+            AddTag(block, tags, "changeset", std::to_string(info.Changeset));
+        }
+        if(info.UID){
+            AddTag(block, tags, "uid", std::to_string(info.UID));
+        }
+        if(info.UserString > 0 && std::size_t(info.UserString) < stringcount){
+            tags.emplace_back(block.Strings.size(), info.UserString);
+            block.Strings.push_back("user");
+        }
+    }
+
+    // adds key/value string index pairs, false if an index is outside the string table
+    static bool AddTags(std::vector<std::pair<uint32_t, uint32_t>> &tags, const std::vector<uint32_t> &keys, const std::vector<uint32_t> &values, std::size_t stringcount){
+        if(keys.size() != values.size()){
+            return false;
+        }
+        for(std::size_t Index = 0; Index < keys.size(); Index++){
+            if(keys[Index] >= stringcount || values[Index] >= stringcount){
+                return false;
+            }
+            tags.emplace_back(keys[Index], values[Index]);
+        }
+        return true;
+    }
+
+    static SInfo DecodeInfo(SProtoReader reader){
+        SInfo Info;
+        uint32_t Field, WireType;
+        while(reader.Next(Field, WireType)){
+            switch(Field){
+                case 1:     Info.Version = int64_t(reader.Varint());
+                            break;
+                case 2:     Info.Timestamp = int64_t(reader.Varint());
+                            break;
+                case 3:     Info.Changeset = int64_t(reader.Varint());
+                            break;
+                case 4:     Info.UID = int32_t(reader.Varint());
+                            break;
+                case 5:     Info.UserString = int64_t(reader.Varint());
+                            break;
+                default:    reader.Skip(WireType);
+                            break;
+            }
+        }
+        return Info;
+    }
+
+    static bool DecodeNode(SProtoReader reader, const SBlockSettings &settings, std::size_t stringcount, SBlock &block){
+        uint32_t Field, WireType;
+        int64_t ID = 0, Latitude = 0, Longitude = 0;
+        std::vector<uint32_t> Keys, Values;
+        SInfo Info;
+        while(reader.Next(Field, WireType)){
+            switch(Field){
+                case 1:     ID = reader.SignedVarint();
+                            break;
+                case 2:     reader.Repeated(WireType, Keys, false, false);
+                            break;
+                case 3:     reader.Repeated(WireType, Values, false, false);
+                            break;
+                case 4:     Info = DecodeInfo(reader.Bytes());
+                            break;
+                case 8:     Latitude = reader.SignedVarint();
+                            break;
+                case 9:     Longitude = reader.SignedVarint();
+                            break;
+                default:    reader.Skip(WireType);
+                            break;
+            }
+        }
+        block.NodeIDs.push_back(ID);
+        block.NodeLatitudes.push_back(Coordinate(settings.LatitudeOffset, settings.Granularity, Latitude));
+        block.NodeLongitudes.push_back(Coordinate(settings.LongitudeOffset, settings.Granularity, Longitude));
+        AddInfo(block, block.NodeTags, Info, settings, stringcount);
+        bool Valid = AddTags(block.NodeTags, Keys, Values, stringcount);
+        block.NodeTagOffsets.push_back(block.NodeTags.size());
+        return Valid && !reader.Error;
+    }
+
+    static bool DecodeDenseNodes(SProtoReader reader, const SBlockSettings &settings, std::size_t stringcount, SBlock &block){
+        uint32_t Field, WireType;
+        std::vector<int64_t> IDs, Latitudes, Longitudes;
+        std::vector<uint32_t> KeysValues;
+        std::vector<int64_t> Versions, Timestamps, Changesets, UIDs, UserStrings;
+        while(reader.Next(Field, WireType)){
+            switch(Field){
+                case 1:     reader.Repeated(WireType, IDs, true, true);
+                            break;
+                case 5:     {
+                                SProtoReader Info = reader.Bytes();
+                                uint32_t InfoField, InfoWireType;
+                                while(Info.Next(InfoField, InfoWireType)){
+                                    switch(InfoField){
+                                        case 1:     Info.Repeated(InfoWireType, Versions, false, false);
+                                                    break;
+                                        case 2:     Info.Repeated(InfoWireType, Timestamps, true, true);
+                                                    break;
+                                        case 3:     Info.Repeated(InfoWireType, Changesets, true, true);
+                                                    break;
+                                        case 4:     Info.Repeated(InfoWireType, UIDs, true, true);
+                                                    break;
+                                        case 5:     Info.Repeated(InfoWireType, UserStrings, true, true);
+                                                    break;
+                                        default:    Info.Skip(InfoWireType);
+                                                    break;
+                                    }
+                                }
+                                reader.Error |= Info.Error;
+                            }
+                            break;
+                case 8:     reader.Repeated(WireType, Latitudes, true, true);
+                            break;
+                case 9:     reader.Repeated(WireType, Longitudes, true, true);
+                            break;
+                case 10:    reader.Repeated(WireType, KeysValues, false, false);
+                            break;
+                default:    reader.Skip(WireType);
+                            break;
+            }
+        }
+        std::size_t Count = IDs.size();
+        if(reader.Error || Latitudes.size() != Count || Longitudes.size() != Count){
+            return false;
+        }
+        std::size_t KeyValue = 0;
+        for(std::size_t Index = 0; Index < Count; Index++){
+            block.NodeIDs.push_back(IDs[Index]);
+            block.NodeLatitudes.push_back(Coordinate(settings.LatitudeOffset, settings.Granularity, Latitudes[Index]));
+            block.NodeLongitudes.push_back(Coordinate(settings.LongitudeOffset, settings.Granularity, Longitudes[Index]));
+            SInfo Info;
+            Info.Version = Index < Versions.size() ? Versions[Index] : 0;
+            Info.Timestamp = Index < Timestamps.size() ? Timestamps[Index] : 0;
+            Info.Changeset = Index < Changesets.size() ? Changesets[Index] : 0;
+            Info.UID = Index < UIDs.size() ? UIDs[Index] : 0;
+            Info.UserString = Index < UserStrings.size() ? UserStrings[Index] : 0;
+            AddInfo(block, block.NodeTags, Info, settings, stringcount);
+            // keys_vals holds key, value pairs for each node ended by a 0
+            while(KeyValue < KeysValues.size() && KeysValues[KeyValue]){
+                if(KeyValue + 1 >= KeysValues.size() || KeysValues[KeyValue] >= stringcount || KeysValues[KeyValue + 1] >= stringcount){
+                    return false;
+                }
+                block.NodeTags.emplace_back(KeysValues[KeyValue], KeysValues[KeyValue + 1]);
+                KeyValue += 2;
+            }
+            KeyValue++;
+            block.NodeTagOffsets.push_back(block.NodeTags.size());
+        }
+        return true;
+    }
+
+    static bool DecodeWay(SProtoReader reader, const SBlockSettings &settings, std::size_t stringcount, SBlock &block){
+        uint32_t Field, WireType;
+        uint64_t ID = 0;
+        std::vector<uint32_t> Keys, Values;
+        std::vector<int64_t> References;
+        SInfo Info;
+        while(reader.Next(Field, WireType)){
+            switch(Field){
+                case 1:     ID = reader.Varint();
+                            break;
+                case 2:     reader.Repeated(WireType, Keys, false, false);
+                            break;
+                case 3:     reader.Repeated(WireType, Values, false, false);
+                            break;
+                case 4:     Info = DecodeInfo(reader.Bytes());
+                            break;
+                case 8:     reader.Repeated(WireType, References, true, true);
+                            break;
+                default:    reader.Skip(WireType);
+                            break;
+            }
+        }
+        block.WayIDs.push_back(ID);
+        block.WayNodeIDs.insert(block.WayNodeIDs.end(), References.begin(), References.end());
+        block.WayNodeOffsets.push_back(block.WayNodeIDs.size());
+        AddInfo(block, block.WayTags, Info, settings, stringcount);
+        bool Valid = AddTags(block.WayTags, Keys, Values, stringcount);
+        block.WayTagOffsets.push_back(block.WayTags.size());
+        return Valid && !reader.Error;
+    }
+
+    // decodes a PrimitiveBlock, the string table and settings come first so
+    // the groups are collected and decoded once the whole block is read
+    static bool DecodeBlock(const std::vector<char> &data, SBlock &block){
+        SProtoReader Reader(reinterpret_cast<const uint8_t *>(data.data()), reinterpret_cast<const uint8_t *>(data.data() + data.size()));
+        SBlockSettings Settings;
+        std::vector<SProtoReader> Groups;
+        uint32_t Field, WireType;
+        block = SBlock();
+        while(Reader.Next(Field, WireType)){
+            switch(Field){
+                case 1:     {
+                                SProtoReader Table = Reader.Bytes();
+                                uint32_t TableField, TableWireType;
+                                while(Table.Next(TableField, TableWireType)){
+                                    if(TableField == 1 && TableWireType == WireLengthDelimited){
+                                        block.Strings.push_back(Table.String());
+                                    }
+                                    else{
+                                        Table.Skip(TableWireType);
+                                    }
+                                }
+                                Reader.Error |= Table.Error;
+                            }
+                            break;
+                case 2:     Groups.push_back(Reader.Bytes());
+                            break;
+                case 17:    Settings.Granularity = int64_t(Reader.Varint());
+                            break;
+                case 18:    Settings.DateGranularity = int64_t(Reader.Varint());
+                            break;
+                case 19:    Settings.LatitudeOffset = int64_t(Reader.Varint());
+                            break;
+                case 20:    Settings.LongitudeOffset = int64_t(Reader.Varint());
+                            break;
+                default:    Reader.Skip(WireType);
+                            break;
+            }
+        }
+        if(Reader.Error){
+            return false;
+        }
+        // tags added for metadata go after the string table, indices below
+        // this count are the only ones the file itself may use
+        std::size_t StringCount = block.Strings.size();
+        block.NodeTagOffsets.push_back(0);
+        block.WayNodeOffsets.push_back(0);
+        block.WayTagOffsets.push_back(0);
+        for(auto &Group : Groups){
+            while(Group.Next(Field, WireType)){
+                bool Valid = true;
+                switch(Field){
+                    case 1:     Valid = DecodeNode(Group.Bytes(), Settings, StringCount, block);
+                                break;
+                    case 2:     Valid = DecodeDenseNodes(Group.Bytes(), Settings, StringCount, block);
+                                break;
+                    case 3:     Valid = DecodeWay(Group.Bytes(), Settings, StringCount, block);
+                                break;
+                    default:    Group.Skip(WireType);
+                                break;
+                }
+                if(!Valid){
+                    return false;
+                }
+            }
+            if(Group.Error){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ReadBlocks(std::vector<SBlock> &blocks, std::size_t count){
+        blocks.clear();
+        if(Finished || Error){
+            return false;
+        }
+        if(!count){
+            count = ThreadCount * 4;
+        }
+        // reading stays sequential, it is only copying bytes
+        std::vector<SRawBlob> RawBlobs;
+        std::string Type;
+        std::vector<char> Blob, Data;
+        while(RawBlobs.size() < count){
+            if(!ReadRawBlob(Type, Blob)){
+                Finished = true;
+                break;
+            }
+            if(Type == "OSMHeader"){
+                if(!Inflate(Blob, Data) || !CheckHeader(Data)){
+                    Error = true;
+                    return false;
+                }
+            }
+            else if(Type == "OSMData"){
+                RawBlobs.push_back({std::move(Blob)});
+                Blob.clear();
+            }
+        }
+        if(Error){
+            return false;
+        }
+
+        // each thread takes the next undecoded blob until none are left
+        blocks.resize(RawBlobs.size());
+        std::atomic<std::size_t> NextBlob(0);
+        std::atomic<bool> Failed(false);
+        auto DecodeBlobs = [&](){
+            std::vector<char> Inflated;
+            std::size_t Index;
+            while((Index = NextBlob++) < RawBlobs.size()){
+                if(!Inflate(RawBlobs[Index].Data, Inflated) || !DecodeBlock(Inflated, blocks[Index])){
+                    Failed = true;
+                }
+            }
+        };
+        std::vector<std::thread> Threads;
+        for(std::size_t Index = 1; Index < std::min(ThreadCount, RawBlobs.size()); Index++){
+            Threads.emplace_back(DecodeBlobs);
+        }
+        DecodeBlobs();
+        for(auto &Thread : Threads){
+            Thread.join();
+        }
+        if(Failed){
+            Error = true;
+            blocks.clear();
+            return false;
+        }
+        return !blocks.empty();
+    }
+};
+
+CPBFReader::CPBFReader(std::shared_ptr<CDataSource> src, std::size_t threads) : DImplementation(std::make_unique<SImplementation>(src, threads)){
+
+}
+
+CPBFReader::~CPBFReader() = default;
+
+bool CPBFReader::End() const{
+    return DImplementation->Finished || DImplementation->Error;
+}
+
+bool CPBFReader::Failed() const{
+    return DImplementation->Error;
+}
+
+bool CPBFReader::ReadBlocks(std::vector<SBlock> &blocks, std::size_t count){
+    return DImplementation->ReadBlocks(blocks, count);
+}
@@ -0,0 +1,200 @@
+#include "ParallelDSVReader.h"
+#include "DSVScanner.h"
+#include "MappedFileDataSource.h"
+#include <algorithm>
+#include <thread>
+
+struct CParallelDSVReader::SImplementation{
+    // rows parsed from one chunk, RowEnds[i] is one past the last field of row i
+    struct SChunk{
+        std::vector<DSVScanner::SField> Fields;
+        std::vector<std::size_t> RowEnds;
+        std::string Scratch;
+    };
+
+    // keeps a mapped source alive while its memory is being scanned
+    std::shared_ptr<CDataSource> DataSource;
+    // the input when it had to be read out of the data source
+    std::vector<char> OwnedData;
+    const char *Data = nullptr;
+    std::size_t Size = 0;
+    // start of the next batch, always the start of a row
+    std::size_t Position = 0;
+    char Delimiter;
+    std::size_t ThreadCount;
+    std::size_t ChunkSize;
+
+    // the batch being handed out and where in it the next row is
+    std::vector<SChunk> Chunks;
+    std::size_t CurrentChunk = 0;
+    std::size_t CurrentRow = 0;
+    std::vector<std::string_view> Views;
+
+    SImplementation(std::shared_ptr<CDataSource> src, char delimiter, std::size_t threads, std::size_t chunksize)
+        : DataSource(std::move(src)), Delimiter(delimiter), ChunkSize(chunksize ? chunksize : 1){
+        ThreadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        auto MappedSource = std::dynamic_pointer_cast<CMappedFileDataSource>(DataSource);
+        if(MappedSource){
+            Data = MappedSource->Data() + MappedSource->Position();
+            Size = MappedSource->Size() - MappedSource->Position();
+        }
+        else if(DataSource){
+            std::vector<char> Block;
+            while(DataSource->Read(Block, 1024 * 1024)){
+                OwnedData.insert(OwnedData.end(), Block.begin(), Block.end());
+            }
+            Data = OwnedData.data();
+            Size = OwnedData.size();
+        }
+        Chunks.resize(ThreadCount);
+        CurrentChunk = Chunks.size();
+    }
+
+    // runs task(0) .. task(count - 1) with one thread each, the calling thread takes the first
+    template <typename TTask>
+    static void RunParallel(std::size_t count, TTask task){
+        std::vector<std::thread> Threads;
+        for(std::size_t Index = 1; Index < count; Index++){
+            Threads.emplace_back(task, Index);
+        }
+        if(count){
+            task(0);
+        }
+        for(auto &Thread : Threads){
+            Thread.join();
+        }
+    }
+
+    // moves a chunk boundary so it doesn't land inside a run of quotes or
+    // between the \r and \n of a line ending
+    std::size_t AdjustBoundary(std::size_t boundary) const{
+        if(boundary >= Size){
+            return Size;
+        }
+        while(boundary < Size && boundary > 0 && Data[boundary - 1] == '"' && Data[boundary] == '"'){
+            boundary++;
+        }
+        if(boundary < Size && boundary > 0 && Data[boundary - 1] == '\r' && Data[boundary] == '\n'){
+            boundary++;
+        }
+        return boundary;
+    }
+
+    // parses the next ThreadCount * ChunkSize bytes. The quoted state at each
+    // chunk boundary comes from a quote parity pre-pass, which gives where
+    // the first row of each chunk starts, then the chunks are parsed
+    // independently since every row starts outside of quotes
+    void ParseBatch(){
+        std::vector<std::size_t> Boundaries(ThreadCount + 1);
+        Boundaries[0] = Position;
+        for(std::size_t Index = 1; Index <= ThreadCount; Index++){
+            std::size_t Nominal = Position + std::min(Size - Position, Index * ChunkSize);
+            Boundaries[Index] = std::max(AdjustBoundary(Nominal), Boundaries[Index - 1]);
+        }
+
+        std::vector<char> Parities(ThreadCount);
+        RunParallel(ThreadCount, [&](std::size_t index){
+            Parities[index] = DSVScanner::QuoteParity(Data + Boundaries[index], Data + Boundaries[index + 1]);
+        });
+
+        std::vector<char> InQuotes(ThreadCount + 1, false);
+        for(std::size_t Index = 0; Index < ThreadCount; Index++){
+            InQuotes[Index + 1] = InQuotes[Index] != Parities[Index];
+        }
+
+        std::vector<std::size_t> RowStarts(ThreadCount + 1);
+        RowStarts[0] = Position;
+        RunParallel(ThreadCount, [&](std::size_t index){
+            const char *Start = DSVScanner::NextRowStart(Data, Data + Boundaries[index + 1], Data + Size, Delimiter, InQuotes[index + 1]);
+            RowStarts[index + 1] = Start - Data;
+        });
+
+        RunParallel(ThreadCount, [&](std::size_t index){
+            SChunk &Chunk = Chunks[index];
+            Chunk.Fields.clear();
+            Chunk.RowEnds.clear();
+            Chunk.Scratch.clear();
+            const char *Current = Data + RowStarts[index];
+            const char *End = Data + RowStarts[index + 1];
+            // no row crosses the end of the chunk, so it can be treated as the end of the input
+            while(DSVScanner::ScanRow(Current, End, Delimiter, true, Chunk.Fields, Chunk.Scratch) == DSVScanner::EScanResult::Row){
+                Chunk.RowEnds.push_back(Chunk.Fields.size());
+            }
+        });
+
+        Position = RowStarts[ThreadCount];
+        CurrentChunk = 0;
+        CurrentRow = 0;
+    }
+
+    // moves to the next chunk with rows left, parsing batches as needed
+    bool NextRow(){
+        while(true){
+            while(CurrentChunk < Chunks.size() && CurrentRow >= Chunks[CurrentChunk].RowEnds.size()){
+                CurrentChunk++;
+                CurrentRow = 0;
+            }
+            if(CurrentChunk < Chunks.size()){
+                return true;
+            }
+            if(Position >= Size){
+                return false;
+            }
+            ParseBatch();
+        }
+    }
+
+    bool End(){
+        return !NextRow();
+    }
+
+    bool ReadRowView(std::vector<std::string_view> &row){
+        row.clear();
+        if(!NextRow()){
+            return false;
+        }
+        SChunk &Chunk = Chunks[CurrentChunk];
+        std::size_t FirstField = CurrentRow ? Chunk.RowEnds[CurrentRow - 1] : 0;
+        for(std::size_t Index = FirstField; Index < Chunk.RowEnds[CurrentRow]; Index++){
+            const DSVScanner::SField &Field = Chunk.Fields[Index];
+            if(Field.InScratch){
+                row.emplace_back(Chunk.Scratch.data() + Field.Offset, Field.Length);
+            }
+            else{
+                row.emplace_back(Field.Data, Field.Length);
+            }
+        }
+        CurrentRow++;
+        return true;
+    }
+
+    bool ReadRow(std::vector<std::string> &row){
+        if(!ReadRowView(Views)){
+            row.clear();
+            return false;
+        }
+        row.resize(Views.size());
+        for(std::size_t Index = 0; Index < Views.size(); Index++){
+            row[Index].assign(Views[Index]);
+        }
+        return true;
+    }
+};
+
+CParallelDSVReader::CParallelDSVReader(std::shared_ptr<CDataSource> src, char delimiter, std::size_t threads, std::size_t chunksize)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), delimiter, threads, chunksize)){
+}
+
+CParallelDSVReader::~CParallelDSVReader() = default;
+
+bool CParallelDSVReader::End() const{
+    return DImplementation->End();
+}
+
+bool CParallelDSVReader::ReadRow(std::vector<std::string> &row){
+    return DImplementation->ReadRow(row);
+}
+
+bool CParallelDSVReader::ReadRowView(std::vector<std::string_view> &row){
+    return DImplementation->ReadRowView(row);
+}
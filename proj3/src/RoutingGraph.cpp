@@ -0,0 +1,182 @@
+#include "RoutingGraph.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+struct CRoutingGraph::SImplementation{
+    // an edge before the CSR table is built
+    struct SEdge{
+        TVertexID Source;
+        TVertexID Target;
+        double Length;
+    };
+
+    // vertex data indexed by vertex ID, the node IDs are ascending
+    std::vector<CStreetMap::TNodeID> NodeIDs;
+    std::vector<CStreetMap::TLocation> Locations;
+    // unit vectors of the vertex positions, for the chord distance
+    std::vector<double> X, Y, Z;
+
+    std::vector<TEdgeID> EdgeOffsets;
+    std::vector<TVertexID> EdgeTargets;
+    std::vector<double> EdgeLengths;
+
+    TVertexID VertexByNodeID(CStreetMap::TNodeID id) const noexcept{
+        auto Found = std::lower_bound(NodeIDs.begin(), NodeIDs.end(), id);
+        if(Found != NodeIDs.end() && *Found == id){
+            return TVertexID(Found - NodeIDs.begin());
+        }
+        return InvalidVertexID;
+    }
+
+    // 1 if the way may only be followed in node order, -1 if only against it
+    // and 0 if both directions are allowed
+    static int Direction(const CStreetMap::SWay &way){
+        std::string OneWay = way.GetAttribute("oneway");
+        if(OneWay == "yes" || OneWay == "true" || OneWay == "1"){
+            return 1;
+        }
+        if(OneWay == "-1" || OneWay == "reverse"){
+            return -1;
+        }
+        if(OneWay.empty() && way.GetAttribute("junction") == "roundabout"){
+            return 1;
+        }
+        return 0;
+    }
+
+    SImplementation(const CStreetMap &map){
+        // every node any way references, looked up once each
+        std::vector<CStreetMap::TNodeID> Referenced;
+        for(std::size_t Index = 0; Index < map.WayCount(); Index++){
+            auto Way = map.WayByIndex(Index);
+            for(std::size_t Node = 0; Node < Way->NodeCount(); Node++){
+                Referenced.push_back(Way->GetNodeID(Node));
+            }
+        }
+        std::sort(Referenced.begin(), Referenced.end());
+        Referenced.erase(std::unique(Referenced.begin(), Referenced.end()), Referenced.end());
+        for(auto ID : Referenced){
+            auto Node = map.NodeByID(ID);
+            if(Node){
+                NodeIDs.push_back(ID);
+                Locations.push_back(Node->Location());
+            }
+        }
+        const double DegreesToRadians = M_PI / 180.0;
+        for(auto &Location : Locations){
+            double Latitude = Location.first * DegreesToRadians;
+            double Longitude = Location.second * DegreesToRadians;
+            X.push_back(std::cos(Latitude) * std::cos(Longitude));
+            Y.push_back(std::cos(Latitude) * std::sin(Longitude));
+            Z.push_back(std::sin(Latitude));
+        }
+
+        // consecutive way nodes become edges, a segment touching a node that
+        // isn't in the map is left out
+        std::vector<SEdge> Edges;
+        for(std::size_t Index = 0; Index < map.WayCount(); Index++){
+            auto Way = map.WayByIndex(Index);
+            int WayDirection = Direction(*Way);
+            TVertexID Previous = InvalidVertexID;
+            for(std::size_t Node = 0; Node < Way->NodeCount(); Node++){
+                TVertexID Current = VertexByNodeID(Way->GetNodeID(Node));
+                if(Previous != InvalidVertexID && Current != InvalidVertexID && Previous != Current){
+                    double Length = Haversine(Locations[Previous], Locations[Current]);
+                    if(WayDirection >= 0){
+                        Edges.push_back({Previous, Current, Length});
+                    }
+                    if(WayDirection <= 0){
+                        Edges.push_back({Current, Previous, Length});
+                    }
+                }
+                Previous = Current;
+            }
+        }
+        std::sort(Edges.begin(), Edges.end(), [](const SEdge &left, const SEdge &right){
+            if(left.Source != right.Source){
+                return left.Source < right.Source;
+            }
+            if(left.Target != right.Target){
+                return left.Target < right.Target;
+            }
+            return left.Length < right.Length;
+        });
+
+        EdgeOffsets.assign(NodeIDs.size() + 1, 0);
+        for(std::size_t Index = 0; Index < Edges.size(); Index++){
+            // the shortest of a run of parallel edges sorts first
+            if(Index && Edges[Index].Source == Edges[Index - 1].Source && Edges[Index].Target == Edges[Index - 1].Target){
+                continue;
+            }
+            EdgeTargets.push_back(Edges[Index].Target);
+            EdgeLengths.push_back(Edges[Index].Length);
+            EdgeOffsets[Edges[Index].Source + 1]++;
+        }
+        for(std::size_t Index = 1; Index < EdgeOffsets.size(); Index++){
+            EdgeOffsets[Index] += EdgeOffsets[Index - 1];
+        }
+    }
+};
+
+CRoutingGraph::CRoutingGraph(const CStreetMap &map) : DImplementation(std::make_unique<SImplementation>(map)){
+
+}
+
+CRoutingGraph::~CRoutingGraph() = default;
+
+std::size_t CRoutingGraph::VertexCount() const noexcept{
+    return DImplementation->NodeIDs.size();
+}
+
+std::size_t CRoutingGraph::EdgeCount() const noexcept{
+    return DImplementation->EdgeTargets.size();
+}
+
+CRoutingGraph::TVertexID CRoutingGraph::VertexByNodeID(CStreetMap::TNodeID id) const noexcept{
+    return DImplementation->VertexByNodeID(id);
+}
+
+CStreetMap::TNodeID CRoutingGraph::NodeID(TVertexID vertex) const noexcept{
+    if(vertex < VertexCount()){
+        return DImplementation->NodeIDs[vertex];
+    }
+    return CStreetMap::InvalidNodeID;
+}
+
+CStreetMap::TLocation CRoutingGraph::Location(TVertexID vertex) const noexcept{
+    if(vertex < VertexCount()){
+        return DImplementation->Locations[vertex];
+    }
+    return CStreetMap::TLocation(0.0, 0.0);
+}
+
+const std::vector<CRoutingGraph::TEdgeID> &CRoutingGraph::EdgeOffsets() const noexcept{
+    return DImplementation->EdgeOffsets;
+}
+
+const std::vector<CRoutingGraph::TVertexID> &CRoutingGraph::EdgeTargets() const noexcept{
+    return DImplementation->EdgeTargets;
+}
+
+const std::vector<double> &CRoutingGraph::EdgeLengths() const noexcept{
+    return DImplementation->EdgeLengths;
+}
+
+double CRoutingGraph::ChordDistance(TVertexID left, TVertexID right) const noexcept{
+    const auto &Impl = *DImplementation;
+    double DX = Impl.X[left] - Impl.X[right];
+    double DY = Impl.Y[left] - Impl.Y[right];
+    double DZ = Impl.Z[left] - Impl.Z[right];
+    return EarthRadiusMeters * std::sqrt(DX * DX + DY * DY + DZ * DZ);
+}
+
+double CRoutingGraph::Haversine(const CStreetMap::TLocation &left, const CStreetMap::TLocation &right) noexcept{
+    const double DegreesToRadians = M_PI / 180.0;
+    double LatitudeLeft = left.first * DegreesToRadians;
+    double LatitudeRight = right.first * DegreesToRadians;
+    double HalfLatitude = std::sin((LatitudeRight - LatitudeLeft) / 2.0);
+    double HalfLongitude = std::sin((right.second - left.second) * DegreesToRadians / 2.0);
+    double A = HalfLatitude * HalfLatitude + std::cos(LatitudeLeft) * std::cos(LatitudeRight) * HalfLongitude * HalfLongitude;
+    return 2.0 * EarthRadiusMeters * std::asin(std::sqrt(std::min(1.0, A)));
+}
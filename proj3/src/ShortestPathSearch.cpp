@@ -0,0 +1,169 @@
+#include "ShortestPathSearch.h"
+#include "IndexedHeap.h"
+#include <algorithm>
+
+struct CShortestPathSearch::SImplementation{
+    using TVertexID = CRoutingGraph::TVertexID;
+
+    std::shared_ptr<const CRoutingGraph> Graph;
+    const std::vector<CRoutingGraph::TEdgeID> &EdgeOffsets;
+    const std::vector<TVertexID> &EdgeTargets;
+    const std::vector<double> &EdgeLengths;
+
+    // per vertex state, a vertex has been reached in the current query when
+    // its Stamp matches and settled when its SettledStamp does
+    std::vector<uint32_t> Stamp;
+    std::vector<uint32_t> SettledStamp;
+    // marks the targets of a one to many query
+    std::vector<uint32_t> TargetStamp;
+    std::vector<double> Distance;
+    std::vector<TVertexID> Parent;
+    uint32_t CurrentStamp = 0;
+
+    CIndexedHeap<4> Heap;
+    std::size_t SettledCount = 0;
+
+    SImplementation(std::shared_ptr<const CRoutingGraph> graph)
+        : Graph(std::move(graph)), EdgeOffsets(Graph->EdgeOffsets()), EdgeTargets(Graph->EdgeTargets()), EdgeLengths(Graph->EdgeLengths()){
+        std::size_t VertexCount = Graph->VertexCount();
+        Stamp.assign(VertexCount, 0);
+        SettledStamp.assign(VertexCount, 0);
+        TargetStamp.assign(VertexCount, 0);
+        Distance.resize(VertexCount);
+        Parent.resize(VertexCount);
+        Heap.Resize(VertexCount);
+    }
+
+    // starts a new query, the stamps only need clearing when they wrap around
+    void NewQuery(){
+        if(++CurrentStamp == 0){
+            std::fill(Stamp.begin(), Stamp.end(), 0);
+            std::fill(SettledStamp.begin(), SettledStamp.end(), 0);
+            std::fill(TargetStamp.begin(), TargetStamp.end(), 0);
+            CurrentStamp = 1;
+        }
+        Heap.Clear();
+        SettledCount = 0;
+    }
+
+    bool Reached(TVertexID vertex) const{
+        return Stamp[vertex] == CurrentStamp;
+    }
+
+    bool IsSettled(TVertexID vertex) const{
+        return SettledStamp[vertex] == CurrentStamp;
+    }
+
+    TVertexID Pop(){
+        TVertexID Top = Heap.Pop();
+        SettledStamp[Top] = CurrentStamp;
+        SettledCount++;
+        return Top;
+    }
+
+    // records a tentative distance, inserting the vertex or lowering its key
+    void Relax(TVertexID vertex, TVertexID parent, double distance, double key){
+        if(!Reached(vertex)){
+            Stamp[vertex] = CurrentStamp;
+            Distance[vertex] = distance;
+            Parent[vertex] = parent;
+            Heap.Push(vertex, key);
+        }
+        else if(!IsSettled(vertex) && distance < Distance[vertex]){
+            Distance[vertex] = distance;
+            Parent[vertex] = parent;
+            Heap.Decrease(vertex, key);
+        }
+    }
+
+    // Dijkstra when UseHeuristic is false, A* with the chord distance to dest
+    // otherwise. The chord is scaled down a hair so rounding can't make it
+    // exceed an edge length
+    template <bool UseHeuristic> double Search(TVertexID src, TVertexID dest, std::vector<TVertexID> &path){
+        path.clear();
+        if(src >= Stamp.size() || dest >= Stamp.size()){
+            return NoPathExists;
+        }
+        auto Heuristic = [&](TVertexID vertex){
+            return UseHeuristic ? Graph->ChordDistance(vertex, dest) * (1.0 - 1e-9) : 0.0;
+        };
+        NewQuery();
+        Relax(src, CRoutingGraph::InvalidVertexID, 0.0, Heuristic(src));
+        while(!Heap.Empty()){
+            TVertexID Current = Pop();
+            if(Current == dest){
+                for(TVertexID Vertex = dest; Vertex != CRoutingGraph::InvalidVertexID; Vertex = Parent[Vertex]){
+                    path.push_back(Vertex);
+                }
+                std::reverse(path.begin(), path.end());
+                return Distance[dest];
+            }
+            double CurrentDistance = Distance[Current];
+            for(auto Edge = EdgeOffsets[Current]; Edge < EdgeOffsets[Current + 1]; Edge++){
+                TVertexID Target = EdgeTargets[Edge];
+                double TargetDistance = CurrentDistance + EdgeLengths[Edge];
+                if(!Reached(Target) || (!IsSettled(Target) && TargetDistance < Distance[Target])){
+                    Relax(Target, Current, TargetDistance, TargetDistance + Heuristic(Target));
+                }
+            }
+        }
+        return NoPathExists;
+    }
+
+    void OneToMany(TVertexID src, const std::vector<TVertexID> &targets, std::vector<double> &distances){
+        distances.assign(targets.size(), NoPathExists);
+        if(src >= Stamp.size()){
+            return;
+        }
+        NewQuery();
+        std::size_t Remaining = 0;
+        for(auto Target : targets){
+            if(Target < Stamp.size() && TargetStamp[Target] != CurrentStamp){
+                TargetStamp[Target] = CurrentStamp;
+                Remaining++;
+            }
+        }
+        Relax(src, CRoutingGraph::InvalidVertexID, 0.0, 0.0);
+        while(Remaining && !Heap.Empty()){
+            TVertexID Current = Pop();
+            if(TargetStamp[Current] == CurrentStamp){
+                Remaining--;
+            }
+            double CurrentDistance = Distance[Current];
+            for(auto Edge = EdgeOffsets[Current]; Edge < EdgeOffsets[Current + 1]; Edge++){
+                TVertexID Target = EdgeTargets[Edge];
+                double TargetDistance = CurrentDistance + EdgeLengths[Edge];
+                if(!Reached(Target) || (!IsSettled(Target) && TargetDistance < Distance[Target])){
+                    Relax(Target, Current, TargetDistance, TargetDistance);
+                }
+            }
+        }
+        for(std::size_t Index = 0; Index < targets.size(); Index++){
+            if(targets[Index] < Stamp.size() && IsSettled(targets[Index])){
+                distances[Index] = Distance[targets[Index]];
+            }
+        }
+    }
+};
+
+CShortestPathSearch::CShortestPathSearch(std::shared_ptr<const CRoutingGraph> graph) : DImplementation(std::make_unique<SImplementation>(graph)){
+
+}
+
+CShortestPathSearch::~CShortestPathSearch() = default;
+
+double CShortestPathSearch::Dijkstra(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest, std::vector<CRoutingGraph::TVertexID> &path){
+    return DImplementation->Search<false>(src, dest, path);
+}
+
+double CShortestPathSearch::AStar(CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest, std::vector<CRoutingGraph::TVertexID> &path){
+    return DImplementation->Search<true>(src, dest, path);
+}
+
+void CShortestPathSearch::OneToMany(CRoutingGraph::TVertexID src, const std::vector<CRoutingGraph::TVertexID> &targets, std::vector<double> &distances){
+    DImplementation->OneToMany(src, targets, distances);
+}
+
+std::size_t CShortestPathSearch::SettledCount() const noexcept{
+    return DImplementation->SettledCount;
+}
@@ -0,0 +1,346 @@
+#include "SpatialIndex.h"
+#include "RoutingGraph.h"
+#include <algorithm>
+#include <cmath>
+
+namespace{
+
+const double DegreesToRadians = M_PI / 180.0;
+
+}
+
+// distances are compared as the haversine term a = sin^2(dlat / 2) +
+// cos(lat1) cos(lat2) sin^2(dlon / 2), which grows with distance, and only
+// turned into meters for the results
+struct CSpatialIndex::SImplementation{
+    // grid in radians, cell (x, y) is CellOffsets[y * Width + x]
+    double MinLatitude = 0.0;
+    double MinLongitude = 0.0;
+    double CellLatitude = 1.0;
+    double CellLongitude = 1.0;
+    std::size_t Width = 1;
+    std::size_t Height = 1;
+    // the smallest cosine of any node latitude, bounds how short a degree
+    // of longitude can get anywhere in the index
+    double MinCosine = 1.0;
+
+    // nodes of cell c are CellOffsets[c] up to CellOffsets[c + 1] and the
+    // routable ones come first, up to RoutableEnds[c]
+    std::vector<uint32_t> CellOffsets;
+    std::vector<uint32_t> RoutableEnds;
+    std::vector<double> Latitudes;
+    std::vector<double> Longitudes;
+    std::vector<double> Cosines;
+    std::vector<uint32_t> Indices;
+    std::vector<CStreetMap::TNodeID> NodeIDs;
+    std::size_t RoutableCount = 0;
+
+    SImplementation(const CStreetMap &map){
+        std::vector<CStreetMap::TNodeID> WayNodeIDs;
+        for(std::size_t Index = 0; Index < map.WayCount(); Index++){
+            auto Way = map.WayByIndex(Index);
+            for(std::size_t Node = 0; Way && Node < Way->NodeCount(); Node++){
+                WayNodeIDs.push_back(Way->GetNodeID(Node));
+            }
+        }
+        std::sort(WayNodeIDs.begin(), WayNodeIDs.end());
+        WayNodeIDs.erase(std::unique(WayNodeIDs.begin(), WayNodeIDs.end()), WayNodeIDs.end());
+
+        struct SPoint{
+            double Latitude;
+            double Longitude;
+            uint32_t Index;
+            bool Routable;
+            CStreetMap::TNodeID ID;
+        };
+        std::vector<SPoint> Points;
+        Points.reserve(map.NodeCount());
+        double MaxLatitude = 0.0, MaxLongitude = 0.0;
+        for(std::size_t Index = 0; Index < map.NodeCount(); Index++){
+            auto Node = map.NodeByIndex(Index);
+            if(!Node){
+                continue;
+            }
+            auto Location = Node->Location();
+            SPoint Point{Location.first * DegreesToRadians, Location.second * DegreesToRadians, static_cast<uint32_t>(Index), false, Node->ID()};
+            if(!std::isfinite(Point.Latitude) || !std::isfinite(Point.Longitude)){
+                continue;
+            }
+            Point.Routable = std::binary_search(WayNodeIDs.begin(), WayNodeIDs.end(), Point.ID);
+            if(Points.empty()){
+                MinLatitude = MaxLatitude = Point.Latitude;
+                MinLongitude = MaxLongitude = Point.Longitude;
+            }
+            MinLatitude = std::min(MinLatitude, Point.Latitude);
+            MaxLatitude = std::max(MaxLatitude, Point.Latitude);
+            MinLongitude = std::min(MinLongitude, Point.Longitude);
+            MaxLongitude = std::max(MaxLongitude, Point.Longitude);
+            MinCosine = std::min(MinCosine, std::cos(Point.Latitude));
+            Points.push_back(Point);
+        }
+
+        // about two nodes per cell, with cells close to square on the ground
+        if(!Points.empty()){
+            double Stretch = std::max(std::cos((MinLatitude + MaxLatitude) / 2.0), 1e-6);
+            double Span = std::max(MaxLatitude - MinLatitude, 1e-9);
+            double Breadth = std::max((MaxLongitude - MinLongitude) * Stretch, 1e-9);
+            double Side = std::sqrt(Span * Breadth / std::max<std::size_t>(1, Points.size() / 2));
+            Width = std::max<std::size_t>(1, std::min<std::size_t>(Points.size(), std::ceil(Breadth / Side)));
+            Height = std::max<std::size_t>(1, std::min<std::size_t>(Points.size(), std::ceil(Span / Side)));
+            // a hair wider than the nodes so the largest lands in the last cell
+            CellLatitude = Span * (1.0 + 1e-9) / Height;
+            CellLongitude = std::max(MaxLongitude - MinLongitude, 1e-9) * (1.0 + 1e-9) / Width;
+        }
+
+        // counting sort of the nodes by cell, routable ones first
+        std::vector<uint32_t> Cells(Points.size());
+        std::vector<uint32_t> Counts(Width * Height, 0);
+        std::vector<uint32_t> RoutableCounts(Width * Height, 0);
+        for(std::size_t Index = 0; Index < Points.size(); Index++){
+            Cells[Index] = CellY(Points[Index].Latitude) * Width + CellX(Points[Index].Longitude);
+            Counts[Cells[Index]]++;
+            RoutableCounts[Cells[Index]] += Points[Index].Routable;
+        }
+        CellOffsets.assign(Width * Height + 1, 0);
+        RoutableEnds.resize(Width * Height);
+        for(std::size_t Cell = 0; Cell < Width * Height; Cell++){
+            CellOffsets[Cell + 1] = CellOffsets[Cell] + Counts[Cell];
+            RoutableEnds[Cell] = CellOffsets[Cell] + RoutableCounts[Cell];
+        }
+        std::vector<uint32_t> RoutableNext(CellOffsets.begin(), CellOffsets.end() - 1);
+        std::vector<uint32_t> OtherNext(RoutableEnds);
+        Latitudes.resize(Points.size());
+        Longitudes.resize(Points.size());
+        Cosines.resize(Points.size());
+        Indices.resize(Points.size());
+        NodeIDs.resize(Points.size());
+        for(std::size_t Index = 0; Index < Points.size(); Index++){
+            const SPoint &Point = Points[Index];
+            uint32_t Slot = Point.Routable ? RoutableNext[Cells[Index]]++ : OtherNext[Cells[Index]]++;
+            Latitudes[Slot] = Point.Latitude;
+            Longitudes[Slot] = Point.Longitude;
+            Cosines[Slot] = std::cos(Point.Latitude);
+            Indices[Slot] = Point.Index;
+            NodeIDs[Slot] = Point.ID;
+            RoutableCount += Point.Routable;
+        }
+    }
+
+    // cell coordinates, clamped to the grid for locations outside of it
+    std::size_t CellX(double longitude) const{
+        double X = std::floor((longitude - MinLongitude) / CellLongitude);
+        return X <= 0.0 ? 0 : std::min<std::size_t>(Width - 1, X);
+    }
+
+    std::size_t CellY(double latitude) const{
+        double Y = std::floor((latitude - MinLatitude) / CellLatitude);
+        return Y <= 0.0 ? 0 : std::min<std::size_t>(Height - 1, Y);
+    }
+
+    static double Meters(double term){
+        return 2.0 * CRoutingGraph::EarthRadiusMeters * std::asin(std::sqrt(std::min(1.0, term)));
+    }
+
+    // a location converted once per query
+    struct SQuery{
+        double Latitude;
+        double Longitude;
+        double Cosine;
+    };
+
+    static SQuery MakeQuery(const CStreetMap::TLocation &location){
+        double Latitude = location.first * DegreesToRadians;
+        return {Latitude, location.second * DegreesToRadians, std::cos(Latitude)};
+    }
+
+    double Term(const SQuery &query, std::size_t slot) const{
+        double HalfLatitude = std::sin((Latitudes[slot] - query.Latitude) / 2.0);
+        double HalfLongitude = std::sin((Longitudes[slot] - query.Longitude) / 2.0);
+        return HalfLatitude * HalfLatitude + query.Cosine * Cosines[slot] * HalfLongitude * HalfLongitude;
+    }
+
+    // lower bounds on the haversine term to any node at least the given
+    // latitude or longitude difference away
+    static double LatitudeBound(double gap){
+        double HalfLatitude = std::sin(std::min(std::max(gap, 0.0), M_PI) / 2.0);
+        return HalfLatitude * HalfLatitude;
+    }
+
+    double LongitudeBound(const SQuery &query, double gap) const{
+        double HalfLongitude = std::sin(std::min(std::max(gap, 0.0), M_PI) / 2.0);
+        return query.Cosine * MinCosine * HalfLongitude * HalfLongitude;
+    }
+
+    std::size_t CellEnd(std::size_t cell, bool routableonly) const{
+        return routableonly ? RoutableEnds[cell] : CellOffsets[cell + 1];
+    }
+
+    static bool Closer(const SResult &left, const SResult &right){
+        return left.Distance < right.Distance || (left.Distance == right.Distance && left.Index < right.Index);
+    }
+
+    // searches rings of cells outward from the cell of the location, keeping
+    // the best count candidates in a max heap ordered by Closer, until the
+    // nearest cell outside the rings can't hold anything closer than the worst one
+    void Nearest(const CStreetMap::TLocation &location, std::size_t count, std::vector<SResult> &results, bool routableonly) const{
+        results.clear();
+        if(!count || Indices.empty()){
+            return;
+        }
+        SQuery Query = MakeQuery(location);
+        // Distance holds the haversine term until the end
+        auto Visit = [&](std::size_t cell){
+            for(std::size_t Slot = CellOffsets[cell]; Slot < CellEnd(cell, routableonly); Slot++){
+                SResult Candidate{Indices[Slot], NodeIDs[Slot], Term(Query, Slot)};
+                if(results.size() < count){
+                    results.push_back(Candidate);
+                    std::push_heap(results.begin(), results.end(), Closer);
+                }
+                else if(Closer(Candidate, results.front())){
+                    std::pop_heap(results.begin(), results.end(), Closer);
+                    results.back() = Candidate;
+                    std::push_heap(results.begin(), results.end(), Closer);
+                }
+            }
+        };
+        long CenterX = CellX(Query.Longitude), CenterY = CellY(Query.Latitude);
+        long LastX = Width - 1, LastY = Height - 1;
+        for(long Ring = 0; ; Ring++){
+            long Left = CenterX - Ring, Right = CenterX + Ring, Bottom = CenterY - Ring, Top = CenterY + Ring;
+            for(long Y = std::max(Bottom, 0L); Y <= std::min(Top, LastY); Y++){
+                if(Y == Bottom || Y == Top){
+                    for(long X = std::max(Left, 0L); X <= std::min(Right, LastX); X++){
+                        Visit(Y * Width + X);
+                    }
+                }
+                else{
+                    if(Left >= 0){
+                        Visit(Y * Width + Left);
+                    }
+                    if(Right <= LastX){
+                        Visit(Y * Width + Right);
+                    }
+                }
+            }
+            bool BelowDone = Bottom <= 0, AboveDone = Top >= LastY, LeftDone = Left <= 0, RightDone = Right >= LastX;
+            if(BelowDone && AboveDone && LeftDone && RightDone){
+                break;
+            }
+            if(results.size() == count){
+                double Bound = std::numeric_limits<double>::max();
+                if(!BelowDone){
+                    Bound = std::min(Bound, LatitudeBound(Query.Latitude - (MinLatitude + Bottom * CellLatitude)));
+                }
+                if(!AboveDone){
+                    Bound = std::min(Bound, LatitudeBound((MinLatitude + (Top + 1) * CellLatitude) - Query.Latitude));
+                }
+                if(!LeftDone){
+                    Bound = std::min(Bound, LongitudeBound(Query, Query.Longitude - (MinLongitude + Left * CellLongitude)));
+                }
+                if(!RightDone){
+                    Bound = std::min(Bound, LongitudeBound(Query, (MinLongitude + (Right + 1) * CellLongitude) - Query.Longitude));
+                }
+                if(results.front().Distance < Bound){
+                    break;
+                }
+            }
+        }
+        std::sort_heap(results.begin(), results.end(), Closer);
+        for(auto &Result : results){
+            Result.Distance = Meters(Result.Distance);
+        }
+    }
+
+    // visits the cells overlapping the latitude and longitude ranges in radians
+    template <typename TVisit> void VisitCells(double minlatitude, double maxlatitude, double minlongitude, double maxlongitude, TVisit visit) const{
+        if(Indices.empty() || maxlatitude < MinLatitude || maxlongitude < MinLongitude ||
+           minlatitude > MinLatitude + Height * CellLatitude || minlongitude > MinLongitude + Width * CellLongitude){
+            return;
+        }
+        std::size_t MaxX = CellX(maxlongitude), MaxY = CellY(maxlatitude);
+        for(std::size_t Y = CellY(minlatitude); Y <= MaxY; Y++){
+            for(std::size_t X = CellX(minlongitude); X <= MaxX; X++){
+                visit(Y * Width + X);
+            }
+        }
+    }
+
+    void WithinRadius(const CStreetMap::TLocation &location, double meters, std::vector<SResult> &results, bool routableonly) const{
+        results.clear();
+        if(!(meters >= 0.0)){
+            return;
+        }
+        SQuery Query = MakeQuery(location);
+        double Angle = std::min(meters / CRoutingGraph::EarthRadiusMeters, M_PI);
+        double HalfAngle = std::sin(Angle / 2.0);
+        double MaxTerm = HalfAngle * HalfAngle;
+        // the widest longitude difference LongitudeBound still allows
+        double Spread = Query.Cosine * MinCosine;
+        double LongitudeRange = Spread > 0.0 && HalfAngle < std::sqrt(Spread) ? 2.0 * std::asin(HalfAngle / std::sqrt(Spread)) : 2.0 * M_PI;
+        VisitCells(Query.Latitude - Angle, Query.Latitude + Angle, Query.Longitude - LongitudeRange, Query.Longitude + LongitudeRange, [&](std::size_t cell){
+            for(std::size_t Slot = CellOffsets[cell]; Slot < CellEnd(cell, routableonly); Slot++){
+                double Candidate = Term(Query, Slot);
+                if(Candidate <= MaxTerm){
+                    results.push_back({Indices[Slot], NodeIDs[Slot], Candidate});
+                }
+            }
+        });
+        std::sort(results.begin(), results.end(), Closer);
+        for(auto &Result : results){
+            Result.Distance = Meters(Result.Distance);
+        }
+    }
+
+    void InBoundingBox(const CStreetMap::TLocation &southwest, const CStreetMap::TLocation &northeast, std::vector<SResult> &results, bool routableonly) const{
+        results.clear();
+        double South = southwest.first * DegreesToRadians, West = southwest.second * DegreesToRadians;
+        double North = northeast.first * DegreesToRadians, East = northeast.second * DegreesToRadians;
+        if(!(South <= North) || !(West <= East)){
+            return;
+        }
+        VisitCells(South, North, West, East, [&](std::size_t cell){
+            for(std::size_t Slot = CellOffsets[cell]; Slot < CellEnd(cell, routableonly); Slot++){
+                if(Latitudes[Slot] >= South && Latitudes[Slot] <= North && Longitudes[Slot] >= West && Longitudes[Slot] <= East){
+                    results.push_back({Indices[Slot], NodeIDs[Slot], 0.0});
+                }
+            }
+        });
+    }
+};
+
+CSpatialIndex::CSpatialIndex(const CStreetMap &map) : DImplementation(std::make_unique<SImplementation>(map)){
+
+}
+
+CSpatialIndex::~CSpatialIndex() = default;
+
+std::size_t CSpatialIndex::NodeCount() const noexcept{
+    return DImplementation->Indices.size();
+}
+
+std::size_t CSpatialIndex::RoutableNodeCount() const noexcept{
+    return DImplementation->RoutableCount;
+}
+
+void CSpatialIndex::Nearest(const CStreetMap::TLocation &location, std::size_t count, std::vector<SResult> &results, bool routableonly) const{
+    DImplementation->Nearest(location, count, results, routableonly);
+}
+
+bool CSpatialIndex::Nearest(const CStreetMap::TLocation &location, SResult &result, bool routableonly) const{
+    // the single nearest node is common enough to not need a results vector
+    thread_local std::vector<SResult> Results;
+    DImplementation->Nearest(location, 1, Results, routableonly);
+    if(Results.empty()){
+        return false;
+    }
+    result = Results[0];
+    return true;
+}
+
+void CSpatialIndex::WithinRadius(const CStreetMap::TLocation &location, double meters, std::vector<SResult> &results, bool routableonly) const{
+    DImplementation->WithinRadius(location, meters, results, routableonly);
+}
+
+void CSpatialIndex::InBoundingBox(const CStreetMap::TLocation &southwest, const CStreetMap::TLocation &northeast, std::vector<SResult> &results, bool routableonly) const{
+    DImplementation->InBoundingBox(southwest, northeast, results, routableonly);
+}
@@ -0,0 +1,242 @@
+#include "StopDistanceMatrix.h"
+#include "ShortestPathSearch.h"
+#include "FileDataSink.h"
+#include "MappedFileDataSource.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace{
+
+const char MatrixMagic[8] = {'S', 'T', 'O', 'P', 'D', 'I', 'S', 'T'};
+
+// followed by the stop IDs, the stop node IDs and then the distances
+struct SFileHeader{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t HeaderSize;
+    uint64_t StopCount;
+};
+
+template <typename T> void AppendArray(std::string &buffer, const T *values, std::size_t count){
+    buffer.append(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+}
+
+struct CStopDistanceMatrix::SImplementation{
+    bool Valid = false;
+    std::size_t ThreadCount;
+    std::vector<CBusSystem::TStopID> StopIDs;
+    std::vector<CStreetMap::TNodeID> NodeIDs;
+    // stop index by ID, sorted by ID
+    std::vector<std::pair<CBusSystem::TStopID, std::size_t>> IndexByID;
+
+    std::shared_ptr<const CRoutingGraph> Graph;
+    std::vector<CRoutingGraph::TVertexID> Vertices;
+
+    // a loaded matrix is used in place from the mapping until a row has to
+    // be recomputed, then it is copied into Owned
+    std::shared_ptr<CMappedFileDataSource> Mapping;
+    std::vector<float> Owned;
+    const float *Values = nullptr;
+
+    SImplementation(const CBusSystem &bussystem, std::shared_ptr<const CRoutingGraph> graph, std::size_t threads) : Graph(std::move(graph)){
+        ThreadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        for(std::size_t Index = 0; Index < bussystem.StopCount(); Index++){
+            auto Stop = bussystem.StopByIndex(Index);
+            StopIDs.push_back(Stop ? Stop->ID() : CBusSystem::InvalidStopID);
+            NodeIDs.push_back(Stop ? Stop->NodeID() : CStreetMap::InvalidNodeID);
+        }
+        BuildIndex();
+        Owned.assign(StopIDs.size() * StopIDs.size(), NoPathExists);
+        Values = Owned.data();
+        std::vector<std::size_t> Rows(StopIDs.size());
+        for(std::size_t Index = 0; Index < Rows.size(); Index++){
+            Rows[Index] = Index;
+        }
+        Valid = RecomputeRows(Rows, nullptr);
+    }
+
+    SImplementation(const std::string &filename){
+        ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        // the distances stay mapped and are read a row at a time as stops are looked up
+        auto Source = std::make_shared<CMappedFileDataSource>(filename, CMappedFileDataSource::EAccessPattern::Random);
+        SFileHeader Header;
+        if(!Source->IsOpen() || Source->Size() < sizeof(SFileHeader)){
+            return;
+        }
+        std::memcpy(&Header, Source->Data(), sizeof(SFileHeader));
+        if(std::memcmp(Header.Magic, MatrixMagic, sizeof(MatrixMagic)) || Header.Version != Version || Header.HeaderSize != sizeof(SFileHeader)){
+            return;
+        }
+        // the square can't overflow once the file is known to hold it
+        std::size_t Available = Source->Size() - sizeof(SFileHeader);
+        if(Header.StopCount > Available / (2 * sizeof(uint64_t)) || Available - Header.StopCount * 2 * sizeof(uint64_t) != Header.StopCount * Header.StopCount * sizeof(float)){
+            return;
+        }
+        const char *Current = Source->Data() + sizeof(SFileHeader);
+        StopIDs.resize(Header.StopCount);
+        std::memcpy(StopIDs.data(), Current, Header.StopCount * sizeof(uint64_t));
+        Current += Header.StopCount * sizeof(uint64_t);
+        NodeIDs.resize(Header.StopCount);
+        std::memcpy(NodeIDs.data(), Current, Header.StopCount * sizeof(uint64_t));
+        Current += Header.StopCount * sizeof(uint64_t);
+        // the header and IDs are a multiple of 8 bytes, so the floats are aligned
+        Values = reinterpret_cast<const float *>(Current);
+        Mapping = Source;
+        BuildIndex();
+        Valid = true;
+#endif
+    }
+
+    void BuildIndex(){
+        IndexByID.clear();
+        for(std::size_t Index = 0; Index < StopIDs.size(); Index++){
+            IndexByID.push_back({StopIDs[Index], Index});
+        }
+        std::sort(IndexByID.begin(), IndexByID.end());
+    }
+
+    std::size_t StopIndex(CBusSystem::TStopID id) const{
+        auto Found = std::lower_bound(IndexByID.begin(), IndexByID.end(), std::make_pair(id, std::size_t(0)));
+        return Found != IndexByID.end() && Found->first == id ? Found->second : InvalidIndex;
+    }
+
+    bool RecomputeRows(const std::vector<std::size_t> &indices, std::shared_ptr<const CRoutingGraph> graph){
+        std::size_t StopCount = StopIDs.size();
+        for(auto Index : indices){
+            if(Index >= StopCount){
+                return false;
+            }
+        }
+        if(graph){
+            Graph = std::move(graph);
+            Vertices.clear();
+        }
+        if(!Graph){
+            return false;
+        }
+        if(Vertices.size() != StopCount){
+            Vertices.resize(StopCount);
+            for(std::size_t Index = 0; Index < StopCount; Index++){
+                Vertices[Index] = Graph->VertexByNodeID(NodeIDs[Index]);
+            }
+        }
+        if(Mapping){
+            Owned.assign(Values, Values + StopCount * StopCount);
+            Values = Owned.data();
+            Mapping.reset();
+        }
+
+        // rows take about the same time each, so an atomic counter balances
+        // them across the threads as well as stealing would
+        std::atomic<std::size_t> NextRow(0);
+        auto Worker = [&](){
+            CShortestPathSearch Search(Graph);
+            std::vector<double> Distances;
+            std::size_t Next;
+            while((Next = NextRow.fetch_add(1)) < indices.size()){
+                std::size_t Row = indices[Next];
+                float *Output = Owned.data() + Row * StopCount;
+                if(Vertices[Row] == CRoutingGraph::InvalidVertexID){
+                    std::fill(Output, Output + StopCount, NoPathExists);
+                }
+                else{
+                    Search.OneToMany(Vertices[Row], Vertices, Distances);
+                    for(std::size_t Column = 0; Column < StopCount; Column++){
+                        Output[Column] = Distances[Column] == CShortestPathSearch::NoPathExists ? NoPathExists : static_cast<float>(Distances[Column]);
+                    }
+                }
+                Output[Row] = 0.0f;
+            }
+        };
+        std::size_t Threads = std::min(ThreadCount, indices.size());
+        std::vector<std::thread> Workers;
+        for(std::size_t Index = 1; Index < Threads; Index++){
+            Workers.emplace_back(Worker);
+        }
+        Worker();
+        for(auto &Thread : Workers){
+            Thread.join();
+        }
+        return true;
+    }
+};
+
+CStopDistanceMatrix::CStopDistanceMatrix(const CBusSystem &bussystem, std::shared_ptr<const CRoutingGraph> graph, std::size_t threads)
+    : DImplementation(std::make_unique<SImplementation>(bussystem, std::move(graph), threads)){
+
+}
+
+CStopDistanceMatrix::CStopDistanceMatrix(const std::string &filename) : DImplementation(std::make_unique<SImplementation>(filename)){
+
+}
+
+CStopDistanceMatrix::~CStopDistanceMatrix() = default;
+
+bool CStopDistanceMatrix::IsValid() const noexcept{
+    return DImplementation->Valid;
+}
+
+bool CStopDistanceMatrix::Save(const std::string &filename) const{
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    return false;
+#else
+    if(!DImplementation->Valid){
+        return false;
+    }
+    std::size_t StopCount = DImplementation->StopIDs.size();
+    SFileHeader Header;
+    std::memset(&Header, 0, sizeof(Header));
+    std::memcpy(Header.Magic, MatrixMagic, sizeof(MatrixMagic));
+    Header.Version = Version;
+    Header.HeaderSize = sizeof(SFileHeader);
+    Header.StopCount = StopCount;
+    std::string Buffer(reinterpret_cast<const char *>(&Header), sizeof(Header));
+    AppendArray(Buffer, DImplementation->StopIDs.data(), StopCount);
+    AppendArray(Buffer, DImplementation->NodeIDs.data(), StopCount);
+    // the distances go straight from the matrix to the file
+    std::string_view Values(reinterpret_cast<const char *>(DImplementation->Values), StopCount * StopCount * sizeof(float));
+    return CFileDataSink::ReplaceFile(filename, {Buffer, Values});
+#endif
+}
+
+std::size_t CStopDistanceMatrix::StopCount() const noexcept{
+    return DImplementation->StopIDs.size();
+}
+
+CBusSystem::TStopID CStopDistanceMatrix::StopID(std::size_t index) const noexcept{
+    return index < DImplementation->StopIDs.size() ? DImplementation->StopIDs[index] : CBusSystem::InvalidStopID;
+}
+
+CStreetMap::TNodeID CStopDistanceMatrix::StopNodeID(std::size_t index) const noexcept{
+    return index < DImplementation->NodeIDs.size() ? DImplementation->NodeIDs[index] : CStreetMap::InvalidNodeID;
+}
+
+std::size_t CStopDistanceMatrix::StopIndex(CBusSystem::TStopID id) const noexcept{
+    return DImplementation->StopIndex(id);
+}
+
+float CStopDistanceMatrix::Distance(std::size_t src, std::size_t dest) const noexcept{
+    std::size_t StopCount = DImplementation->StopIDs.size();
+    if(src >= StopCount || dest >= StopCount){
+        return NoPathExists;
+    }
+    return DImplementation->Values[src * StopCount + dest];
+}
+
+const float *CStopDistanceMatrix::Row(std::size_t src) const noexcept{
+    std::size_t StopCount = DImplementation->StopIDs.size();
+    return src < StopCount ? DImplementation->Values + src * StopCount : nullptr;
+}
+
+bool CStopDistanceMatrix::RecomputeRows(const std::vector<std::size_t> &indices, std::shared_ptr<const CRoutingGraph> graph){
+    return DImplementation->RecomputeRows(indices, std::move(graph));
+}
+
+bool CStopDistanceMatrix::RecomputeRow(std::size_t index){
+    return DImplementation->RecomputeRows({index}, nullptr);
+}
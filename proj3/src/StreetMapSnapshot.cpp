@@ -0,0 +1,499 @@
+#include "StreetMapSnapshot.h"
+#include "MappedFileDataSource.h"
+#include "FileDataSink.h"
+#include "StringPool.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+enum ESection : std::size_t{
+    SectionNodeIDs,
+    SectionNodeLatitudes,
+    SectionNodeLongitudes,
+    SectionNodeTagOffsets,
+    SectionNodeTags,
+    SectionNodeIDOrder,
+    SectionWayIDs,
+    SectionWayNodeOffsets,
+    SectionWayNodeIDs,
+    SectionWayTagOffsets,
+    SectionWayTags,
+    SectionWayIDOrder,
+    SectionStringOffsets,
+    SectionStringCharacters,
+    SectionCount
+};
+
+const char SnapshotMagic[8] = {'S','T','M','A','P','S','N','P'};
+
+struct SSection{
+    uint64_t Offset;
+    uint64_t Size;
+};
+
+struct SHeader{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t HeaderSize;
+    SSection Sections[SectionCount];
+    uint64_t FileSize;
+    uint64_t DataChecksum;
+    // covers every header byte before it
+    uint64_t HeaderChecksum;
+};
+
+static_assert(sizeof(SHeader) % 8 == 0, "sections after the header must stay 8 byte aligned");
+
+// a key/value pair of string indices, as stored in the tag sections
+struct STag{
+    uint32_t Key;
+    uint32_t Value;
+};
+
+const uint64_t ChecksumBasis = 0xcbf29ce484222325ULL;
+
+// FNV-1a over 64 bit little-endian words with an extra shift to fold the high
+// bits back down, a short tail is padded with zeros
+uint64_t Checksum(const char *data, std::size_t size, uint64_t hash = ChecksumBasis){
+    std::size_t Index = 0;
+    while(Index < size){
+        uint64_t Word = 0;
+        std::memcpy(&Word, data + Index, std::min<std::size_t>(8, size - Index));
+        hash = (hash ^ Word) * 0x100000001b3ULL;
+        hash ^= hash >> 29;
+        Index += 8;
+    }
+    return hash;
+}
+
+template <typename T> void AppendArray(std::string &section, const std::vector<T> &values){
+    section.append(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+// indices sorted by ID, left empty when the IDs are already ascending. The
+// sort is stable so duplicate IDs resolve to the first one, like COpenStreetMap
+std::vector<uint64_t> IDOrder(const std::vector<uint64_t> &ids){
+    std::vector<uint64_t> Order;
+    if(std::is_sorted(ids.begin(), ids.end())){
+        return Order;
+    }
+    Order.resize(ids.size());
+    for(std::size_t Index = 0; Index < Order.size(); Index++){
+        Order[Index] = Index;
+    }
+    std::stable_sort(Order.begin(), Order.end(), [&ids](uint64_t left, uint64_t right){
+        return ids[left] < ids[right];
+    });
+    return Order;
+}
+
+}
+
+struct CStreetMapSnapshot::SImplementation{
+    // a section of the mapped file viewed as an array
+    template <typename T> struct SArray{
+        const T *Data = nullptr;
+        std::size_t Count = 0;
+
+        T operator[](std::size_t index) const noexcept{
+            return Data[index];
+        }
+    };
+
+    // the mapped file and the sections inside it, shared with the views so
+    // they stay valid after the snapshot object is gone
+    struct SMapping{
+        std::shared_ptr<CMappedFileDataSource> Source;
+        SArray<uint64_t> NodeIDs;
+        SArray<double> NodeLatitudes;
+        SArray<double> NodeLongitudes;
+        SArray<uint64_t> NodeTagOffsets;
+        SArray<STag> NodeTags;
+        SArray<uint64_t> NodeIDOrder;
+        SArray<uint64_t> WayIDs;
+        SArray<uint64_t> WayNodeOffsets;
+        SArray<uint64_t> WayNodeIDs;
+        SArray<uint64_t> WayTagOffsets;
+        SArray<STag> WayTags;
+        SArray<uint64_t> WayIDOrder;
+        SArray<uint64_t> StringOffsets;
+        SArray<char> StringCharacters;
+
+        // the offsets aren't checked when the file is opened, every range read
+        // from them is checked here so a damaged file can't read out of bounds
+        static bool Range(const SArray<uint64_t> &offsets, std::size_t index, std::size_t limit, std::size_t &begin, std::size_t &end) noexcept{
+            begin = offsets[index];
+            end = offsets[index + 1];
+            if(begin > end || end > limit){
+                begin = end = 0;
+                return false;
+            }
+            return true;
+        }
+
+        std::string_view String(uint32_t index) const noexcept{
+            std::size_t Begin, End;
+            if(index + 1 >= StringOffsets.Count || !Range(StringOffsets, index, StringCharacters.Count, Begin, End)){
+                return std::string_view();
+            }
+            return std::string_view(StringCharacters.Data + Begin, End - Begin);
+        }
+
+        // looks up a key among tags [begin, end), returns end if it isn't there
+        std::size_t FindTag(const SArray<STag> &tags, std::size_t begin, std::size_t end, const std::string &key) const noexcept{
+            for(std::size_t Index = begin; Index < end; Index++){
+                if(String(tags[Index].Key) == key){
+                    return Index;
+                }
+            }
+            return end;
+        }
+
+        // binary search for an ID, returns ids.Count if it isn't found
+        static std::size_t FindID(const SArray<uint64_t> &ids, const SArray<uint64_t> &order, uint64_t id) noexcept{
+            if(!order.Count){
+                auto Found = std::lower_bound(ids.Data, ids.Data + ids.Count, id);
+                if(Found != ids.Data + ids.Count && *Found == id){
+                    return Found - ids.Data;
+                }
+                return ids.Count;
+            }
+            auto Found = std::lower_bound(order.Data, order.Data + order.Count, id, [&ids](uint64_t index, uint64_t value){
+                return index < ids.Count && ids[index] < value;
+            });
+            if(Found != order.Data + order.Count && *Found < ids.Count && ids[*Found] == id){
+                return *Found;
+            }
+            return ids.Count;
+        }
+    };
+
+    class SNodeView;
+    class SWayView;
+
+    std::shared_ptr<SMapping> Mapping;
+    bool Open = false;
+
+    // points Array at a section, checking that it fits the file and holds
+    // whole elements
+    template <typename T> static bool MapSection(const SHeader &header, const CMappedFileDataSource &source, ESection section, SArray<T> &array){
+        const SSection &Section = header.Sections[section];
+        if(Section.Offset % 8 || Section.Offset < sizeof(SHeader) || Section.Offset > source.Size() || Section.Size > source.Size() - Section.Offset || Section.Size % sizeof(T)){
+            return false;
+        }
+        array.Data = reinterpret_cast<const T *>(source.Data() + Section.Offset);
+        array.Count = Section.Size / sizeof(T);
+        return true;
+    }
+
+    // the last entry of an offset table has to match the size of the table it indexes
+    static bool CheckOffsets(const SArray<uint64_t> &offsets, std::size_t count, std::size_t limit){
+        return offsets.Count == count + 1 && offsets[0] == 0 && offsets[count] == limit;
+    }
+
+    SImplementation(const std::string &filename){
+        // the sections are used in place, which only works on little-endian hosts
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        // only the pages a query touches are read
+        auto Source = std::make_shared<CMappedFileDataSource>(filename, CMappedFileDataSource::EAccessPattern::Random);
+        SHeader Header;
+        if(!Source->IsOpen() || Source->Size() < sizeof(SHeader)){
+            return;
+        }
+        std::memcpy(&Header, Source->Data(), sizeof(SHeader));
+        if(std::memcmp(Header.Magic, SnapshotMagic, sizeof(SnapshotMagic)) || Header.Version != Version || Header.HeaderSize != sizeof(SHeader)){
+            return;
+        }
+        if(Header.HeaderChecksum != Checksum(Source->Data(), offsetof(SHeader, HeaderChecksum)) || Header.FileSize != Source->Size()){
+            return;
+        }
+        auto NewMapping = std::make_shared<SMapping>();
+        NewMapping->Source = Source;
+        SMapping &M = *NewMapping;
+        if(!MapSection(Header, *Source, SectionNodeIDs, M.NodeIDs) ||
+           !MapSection(Header, *Source, SectionNodeLatitudes, M.NodeLatitudes) ||
+           !MapSection(Header, *Source, SectionNodeLongitudes, M.NodeLongitudes) ||
+           !MapSection(Header, *Source, SectionNodeTagOffsets, M.NodeTagOffsets) ||
+           !MapSection(Header, *Source, SectionNodeTags, M.NodeTags) ||
+           !MapSection(Header, *Source, SectionNodeIDOrder, M.NodeIDOrder) ||
+           !MapSection(Header, *Source, SectionWayIDs, M.WayIDs) ||
+           !MapSection(Header, *Source, SectionWayNodeOffsets, M.WayNodeOffsets) ||
+           !MapSection(Header, *Source, SectionWayNodeIDs, M.WayNodeIDs) ||
+           !MapSection(Header, *Source, SectionWayTagOffsets, M.WayTagOffsets) ||
+           !MapSection(Header, *Source, SectionWayTags, M.WayTags) ||
+           !MapSection(Header, *Source, SectionWayIDOrder, M.WayIDOrder) ||
+           !MapSection(Header, *Source, SectionStringOffsets, M.StringOffsets) ||
+           !MapSection(Header, *Source, SectionStringCharacters, M.StringCharacters)){
+            return;
+        }
+        std::size_t NodeCount = M.NodeIDs.Count;
+        std::size_t WayCount = M.WayIDs.Count;
+        if(M.NodeLatitudes.Count != NodeCount || M.NodeLongitudes.Count != NodeCount || (M.NodeIDOrder.Count && M.NodeIDOrder.Count != NodeCount)){
+            return;
+        }
+        if(M.WayIDOrder.Count && M.WayIDOrder.Count != WayCount){
+            return;
+        }
+        if(!M.StringOffsets.Count || !CheckOffsets(M.StringOffsets, M.StringOffsets.Count - 1, M.StringCharacters.Count)){
+            return;
+        }
+        if(!CheckOffsets(M.NodeTagOffsets, NodeCount, M.NodeTags.Count) ||
+           !CheckOffsets(M.WayNodeOffsets, WayCount, M.WayNodeIDs.Count) ||
+           !CheckOffsets(M.WayTagOffsets, WayCount, M.WayTags.Count)){
+            return;
+        }
+        Mapping = NewMapping;
+        Open = true;
+#endif
+    }
+};
+
+// node view, only an index into the mapped sections
+class CStreetMapSnapshot::SImplementation::SNodeView : public CStreetMap::SNode{
+    private:
+        std::shared_ptr<const SMapping> DMapping;
+        std::size_t DIndex;
+        std::size_t DTagBegin;
+        std::size_t DTagEnd;
+
+    public:
+        SNodeView(std::shared_ptr<const SMapping> mapping, std::size_t index) : DMapping(std::move(mapping)), DIndex(index){
+            SMapping::Range(DMapping->NodeTagOffsets, DIndex, DMapping->NodeTags.Count, DTagBegin, DTagEnd);
+        }
+
+        TNodeID ID() const noexcept override{
+            return DMapping->NodeIDs[DIndex];
+        }
+
+        TLocation Location() const noexcept override{
+            return TLocation(DMapping->NodeLatitudes[DIndex], DMapping->NodeLongitudes[DIndex]);
+        }
+
+        std::size_t AttributeCount() const noexcept override{
+            return DTagEnd - DTagBegin;
+        }
+
+        std::string GetAttributeKey(std::size_t index) const noexcept override{
+            if(index < AttributeCount()){
+                return std::string(DMapping->String(DMapping->NodeTags[DTagBegin + index].Key));
+            }
+            return "";
+        }
+
+        bool HasAttribute(const std::string &key) const noexcept override{
+            return DMapping->FindTag(DMapping->NodeTags, DTagBegin, DTagEnd, key) != DTagEnd;
+        }
+
+        std::string GetAttribute(const std::string &key) const noexcept override{
+            std::size_t Found = DMapping->FindTag(DMapping->NodeTags, DTagBegin, DTagEnd, key);
+            if(Found != DTagEnd){
+                return std::string(DMapping->String(DMapping->NodeTags[Found].Value));
+            }
+            return "";
+        }
+};
+
+// way view, only an index into the mapped sections
+class CStreetMapSnapshot::SImplementation::SWayView : public CStreetMap::SWay{
+    private:
+        std::shared_ptr<const SMapping> DMapping;
+        std::size_t DIndex;
+        std::size_t DNodeBegin;
+        std::size_t DNodeEnd;
+        std::size_t DTagBegin;
+        std::size_t DTagEnd;
+
+    public:
+        SWayView(std::shared_ptr<const SMapping> mapping, std::size_t index) : DMapping(std::move(mapping)), DIndex(index){
+            SMapping::Range(DMapping->WayNodeOffsets, DIndex, DMapping->WayNodeIDs.Count, DNodeBegin, DNodeEnd);
+            SMapping::Range(DMapping->WayTagOffsets, DIndex, DMapping->WayTags.Count, DTagBegin, DTagEnd);
+        }
+
+        TWayID ID() const noexcept override{
+            return DMapping->WayIDs[DIndex];
+        }
+
+        std::size_t NodeCount() const noexcept override{
+            return DNodeEnd - DNodeBegin;
+        }
+
+        TNodeID GetNodeID(std::size_t index) const noexcept override{
+            if(index < NodeCount()){
+                return DMapping->WayNodeIDs[DNodeBegin + index];
+            }
+            return CStreetMap::InvalidNodeID;
+        }
+
+        std::size_t AttributeCount() const noexcept override{
+            return DTagEnd - DTagBegin;
+        }
+
+        std::string GetAttributeKey(std::size_t index) const noexcept override{
+            if(index < AttributeCount()){
+                return std::string(DMapping->String(DMapping->WayTags[DTagBegin + index].Key));
+            }
+            return "";
+        }
+
+        bool HasAttribute(const std::string &key) const noexcept override{
+            return DMapping->FindTag(DMapping->WayTags, DTagBegin, DTagEnd, key) != DTagEnd;
+        }
+
+        std::string GetAttribute(const std::string &key) const noexcept override{
+            std::size_t Found = DMapping->FindTag(DMapping->WayTags, DTagBegin, DTagEnd, key);
+            if(Found != DTagEnd){
+                return std::string(DMapping->String(DMapping->WayTags[Found].Value));
+            }
+            return "";
+        }
+};
+
+CStreetMapSnapshot::CStreetMapSnapshot(const std::string &filename) : DImplementation(std::make_unique<SImplementation>(filename)){
+
+}
+
+CStreetMapSnapshot::~CStreetMapSnapshot() = default;
+
+bool CStreetMapSnapshot::Save(const CStreetMap &map, const std::string &filename){
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    return false;
+#else
+    std::vector<std::string> Sections(SectionCount);
+    CStringPool Strings;
+    std::vector<STag> Tags;
+    std::vector<uint64_t> Offsets;
+
+    // appends the attributes of a node or way to Tags in their original order
+    auto AddAttributes = [&](const auto &element){
+        for(std::size_t Index = 0; Index < element.AttributeCount(); Index++){
+            std::string Key = element.GetAttributeKey(Index);
+            Tags.push_back({Strings.Intern(Key), Strings.Intern(element.GetAttribute(Key))});
+        }
+        Offsets.push_back(Tags.size());
+    };
+
+    std::vector<uint64_t> IDs;
+    std::vector<double> Latitudes, Longitudes;
+    Offsets.push_back(0);
+    for(std::size_t Index = 0; Index < map.NodeCount(); Index++){
+        auto Node = map.NodeByIndex(Index);
+        if(!Node){
+            return false;
+        }
+        IDs.push_back(Node->ID());
+        auto Location = Node->Location();
+        Latitudes.push_back(Location.first);
+        Longitudes.push_back(Location.second);
+        AddAttributes(*Node);
+    }
+    AppendArray(Sections[SectionNodeIDs], IDs);
+    AppendArray(Sections[SectionNodeLatitudes], Latitudes);
+    AppendArray(Sections[SectionNodeLongitudes], Longitudes);
+    AppendArray(Sections[SectionNodeTagOffsets], Offsets);
+    AppendArray(Sections[SectionNodeTags], Tags);
+    AppendArray(Sections[SectionNodeIDOrder], IDOrder(IDs));
+
+    IDs.clear();
+    Tags.clear();
+    Offsets.assign(1, 0);
+    std::vector<uint64_t> NodeOffsets(1, 0);
+    std::vector<uint64_t> NodeIDs;
+    for(std::size_t Index = 0; Index < map.WayCount(); Index++){
+        auto Way = map.WayByIndex(Index);
+        if(!Way){
+            return false;
+        }
+        IDs.push_back(Way->ID());
+        for(std::size_t Node = 0; Node < Way->NodeCount(); Node++){
+            NodeIDs.push_back(Way->GetNodeID(Node));
+        }
+        NodeOffsets.push_back(NodeIDs.size());
+        AddAttributes(*Way);
+    }
+    AppendArray(Sections[SectionWayIDs], IDs);
+    AppendArray(Sections[SectionWayNodeOffsets], NodeOffsets);
+    AppendArray(Sections[SectionWayNodeIDs], NodeIDs);
+    AppendArray(Sections[SectionWayTagOffsets], Offsets);
+    AppendArray(Sections[SectionWayTags], Tags);
+    AppendArray(Sections[SectionWayIDOrder], IDOrder(IDs));
+    AppendArray(Sections[SectionStringOffsets], Strings.Offsets());
+    Sections[SectionStringCharacters] = Strings.Characters();
+
+    SHeader Header;
+    std::memset(&Header, 0, sizeof(Header));
+    std::memcpy(Header.Magic, SnapshotMagic, sizeof(SnapshotMagic));
+    Header.Version = Version;
+    Header.HeaderSize = sizeof(SHeader);
+    Header.DataChecksum = ChecksumBasis;
+    uint64_t Offset = sizeof(SHeader);
+    for(std::size_t Index = 0; Index < SectionCount; Index++){
+        Header.Sections[Index] = {Offset, Sections[Index].size()};
+        // pad so the next section starts 8 byte aligned
+        Sections[Index].resize((Sections[Index].size() + 7) & ~std::size_t(7), '\0');
+        Header.DataChecksum = Checksum(Sections[Index].data(), Sections[Index].size(), Header.DataChecksum);
+        Offset += Sections[Index].size();
+    }
+    Header.FileSize = Offset;
+    Header.HeaderChecksum = Checksum(reinterpret_cast<const char *>(&Header), offsetof(SHeader, HeaderChecksum));
+
+    std::vector<std::string_view> Pieces{std::string_view(reinterpret_cast<const char *>(&Header), sizeof(Header))};
+    Pieces.insert(Pieces.end(), Sections.begin(), Sections.end());
+    return CFileDataSink::ReplaceFile(filename, Pieces);
+#endif
+}
+
+bool CStreetMapSnapshot::IsOpen() const noexcept{
+    return DImplementation->Open;
+}
+
+bool CStreetMapSnapshot::Verify() const noexcept{
+    if(!DImplementation->Open){
+        return false;
+    }
+    auto &Source = *DImplementation->Mapping->Source;
+    SHeader Header;
+    std::memcpy(&Header, Source.Data(), sizeof(SHeader));
+    return Header.DataChecksum == Checksum(Source.Data() + sizeof(SHeader), Source.Size() - sizeof(SHeader));
+}
+
+std::size_t CStreetMapSnapshot::NodeCount() const noexcept{
+    return DImplementation->Open ? DImplementation->Mapping->NodeIDs.Count : 0;
+}
+
+std::size_t CStreetMapSnapshot::WayCount() const noexcept{
+    return DImplementation->Open ? DImplementation->Mapping->WayIDs.Count : 0;
+}
+
+std::shared_ptr<CStreetMap::SNode> CStreetMapSnapshot::NodeByIndex(std::size_t index) const noexcept{
+    if(index < NodeCount()){
+        return std::make_shared<SImplementation::SNodeView>(DImplementation->Mapping, index);
+    }
+    return nullptr;
+}
+
+std::shared_ptr<CStreetMap::SNode> CStreetMapSnapshot::NodeByID(TNodeID id) const noexcept{
+    if(!DImplementation->Open){
+        return nullptr;
+    }
+    auto &Mapping = *DImplementation->Mapping;
+    return NodeByIndex(SImplementation::SMapping::FindID(Mapping.NodeIDs, Mapping.NodeIDOrder, id));
+}
+
+std::shared_ptr<CStreetMap::SWay> CStreetMapSnapshot::WayByIndex(std::size_t index) const noexcept{
+    if(index < WayCount()){
+        return std::make_shared<SImplementation::SWayView>(DImplementation->Mapping, index);
+    }
+    return nullptr;
+}
+
+std::shared_ptr<CStreetMap::SWay> CStreetMapSnapshot::WayByID(TWayID id) const noexcept{
+    if(!DImplementation->Open){
+        return nullptr;
+    }
+    auto &Mapping = *DImplementation->Mapping;
+    return WayByIndex(SImplementation::SMapping::FindID(Mapping.WayIDs, Mapping.WayIDOrder, id));
+}
@@ -0,0 +1,237 @@
+#include "StreetNameIndex.h"
+#include "StringUtils.h"
+#include <algorithm>
+#include <cctype>
+
+namespace{
+
+const char *NameKeys[] = {"name", "name_1", "ref"};
+
+// the distinct trigrams of a name padded with two spaces in front and one
+// behind, so short names and the first letters still get a few
+void Trigrams(const std::string &name, std::vector<uint32_t> &trigrams){
+    std::string Padded = "  " + name + " ";
+    trigrams.clear();
+    for(std::size_t Index = 0; Index + 2 < Padded.size(); Index++){
+        trigrams.push_back((uint32_t(uint8_t(Padded[Index])) << 16) | (uint32_t(uint8_t(Padded[Index + 1])) << 8) | uint8_t(Padded[Index + 2]));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+}
+
+// names, trigram postings and name lengths are all in compressed sparse row
+// form, the ways named Names[n] are NameWays[NameWayOffsets[n]] up to
+// NameWays[NameWayOffsets[n + 1]]
+struct CStreetNameIndex::SImplementation{
+    std::vector<std::string> Names;
+    std::vector<uint32_t> NameWayOffsets;
+    std::vector<uint32_t> NameWays;
+    // indexed by way index, for the results
+    std::vector<CStreetMap::TWayID> WayIDs;
+    std::size_t NamedWayCount = 0;
+
+    // the names holding TrigramKeys[t] are TrigramNames[TrigramOffsets[t]]
+    // up to TrigramNames[TrigramOffsets[t + 1]]
+    std::vector<uint32_t> TrigramKeys;
+    std::vector<uint32_t> TrigramOffsets;
+    std::vector<uint32_t> TrigramNames;
+
+    // names in order of length, those of length l start at LengthOffsets[l],
+    // for queries too short for the trigram count to rule anything out
+    std::vector<uint32_t> LengthOrder;
+    std::vector<uint32_t> LengthOffsets;
+
+    SImplementation(const CStreetMap &map){
+        std::vector<std::pair<std::string, uint32_t>> Entries;
+        WayIDs.resize(map.WayCount(), +CStreetMap::InvalidWayID);
+        for(std::size_t Index = 0; Index < map.WayCount(); Index++){
+            auto Way = map.WayByIndex(Index);
+            if(!Way){
+                continue;
+            }
+            WayIDs[Index] = Way->ID();
+            bool Named = false;
+            for(auto Key : NameKeys){
+                if(!Way->HasAttribute(Key)){
+                    continue;
+                }
+                // refs like "I 80;CA 113" list several names
+                StringUtils::SplitView(Way->GetAttribute(Key), ";", [&](std::string_view part){
+                    std::string Name = Normalize(part);
+                    if(!Name.empty()){
+                        Entries.push_back({Name, static_cast<uint32_t>(Index)});
+                        Named = true;
+                    }
+                });
+            }
+            NamedWayCount += Named ? 1 : 0;
+        }
+        std::sort(Entries.begin(), Entries.end());
+        Entries.erase(std::unique(Entries.begin(), Entries.end()), Entries.end());
+
+        NameWays.reserve(Entries.size());
+        for(auto &Entry : Entries){
+            if(Names.empty() || Names.back() != Entry.first){
+                Names.push_back(Entry.first);
+                NameWayOffsets.push_back(NameWays.size());
+            }
+            NameWays.push_back(Entry.second);
+        }
+        NameWayOffsets.push_back(NameWays.size());
+
+        std::vector<std::pair<uint32_t, uint32_t>> Postings;
+        std::vector<uint32_t> NameTrigrams;
+        std::size_t MaxLength = 0;
+        for(std::size_t Name = 0; Name < Names.size(); Name++){
+            Trigrams(Names[Name], NameTrigrams);
+            for(auto Trigram : NameTrigrams){
+                Postings.push_back({Trigram, static_cast<uint32_t>(Name)});
+            }
+            MaxLength = std::max(MaxLength, Names[Name].size());
+        }
+        // names are added in order so a stable sort leaves each posting list sorted
+        std::stable_sort(Postings.begin(), Postings.end(), [](const auto &left, const auto &right){
+            return left.first < right.first;
+        });
+        TrigramNames.reserve(Postings.size());
+        for(auto &Posting : Postings){
+            if(TrigramKeys.empty() || TrigramKeys.back() != Posting.first){
+                TrigramKeys.push_back(Posting.first);
+                TrigramOffsets.push_back(TrigramNames.size());
+            }
+            TrigramNames.push_back(Posting.second);
+        }
+        TrigramOffsets.push_back(TrigramNames.size());
+
+        LengthOffsets.assign(MaxLength + 2, 0);
+        for(auto &Name : Names){
+            LengthOffsets[Name.size() + 1]++;
+        }
+        for(std::size_t Length = 1; Length < LengthOffsets.size(); Length++){
+            LengthOffsets[Length] += LengthOffsets[Length - 1];
+        }
+        LengthOrder.resize(Names.size());
+        std::vector<uint32_t> Next(LengthOffsets.begin(), LengthOffsets.end() - 1);
+        for(std::size_t Name = 0; Name < Names.size(); Name++){
+            LengthOrder[Next[Names[Name].size()]++] = Name;
+        }
+    }
+
+    // names that could be within maxdistance of query
+    void Candidates(const std::string &query, int maxdistance, std::vector<uint32_t> &candidates) const{
+        candidates.clear();
+        std::size_t MinLength = query.size() > std::size_t(maxdistance) ? query.size() - maxdistance : 0;
+        std::size_t MaxLength = query.size() + maxdistance;
+        thread_local std::vector<uint32_t> QueryTrigrams;
+        Trigrams(query, QueryTrigrams);
+        // an edit touches at most three trigrams, so a name within
+        // maxdistance still holds all but 3 * maxdistance of the query's
+        long Required = long(QueryTrigrams.size()) - 3 * long(maxdistance);
+        if(Required <= 0){
+            for(std::size_t Length = MinLength; Length <= MaxLength && Length + 1 < LengthOffsets.size(); Length++){
+                candidates.insert(candidates.end(), LengthOrder.begin() + LengthOffsets[Length], LengthOrder.begin() + LengthOffsets[Length + 1]);
+            }
+            return;
+        }
+        // shared trigram counts, reset through the touched list after every query
+        thread_local std::vector<uint32_t> Counts;
+        thread_local std::vector<uint32_t> Touched;
+        if(Counts.size() < Names.size()){
+            Counts.resize(Names.size(), 0);
+        }
+        Touched.clear();
+        for(auto Trigram : QueryTrigrams){
+            auto Found = std::lower_bound(TrigramKeys.begin(), TrigramKeys.end(), Trigram);
+            if(Found == TrigramKeys.end() || *Found != Trigram){
+                continue;
+            }
+            std::size_t Key = Found - TrigramKeys.begin();
+            for(auto Posting = TrigramOffsets[Key]; Posting < TrigramOffsets[Key + 1]; Posting++){
+                auto Name = TrigramNames[Posting];
+                if(!Counts[Name]++){
+                    Touched.push_back(Name);
+                }
+            }
+        }
+        for(auto Name : Touched){
+            if(long(Counts[Name]) >= Required && Names[Name].size() >= MinLength && Names[Name].size() <= MaxLength){
+                candidates.push_back(Name);
+            }
+            Counts[Name] = 0;
+        }
+    }
+};
+
+CStreetNameIndex::CStreetNameIndex(const CStreetMap &map){
+    DImplementation = std::make_unique<SImplementation>(map);
+}
+
+CStreetNameIndex::~CStreetNameIndex() = default;
+
+std::size_t CStreetNameIndex::NameCount() const noexcept{
+    return DImplementation->Names.size();
+}
+
+std::size_t CStreetNameIndex::WayCount() const noexcept{
+    return DImplementation->NamedWayCount;
+}
+
+std::string CStreetNameIndex::Normalize(std::string_view name){
+    std::string Result;
+    Result.reserve(name.size());
+    bool Space = false;
+    for(char Ch : name){
+        if(std::isalnum(static_cast<unsigned char>(Ch))){
+            if(Space && !Result.empty()){
+                Result += ' ';
+            }
+            Space = false;
+            Result += std::tolower(static_cast<unsigned char>(Ch));
+        }
+        else{
+            Space = true;
+        }
+    }
+    return Result;
+}
+
+void CStreetNameIndex::Search(const std::string &name, int maxdistance, std::size_t count, std::vector<SResult> &results) const{
+    results.clear();
+    std::string Query = Normalize(name);
+    if(Query.empty() || maxdistance < 0 || !count){
+        return;
+    }
+    thread_local std::vector<uint32_t> Candidates;
+    DImplementation->Candidates(Query, maxdistance, Candidates);
+    struct SMatch{
+        uint32_t Way;
+        int Distance;
+        uint32_t Name;
+    };
+    std::vector<SMatch> Matches;
+    for(auto Name : Candidates){
+        int Distance = StringUtils::EditDistance(Query, DImplementation->Names[Name], false, maxdistance);
+        if(Distance > maxdistance){
+            continue;
+        }
+        for(auto Way = DImplementation->NameWayOffsets[Name]; Way < DImplementation->NameWayOffsets[Name + 1]; Way++){
+            Matches.push_back({DImplementation->NameWays[Way], Distance, Name});
+        }
+    }
+    // one result per way with its closest name, the first in name order on ties
+    std::sort(Matches.begin(), Matches.end(), [](const SMatch &left, const SMatch &right){
+        return left.Way != right.Way ? left.Way < right.Way : left.Distance != right.Distance ? left.Distance < right.Distance : left.Name < right.Name;
+    });
+    Matches.erase(std::unique(Matches.begin(), Matches.end(), [](const SMatch &left, const SMatch &right){
+        return left.Way == right.Way;
+    }), Matches.end());
+    std::stable_sort(Matches.begin(), Matches.end(), [](const SMatch &left, const SMatch &right){
+        return left.Distance < right.Distance;
+    });
+    Matches.resize(std::min(Matches.size(), count));
+    for(auto &Match : Matches){
+        results.push_back({Match.Way, DImplementation->WayIDs[Match.Way], Match.Distance, DImplementation->Names[Match.Name]});
+    }
+}
@@ -5,11 +5,16 @@ const std::string &CStringDataSink::String() const{
 }
 
 bool CStringDataSink::Put(const char &ch) noexcept{
-    DString += std::string(1,ch);
+    DString.push_back(ch);
     return true;
 }
 
 bool CStringDataSink::Write(const std::vector<char> &buf) noexcept{
-    DString += std::string(buf.data(),buf.size());
+    DString.append(buf.data(),buf.size());
+    return true;
+}
+
+bool CStringDataSink::Write(const char *buf, std::size_t count) noexcept{
+    DString.append(buf,count);
     return true;
 }
@@ -26,15 +26,11 @@ bool CStringDataSource::Peek(char &ch) noexcept{
 }
 
 bool CStringDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
-    buf.clear();
-    while(buf.size() < count){
-        char TempChar;
-        if(Get(TempChar)){
-            buf.push_back(TempChar);
-        }
-        else{
-            break;
-        }
+    std::size_t Remaining = DIndex < DString.length() ? DString.length() - DIndex : 0;
+    if(count > Remaining){
+        count = Remaining;
     }
+    buf.assign(DString.begin() + DIndex, DString.begin() + DIndex + count);
+    DIndex += count;
     return !buf.empty();
 }
@@ -0,0 +1,48 @@
+#include "StringPool.h"
+#include <functional>
+
+std::size_t CStringPool::Slot(std::string_view str) const noexcept{
+    return std::hash<std::string_view>()(str) & (DSlots.size() - 1);
+}
+
+// doubles the hash table and reinserts every string
+void CStringPool::Grow(){
+    std::size_t SlotCount = 64;
+    while(SlotCount < (Count() + 1) * 2){
+        SlotCount *= 2;
+    }
+    DSlots.assign(SlotCount, 0);
+    for(uint32_t Index = 0; Index < Count(); Index++){
+        std::size_t CurrentSlot = Slot(String(Index));
+        while(DSlots[CurrentSlot]){
+            CurrentSlot = (CurrentSlot + 1) & (DSlots.size() - 1);
+        }
+        DSlots[CurrentSlot] = Index + 1;
+    }
+}
+
+uint32_t CStringPool::Intern(std::string_view str){
+    // keep the table at most half full so probe runs stay short
+    if(DSlots.size() < (Count() + 1) * 2){
+        Grow();
+    }
+    std::size_t CurrentSlot = Slot(str);
+    while(DSlots[CurrentSlot]){
+        if(String(DSlots[CurrentSlot] - 1) == str){
+            return DSlots[CurrentSlot] - 1;
+        }
+        CurrentSlot = (CurrentSlot + 1) & (DSlots.size() - 1);
+    }
+    uint32_t Index = Count();
+    DCharacters.append(str);
+    DOffsets.push_back(DCharacters.size());
+    DSlots[CurrentSlot] = Index + 1;
+    return Index;
+}
+
+void CStringPool::Shrink(){
+    DCharacters.shrink_to_fit();
+    DOffsets.shrink_to_fit();
+    DSlots.clear();
+    DSlots.shrink_to_fit();
+}
@@ -1,26 +1,36 @@
 #include "StringUtils.h"
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
 #include <vector>
 
 namespace StringUtils {
 
 std::string Slice(const std::string &str, ssize_t start, ssize_t end) noexcept {
+    return std::string(SliceView(str, start, end));
+}
+
+std::string_view SliceView(std::string_view str, ssize_t start, ssize_t end) noexcept {
+    ssize_t length = str.size();
     //At the end if the index is 0, it becomes the length of the string
-    if (end == 0){
-    end = str.length();
-    } 
-    //if the index is negative to begin with, then we adjust the index
-    //to start from the begginning
-    if (start < 0)
-    {
-    start += str.length();
-    //same thing here, we want to start at end of string when end index is negative
-    } 
-    if (end < 0){
-    end += str.length();
-    } 
-    //returning a substring
+    if (end == 0) {
+        end = length;
+    }
+    //negative indices count back from the end of the string
+    if (start < 0) {
+        start += length;
+    }
+    if (end < 0) {
+        end += length;
+    }
+    //keep both inside the string like python does
+    start = std::clamp<ssize_t>(start, 0, length);
+    end = std::clamp<ssize_t>(end, 0, length);
+    if (end <= start) {
+        return std::string_view();
+    }
     return str.substr(start, end - start);
 }
 
@@ -64,55 +74,47 @@ std::string Lower(const std::string &str) noexcept {
     return result;
 }
 
+namespace {
+
+bool IsStripSpace(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+}
+
 std::string LStrip(const std::string &str) noexcept {
-    size_t start = 0;
+    return std::string(LStripView(str));
+}
 
-    // go through each character from the start
-    while (start < str.size()) {
-        char currentChar = str[start];
+std::string RStrip(const std::string &str) noexcept {
+    return std::string(RStripView(str));
+}
 
-        // if the current character is not a whitespace we stop the code
-        if (currentChar != ' ' && currentChar != '\t' && currentChar != '\n' && currentChar != '\r') {
-            break;
-        }
+std::string Strip(const std::string &str) noexcept {
+    // one copy of the stripped view instead of one per side
+    return std::string(StripView(str));
+}
 
-        //move to next character if it is a whitespace
+std::string_view LStripView(std::string_view str) noexcept {
+    size_t start = 0;
+    // go through each character from the start until one isn't whitespace
+    while (start < str.size() && IsStripSpace(str[start])) {
         start++;
     }
-
-    // retuurn everything from first non white space and forward
     return str.substr(start);
 }
 
-std::string RStrip(const std::string &str) noexcept {
+std::string_view RStripView(std::string_view str) noexcept {
     size_t end = str.size();
-
-    // go through each character from the end
-    while (end > 0) {
-        char currentChar = str[end - 1];
-
-        //if the current character is not a whitespace we stop the code
-        if (currentChar != ' ' && currentChar != '\t' && currentChar != '\n' && currentChar != '\r') {
-            break;
-        }
-
-        // move a position backward
+    // go through each character from the end until one isn't whitespace
+    while (end > 0 && IsStripSpace(str[end - 1])) {
         end--;
     }
-
-    // return everything to the last non whitespace character
     return str.substr(0, end);
 }
 
-
-std::string Strip(const std::string &str) noexcept {
-    // first, i am removing trailing whitespace using RStrip
-    std::string rstripResult = RStrip(str);
-
-    // then i am removing leading whitespace from the result using LStrip
-    return LStrip(rstripResult);
-
-    //return Lstrip(Rstrip(str)) works here but im trying to see my thoughts worked out
+std::string_view StripView(std::string_view str) noexcept {
+    return LStripView(RStripView(str));
 }
 
 
@@ -163,104 +165,75 @@ std::string Replace(const std::string &str, const std::string &old, const std::s
     if (old.empty()) {
         return str;
     }
-    //input string here as result and start searching
-    // for string at begginning of the string
-    std::string result = str;  
-    size_t pos = 0;  
-
-    // while loop here to find and replace all occurrences of old with rep
-    while ((pos = result.find(old, pos)) != std::string::npos) {
-        // Replace old with rep
-        result.replace(pos, old.length(), rep); 
-        // Mmve the search position forward in the string 
-        pos += rep.length();  
+    // build the result in one pass, copying the text between matches and
+    // rep for each match, instead of shifting the tail on every replace
+    std::string result;
+    size_t start = 0;
+    size_t pos = str.find(old);
+    if (pos == std::string::npos) {
+        return str;
     }
-//return the string result
-    return result;  
+    result.reserve(str.size());
+    while (pos != std::string::npos) {
+        result.append(str, start, pos - start);
+        result += rep;
+        start = pos + old.size();
+        pos = str.find(old, start);
+    }
+    result.append(str, start, std::string::npos);
+    return result;
 }
 
 
 
 std::vector<std::string> Split(const std::string &str, const std::string &splt) noexcept {
-    // storing the resulting substrings
-    std::vector<std::string> result;  
-
-    // if the input string is empty, return an empty vector
-    if (str.empty()) {
-        return result;
-    }
+    std::vector<std::string> result;
+    SplitView(str, splt, [&result](std::string_view piece) {
+        result.emplace_back(piece);
+    });
+    return result;
+}
 
-    // split the string by whitespace
-    if (splt.empty()) {
-        //start and end position
-        size_t start = 0;  
-        size_t end = 0;    
-
-        //iterate through the string to find whitespace
-        while (end < str.size()) {
-            // skip leading whitespace
-            while (start < str.size() && std::isspace(str[start])) {
-                start++;
-            }
+std::vector<std::string_view> SplitView(std::string_view str, std::string_view splt) noexcept {
+    std::vector<std::string_view> result;
+    SplitView(str, splt, [&result](std::string_view piece) {
+        result.push_back(piece);
+    });
+    return result;
+}
 
-            // if we've reached the end of the string, lets break
-            if (start >= str.size()) {
-                break;
-            }
 
-            // Find the end of the current
-            end = start;
-            while (end < str.size() && !std::isspace(str[end])) {
-                end++;
-            }
 
-            // extract and add to the result vector
-            result.push_back(str.substr(start, end - start));
+namespace {
 
-            // move the start position to the end of the current
-            start = end;
-        }
-         // return the vector
-        return result;  
+// the total size is added up first so the result is allocated once
+template <typename TPiece>
+std::string JoinPieces(std::string_view str, const std::vector<TPiece> &vect) {
+    std::string result;
+    if (vect.empty()) {
+        return result;
     }
-
-    // start position of the current substring
-    size_t start = 0;  
-   // find the first occurrence 
-    size_t end = str.find(splt);  
-
-    // loop to split the string 
-    while (end != std::string::npos) {
- // add the substring to the result
-        result.push_back(str.substr(start, end - start)); 
-// move the start position 
-        start = end + splt.length();  
-// find the next occurrence
-        end = str.find(splt, start);  
+    size_t size = str.size() * (vect.size() - 1);
+    for (const auto &piece : vect) {
+        size += piece.size();
     }
-
-    // add the last substring 
-    result.push_back(str.substr(start));
- // return the vector of substrings
-  return result; 
+    result.reserve(size);
+    result.append(vect[0].data(), vect[0].size());
+    for (size_t i = 1; i < vect.size(); ++i) {
+        result.append(str.data(), str.size());
+        result.append(vect[i].data(), vect[i].size());
+    }
+    return result;
 }
-   
 
+}
 
 std::string Join(const std::string &str, const std::vector<std::string> &vect) noexcept {
-    // if the vector is empty, return an empty string
-    if (vect.empty()) {
-        return "";
-    }
- // start with the first string in the vector
-    std::string result = vect[0]; 
+    return JoinPieces(str, vect);
+}
 
-    // loop to append the remaining strings with the separator
-    for (size_t i = 1; i < vect.size(); ++i) {
-        result += str + vect[i];  // add the separator and the next string
-    }
- // return the joined string
-    return result; 
+std::string JoinView(std::string_view str, const std::vector<std::string_view> &vect) noexcept {
+    return JoinPieces(str, vect);
 }
   
 // Function to expand tabs in a string to spaces based on a given tab size
@@ -304,49 +277,142 @@ std::string ExpandTabs(const std::string &str, int tabsize) noexcept {
 
 
 
-   int EditDistance(const std::string &left, const std::string &right, bool ignorecase) noexcept {
-    //Im using dynamic programming from my ecs 122a class i took over summer cause time complexity
-    //O(m*n) complexity
-    // and coding it is much easier this way
+namespace {
+
+// Myers' bit-parallel edit distance as formulated by Hyyro. The pattern's
+// characters are bits of 64 bit words, one block per 64 characters, and each
+// character of the text advances a whole column of the DP table at once by
+// tracking only whether the values go up or down by one between rows
+class CBitPattern {
+public:
+    CBitPattern() = default;
 
-    std::string l = left;
-    std::string r = right;
-// convert to lowercase if ignorecase is true
-    if (ignorecase) {
-        l = Lower(left);
-        r = Lower(right);
+    CBitPattern(const std::string &pattern, bool ignorecase) {
+        Assign(pattern, ignorecase);
     }
-//lengths of both strings
-    size_t len1 = l.size();
-    size_t len2 = r.size();
-//dp table b/w substrings
-    std::vector<std::vector<int>> dp(len1 + 1, std::vector<int>(len2 + 1));
-//first column of dp table
-    for (size_t i = 0; i <= len1; ++i) {
-        dp[i][0] = i;
-//first row of dp table
+
+    // the masks are only cleared where the last pattern set them, so reusing
+    // one object for short patterns doesn't cost a 2 KiB fill every call
+    void Assign(const std::string &pattern, bool ignorecase) {
+        for (size_t index = 0; index < folded.size(); index++) {
+            masks[(index / 64) * 256 + folded[index]] = 0;
+        }
+        ignoreCase = ignorecase;
+        length = pattern.size();
+        blockCount = (length + 63) / 64;
+        folded.resize(length);
+        if (masks.size() < blockCount * 256) {
+            masks.resize(blockCount * 256, 0);
+        }
+        for (size_t index = 0; index < length; index++) {
+            folded[index] = Fold(pattern[index]);
+            masks[(index / 64) * 256 + folded[index]] |= uint64_t(1) << (index % 64);
+        }
+        positive.resize(blockCount);
+        negative.resize(blockCount);
     }
-    for (size_t j = 0; j <= len2; ++j) {
-        dp[0][j] = j;
+
+    // returns maxdistance + 1 as soon as the distance is known to be larger
+    int Distance(const std::string &text, int maxdistance) {
+        int textLength = text.size();
+        if (!length) {
+            return std::min(textLength, maxdistance + 1);
+        }
+        if (std::abs(textLength - static_cast<int>(length)) > maxdistance) {
+            return maxdistance + 1;
+        }
+        std::fill(positive.begin(), positive.end(), ~uint64_t(0));
+        std::fill(negative.begin(), negative.end(), 0);
+        uint64_t lastBit = uint64_t(1) << ((length - 1) % 64);
+        int score = length;
+        for (int column = 0; column < textLength; column++) {
+            const uint64_t *equal = masks.data() + Fold(text[column]);
+            // the top row grows by one every column
+            int carry = 1;
+            for (size_t block = 0; block < blockCount; block++) {
+                carry = AdvanceBlock(block, equal[block * 256], carry, block + 1 == blockCount ? lastBit : uint64_t(1) << 63);
+            }
+            score += carry;
+            // each remaining column can lower the score by at most one
+            if (score - (textLength - column - 1) > maxdistance) {
+                return maxdistance + 1;
+            }
+        }
+        return score;
     }
-//making the rest of the dp table
-    for (size_t i = 1; i <= len1; ++i) {
-        for (size_t j = 1; j <= len2; ++j) {
-//determining cost
-            int cost = 1;
-        if(l[i-1] == r[j-1]){
-            cost = 0;
+
+private:
+    bool ignoreCase = false;
+    size_t length = 0;
+    size_t blockCount = 0;
+    // the pattern after case folding
+    std::vector<unsigned char> folded;
+    // masks[block * 256 + c] has a bit set where the block holds character c
+    std::vector<uint64_t> masks;
+    // vertical deltas of the current column, +1 and -1
+    std::vector<uint64_t> positive;
+    std::vector<uint64_t> negative;
+
+    unsigned char Fold(char ch) const {
+        return ignoreCase ? std::tolower(static_cast<unsigned char>(ch)) : static_cast<unsigned char>(ch);
+    }
+
+    // moves one block of the column forward, carry in and out are the
+    // horizontal delta at the row above the block and at its last row
+    int AdvanceBlock(size_t block, uint64_t equal, int carry, uint64_t lastBit) {
+        uint64_t pv = positive[block];
+        uint64_t mv = negative[block];
+        uint64_t xv = equal | mv;
+        if (carry < 0) {
+            equal |= 1;
         }
-//min cost of deletion,insertion and subsitution
-            int deletion = dp[i - 1][j] + 1;
-            int insertion = dp[i][j - 1] + 1;
-            int substitution = dp[i - 1][j - 1] + cost;
-//store min cost with std::min
-            dp[i][j] = std::min({deletion, insertion, substitution});
+        uint64_t xh = (((equal & pv) + pv) ^ pv) | equal;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        int carryOut = (ph & lastBit) ? 1 : ((mh & lastBit) ? -1 : 0);
+        ph <<= 1;
+        mh <<= 1;
+        if (carry < 0) {
+            mh |= 1;
+        } else if (carry > 0) {
+            ph |= 1;
         }
+        positive[block] = mh | ~(xv | ph);
+        negative[block] = ph & xv;
+        return carryOut;
+    }
+};
+
+}
+
+int EditDistance(const std::string &left, const std::string &right, bool ignorecase) noexcept {
+    return EditDistance(left, right, ignorecase, std::numeric_limits<int>::max() - 1);
+}
+
+int EditDistance(const std::string &left, const std::string &right, bool ignorecase, int maxdistance) noexcept {
+    if (maxdistance < 0) {
+        return 0;
+    }
+    // the distance is symmetric, the shorter string as the pattern needs fewer blocks
+    const std::string &pattern = left.size() <= right.size() ? left : right;
+    const std::string &text = left.size() <= right.size() ? right : left;
+    thread_local CBitPattern bits;
+    bits.Assign(pattern, ignorecase);
+    return bits.Distance(text, maxdistance);
+}
+
+std::vector<int> EditDistances(const std::string &pattern, const std::vector<std::string> &candidates, bool ignorecase, int maxdistance) noexcept {
+    std::vector<int> distances;
+    distances.reserve(candidates.size());
+    if (maxdistance < 0) {
+        distances.resize(candidates.size(), 0);
+        return distances;
+    }
+    CBitPattern bits(pattern, ignorecase);
+    for (const auto &candidate : candidates) {
+        distances.push_back(bits.Distance(candidate, maxdistance));
     }
-//return distance
-    return dp[len1][len2];
+    return distances;
 }
 
 }
\ No newline at end of file
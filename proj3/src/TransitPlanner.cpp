@@ -0,0 +1,367 @@
+#include "TransitPlanner.h"
+#include "RoutingGraph.h"
+#include "SpatialIndex.h"
+#include <algorithm>
+
+namespace{
+
+const uint32_t NoStop = std::numeric_limits<uint32_t>::max();
+const double Unreached = std::numeric_limits<double>::infinity();
+
+// set of stop or route indices that can be walked in index order
+class CBitSet{
+    private:
+        std::vector<uint64_t> DWords;
+
+    public:
+        void Resize(std::size_t count){
+            DWords.assign((count + 63) / 64, 0);
+        }
+
+        void Set(std::size_t index){
+            DWords[index / 64] |= uint64_t(1) << (index % 64);
+        }
+
+        bool Any() const{
+            for(auto Word : DWords){
+                if(Word){
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // calls visit with every index in the set and empties it
+        template <typename TVisit> void Drain(TVisit visit){
+            for(std::size_t Index = 0; Index < DWords.size(); Index++){
+                uint64_t Word = DWords[Index];
+                DWords[Index] = 0;
+                while(Word){
+                    visit(Index * 64 + __builtin_ctzll(Word));
+                    Word &= Word - 1;
+                }
+            }
+        }
+};
+
+}
+
+struct CTransitPlanner::SImplementation{
+    SOptions Options;
+    std::vector<CBusSystem::TStopID> StopIDs;
+    // stop index by ID, sorted by ID
+    std::vector<std::pair<CBusSystem::TStopID, uint32_t>> IndexByID;
+
+    // the stops of route r are RouteStops[RouteOffsets[r]] up to
+    // RouteStops[RouteOffsets[r + 1]], RouteSeconds holds the riding time
+    // from the start of the route to each of them
+    std::vector<uint32_t> RouteOffsets;
+    std::vector<uint32_t> RouteStops;
+    std::vector<double> RouteSeconds;
+    // the routes through stop s with the position they pass it at
+    struct SStopRoute{
+        uint32_t Route;
+        uint32_t Position;
+    };
+    std::vector<uint32_t> StopRouteOffsets;
+    std::vector<SStopRoute> StopRoutes;
+    // footpaths from stop s
+    std::vector<uint32_t> FootpathOffsets;
+    std::vector<uint32_t> FootpathTargets;
+    std::vector<double> FootpathSeconds;
+
+    // query state, round k of stop s is at k * StopIDs.size() + s. Arrival is
+    // the best time with k rides, RideArrival the best that ends in a ride
+    struct SRideLabel{
+        uint32_t Route;
+        uint32_t BoardPosition;
+        uint32_t AlightPosition;
+    };
+    std::vector<double> Arrival;
+    std::vector<double> RideArrival;
+    std::vector<SRideLabel> RideLabels;
+    // the stop walked from when Arrival came from a footpath, NoStop otherwise
+    std::vector<uint32_t> WalkedFrom;
+    std::vector<double> Best;
+    std::vector<uint32_t> EarliestPosition;
+    std::vector<uint32_t> QueuedRoutes;
+    std::vector<uint32_t> RideImproved;
+    CBitSet Marked;
+
+    SImplementation(const CBusSystem &bussystem, const CStreetMap &map, const SOptions &options) : Options(options){
+        for(std::size_t Index = 0; Index < bussystem.StopCount(); Index++){
+            auto Stop = bussystem.StopByIndex(Index);
+            StopIDs.push_back(Stop ? Stop->ID() : CBusSystem::InvalidStopID);
+        }
+        BuildIndex();
+        // stops named only by routes come after the ones from the stop list
+        std::vector<CBusSystem::TStopID> Unlisted;
+        for(std::size_t RouteIndex = 0; RouteIndex < bussystem.RouteCount(); RouteIndex++){
+            auto Route = bussystem.RouteByIndex(RouteIndex);
+            for(std::size_t Position = 0; Position < Route->StopCount(); Position++){
+                if(StopIndex(Route->GetStopID(Position)) == NoStop){
+                    Unlisted.push_back(Route->GetStopID(Position));
+                }
+            }
+        }
+        std::sort(Unlisted.begin(), Unlisted.end());
+        Unlisted.erase(std::unique(Unlisted.begin(), Unlisted.end()), Unlisted.end());
+        if(!Unlisted.empty()){
+            StopIDs.insert(StopIDs.end(), Unlisted.begin(), Unlisted.end());
+            BuildIndex();
+        }
+        std::size_t StopCount = StopIDs.size();
+
+        std::vector<CStreetMap::TLocation> Locations(StopCount);
+        std::vector<bool> Located(StopCount, false);
+        std::vector<std::pair<CStreetMap::TNodeID, uint32_t>> StopsByNode;
+        for(std::size_t Index = 0; Index < bussystem.StopCount(); Index++){
+            auto Stop = bussystem.StopByIndex(Index);
+            auto Node = Stop ? map.NodeByID(Stop->NodeID()) : nullptr;
+            // a duplicated stop ID takes the location of the stop StopByID returns
+            uint32_t StopIndex = this->StopIndex(Stop ? Stop->ID() : CBusSystem::InvalidStopID);
+            if(Node && StopIndex == Index){
+                Locations[Index] = Node->Location();
+                Located[Index] = true;
+                StopsByNode.push_back({Node->ID(), StopIndex});
+            }
+        }
+        std::sort(StopsByNode.begin(), StopsByNode.end());
+
+        RouteOffsets.push_back(0);
+        for(std::size_t RouteIndex = 0; RouteIndex < bussystem.RouteCount(); RouteIndex++){
+            auto Route = bussystem.RouteByIndex(RouteIndex);
+            uint32_t Previous = NoStop;
+            double Seconds = 0.0;
+            for(std::size_t Position = 0; Position < Route->StopCount(); Position++){
+                uint32_t Stop = StopIndex(Route->GetStopID(Position));
+                if(Previous != NoStop){
+                    Seconds += Options.DwellSeconds;
+                    if(Located[Previous] && Located[Stop]){
+                        Seconds += CRoutingGraph::Haversine(Locations[Previous], Locations[Stop]) / Options.BusMetersPerSecond;
+                    }
+                }
+                RouteStops.push_back(Stop);
+                RouteSeconds.push_back(Seconds);
+                Previous = Stop;
+            }
+            RouteOffsets.push_back(RouteStops.size());
+        }
+
+        std::vector<std::vector<SStopRoute>> RoutesByStop(StopCount);
+        for(uint32_t Route = 0; Route + 1 < RouteOffsets.size(); Route++){
+            for(uint32_t Position = 0; Position < RouteOffsets[Route + 1] - RouteOffsets[Route]; Position++){
+                RoutesByStop[RouteStops[RouteOffsets[Route] + Position]].push_back({Route, Position});
+            }
+        }
+        StopRouteOffsets.push_back(0);
+        for(auto &Routes : RoutesByStop){
+            StopRoutes.insert(StopRoutes.end(), Routes.begin(), Routes.end());
+            StopRouteOffsets.push_back(StopRoutes.size());
+        }
+
+        // footpaths to the stops on nodes within walking distance
+        CSpatialIndex Index(map);
+        std::vector<CSpatialIndex::SResult> Nearby;
+        FootpathOffsets.push_back(0);
+        for(uint32_t Stop = 0; Stop < StopCount; Stop++){
+            if(Located[Stop]){
+                Index.WithinRadius(Locations[Stop], Options.MaxWalkMeters, Nearby);
+                for(auto &Result : Nearby){
+                    auto Range = std::equal_range(StopsByNode.begin(), StopsByNode.end(), std::make_pair(Result.NodeID, uint32_t(0)), [](const auto &left, const auto &right){
+                        return left.first < right.first;
+                    });
+                    for(auto Other = Range.first; Other != Range.second; Other++){
+                        if(Other->second != Stop){
+                            FootpathTargets.push_back(Other->second);
+                            FootpathSeconds.push_back(Result.Distance / Options.WalkMetersPerSecond);
+                        }
+                    }
+                }
+            }
+            FootpathOffsets.push_back(FootpathTargets.size());
+        }
+
+        Best.resize(StopCount);
+        EarliestPosition.assign(RouteOffsets.size() - 1, NoStop);
+        Marked.Resize(StopCount);
+    }
+
+    void BuildIndex(){
+        IndexByID.clear();
+        for(std::size_t Index = 0; Index < StopIDs.size(); Index++){
+            IndexByID.push_back({StopIDs[Index], Index});
+        }
+        // a duplicated stop ID finds the last one, like CCSVBusSystem::StopByID
+        std::stable_sort(IndexByID.begin(), IndexByID.end(), [](const auto &left, const auto &right){
+            return left.first < right.first;
+        });
+    }
+
+    uint32_t StopIndex(CBusSystem::TStopID id) const{
+        auto Found = std::upper_bound(IndexByID.begin(), IndexByID.end(), id, [](CBusSystem::TStopID value, const auto &entry){
+            return value < entry.first;
+        });
+        return Found != IndexByID.begin() && (Found - 1)->first == id ? (Found - 1)->second : NoStop;
+    }
+
+    // walks from the stops whose ride arrival improved this round, footpaths
+    // only start at a ride so a walk never follows a walk
+    void RelaxFootpaths(std::size_t round, uint32_t target){
+        std::size_t Base = round * StopIDs.size();
+        for(auto Stop : RideImproved){
+            for(auto Footpath = FootpathOffsets[Stop]; Footpath < FootpathOffsets[Stop + 1]; Footpath++){
+                uint32_t Other = FootpathTargets[Footpath];
+                double Seconds = RideArrival[Base + Stop] + FootpathSeconds[Footpath];
+                if(Seconds < Best[Other] && Seconds < Best[target]){
+                    Arrival[Base + Other] = Seconds;
+                    Best[Other] = Seconds;
+                    WalkedFrom[Base + Other] = Stop;
+                    Marked.Set(Other);
+                }
+            }
+        }
+    }
+
+    void ScanRoute(uint32_t route, std::size_t round, uint32_t target){
+        std::size_t StopCount = StopIDs.size();
+        const uint32_t *Stops = RouteStops.data() + RouteOffsets[route];
+        const double *Seconds = RouteSeconds.data() + RouteOffsets[route];
+        uint32_t Length = RouteOffsets[route + 1] - RouteOffsets[route];
+        const double *Previous = Arrival.data() + (round - 1) * StopCount;
+        std::size_t Base = round * StopCount;
+        uint32_t BoardPosition = NoStop;
+        double BoardSeconds = Unreached;
+        for(uint32_t Position = EarliestPosition[route]; Position < Length; Position++){
+            uint32_t Stop = Stops[Position];
+            double Riding = BoardPosition == NoStop ? Unreached : BoardSeconds + Seconds[Position] - Seconds[BoardPosition];
+            if(Riding < Best[Stop] && Riding < Best[target]){
+                if(RideArrival[Base + Stop] == Unreached){
+                    RideImproved.push_back(Stop);
+                }
+                Arrival[Base + Stop] = Riding;
+                RideArrival[Base + Stop] = Riding;
+                RideLabels[Base + Stop] = {route, BoardPosition, Position};
+                WalkedFrom[Base + Stop] = NoStop;
+                Best[Stop] = Riding;
+                Marked.Set(Stop);
+            }
+            // boarding here is better than staying on from further back
+            if(Previous[Stop] + Options.BoardSeconds < Riding){
+                BoardPosition = Position;
+                BoardSeconds = Previous[Stop] + Options.BoardSeconds;
+            }
+        }
+        EarliestPosition[route] = NoStop;
+    }
+
+    // follows the labels back from dest at the given round
+    void Reconstruct(std::size_t round, uint32_t dest, SJourney &journey) const{
+        std::size_t StopCount = StopIDs.size();
+        journey.Rides = round;
+        journey.StopCount = 0;
+        journey.Seconds = Arrival[round * StopCount + dest];
+        journey.Legs.clear();
+        uint32_t Stop = dest;
+        bool Walked = false;
+        while(true){
+            std::size_t Label = round * StopCount + Stop;
+            if(!Walked && WalkedFrom[Label] != NoStop){
+                uint32_t From = WalkedFrom[Label];
+                double Seconds = Arrival[Label] - RideArrival[round * StopCount + From];
+                journey.Legs.push_back({InvalidRouteIndex, StopIDs[From], StopIDs[Stop], 0, 0, Seconds});
+                Stop = From;
+                Walked = true;
+                continue;
+            }
+            if(!round){
+                break;
+            }
+            const SRideLabel &Ride = RideLabels[Label];
+            uint32_t From = RouteStops[RouteOffsets[Ride.Route] + Ride.BoardPosition];
+            double Seconds = RideArrival[Label] - Arrival[(round - 1) * StopCount + From];
+            journey.Legs.push_back({Ride.Route, StopIDs[From], StopIDs[Stop], Ride.BoardPosition, Ride.AlightPosition, Seconds});
+            journey.StopCount += Ride.AlightPosition - Ride.BoardPosition;
+            Stop = From;
+            Walked = false;
+            round--;
+        }
+        std::reverse(journey.Legs.begin(), journey.Legs.end());
+    }
+
+    bool FindJourneys(CBusSystem::TStopID src, CBusSystem::TStopID dest, std::vector<SJourney> &journeys, std::size_t maxtransfers){
+        journeys.clear();
+        uint32_t Source = StopIndex(src), Target = StopIndex(dest);
+        if(Source == NoStop || Target == NoStop){
+            return false;
+        }
+        if(Source == Target){
+            journeys.push_back({0, 0, 0.0, {}});
+            return true;
+        }
+        std::size_t StopCount = StopIDs.size();
+        std::size_t Rounds = maxtransfers + 2;
+        Arrival.assign(Rounds * StopCount, Unreached);
+        RideArrival.assign(Rounds * StopCount, Unreached);
+        RideLabels.resize(Rounds * StopCount);
+        WalkedFrom.assign(Rounds * StopCount, NoStop);
+        std::fill(Best.begin(), Best.end(), Unreached);
+
+        // round 0 is the source and the walks from it
+        Arrival[Source] = RideArrival[Source] = Best[Source] = 0.0;
+        Marked.Set(Source);
+        RideImproved.assign(1, Source);
+        RelaxFootpaths(0, Target);
+        if(Best[Target] != Unreached){
+            journeys.emplace_back();
+            Reconstruct(0, Target, journeys.back());
+        }
+
+        for(std::size_t Round = 1; Round < Rounds && Marked.Any(); Round++){
+            double PreviousBest = Best[Target];
+            QueuedRoutes.clear();
+            Marked.Drain([&](std::size_t stop){
+                for(auto Entry = StopRouteOffsets[stop]; Entry < StopRouteOffsets[stop + 1]; Entry++){
+                    const SStopRoute &Route = StopRoutes[Entry];
+                    if(EarliestPosition[Route.Route] == NoStop){
+                        QueuedRoutes.push_back(Route.Route);
+                    }
+                    EarliestPosition[Route.Route] = std::min(EarliestPosition[Route.Route], Route.Position);
+                }
+            });
+            RideImproved.clear();
+            for(auto Route : QueuedRoutes){
+                ScanRoute(Route, Round, Target);
+            }
+            RelaxFootpaths(Round, Target);
+            if(Best[Target] < PreviousBest){
+                journeys.emplace_back();
+                Reconstruct(Round, Target, journeys.back());
+            }
+        }
+        Marked.Drain([](std::size_t){});
+        return !journeys.empty();
+    }
+};
+
+CTransitPlanner::CTransitPlanner(const CBusSystem &bussystem, const CStreetMap &map, const SOptions &options) : DImplementation(std::make_unique<SImplementation>(bussystem, map, options)){
+
+}
+
+CTransitPlanner::CTransitPlanner(const CBusSystem &bussystem, const CStreetMap &map) : CTransitPlanner(bussystem, map, SOptions()){
+
+}
+
+CTransitPlanner::~CTransitPlanner() = default;
+
+std::size_t CTransitPlanner::StopCount() const noexcept{
+    return DImplementation->StopIDs.size();
+}
+
+std::size_t CTransitPlanner::FootpathCount() const noexcept{
+    return DImplementation->FootpathTargets.size();
+}
+
+bool CTransitPlanner::FindJourneys(CBusSystem::TStopID src, CBusSystem::TStopID dest, std::vector<SJourney> &journeys, std::size_t maxtransfers){
+    return DImplementation->FindJourneys(src, dest, journeys, maxtransfers);
+}
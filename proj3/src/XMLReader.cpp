@@ -1,8 +1,12 @@
 #include "XMLReader.h" // includes the XMLReader class definition
 #include <expat.h>     // XML parsing library (Expat)
-#include <queue>       // std::queue for storing parsed XML entities
+#include <algorithm>   // std::max for growing the ring
+#include <utility>     // std::swap to hand entities over without copying
 #include <memory>      // for std::shared_ptr and std::unique_ptr
 #include <vector>      // for std::vector used to buffer data chunks
+#include <cstring>     // std::strcmp for the element filter
+#include <typeinfo>    // typeid to tell a plain reader from a subclass
+#include "StringPool.h" // interning table for element and attribute names
 
 // implements the XML Reader using a struct to handle XML parsing
 struct CXMLReader::SImplementation {
@@ -10,12 +14,31 @@ struct CXMLReader::SImplementation {
     std::shared_ptr<CDataSource> DataSource;
     // XML parser (from Expat) to handle parsing
     XML_Parser Parser;
-    // queue to store parsed XML entities for processing
-    std::queue<SXMLEntity> EntityQueue;
+    // parsed entities waiting for ReadEntity, a ring buffer of slots that are
+    // filled in place so their strings and vectors keep their capacity from
+    // one entity to the next. ReadEntity swaps the caller's entity into the
+    // slot, so its buffers are reused too
+    std::vector<SXMLEntity> Ring;
+    std::size_t RingHead = 0;
+    std::size_t RingCount = 0;
+    // attributes taken off entities that had more of them than the next one
+    // put in their slot, kept for their string buffers
+    std::vector<SXMLEntity::TAttribute> SpareAttributes;
     // indicates the end of the data source
     bool IsEndOfData;
     // buffer to accumulate character data between XML tags
     std::string CharDataBuffer;
+    // number of bytes pulled from the data source per parse call
+    std::size_t ChunkSize;
+    // block buffer reused for every read from the data source
+    std::vector<char> ReadBuffer;
+    // visitor and element names for Parse, only set while it runs
+    CXMLVisitor *Visitor = nullptr;
+    const std::vector<std::string> *Filter = nullptr;
+    // element and attribute names seen so far, the index of a name is its atom
+    CStringPool Names;
+    // attribute name atoms of the element being handed to the visitor
+    std::vector<SXMLEntity::TAtom> AttributeAtoms;
 
     //handler for start element tags
     static void StartElementHandler(void* userData, const char* name, const char** attributes) {
@@ -24,22 +47,27 @@ struct CXMLReader::SImplementation {
         //flush any pending character data before handling the new element
         impl->FlushCharData();
 
-        // create a new entity for the start element
-        SXMLEntity entity;
-        entity.DType = SXMLEntity::EType::StartElement; //set entity type to StartElement
-        entity.DNameData = name; //assign element name
+        // fill the next free slot for the start element
+        SXMLEntity &entity = impl->PushEntity(SXMLEntity::EType::StartElement);
+        entity.DNameData.assign(name); //assign element name
+        entity.DNameAtom = impl->Names.Intern(name);
 
         //process attributes, if any
-        if (attributes) {
-            for (int i = 0; attributes[i]; i += 2) {
-                if (attributes[i + 1]) {
-                    entity.DAttributes.emplace_back(attributes[i], attributes[i + 1]); //add attribute name value pair
-                }
+        std::size_t count = 0;
+        for (int i = 0; attributes && attributes[i]; i += 2) {
+            count += attributes[i + 1] ? 1 : 0;
+        }
+        impl->ResizeAttributes(entity, count);
+        count = 0;
+        for (int i = 0; attributes && attributes[i]; i += 2) {
+            if (attributes[i + 1]) {
+                //add attribute name value pair
+                entity.DAttributes[count].first.assign(attributes[i]);
+                entity.DAttributes[count].second.assign(attributes[i + 1]);
+                entity.DAttributeAtoms[count] = impl->Names.Intern(attributes[i]);
+                count++;
             }
         }
-
-        //add the entity to the queue
-        impl->EntityQueue.push(entity);
     }
 
     //handler for end element tags
@@ -48,13 +76,11 @@ struct CXMLReader::SImplementation {
         //flush any pending character data before handling the end element
         impl->FlushCharData();
 
-        //create a new entity for the end element
-        SXMLEntity entity;
-        entity.DType = SXMLEntity::EType::EndElement;
-        entity.DNameData = name;
-
-        //add the end element entity to the queue
-        impl->EntityQueue.push(entity);
+        //fill the next free slot for the end element
+        SXMLEntity &entity = impl->PushEntity(SXMLEntity::EType::EndElement);
+        entity.DNameData.assign(name);
+        entity.DNameAtom = impl->Names.Intern(name);
+        impl->ResizeAttributes(entity, 0);
     }
 
     //handler for character data between XML tags
@@ -66,9 +92,79 @@ struct CXMLReader::SImplementation {
         }
     }
 
+    // checks the element filter, every element passes when there isn't one
+    static bool Wanted(const std::vector<std::string> *filter, const char *name) {
+        if (!filter || filter->empty()) {
+            return true;
+        }
+        for (const auto &element : *filter) {
+            if (!std::strcmp(element.c_str(), name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //handlers used by Parse, passing expat's strings straight on
+    static void VisitStartElement(void* userData, const char* name, const char** attributes) {
+        auto* impl = static_cast<SImplementation*>(userData);
+        if (Wanted(impl->Filter, name)) {
+            impl->AttributeAtoms.clear();
+            for (int i = 0; attributes && attributes[i]; i += 2) {
+                impl->AttributeAtoms.push_back(impl->Names.Intern(attributes[i]));
+            }
+            impl->Visitor->StartElement(name, impl->Names.Intern(name), SXMLAttributes{attributes, impl->AttributeAtoms.data()});
+        }
+    }
+
+    static void VisitEndElement(void* userData, const char* name) {
+        auto* impl = static_cast<SImplementation*>(userData);
+        if (Wanted(impl->Filter, name)) {
+            impl->Visitor->EndElement(name, impl->Names.Intern(name));
+        }
+    }
+
+    static void VisitCharData(void* userData, const char* data, int length) {
+        auto* impl = static_cast<SImplementation*>(userData);
+        if (data && length > 0) {
+            impl->Visitor->CharData(std::string_view(data, length));
+        }
+    }
+
+    // passes a queued entity to the visitor, for entities read before Parse
+    // and for readers that only provide ReadEntity. Those entities may have
+    // no atoms or atoms from some other reader, so unless ownAtoms is set the
+    // names are interned again
+    void Visit(CXMLVisitor &visitor, const std::vector<std::string> &elements, const SXMLEntity &entity, bool ownAtoms) {
+        if (entity.DType == SXMLEntity::EType::CharData) {
+            if (elements.empty()) {
+                visitor.CharData(entity.DNameData);
+            }
+            return;
+        }
+        if (!Wanted(&elements, entity.DNameData.c_str())) {
+            return;
+        }
+        SXMLEntity::TAtom nameAtom = ownAtoms ? entity.DNameAtom : Names.Intern(entity.DNameData);
+        if (entity.DType != SXMLEntity::EType::EndElement) {
+            std::vector<const char*> attributes;
+            std::vector<SXMLEntity::TAtom> atoms;
+            for (std::size_t i = 0; i < entity.DAttributes.size(); i++) {
+                attributes.push_back(entity.DAttributes[i].first.c_str());
+                attributes.push_back(entity.DAttributes[i].second.c_str());
+                atoms.push_back(ownAtoms ? entity.DAttributeAtoms[i] : Names.Intern(entity.DAttributes[i].first));
+            }
+            attributes.push_back(nullptr);
+            visitor.StartElement(entity.DNameData, nameAtom, SXMLAttributes{attributes.data(), atoms.data()});
+        }
+        if (entity.DType != SXMLEntity::EType::StartElement) {
+            visitor.EndElement(entity.DNameData, nameAtom);
+        }
+    }
+
     //constructor to initialize the implementation
-    SImplementation(std::shared_ptr<CDataSource> src)
-        : DataSource(std::move(src)), IsEndOfData(false) {
+    SImplementation(std::shared_ptr<CDataSource> src, std::size_t chunksize)
+        : DataSource(std::move(src)), IsEndOfData(false), ChunkSize(chunksize ? chunksize : 1) {
         //create the XML parser
         Parser = XML_ParserCreate(nullptr);
 
@@ -86,31 +182,66 @@ struct CXMLReader::SImplementation {
     // flush accumulated character data into the entity queue
     void FlushCharData() {
         if (!CharDataBuffer.empty()) {
-            SXMLEntity entity;
-            entity.DType = SXMLEntity::EType::CharData; // set entity type to CharData
-            entity.DNameData = CharDataBuffer; // assign buffered data
-
-            // add the entity to the queue and clear the buffer
-            EntityQueue.push(entity);
+            SXMLEntity &entity = PushEntity(SXMLEntity::EType::CharData);
+            entity.DNameData.assign(CharDataBuffer); // assign buffered data
+            entity.DNameAtom = SXMLEntity::InvalidAtom;
+            ResizeAttributes(entity, 0);
             CharDataBuffer.clear();
         }
     }
 
+    // the slot after the last queued entity, the ring doubles when it is full
+    SXMLEntity &PushEntity(SXMLEntity::EType type) {
+        if (RingCount == Ring.size()) {
+            std::vector<SXMLEntity> grown(std::max<std::size_t>(16, Ring.size() * 2));
+            for (std::size_t i = 0; i < RingCount; i++) {
+                grown[i] = std::move(Ring[(RingHead + i) % Ring.size()]);
+            }
+            Ring = std::move(grown);
+            RingHead = 0;
+        }
+        SXMLEntity &entity = Ring[(RingHead + RingCount) % Ring.size()];
+        RingCount++;
+        entity.DType = type;
+        return entity;
+    }
+
+    SXMLEntity &FrontEntity() {
+        return Ring[RingHead];
+    }
+
+    void PopEntity() {
+        RingHead = (RingHead + 1) % Ring.size();
+        RingCount--;
+    }
+
+    // sets the number of attributes, moving extra ones to the spares and
+    // taking new ones from there so their strings don't have to be allocated
+    void ResizeAttributes(SXMLEntity &entity, std::size_t count) {
+        auto &attributes = entity.DAttributes;
+        while (attributes.size() > count) {
+            SpareAttributes.push_back(std::move(attributes.back()));
+            attributes.pop_back();
+        }
+        while (attributes.size() < count) {
+            if (SpareAttributes.empty()) {
+                attributes.emplace_back();
+            } else {
+                attributes.push_back(std::move(SpareAttributes.back()));
+                SpareAttributes.pop_back();
+            }
+        }
+        entity.DAttributeAtoms.resize(count);
+    }
+
     // read the next entity from the XML input
     bool ReadEntity(SXMLEntity& entity, bool skipCharData) {
         // read until an entity is available or end of input is reached
-        while (EntityQueue.empty() && !IsEndOfData) {
-            std::vector<char> buffer(4096); // buffer to hold data
+        while (!RingCount && !IsEndOfData) {
+            // pull a whole block from the data source at once
             size_t bytesRead = 0;
-
-            // fill the buffer with data from the data source
-            while (bytesRead < buffer.size() && !DataSource->End()) {
-                char ch;
-                if (DataSource->Get(ch)) {
-                    buffer[bytesRead++] = ch;
-                } else {
-                    break;
-                }
+            if (DataSource->Read(ReadBuffer, ChunkSize)) {
+                bytesRead = ReadBuffer.size();
             }
 
             // check if we've reached the end of the data source
@@ -121,15 +252,16 @@ struct CXMLReader::SImplementation {
             }
 
             // parse the data 
-            if (XML_Parse(Parser, buffer.data(), bytesRead, 0) == XML_STATUS_ERROR) {
+            if (XML_Parse(Parser, ReadBuffer.data(), bytesRead, 0) == XML_STATUS_ERROR) {
                 return false; // parsing error
             }
         }
 
-        // return the next available entity
-        if (!EntityQueue.empty()) {
-            entity = EntityQueue.front();
-            EntityQueue.pop();
+        // return the next available entity, the caller's old one takes its
+        // place in the ring
+        if (RingCount) {
+            std::swap(entity, FrontEntity());
+            PopEntity();
 
             // skip character data if it is requested
             if (skipCharData && entity.DType == SXMLEntity::EType::CharData) {
@@ -141,21 +273,91 @@ struct CXMLReader::SImplementation {
 
         return false; // no more entities to process
     }
+
+    // parses the rest of the input with the visitor handlers in place of the
+    // queueing ones
+    bool Parse(CXMLVisitor &visitor, const std::vector<std::string> &elements) {
+        // anything already parsed for ReadEntity goes first
+        FlushCharData();
+        while (RingCount) {
+            Visit(visitor, elements, FrontEntity(), true);
+            PopEntity();
+        }
+        Visitor = &visitor;
+        Filter = &elements;
+        XML_SetElementHandler(Parser, VisitStartElement, VisitEndElement);
+        XML_SetCharacterDataHandler(Parser, elements.empty() ? VisitCharData : nullptr);
+
+        bool success = true;
+        while (!IsEndOfData) {
+            size_t bytesRead = 0;
+            if (DataSource->Read(ReadBuffer, ChunkSize)) {
+                bytesRead = ReadBuffer.size();
+            }
+            if (bytesRead == 0) {
+                IsEndOfData = true;
+            }
+            if (XML_Parse(Parser, ReadBuffer.data(), bytesRead, IsEndOfData) == XML_STATUS_ERROR) {
+                success = false;
+                break;
+            }
+        }
+
+        XML_SetElementHandler(Parser, StartElementHandler, EndElementHandler);
+        XML_SetCharacterDataHandler(Parser, CharDataHandler);
+        Visitor = nullptr;
+        Filter = nullptr;
+        return success;
+    }
 };
 
 // constructor for CXMLReader
-CXMLReader::CXMLReader(std::shared_ptr<CDataSource> src)
-    : DImplementation(std::make_unique<SImplementation>(std::move(src))) {}
+CXMLReader::CXMLReader(std::shared_ptr<CDataSource> src, std::size_t chunksize)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), chunksize)) {}
 
 // destructor for CXMLReader
 CXMLReader::~CXMLReader() = default;
 
 // check if we've reached the end of the XML input
 bool CXMLReader::End() const {
-    return DImplementation->IsEndOfData && DImplementation->EntityQueue.empty();
+    return DImplementation->IsEndOfData && !DImplementation->RingCount;
 }
 
 // read the next entity from the XML input
 bool CXMLReader::ReadEntity(SXMLEntity& entity, bool skipCharData) {
     return DImplementation->ReadEntity(entity, skipCharData);
-}
\ No newline at end of file
+}
+
+// visit the rest of the XML input, a subclass may have overridden ReadEntity
+// so only a plain reader skips it
+bool CXMLReader::Parse(CXMLVisitor &visitor, const std::vector<std::string> &elements) {
+    if (typeid(*this) == typeid(CXMLReader)) {
+        return ParseSource(visitor, elements);
+    }
+    SXMLEntity entity;
+    while (ReadEntity(entity)) {
+        DImplementation->Visit(visitor, elements, entity, false);
+    }
+    return true;
+}
+
+// visit the rest of the XML input straight from expat
+bool CXMLReader::ParseSource(CXMLVisitor &visitor, const std::vector<std::string> &elements) {
+    if (!DImplementation->DataSource) {
+        return true;
+    }
+    return DImplementation->Parse(visitor, elements);
+}
+
+// intern a name, giving the atom entities and visitors see for it
+SXMLEntity::TAtom CXMLReader::NameAtom(std::string_view name) {
+    return DImplementation->Names.Intern(name);
+}
+
+// the name an atom stands for
+std::string_view CXMLReader::AtomName(SXMLEntity::TAtom atom) const {
+    if (atom < DImplementation->Names.Count()) {
+        return DImplementation->Names.String(atom);
+    }
+    return std::string_view();
+}
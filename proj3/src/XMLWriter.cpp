@@ -6,106 +6,95 @@ struct CXMLWriter::SImplementation {
     std::shared_ptr<CDataSink> DDataSink;   //data sink used for writing output.
     std::vector<std::string> DElementList;  //stores the stack of open elements.
 
+    std::string DOutput;                    //output of the current call, written to the sink at once.
+
     //constructor initializes the data sink.
     SImplementation(std::shared_ptr<CDataSink> sink)
         : DDataSink(sink) {}
 
-    //writes a plain string to the data sink 
-    //returns false if writing fails
-    bool OutputString(const std::string& str) {
-        for (char ch : str) {
-            if (!DDataSink->Put(ch)) {
-                return false;
-            }
-        }
-        return true;
+    //appends a plain string to the pending output, the sink is only written
+    //by WriteOutput
+    void OutputString(const std::string& str) {
+        DOutput.append(str);
     }
 
-    //writes an escaped version of the string (e.g., for special XML characters).
-    //used switch and case
-    bool StringEscaped(const std::string& str) {
-        for (char ch : str) {
-            switch (ch) {
+    //appends an escaped version of the string (e.g., for special XML characters).
+    //the runs between special characters are copied whole
+    void StringEscaped(const std::string& str) {
+        size_t start = 0;
+        size_t special;
+        while ((special = str.find_first_of("<>&'\"", start)) != std::string::npos) {
+            DOutput.append(str, start, special - start);
+            switch (str[special]) {
                 case '<':
-                    if (!OutputString("&lt;")) {
-                        return false;
-                    }
+                    DOutput.append("&lt;");
                     break;
                 case '>':
-                    if (!OutputString("&gt;")){
-                         return false;
-                    }
-                        break;
+                    DOutput.append("&gt;");
+                    break;
                 case '&':
-                    if (!OutputString("&amp;")){ 
-                        return false;
-                    }
-                        break;
-                case '\'':
-                    if (!OutputString("&apos;")) {
-                    return false;
-                    }
+                    DOutput.append("&amp;");
                     break;
-                case '"':
-                    if (!OutputString("&quot;")){
-                         return false;
-                    }
+                case '\'':
+                    DOutput.append("&apos;");
                     break;
                 default:
-                    if (!DDataSink->Put(ch)){ 
-                        return false;
-                    }
+                    DOutput.append("&quot;");
+                    break;
             }
+            start = special + 1;
+        }
+        DOutput.append(str, start, std::string::npos);
+    }
+
+    //appends the attributes of a start or complete element
+    void OutputAttributes(const SXMLEntity& entity) {
+        for (const auto& attr : entity.DAttributes) {
+            OutputString(" ");
+            OutputString(attr.first);
+            OutputString("=\"");
+            StringEscaped(attr.second);
+            OutputString("\"");
         }
-        return true;
+    }
+
+    //hands the pending output to the data sink in a single write
+    //returns false if writing fails
+    bool WriteOutput() {
+        bool result = DOutput.empty() || DDataSink->Write(DOutput.data(), DOutput.size());
+        DOutput.clear();
+        return result;
     }
 
     //closes all remaining open tags
     //returns false if writing fails
     bool FinalizeOutput() {
         for (auto it = DElementList.rbegin(); it != DElementList.rend(); ++it) {
-            if (!OutputString("</") ||
-                !OutputString(*it) ||
-                !OutputString(">")) {
-                return false;
-            }
+            OutputString("</");
+            OutputString(*it);
+            OutputString(">");
         }
         DElementList.clear();  // clear the element list once all tags are closed.
-        return true;
+        return WriteOutput();
     }
 
     // writes the provided XML entity to the output.
     bool OutputEntity(const SXMLEntity& entity) {
         switch (entity.DType) {
             case SXMLEntity::EType::StartElement:
-                // write the opening tag for the element.
-                if (!OutputString("<") ||
-                    !OutputString(entity.DNameData)) {
-                    return false;
-                }
-                // write all attributes for the element.
-                for (const auto& attr : entity.DAttributes) {
-                    if (!OutputString(" ") ||
-                        !OutputString(attr.first) ||
-                        !OutputString("=\"") ||
-                        !StringEscaped(attr.second) ||
-                        !OutputString("\"")) {
-                        return false;
-                    }
-                }
-                if (!OutputString(">")) {
-                    return false;
-                }
+                // write the opening tag and its attributes.
+                OutputString("<");
+                OutputString(entity.DNameData);
+                OutputAttributes(entity);
+                OutputString(">");
                 DElementList.push_back(entity.DNameData);  // add element to the stack.
                 break;
 
             case SXMLEntity::EType::EndElement:
                 // write the closing tag for the element.
-                if (!OutputString("</") ||
-                    !OutputString(entity.DNameData) ||
-                    !OutputString(">")) {
-                    return false;
-                }
+                OutputString("</");
+                OutputString(entity.DNameData);
+                OutputString(">");
                 if (!DElementList.empty()) {
                     DElementList.pop_back();  // remove the element from the stack.
                 }
@@ -113,33 +102,19 @@ struct CXMLWriter::SImplementation {
 
             case SXMLEntity::EType::CharData:
                 // write character data, escaping special characters.
-                if (!StringEscaped(entity.DNameData)) {
-                    return false;
-                }
+                StringEscaped(entity.DNameData);
                 break;
 
             case SXMLEntity::EType::CompleteElement:
-                // write a self-closing tag for the element.
-                if (!OutputString("<") ||
-                    !OutputString(entity.DNameData)) {
-                    return false;
-                }
-                // write all attributes for the element.
-                for (const auto& attr : entity.DAttributes) {
-                    if (!OutputString(" ") ||
-                        !OutputString(attr.first) ||
-                        !OutputString("=\"") ||
-                        !StringEscaped(attr.second) ||
-                        !OutputString("\"")) {
-                        return false;
-                    }
-                }
-                if (!OutputString("/>")) {
-                    return false;
-                }
+                // write a self-closing tag and its attributes.
+                OutputString("<");
+                OutputString(entity.DNameData);
+                OutputAttributes(entity);
+                OutputString("/>");
                 break;
         }
-        return true;
+        //everything above only appends to DOutput, this is the only write
+        return WriteOutput();
     }
 };
 
@@ -0,0 +1,31 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// kept in its own file so the replacements aren't inlined into the tests
+static std::atomic<std::size_t> AllocationCount{0};
+
+void *operator new(std::size_t size){
+    AllocationCount++;
+    if(void *Pointer = std::malloc(size ? size : 1)){
+        return Pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept{
+    std::free(pointer);
+}
+
+namespace AllocationCounter{
+
+std::size_t Count() noexcept{
+    return AllocationCount;
+}
+
+}
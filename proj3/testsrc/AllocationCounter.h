@@ -0,0 +1,15 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+
+// the test program replaces the global operator new so tests can count the
+// heap allocations made between two points
+namespace AllocationCounter{
+
+// allocations made through operator new since the program started
+std::size_t Count() noexcept;
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "BufferedDataSink.h"
+#include "StringDataSink.h"
+#include "DSVWriter.h"
+#include "XMLWriter.h"
+
+// records how many times each entry point is used by the buffered sink
+class CCountingDataSink : public CDataSink{
+    public:
+        std::string DString;
+        std::size_t DPutCount = 0;
+        std::size_t DWriteCount = 0;
+        bool DFail = false;
+
+        using CDataSink::Write;
+        bool Put(const char &ch) noexcept override{
+            DPutCount++;
+            DString.push_back(ch);
+            return !DFail;
+        }
+        bool Write(const std::vector<char> &buf) noexcept override{
+            return Write(buf.data(), buf.size());
+        }
+        bool Write(const char *buf, std::size_t count) noexcept override{
+            DWriteCount++;
+            DString.append(buf, count);
+            return !DFail;
+        }
+};
+
+TEST(BufferedDataSink, PutTest){
+    auto Target = std::make_shared<CCountingDataSink>();
+    CBufferedDataSink Sink(Target, 4);
+
+    EXPECT_TRUE(Sink.Put('H'));
+    EXPECT_TRUE(Sink.Put('e'));
+    EXPECT_TRUE(Sink.Put('l'));
+    EXPECT_TRUE(Sink.Put('l'));
+    EXPECT_EQ(Target->DString,"");
+    EXPECT_TRUE(Sink.Put('o'));
+    EXPECT_EQ(Target->DString,"Hell");
+    EXPECT_TRUE(Sink.Flush());
+    EXPECT_EQ(Target->DString,"Hello");
+    EXPECT_EQ(Target->DPutCount,0);
+    EXPECT_EQ(Target->DWriteCount,2);
+}
+
+TEST(BufferedDataSink, WriteTest){
+    auto Target = std::make_shared<CCountingDataSink>();
+    CBufferedDataSink Sink(Target, 8);
+    std::vector<char> Small = {'a','b','c'};
+
+    EXPECT_TRUE(Sink.Write(Small));
+    EXPECT_TRUE(Sink.Write(Small));
+    EXPECT_EQ(Target->DWriteCount,0);
+    EXPECT_TRUE(Sink.Write(Small));
+    EXPECT_EQ(Target->DString,"abcabc");
+    // spans at least a block long go straight through after a flush
+    EXPECT_TRUE(Sink.Write("0123456789",10));
+    EXPECT_EQ(Target->DString,"abcabcabc0123456789");
+    EXPECT_EQ(Target->DWriteCount,3);
+    EXPECT_TRUE(Sink.Flush());
+    EXPECT_EQ(Target->DWriteCount,3);
+}
+
+TEST(BufferedDataSink, DestructorFlushTest){
+    auto Target = std::make_shared<CCountingDataSink>();
+    {
+        CBufferedDataSink Sink(Target);
+        EXPECT_TRUE(Sink.Write("pending",7));
+        EXPECT_EQ(Target->DString,"");
+    }
+    EXPECT_EQ(Target->DString,"pending");
+}
+
+TEST(BufferedDataSink, FailureTest){
+    auto Target = std::make_shared<CCountingDataSink>();
+    CBufferedDataSink Sink(Target, 2);
+
+    Target->DFail = true;
+    EXPECT_TRUE(Sink.Put('a'));
+    EXPECT_TRUE(Sink.Put('b'));
+    EXPECT_FALSE(Sink.Put('c'));
+    EXPECT_FALSE(Sink.Flush());
+}
+
+TEST(BufferedDataSink, WritersTest){
+    auto Target = std::make_shared<CStringDataSink>();
+    auto Sink = std::make_shared<CBufferedDataSink>(Target, 16);
+    CDSVWriter DSVWriter(Sink, ',');
+    CXMLWriter XMLWriter(Sink);
+
+    EXPECT_TRUE(DSVWriter.WriteRow({"a","b \"c\"","d,e"}));
+    EXPECT_TRUE(XMLWriter.WriteEntity({SXMLEntity::EType::CompleteElement, "tag", {{"k","<&>"}}}));
+    EXPECT_TRUE(Sink->Flush());
+    EXPECT_EQ(Target->String(),"a,\"b \"\"c\"\"\",\"d,e\"\n<tag k=\"&lt;&amp;&gt;\"/>");
+}
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <fstream>
+#include <sstream>
 
 // Create a mock DSVReader that matches the actual interface
 class MockDSVReader : public CDSVReader {
@@ -151,4 +153,100 @@ TEST_F(CSVBusSystemTest, EmptyData) {
     EXPECT_EQ(busSystem.StopByID(1), nullptr);
     EXPECT_EQ(busSystem.RouteByIndex(0), nullptr);
     EXPECT_EQ(busSystem.RouteByName("Route1"), nullptr);
-}
\ No newline at end of file
+}
+// Test loading the real data files through CDSVReader
+TEST(CSVBusSystemDataTest, LoadsDataFiles) {
+    std::ifstream stopFile("data/stops.csv");
+    std::ifstream routeFile("data/routes.csv");
+    std::stringstream stopData, routeData;
+    stopData << stopFile.rdbuf();
+    routeData << routeFile.rdbuf();
+    auto stopReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(stopData.str()), ',');
+    auto routeReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(routeData.str()), ',');
+
+    CCSVBusSystem busSystem(stopReader, routeReader);
+
+    // The header rows aren't stops or routes
+    EXPECT_EQ(busSystem.StopCount(), 298);
+    EXPECT_EQ(busSystem.RouteCount(), 17);
+    EXPECT_EQ(busSystem.ErrorCount(), 0);
+
+    auto stop = busSystem.StopByIndex(0);
+    ASSERT_NE(stop, nullptr);
+    EXPECT_EQ(stop->ID(), 22043);
+    EXPECT_EQ(stop->NodeID(), 2849810514);
+
+    // Routes keep the order they first appear in
+    auto route = busSystem.RouteByIndex(0);
+    ASSERT_NE(route, nullptr);
+    EXPECT_EQ(route->Name(), "A");
+    EXPECT_EQ(route->StopCount(), 22);
+    EXPECT_EQ(route->GetStopID(0), 22258);
+    EXPECT_EQ(busSystem.RouteByName("Z"), busSystem.RouteByIndex(16));
+}
+
+// Test the reverse index from stops to the routes that stop there
+TEST(CSVBusSystemDataTest, RoutesByStopID) {
+    auto stopReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("stop_id,node_id\n1,100\n2,200\n3,300\n"), ',');
+    auto routeReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("route,stop_id\nA,1\nA,2\nA,1\nB,2\nB,4\nC,1\n"), ',');
+    CCSVBusSystem busSystem(stopReader, routeReader);
+    std::vector<CBusSystem::SRouteStop> routes;
+
+    // Route A passes stop 1 twice
+    ASSERT_TRUE(busSystem.RoutesByStopID(1, routes));
+    ASSERT_EQ(routes.size(), 3);
+    EXPECT_EQ(routes[0].RouteIndex, 0);
+    EXPECT_EQ(routes[0].Position, 0);
+    EXPECT_EQ(routes[1].RouteIndex, 0);
+    EXPECT_EQ(routes[1].Position, 2);
+    EXPECT_EQ(routes[2].RouteIndex, 2);
+    EXPECT_EQ(routes[2].Position, 0);
+
+    ASSERT_TRUE(busSystem.RoutesByStopID(2, routes));
+    ASSERT_EQ(routes.size(), 2);
+    EXPECT_EQ(busSystem.RouteByIndex(routes[1].RouteIndex)->GetStopID(routes[1].Position), 2);
+
+    // A route can name a stop that isn't in the stop file
+    ASSERT_TRUE(busSystem.RoutesByStopID(4, routes));
+    ASSERT_EQ(routes.size(), 1);
+    EXPECT_EQ(routes[0].RouteIndex, 1);
+    EXPECT_EQ(routes[0].Position, 1);
+
+    // Stop 3 is in no route
+    EXPECT_FALSE(busSystem.RoutesByStopID(3, routes));
+    EXPECT_TRUE(routes.empty());
+    EXPECT_FALSE(busSystem.RoutesByStopID(5, routes));
+}
+
+// Test the reverse index against a scan of every route
+TEST(CSVBusSystemDataTest, RoutesByStopIDMatchesScan) {
+    std::ifstream stopFile("data/stops.csv");
+    std::ifstream routeFile("data/routes.csv");
+    std::stringstream stopData, routeData;
+    stopData << stopFile.rdbuf();
+    routeData << routeFile.rdbuf();
+    auto stopReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(stopData.str()), ',');
+    auto routeReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(routeData.str()), ',');
+    CCSVBusSystem busSystem(stopReader, routeReader);
+    std::vector<CBusSystem::SRouteStop> routes;
+    std::size_t total = 0;
+    for (std::size_t index = 0; index < busSystem.StopCount(); index++) {
+        auto id = busSystem.StopByIndex(index)->ID();
+        std::vector<std::pair<std::size_t, std::size_t>> expected, actual;
+        for (std::size_t routeIndex = 0; routeIndex < busSystem.RouteCount(); routeIndex++) {
+            auto route = busSystem.RouteByIndex(routeIndex);
+            for (std::size_t position = 0; position < route->StopCount(); position++) {
+                if (route->GetStopID(position) == id) {
+                    expected.push_back({routeIndex, position});
+                }
+            }
+        }
+        EXPECT_EQ(busSystem.RoutesByStopID(id, routes), !expected.empty());
+        for (const auto &routeStop : routes) {
+            actual.push_back({routeStop.RouteIndex, routeStop.Position});
+        }
+        EXPECT_EQ(actual, expected);
+        total += actual.size();
+    }
+    EXPECT_GT(total, 0);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "ContractionHierarchy.h"
+#include "ContractionHierarchySearch.h"
+#include "ShortestPathSearch.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "MappedFileDataSource.h"
+#include "TestUtils.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+// checks random queries against Dijkstra on the original graph
+static void ExpectMatchesDijkstra(std::shared_ptr<const CRoutingGraph> graph, std::shared_ptr<const CContractionHierarchy> hierarchy, int queries, unsigned seed){
+    CShortestPathSearch Reference(graph);
+    CContractionHierarchySearch Search(hierarchy);
+    std::mt19937 Generator(seed);
+    std::uniform_int_distribution<CRoutingGraph::TVertexID> Pick(0, graph->VertexCount() - 1);
+    std::vector<CRoutingGraph::TVertexID> ReferencePath, Path;
+    std::size_t Connected = 0;
+    for(int Query = 0; Query < queries; Query++){
+        auto Source = Pick(Generator), Destination = Pick(Generator);
+        double Expected = Reference.Dijkstra(Source, Destination, ReferencePath);
+        double Distance = Search.FindShortestPath(Source, Destination, Path);
+        ASSERT_EQ(Distance == CContractionHierarchySearch::NoPathExists, Expected == CShortestPathSearch::NoPathExists);
+        EXPECT_EQ(Search.FindDistance(Source, Destination), Distance);
+        if(Expected == CShortestPathSearch::NoPathExists){
+            EXPECT_TRUE(Path.empty());
+            continue;
+        }
+        Connected++;
+        EXPECT_NEAR(Distance, Expected, 1e-6);
+        ASSERT_EQ(Path.front(), Source);
+        ASSERT_EQ(Path.back(), Destination);
+        EXPECT_NEAR(TestUtils::PathLength(*graph, Path), Expected, 1e-6);
+    }
+    EXPECT_GT(Connected, 0);
+}
+
+TEST(ContractionHierarchy, SmallMapTest){
+    auto Map = TestUtils::SmallMap();
+    auto Graph = std::make_shared<CRoutingGraph>(*Map);
+    auto Hierarchy = std::make_shared<CContractionHierarchy>(*Graph, 2);
+    ASSERT_TRUE(Hierarchy->IsValid());
+    ASSERT_EQ(Hierarchy->VertexCount(), 6);
+    std::vector<bool> RankUsed(6, false);
+    for(CRoutingGraph::TVertexID Vertex = 0; Vertex < 6; Vertex++){
+        ASSERT_LT(Hierarchy->Rank(Vertex), 6);
+        EXPECT_FALSE(RankUsed[Hierarchy->Rank(Vertex)]);
+        RankUsed[Hierarchy->Rank(Vertex)] = true;
+    }
+    CContractionHierarchySearch Search(Hierarchy);
+    auto V1 = Graph->VertexByNodeID(1), V3 = Graph->VertexByNodeID(3), V5 = Graph->VertexByNodeID(5), V6 = Graph->VertexByNodeID(6);
+    std::vector<CRoutingGraph::TVertexID> Path;
+    EXPECT_GT(Search.FindShortestPath(V1, V5, Path), 0.0);
+    EXPECT_EQ(Path.size(), 5);
+    EXPECT_EQ(Search.FindShortestPath(V5, V1, Path), CContractionHierarchySearch::NoPathExists);
+    EXPECT_TRUE(Path.empty());
+    EXPECT_EQ(Search.FindShortestPath(V1, V6, Path), CContractionHierarchySearch::NoPathExists);
+    EXPECT_EQ(Search.FindShortestPath(V3, V3, Path), 0.0);
+    EXPECT_EQ(Path, std::vector<CRoutingGraph::TVertexID>({V3}));
+    EXPECT_EQ(Search.FindShortestPath(V1, 100, Path), CContractionHierarchySearch::NoPathExists);
+    ExpectMatchesDijkstra(Graph, Hierarchy, 100, 3);
+}
+
+TEST(ContractionHierarchy, DavisRandomPairsTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    auto Graph = std::make_shared<CRoutingGraph>(Map);
+    auto Hierarchy = std::make_shared<CContractionHierarchy>(*Graph);
+    ASSERT_TRUE(Hierarchy->IsValid());
+    EXPECT_EQ(Hierarchy->VertexCount(), Graph->VertexCount());
+    ExpectMatchesDijkstra(Graph, Hierarchy, 300, 17);
+}
+
+TEST(ContractionHierarchy, SaveLoadTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    auto Graph = std::make_shared<CRoutingGraph>(Map);
+    CContractionHierarchy Built(*Graph);
+    std::string Filename = "/tmp/ContractionHierarchyTest.ch";
+    ASSERT_TRUE(Built.Save(Filename));
+    auto Loaded = std::make_shared<CContractionHierarchy>(Filename);
+    ASSERT_TRUE(Loaded->IsValid());
+    EXPECT_EQ(Loaded->VertexCount(), Built.VertexCount());
+    EXPECT_EQ(Loaded->ShortcutCount(), Built.ShortcutCount());
+    EXPECT_EQ(Loaded->ForwardGraph().Targets, Built.ForwardGraph().Targets);
+    EXPECT_EQ(Loaded->BackwardGraph().Weights, Built.BackwardGraph().Weights);
+    ExpectMatchesDijkstra(Graph, Loaded, 100, 5);
+
+    // a truncated file is rejected rather than read past its end
+    {
+        std::ifstream Input(Filename, std::ios::binary);
+        std::string Contents((std::istreambuf_iterator<char>(Input)), std::istreambuf_iterator<char>());
+        std::ofstream Output(Filename, std::ios::binary | std::ios::trunc);
+        Output.write(Contents.data(), Contents.size() / 2);
+    }
+    EXPECT_FALSE(CContractionHierarchy(Filename).IsValid());
+    std::remove(Filename.c_str());
+    EXPECT_FALSE(CContractionHierarchy(Filename).IsValid());
+    EXPECT_FALSE(CContractionHierarchy("/nonexistent/ContractionHierarchyTest.ch").Save("/nonexistent/ContractionHierarchyTest.ch"));
+}
+
+// writes a two vertex hierarchy file by hand with one forward edge 0 -> 1
+// that skips middle
+static void WriteTinyHierarchy(const std::string &filename, CRoutingGraph::TVertexID middle){
+    std::string Contents("CONTRHIE", 8);
+    auto Append = [&Contents](const auto &value){
+        Contents.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+    Append(uint32_t(+CContractionHierarchy::Version));
+    Append(uint32_t(40));
+    Append(uint64_t(2));
+    Append(uint64_t(1));
+    Append(uint64_t(0));
+    // ranks
+    Append(uint32_t(0));
+    Append(uint32_t(1));
+    // forward offsets, target, weight and middle
+    Append(uint32_t(0));
+    Append(uint32_t(1));
+    Append(uint32_t(1));
+    Append(CRoutingGraph::TVertexID(1));
+    Append(double(1.0));
+    Append(middle);
+    // backward offsets
+    Append(uint32_t(0));
+    Append(uint32_t(0));
+    Append(uint32_t(0));
+    std::ofstream Output(filename, std::ios::binary | std::ios::trunc);
+    Output.write(Contents.data(), Contents.size());
+}
+
+TEST(ContractionHierarchy, CorruptShortcutTest){
+    std::string Filename = "/tmp/ContractionHierarchyCorruptTest.ch";
+    WriteTinyHierarchy(Filename, CRoutingGraph::InvalidVertexID);
+    CContractionHierarchy Plain(Filename);
+    ASSERT_TRUE(Plain.IsValid());
+    std::vector<CRoutingGraph::TVertexID> Path;
+    EXPECT_TRUE(Plain.UnpackEdge(0, 1, Path));
+    EXPECT_EQ(Path, std::vector<CRoutingGraph::TVertexID>({1}));
+
+    // a middle that is an end of its own shortcut, or not ranked below both
+    // ends, would unpack forever
+    for(CRoutingGraph::TVertexID Middle : {0, 1}){
+        WriteTinyHierarchy(Filename, Middle);
+        EXPECT_FALSE(CContractionHierarchy(Filename).IsValid());
+    }
+    std::remove(Filename.c_str());
+}
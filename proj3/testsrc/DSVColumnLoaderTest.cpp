@@ -0,0 +1,65 @@
+#include "DSVColumnLoader.h"
+#include "StringDataSource.h"
+#include <gtest/gtest.h>
+
+static std::shared_ptr<CDSVReader> MakeReader(const std::string &contents) {
+    return std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(contents), ',');
+}
+
+TEST(DSVColumnLoaderTest, ProjectsHeaderColumns) {
+    CDSVColumnLoader loader(MakeReader("name,node_id,stop_id\n\"Main, St\",100,1\nOak,200,2\n"));
+    std::size_t stopColumn = loader.AddUIntColumn("stop_id", 0);
+    std::size_t nodeColumn = loader.AddUIntColumn("node_id", 1);
+
+    EXPECT_TRUE(loader.Load());
+    EXPECT_TRUE(loader.HasHeader());
+    EXPECT_EQ(loader.RowCount(), 2);
+    EXPECT_EQ(loader.ErrorCount(), 0);
+    EXPECT_EQ(loader.UIntColumn(stopColumn), std::vector<uint64_t>({1, 2}));
+    EXPECT_EQ(loader.UIntColumn(nodeColumn), std::vector<uint64_t>({100, 200}));
+}
+
+TEST(DSVColumnLoaderTest, FallsBackToPositionsWithoutHeader) {
+    CDSVColumnLoader loader(MakeReader("1,100\n2,200"));
+    std::size_t stopColumn = loader.AddUIntColumn("stop_id", 0);
+    std::size_t nodeColumn = loader.AddUIntColumn("node_id", 1);
+
+    EXPECT_TRUE(loader.Load());
+    EXPECT_FALSE(loader.HasHeader());
+    EXPECT_EQ(loader.UIntColumn(stopColumn), std::vector<uint64_t>({1, 2}));
+    EXPECT_EQ(loader.UIntColumn(nodeColumn), std::vector<uint64_t>({100, 200}));
+}
+
+TEST(DSVColumnLoaderTest, CountsBadRows) {
+    CDSVColumnLoader loader(MakeReader("stop_id,node_id\n1,100\nx,200\n3\n\n4, 400 \n5,5z\n"));
+    std::size_t stopColumn = loader.AddUIntColumn("stop_id", 0);
+    std::size_t nodeColumn = loader.AddUIntColumn("node_id", 1);
+
+    EXPECT_TRUE(loader.Load());
+    EXPECT_EQ(loader.RowCount(), 2);
+    EXPECT_EQ(loader.ErrorCount(), 3);
+    EXPECT_EQ(loader.UIntColumn(stopColumn), std::vector<uint64_t>({1, 4}));
+    EXPECT_EQ(loader.UIntColumn(nodeColumn), std::vector<uint64_t>({100, 400}));
+}
+
+TEST(DSVColumnLoaderTest, DictionaryEncodesCategories) {
+    CDSVColumnLoader loader(MakeReader("route,stop_id\nA,1\nA,2\nB,2\nA,3\n"));
+    std::size_t routeColumn = loader.AddCategoryColumn("route", 0);
+    std::size_t stopColumn = loader.AddUIntColumn("stop_id", 1);
+
+    EXPECT_TRUE(loader.Load());
+    EXPECT_EQ(loader.Categories(routeColumn), std::vector<std::string>({"A", "B"}));
+    EXPECT_EQ(loader.CategoryColumn(routeColumn), std::vector<uint32_t>({0, 0, 1, 0}));
+    EXPECT_EQ(loader.UIntColumn(stopColumn), std::vector<uint64_t>({1, 2, 2, 3}));
+    EXPECT_TRUE(loader.UIntColumn(routeColumn).empty());
+    EXPECT_TRUE(loader.Categories(5).empty());
+}
+
+TEST(DSVColumnLoaderTest, EmptyInput) {
+    CDSVColumnLoader loader(MakeReader(""));
+    loader.AddUIntColumn("stop_id", 0);
+
+    EXPECT_FALSE(loader.Load());
+    EXPECT_EQ(loader.RowCount(), 0);
+    EXPECT_EQ(loader.ErrorCount(), 0);
+}
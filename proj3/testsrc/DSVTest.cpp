@@ -121,4 +121,83 @@ TEST(DSVTest, ExtraWhitespaceHandling) {
     }
 
     EXPECT_EQ(sink->String(), "  a , b ,c\n1,2 , 3\n");  // Expect the original spacing to be preserved.
-}
\ No newline at end of file
+}
+TEST(DSVTest, QuotedNewlinesAndEscapedQuotes) {
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("\"line\nbreak\",\"say \"\"hi\"\"\"\nnext,row\n");
+
+    CDSVReader reader(src, ',');
+
+    std::vector<std::string> row;
+    EXPECT_TRUE(reader.ReadRow(row));
+    ASSERT_EQ(row.size(), 2);
+    EXPECT_EQ(row[0], "line\nbreak");
+    EXPECT_EQ(row[1], "say \"hi\"");
+    EXPECT_TRUE(reader.ReadRow(row));
+    ASSERT_EQ(row.size(), 2);
+    EXPECT_EQ(row[0], "next");
+    EXPECT_EQ(row[1], "row");
+    EXPECT_TRUE(reader.End());
+    EXPECT_FALSE(reader.ReadRow(row));
+}
+
+TEST(DSVTest, CarriageReturnLineEndings) {
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("a,b\r\n\r\nc,d\re,\r\n");
+
+    CDSVReader reader(src, ',');
+
+    std::vector<std::string> row;
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"a", "b"}));
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_TRUE(row.empty());
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"c", "d"}));
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"e", ""}));
+    EXPECT_TRUE(reader.End());
+}
+
+TEST(DSVTest, ReadRowView) {
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("plain,\"quoted, cell\",\"esc\"\"aped\"\n,x");
+
+    CDSVReader reader(src, ',');
+
+    std::vector<std::string_view> row;
+    EXPECT_TRUE(reader.ReadRowView(row));
+    ASSERT_EQ(row.size(), 3);
+    EXPECT_EQ(row[0], "plain");
+    EXPECT_EQ(row[1], "quoted, cell");
+    EXPECT_EQ(row[2], "esc\"aped");
+    EXPECT_TRUE(reader.ReadRowView(row));
+    ASSERT_EQ(row.size(), 2);
+    EXPECT_EQ(row[0], "");
+    EXPECT_EQ(row[1], "x");
+    EXPECT_FALSE(reader.ReadRowView(row));
+    EXPECT_TRUE(row.empty());
+}
+
+TEST(DSVTest, RowsLongerThanManyRefills) {
+    // a quoted cell with escaped quotes and newlines several megabytes long,
+    // so the row is only complete after the buffer has grown a few times
+    std::string cell;
+    while (cell.size() < 3000000) {
+        cell += "some text, \"quoted\"\nand more ";
+    }
+    std::string escaped;
+    for (char ch : cell) {
+        escaped += ch == '"' ? "\"\"" : std::string(1, ch);
+    }
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("a,\"" + escaped + "\",b\nc,d\n");
+
+    CDSVReader reader(src, ',');
+
+    std::vector<std::string> row;
+    EXPECT_TRUE(reader.ReadRow(row));
+    ASSERT_EQ(row.size(), 3);
+    EXPECT_EQ(row[0], "a");
+    EXPECT_EQ(row[1], cell);
+    EXPECT_EQ(row[2], "b");
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"c", "d"}));
+    EXPECT_FALSE(reader.ReadRow(row));
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "FileDataSink.h"
+#include "TestUtils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+TEST(FileDataSink, MissingDirectoryTest){
+    CFileDataSink Sink("/nonexistent/FileDataSinkTest");
+
+    EXPECT_FALSE(Sink.IsOpen());
+    EXPECT_FALSE(Sink.Put('x'));
+    EXPECT_FALSE(Sink.Write("abc",3));
+    EXPECT_FALSE(Sink.Flush());
+}
+
+TEST(FileDataSink, WhenFullTest){
+    std::string Name = TestUtils::TemporaryFile();
+    {
+        CFileDataSink Sink(Name, CFileDataSink::EFlushPolicy::WhenFull, 4);
+        EXPECT_TRUE(Sink.IsOpen());
+        EXPECT_TRUE(Sink.Put('H'));
+        EXPECT_TRUE(Sink.Write("ell",3));
+        EXPECT_EQ(TestUtils::FileContents(Name),"");
+        EXPECT_TRUE(Sink.Put('o'));
+        EXPECT_EQ(TestUtils::FileContents(Name),"Hell");
+        EXPECT_TRUE(Sink.Write(std::vector<char>{' ','W','o','r','l','d'}));
+        EXPECT_EQ(TestUtils::FileContents(Name),"Hello World");
+        EXPECT_TRUE(Sink.Put('!'));
+    }
+    EXPECT_EQ(TestUtils::FileContents(Name),"Hello World!");
+    std::remove(Name.c_str());
+}
+
+TEST(FileDataSink, EveryWriteTest){
+    std::string Name = TestUtils::TemporaryFile();
+    CFileDataSink Sink(Name, CFileDataSink::EFlushPolicy::EveryWrite);
+
+    EXPECT_TRUE(Sink.Write("abc",3));
+    EXPECT_EQ(TestUtils::FileContents(Name),"abc");
+    EXPECT_TRUE(Sink.Put('d'));
+    EXPECT_EQ(TestUtils::FileContents(Name),"abcd");
+    std::remove(Name.c_str());
+}
+
+TEST(FileDataSink, AppendTest){
+    std::string Name = TestUtils::TemporaryFile();
+    {
+        CFileDataSink Sink(Name, CFileDataSink::EFlushPolicy::Sync);
+        EXPECT_TRUE(Sink.Write("first\n",6));
+        EXPECT_TRUE(Sink.Flush());
+        EXPECT_EQ(TestUtils::FileContents(Name),"first\n");
+    }
+    {
+        CFileDataSink Sink(Name);
+        EXPECT_TRUE(Sink.Write("second\n",7));
+    }
+    EXPECT_EQ(TestUtils::FileContents(Name),"first\nsecond\n");
+    std::remove(Name.c_str());
+}
+
+TEST(FileDataSink, ReplaceFileTest){
+    char Directory[] = "/tmp/FileDataSinkTestXXXXXX";
+    ASSERT_NE(mkdtemp(Directory),nullptr);
+    std::string Name = std::string(Directory) + "/file";
+    {
+        CFileDataSink Sink(Name);
+        EXPECT_TRUE(Sink.Write("old contents",12));
+    }
+    EXPECT_TRUE(CFileDataSink::ReplaceFile(Name, {"new", " ", "contents"}));
+    EXPECT_EQ(TestUtils::FileContents(Name),"new contents");
+    struct stat FileStat;
+    ASSERT_EQ(stat(Name.c_str(), &FileStat),0);
+    EXPECT_EQ(FileStat.st_mode & 0044,0044);
+    // two savers racing on one file never see each other's temporary file
+    auto Save = [&Name](const std::string &contents){
+        for(int Index = 0; Index < 50; Index++){
+            EXPECT_TRUE(CFileDataSink::ReplaceFile(Name, {contents}));
+        }
+    };
+    std::string First(100000, 'a'), Second(200000, 'b');
+    std::thread Other(Save, Second);
+    Save(First);
+    Other.join();
+    std::string Contents = TestUtils::FileContents(Name);
+    EXPECT_TRUE(Contents == First || Contents == Second);
+    // nothing but the file itself is left in the directory
+    EXPECT_EQ(std::remove(Name.c_str()),0);
+    EXPECT_EQ(rmdir(Directory),0);
+    EXPECT_FALSE(CFileDataSink::ReplaceFile("/nonexistent/FileDataSinkTest", {"abc"}));
+}
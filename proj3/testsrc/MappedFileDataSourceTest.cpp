@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "MappedFileDataSource.h"
+#include "TestUtils.h"
+#include <cstdio>
+#include <string>
+
+TEST(MappedFileDataSource, MissingFileTest){
+    CMappedFileDataSource Source("/nonexistent/MappedFileDataSourceTest");
+    char TempCh = 'x';
+
+    EXPECT_FALSE(Source.IsOpen());
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'x');
+}
+
+TEST(MappedFileDataSource, EmptyFileTest){
+    std::string Name = TestUtils::TemporaryFile("");
+    CMappedFileDataSource Source(Name);
+    std::vector< char > TempVector;
+
+    EXPECT_TRUE(Source.IsOpen());
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Read(TempVector,3));
+    EXPECT_EQ(TempVector.size(),0);
+    std::remove(Name.c_str());
+}
+
+TEST(MappedFileDataSource, GetPeekTest){
+    std::string Name = TestUtils::TemporaryFile("Bye");
+    CMappedFileDataSource Source(Name);
+    char TempCh = 'x';
+
+    EXPECT_FALSE(Source.End());
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'B');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'B');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'y');
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    EXPECT_EQ(Source.Position(),2);
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    TempCh = 'x';
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'x');
+    std::remove(Name.c_str());
+}
+
+TEST(MappedFileDataSource, ReadTest){
+    std::string Name = TestUtils::TemporaryFile("Hello");
+    CMappedFileDataSource Source(Name);
+    std::vector< char > TempVector;
+    char TempCh = 'x';
+
+    EXPECT_EQ(Source.Size(),5);
+    EXPECT_EQ(std::string(Source.Data(),Source.Size()),"Hello");
+    EXPECT_TRUE(Source.Read(TempVector,4));
+    ASSERT_EQ(TempVector.size(),4);
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"Hell");
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'o');
+    EXPECT_TRUE(Source.Read(TempVector,4));
+    ASSERT_EQ(TempVector.size(),1);
+    EXPECT_EQ(TempVector[0],'o');
+    EXPECT_FALSE(Source.Read(TempVector,4));
+    EXPECT_TRUE(TempVector.empty());
+    std::remove(Name.c_str());
+}
+
+TEST(MappedFileDataSource, AccessPatternTest){
+    std::string Name = TestUtils::TemporaryFile("Hello");
+    for(auto Pattern : {CMappedFileDataSource::EAccessPattern::Sequential, CMappedFileDataSource::EAccessPattern::Random, CMappedFileDataSource::EAccessPattern::None}){
+        CMappedFileDataSource Source(Name, Pattern);
+        std::vector< char > TempVector;
+
+        EXPECT_TRUE(Source.IsOpen());
+        EXPECT_TRUE(Source.Read(TempVector,5));
+        EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"Hello");
+        EXPECT_TRUE(Source.End());
+    }
+    std::remove(Name.c_str());
+}
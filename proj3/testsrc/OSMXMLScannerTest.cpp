@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include "OSMXMLScanner.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "MappedFileDataSource.h"
+#include "TestUtils.h"
+#include <random>
+
+// loads a document both ways and checks they agree
+static void ExpectSameAsXMLReader(const std::string &document){
+    COpenStreetMap XMLMap(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(document)));
+    COpenStreetMap ScanMap(std::make_shared<COSMXMLScanner>(std::make_shared<CStringDataSource>(document)));
+    TestUtils::ExpectSameMap(XMLMap, ScanMap);
+}
+
+TEST(OSMXMLScanner, DavisTest){
+    COpenStreetMap XMLMap(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    auto Scanner = std::make_shared<COSMXMLScanner>(std::make_shared<CMappedFileDataSource>("data/davis.osm"));
+    COpenStreetMap ScanMap(Scanner);
+    EXPECT_TRUE(Scanner->End());
+    ASSERT_EQ(ScanMap.NodeCount(), 10259);
+    EXPECT_TRUE(ScanMap.IsValid());
+    TestUtils::ExpectSameMap(XMLMap, ScanMap);
+    EXPECT_EQ(ScanMap.NodeByID(62208369)->Location(), CStreetMap::TLocation(38.5178523, -121.7712408));
+}
+
+TEST(OSMXMLScanner, SyntaxTest){
+    std::string Document =
+        "\xEF\xBB\xBF<?xml version='1.0' encoding='UTF-8'?>\n"
+        "<!DOCTYPE osm [ <!ENTITY unused \"x\"> ]>\n"
+        "<osm version=\"0.6\">\n"
+        "  <!-- <node id=\"99\" lat=\"1\" lon=\"1\"/> -->\n"
+        "  <bounds minlat=\"38\" note=\"a > b\"/>\n"
+        "  <node id='1' lat = '38.5' lon=\"-121.75\" user=\"Tom &amp; Jerry&#39;s &#x263A;\"/>\n"
+        "  <node id=\"2\" lat=\"38.25\" lon=\"-121.5\" >\n"
+        "    <tag k=\"note\" v=\"line one\nline two\ttabbed\r\nend\"/>\n"
+        "    <tag k=\"quote\" v='say \"hi\"'/>\n"
+        "    <tag k=\"\" v=\"no key\"/>\n"
+        "    <![CDATA[ <tag k=\"hidden\" v=\"x\"/> ]]>\n"
+        "  </node >\n"
+        "  <way id=\"10\" visible=\"true\">\n"
+        "    <nd ref=\"1\"/><nd ref=\"2\"/>\n"
+        "    <tag k=\"name\" v=\"&lt;Main&gt; &quot;St&quot;\"/>\n"
+        "    <tag k=\"name\" v=\"Second\"/>\n"
+        "  </way>\n"
+        "  <relation id=\"5\"><member type=\"way\" ref=\"10\" role=\"\"/></relation>\n"
+        "</osm>\n";
+    ExpectSameAsXMLReader(Document);
+
+    COpenStreetMap Map(std::make_shared<COSMXMLScanner>(std::make_shared<CStringDataSource>(Document)));
+    ASSERT_EQ(Map.NodeCount(), 2);
+    ASSERT_EQ(Map.WayCount(), 1);
+    EXPECT_EQ(Map.NodeByIndex(0)->Location(), CStreetMap::TLocation(38.5, -121.75));
+    EXPECT_EQ(Map.NodeByIndex(0)->GetAttribute("user"), "Tom & Jerry's \xE2\x98\xBA");
+    EXPECT_EQ(Map.NodeByIndex(1)->GetAttribute("note"), "line one line two tabbed end");
+    EXPECT_EQ(Map.NodeByIndex(1)->GetAttribute("quote"), "say \"hi\"");
+    EXPECT_FALSE(Map.NodeByIndex(1)->HasAttribute("hidden"));
+    auto Way = Map.WayByID(10);
+    ASSERT_NE(Way, nullptr);
+    ASSERT_EQ(Way->NodeCount(), 2);
+    EXPECT_EQ(Way->GetNodeID(1), 2);
+    EXPECT_EQ(Way->GetAttribute("visible"), "true");
+    EXPECT_EQ(Way->GetAttribute("name"), "Second");
+}
+
+TEST(OSMXMLScanner, NumbersTest){
+    // short and long decimals, exponents and text that isn't a number all
+    // have to read the same as they do through CXMLReader
+    std::mt19937_64 Generator(24);
+    std::uniform_int_distribution<int> Digit(0, 9), Length(0, 20), Coin(0, 3);
+    std::string Document = "<osm>";
+    for(int Index = 0; Index < 2000; Index++){
+        std::string Coordinates[2];
+        for(auto &Coordinate : Coordinates){
+            Coordinate = Coin(Generator) ? "-" : "";
+            for(int Count = Length(Generator); Count > 0; Count--){
+                Coordinate.push_back('0' + Digit(Generator));
+            }
+            Coordinate += ".";
+            for(int Count = Length(Generator); Count > 0; Count--){
+                Coordinate.push_back('0' + Digit(Generator));
+            }
+            if(!Coin(Generator)){
+                Coordinate += "e-" + std::to_string(Digit(Generator));
+            }
+        }
+        std::string ID = std::to_string(Generator());
+        if(!Coin(Generator)){
+            ID += std::to_string(Digit(Generator));
+        }
+        Document += "<node id=\"" + ID + "\" lat=\"" + Coordinates[0] + "\" lon=\"" + Coordinates[1] + "\"/>\n";
+    }
+    Document += "<node id=\"abc\" lat=\"x1\" lon=\"-\"/><node id=\"-7\" lat=\"1.5xyz\" lon=\".25\"/>";
+    Document += "<way id=\"3\"><nd ref=\"99999999999999999999\"/><nd ref=\"18446744073709551615\"/></way></osm>";
+    ExpectSameAsXMLReader(Document);
+    COpenStreetMap Map(std::make_shared<COSMXMLScanner>(std::make_shared<CStringDataSource>(Document)));
+    EXPECT_EQ(Map.NodeCount(), 2002);
+    EXPECT_EQ(Map.WayCount(), 1);
+}
+
+TEST(OSMXMLScanner, MalformedTest){
+    // everything before the error is kept, the unfinished way is dropped
+    std::string Document = "<osm><node id=\"1\" lat=\"1\" lon=\"2\"/><way id=\"2\"><tag k=\"name\" v=\"&bogus;\"/></way><node id=\"3\"/></osm>";
+    auto Scanner = std::make_shared<COSMXMLScanner>(std::make_shared<CStringDataSource>(Document));
+    COpenStreetMap Map(Scanner);
+    EXPECT_TRUE(Scanner->End());
+    EXPECT_FALSE(Map.IsValid());
+    EXPECT_EQ(Map.NodeCount(), 1);
+    EXPECT_EQ(Map.WayCount(), 0);
+    ExpectSameAsXMLReader(Document);
+
+    for(std::string Broken : {"<osm><node id=\"1\" lat=\"1", "<osm><node id=1/>", "<osm><!-- never closed", "<osm><node id=\"1\" lat=\"a<b\"/>"}){
+        COSMXMLScanner Scanner(std::make_shared<CStringDataSource>(Broken));
+        class CNullVisitor : public COSMXMLVisitor{
+            public:
+                void BeginNode(uint64_t id, double latitude, double longitude) override{}
+                void EndNode() override{}
+                void BeginWay(uint64_t id) override{}
+                void EndWay() override{}
+                void WayNode(uint64_t ref) override{}
+                void Tag(std::string_view key, std::string_view value) override{}
+        } Visitor;
+        EXPECT_FALSE(Scanner.Scan(Visitor)) << Broken;
+    }
+}
+
+// writes down every call so scans can be compared
+class CRecordingScanVisitor : public COSMXMLVisitor{
+    public:
+        std::vector<std::string> Calls;
+
+        void BeginNode(uint64_t id, double latitude, double longitude) override{
+            Calls.push_back("node " + std::to_string(id) + " " + std::to_string(latitude) + " " + std::to_string(longitude));
+        }
+        void EndNode() override{
+            Calls.push_back("/node");
+        }
+        void BeginWay(uint64_t id) override{
+            Calls.push_back("way " + std::to_string(id));
+        }
+        void EndWay() override{
+            Calls.push_back("/way");
+        }
+        void WayNode(uint64_t ref) override{
+            Calls.push_back("nd " + std::to_string(ref));
+        }
+        void Tag(std::string_view key, std::string_view value) override{
+            Calls.push_back("tag " + std::string(key) + "=" + std::string(value));
+        }
+};
+
+TEST(OSMXMLScanner, SplitTest){
+    COSMXMLScanner Scanner(std::make_shared<CMappedFileDataSource>("data/davis.osm"));
+    for(std::size_t Count : {1, 2, 5, 16}){
+        auto Parts = Scanner.Split(Count);
+        ASSERT_GE(Parts.size(), 1);
+        EXPECT_LE(Parts.size(), Count);
+        CRecordingScanVisitor Split;
+        for(auto &Part : Parts){
+            std::size_t Before = Split.Calls.size();
+            EXPECT_TRUE(Part->Scan(Split));
+            EXPECT_TRUE(Part->End());
+            // every part after the first starts right at a node or way
+            if(&Part != &Parts.front()){
+                ASSERT_LT(Before, Split.Calls.size());
+                EXPECT_TRUE(Split.Calls[Before].substr(0, 5) == "node " || Split.Calls[Before].substr(0, 4) == "way ");
+            }
+        }
+        EXPECT_FALSE(Scanner.End());
+        CRecordingScanVisitor Whole;
+        COSMXMLScanner(std::make_shared<CMappedFileDataSource>("data/davis.osm")).Scan(Whole);
+        EXPECT_EQ(Split.Calls, Whole.Calls);
+    }
+    // a tiny document can't be split more than it has elements
+    COSMXMLScanner Tiny(std::make_shared<CStringDataSource>("<osm><node id=\"1\"/><way id=\"2\"/></osm>"));
+    EXPECT_EQ(Tiny.Split(8).size(), 3);
+}
+
+TEST(OSMXMLScanner, ParallelLoadTest){
+    COpenStreetMap XMLMap(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    for(std::size_t Threads : {1, 2, 3, 8, 64}){
+        auto Scanner = std::make_shared<COSMXMLScanner>(std::make_shared<CMappedFileDataSource>("data/davis.osm"));
+        COpenStreetMap ScanMap(Scanner, Threads);
+        // the scanner ends up in the same place however many threads read it
+        EXPECT_TRUE(Scanner->End());
+        TestUtils::ExpectSameMap(XMLMap, ScanMap);
+        EXPECT_EQ(ScanMap.WayByID(ScanMap.WayByIndex(100)->ID())->ID(), ScanMap.WayByIndex(100)->ID());
+    }
+}
+
+TEST(OSMXMLScanner, ParallelFallbackTest){
+    // comments and CDATA full of nodes across every boundary, and an error
+    // half way through, still load like they do on one thread
+    std::string Nodes;
+    for(int Index = 0; Index < 200; Index++){
+        Nodes += "<node id=\"" + std::to_string(Index) + "\" lat=\"1.5\" lon=\"2.5\"><tag k=\"n\" v=\"" + std::to_string(Index) + "\"/></node>\n";
+    }
+    std::string Commented = "<osm>" + Nodes + "<!--" + Nodes + "-->" + Nodes + "<![CDATA[" + Nodes + "]]>" + Nodes + "</osm>";
+    std::string Broken = "<osm>" + Nodes + "<node id=\"1000\" lat=\"1\" lon=\"1\" v=\"&bogus;\"/>" + Nodes + "</osm>";
+    for(auto &Document : {Commented, Broken}){
+        COpenStreetMap Sequential(std::make_shared<COSMXMLScanner>(std::make_shared<CStringDataSource>(Document)), 1);
+        COpenStreetMap XMLMap(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(Document)));
+        TestUtils::ExpectSameMap(XMLMap, Sequential);
+        for(std::size_t Threads : {2, 7, 32}){
+            COpenStreetMap Parallel(std::make_shared<COSMXMLScanner>(std::make_shared<CStringDataSource>(Document)), Threads);
+            TestUtils::ExpectSameMap(Sequential, Parallel);
+        }
+    }
+    EXPECT_EQ(COpenStreetMap(std::make_shared<COSMXMLScanner>(std::make_shared<CStringDataSource>(Commented)), 7).NodeCount(), 600);
+    EXPECT_EQ(COpenStreetMap(std::make_shared<COSMXMLScanner>(std::make_shared<CStringDataSource>(Broken)), 7).NodeCount(), 200);
+}
@@ -1,5 +1,6 @@
 #include "OpenStreetMap.h"
 #include "XMLReader.h"
+#include "StringDataSource.h"
 #include <gtest/gtest.h>
 #include <memory>
 #include <vector>
@@ -71,3 +72,87 @@ TEST_F(OpenStreetMapTest, MixedElementsTest) {
     EXPECT_EQ(osmMap.NodeCount(), 3);
     EXPECT_EQ(osmMap.WayCount(), 2);
 }
+
+TEST(OpenStreetMapDataTest, AttributesAndViews) {
+    auto source = std::make_shared<CStringDataSource>(
+        "<osm>"
+        "<node id=\"5\" lat=\"38.5\" lon=\"-121.75\" version=\"2\">"
+        "<tag k=\"name\" v=\"First\"/><tag k=\"amenity\" v=\"cafe\"/><tag k=\"name\" v=\"Second\"/>"
+        "</node>"
+        "<node id=\"3\" lat=\"1\" lon=\"2\"/>"
+        "<way id=\"9\"><nd ref=\"5\"/><nd ref=\"3\"/><tag k=\"name\" v=\"First\"/></way>"
+        "</osm>");
+    std::shared_ptr<CStreetMap::SNode> node;
+    std::shared_ptr<CStreetMap::SWay> way;
+    {
+        COpenStreetMap osmMap(std::make_shared<CXMLReader>(source));
+        ASSERT_EQ(osmMap.NodeCount(), 2);
+        ASSERT_EQ(osmMap.WayCount(), 1);
+        EXPECT_EQ(osmMap.NodeByID(3)->Location(), CStreetMap::TLocation(1.0, 2.0));
+        EXPECT_EQ(osmMap.NodeByIndex(1)->AttributeCount(), 0);
+        EXPECT_EQ(osmMap.NodeByID(4), nullptr);
+        EXPECT_EQ(osmMap.NodeByIndex(2), nullptr);
+        node = osmMap.NodeByID(5);
+        way = osmMap.WayByIndex(0);
+    }
+    // the views stay usable after the map is gone
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->ID(), 5);
+    EXPECT_EQ(node->Location(), CStreetMap::TLocation(38.5, -121.75));
+    // attributes keep document order, a repeated key keeps the last value
+    ASSERT_EQ(node->AttributeCount(), 3);
+    EXPECT_EQ(node->GetAttributeKey(0), "version");
+    EXPECT_EQ(node->GetAttributeKey(1), "name");
+    EXPECT_EQ(node->GetAttributeKey(2), "amenity");
+    EXPECT_EQ(node->GetAttributeKey(3), "");
+    EXPECT_EQ(node->GetAttribute("name"), "Second");
+    EXPECT_TRUE(node->HasAttribute("amenity"));
+    EXPECT_FALSE(node->HasAttribute("highway"));
+    EXPECT_EQ(node->GetAttribute("highway"), "");
+    ASSERT_NE(way, nullptr);
+    EXPECT_EQ(way->ID(), 9);
+    ASSERT_EQ(way->NodeCount(), 2);
+    EXPECT_EQ(way->GetNodeID(0), 5);
+    EXPECT_EQ(way->GetNodeID(1), 3);
+    EXPECT_EQ(way->GetNodeID(2), +CStreetMap::InvalidNodeID);
+    EXPECT_EQ(way->GetAttribute("name"), "First");
+}
+
+// readers with no data source still reach the map through ReadEntity
+TEST_F(OpenStreetMapTest, ReadEntityOnlyReaderTest) {
+    auto xmlReader = std::make_shared<MockXMLReader>();
+    SXMLEntity node{SXMLEntity::EType::StartElement, "node"};
+    node.SetAttribute("id", "7");
+    node.SetAttribute("lat", "38.5");
+    node.SetAttribute("lon", "-121.75");
+    node.SetAttribute("highway", "stop");
+    SXMLEntity way{SXMLEntity::EType::StartElement, "way"};
+    way.SetAttribute("id", "9");
+    SXMLEntity nd{SXMLEntity::EType::CompleteElement, "nd"};
+    nd.SetAttribute("ref", "7");
+    SXMLEntity tag{SXMLEntity::EType::CompleteElement, "tag"};
+    tag.SetAttribute("k", "name");
+    tag.SetAttribute("v", "A Street");
+    xmlReader->Data = {
+        node,
+        {SXMLEntity::EType::EndElement, "node"},
+        way, nd, tag,
+        {SXMLEntity::EType::EndElement, "way"}
+    };
+    COpenStreetMap osmMap(xmlReader);
+    ASSERT_EQ(osmMap.NodeCount(), 1);
+    ASSERT_EQ(osmMap.WayCount(), 1);
+    EXPECT_EQ(osmMap.NodeByIndex(0)->ID(), 7);
+    EXPECT_EQ(osmMap.NodeByIndex(0)->Location(), CStreetMap::TLocation(38.5, -121.75));
+    EXPECT_EQ(osmMap.NodeByIndex(0)->GetAttribute("highway"), "stop");
+    EXPECT_EQ(osmMap.WayByIndex(0)->GetNodeID(0), 7);
+    EXPECT_EQ(osmMap.WayByIndex(0)->GetAttribute("name"), "A Street");
+}
+
+TEST(OpenStreetMapDataTest, MalformedXMLTest) {
+    COpenStreetMap Whole(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>("<osm><node id=\"1\" lat=\"1\" lon=\"2\"/></osm>")));
+    EXPECT_TRUE(Whole.IsValid());
+    COpenStreetMap Broken(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>("<osm><node id=\"1\" lat=\"1\" lon=\"2\"/><node id=\"2\"</osm>")));
+    EXPECT_FALSE(Broken.IsValid());
+    EXPECT_EQ(Broken.NodeCount(), 1);
+}
@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include "PBFReader.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "MappedFileDataSource.h"
+#include "TestUtils.h"
+#include <zlib.h>
+
+// just enough of a protobuf encoder to build small PBF files by hand
+static std::string Varint(uint64_t value){
+    std::string Result;
+    while(value >= 0x80){
+        Result.push_back(char((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    Result.push_back(char(value));
+    return Result;
+}
+
+static uint64_t ZigZag(int64_t value){
+    return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+static std::string VarintField(uint32_t field, uint64_t value){
+    return Varint(field << 3) + Varint(value);
+}
+
+static std::string BytesField(uint32_t field, const std::string &bytes){
+    return Varint((field << 3) | 2) + Varint(bytes.size()) + bytes;
+}
+
+static std::string Packed(uint32_t field, const std::vector<uint64_t> &values){
+    std::string Bytes;
+    for(auto Value : values){
+        Bytes += Varint(Value);
+    }
+    return BytesField(field, Bytes);
+}
+
+static std::string Blob(const std::string &type, const std::string &payload, bool compress){
+    std::string Contents;
+    if(compress){
+        std::string Compressed(compressBound(payload.size()), '\0');
+        uLongf Length = Compressed.size();
+        compress2(reinterpret_cast<Bytef *>(&Compressed[0]), &Length, reinterpret_cast<const Bytef *>(payload.data()), payload.size(), 9);
+        Compressed.resize(Length);
+        Contents = VarintField(2, payload.size()) + BytesField(3, Compressed);
+    }
+    else{
+        Contents = BytesField(1, payload);
+    }
+    std::string Header = BytesField(1, type) + VarintField(3, Contents.size());
+    std::string Length = {char(Header.size() >> 24), char(Header.size() >> 16), char(Header.size() >> 8), char(Header.size())};
+    return Length + Header + Contents;
+}
+
+static std::string OSMHeader(const std::string &feature = "DenseNodes"){
+    return Blob("OSMHeader", BytesField(4, "OsmSchema-V0.6") + BytesField(4, feature), true);
+}
+
+static std::string StringTable(const std::vector<std::string> &strings){
+    std::string Table;
+    for(auto &String : strings){
+        Table += BytesField(1, String);
+    }
+    return BytesField(1, Table);
+}
+
+TEST(PBFReader, DavisTest){
+    COpenStreetMap XMLMap(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    for(std::size_t Threads : {1, 4}){
+        auto Reader = std::make_shared<CPBFReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm.pbf"), Threads);
+        COpenStreetMap PBFMap(Reader);
+        EXPECT_FALSE(Reader->Failed());
+        EXPECT_TRUE(Reader->End());
+        ASSERT_EQ(PBFMap.NodeCount(), 10259);
+        EXPECT_TRUE(PBFMap.IsValid());
+        TestUtils::ExpectSameMap(XMLMap, PBFMap);
+        EXPECT_EQ(PBFMap.NodeByID(62208369)->Location(), CStreetMap::TLocation(38.5178523, -121.7712408));
+    }
+}
+
+TEST(PBFReader, ToolWrittenDavisTest){
+    // data/davis.osmium.osm.pbf is written from data/davis.osm by a standard
+    // tool rather than by this project, with
+    //   osmium cat data/davis.osm -o data/davis.osmium.osm.pbf
+    // so the reader is checked against files it didn't shape
+    if(!CMappedFileDataSource("data/davis.osmium.osm.pbf").IsOpen()){
+        GTEST_SKIP() << "data/davis.osmium.osm.pbf is not present";
+    }
+    COpenStreetMap XMLMap(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    for(std::size_t Threads : {1, 4}){
+        COpenStreetMap PBFMap(std::make_shared<CPBFReader>(std::make_shared<CMappedFileDataSource>("data/davis.osmium.osm.pbf"), Threads));
+        EXPECT_TRUE(PBFMap.IsValid());
+        TestUtils::ExpectSameMap(XMLMap, PBFMap);
+    }
+}
+
+TEST(PBFReader, ToolHeaderTest){
+    // the header osmium and osmconvert write: a bounding box, the required
+    // features, optional ones such as the sort order, the writing program
+    // and replication fields, none of which may stop the load
+    std::string BBox = VarintField(1, ZigZag(-121800000000)) + VarintField(2, ZigZag(-121700000000)) + VarintField(3, ZigZag(38600000000)) + VarintField(4, ZigZag(38500000000));
+    std::string Header = BytesField(1, BBox) + BytesField(4, "OsmSchema-V0.6") + BytesField(4, "DenseNodes")
+        + BytesField(5, "Sort.Type_then_ID") + BytesField(5, "LocationsOnWays") + BytesField(16, "osmium/1.16.0")
+        + BytesField(17, "davis.osm") + VarintField(32, 1700000000) + VarintField(33, 42) + BytesField(34, "https://planet.osm.org/replication/minute");
+    // metadata the input didn't have is written as zeros, and a block whose
+    // nodes have no tags leaves out keys_vals
+    std::string DenseInfo = Packed(1, {0, 0}) + Packed(2, {0, 0}) + Packed(3, {0, 0}) + Packed(4, {0, 0}) + Packed(5, {0, 0});
+    std::string Dense = Packed(1, {ZigZag(62208369), ZigZag(735)}) + BytesField(5, DenseInfo)
+        + Packed(8, {ZigZag(385178523), ZigZag(171997)}) + Packed(9, {ZigZag(-1217712408), ZigZag(303802)});
+    std::string WayMessage = VarintField(1, 10) + Packed(8, {ZigZag(62208369), ZigZag(735)});
+    std::string File = Blob("OSMHeader", Header, true)
+        + Blob("OSMData", StringTable({""}) + BytesField(2, BytesField(2, Dense)), true)
+        + Blob("OSMData", StringTable({""}) + BytesField(2, BytesField(3, WayMessage)), true);
+
+    auto Reader = std::make_shared<CPBFReader>(std::make_shared<CStringDataSource>(File));
+    COpenStreetMap Map(Reader);
+    EXPECT_FALSE(Reader->Failed());
+    EXPECT_TRUE(Map.IsValid());
+    ASSERT_EQ(Map.NodeCount(), 2);
+    ASSERT_EQ(Map.WayCount(), 1);
+    EXPECT_EQ(Map.NodeByIndex(0)->Location(), CStreetMap::TLocation(38.5178523, -121.7712408));
+    EXPECT_EQ(Map.NodeByIndex(1)->Location(), CStreetMap::TLocation(38.535052, -121.7408606));
+    EXPECT_EQ(Map.NodeByIndex(0)->AttributeCount(), 0);
+    EXPECT_EQ(Map.NodeByIndex(1)->AttributeCount(), 0);
+    EXPECT_EQ(Map.WayByID(10)->GetNodeID(1), 62209104);
+    EXPECT_EQ(Map.WayByID(10)->AttributeCount(), 0);
+}
+
+TEST(PBFReader, NodesWaysAndMetadataTest){
+    std::vector<std::string> Strings = {"", "name", "Main St", "highway", "residential", "alice"};
+    std::string Info = VarintField(1, 3) + VarintField(2, 1230768000) + VarintField(3, 42) + VarintField(4, 7) + VarintField(5, 5);
+    std::string Node = VarintField(1, ZigZag(-5)) + Packed(2, {1}) + Packed(3, {2}) + BytesField(4, Info) + VarintField(8, ZigZag(385000000)) + VarintField(9, ZigZag(-1217500000));
+    std::string Dense = Packed(1, {ZigZag(10), ZigZag(2)}) + Packed(8, {ZigZag(1), ZigZag(1)}) + Packed(9, {ZigZag(-2), ZigZag(0)}) + Packed(10, {3, 4, 0, 0});
+    std::string WayMessage = VarintField(1, 99) + Packed(2, {1, 3}) + Packed(3, {2, 4}) + Packed(8, {ZigZag(10), ZigZag(2)});
+    std::string Relation = VarintField(1, 1000);
+    std::string Block = StringTable(Strings)
+        + BytesField(2, BytesField(1, Node) + BytesField(2, Dense))
+        + BytesField(2, BytesField(3, WayMessage) + BytesField(4, Relation))
+        + VarintField(17, 1000) + VarintField(19, 1000000);
+    std::string File = OSMHeader() + Blob("OSMUnknown", "ignored", false) + Blob("OSMData", Block, false);
+
+    auto Reader = std::make_shared<CPBFReader>(std::make_shared<CStringDataSource>(File));
+    COpenStreetMap Map(Reader);
+    EXPECT_FALSE(Reader->Failed());
+    ASSERT_EQ(Map.NodeCount(), 3);
+    ASSERT_EQ(Map.WayCount(), 1);
+
+    auto First = Map.NodeByIndex(0);
+    EXPECT_EQ(First->ID(), uint64_t(-5));
+    EXPECT_EQ(First->Location(), CStreetMap::TLocation(385.001, -1217.5));
+    ASSERT_EQ(First->AttributeCount(), 6);
+    EXPECT_EQ(First->GetAttributeKey(0), "version");
+    EXPECT_EQ(First->GetAttribute("version"), "3");
+    EXPECT_EQ(First->GetAttribute("timestamp"), "2009-01-01T00:00:00Z");
+    EXPECT_EQ(First->GetAttribute("changeset"), "42");
+    EXPECT_EQ(First->GetAttribute("uid"), "7");
+    EXPECT_EQ(First->GetAttribute("user"), "alice");
+    EXPECT_EQ(First->GetAttributeKey(5), "name");
+    EXPECT_EQ(First->GetAttribute("name"), "Main St");
+
+    // dense IDs and coordinates are delta coded, granularity 1000 and a 1e6 nanodegree latitude offset
+    EXPECT_EQ(Map.NodeByIndex(1)->ID(), 10);
+    EXPECT_EQ(Map.NodeByIndex(2)->ID(), 12);
+    EXPECT_EQ(Map.NodeByIndex(1)->Location(), CStreetMap::TLocation(0.001001, -0.000002));
+    EXPECT_EQ(Map.NodeByIndex(2)->Location(), CStreetMap::TLocation(0.001002, -0.000002));
+    EXPECT_EQ(Map.NodeByIndex(1)->GetAttribute("highway"), "residential");
+    EXPECT_EQ(Map.NodeByIndex(2)->AttributeCount(), 0);
+
+    auto Way = Map.WayByID(99);
+    ASSERT_NE(Way, nullptr);
+    ASSERT_EQ(Way->NodeCount(), 2);
+    EXPECT_EQ(Way->GetNodeID(0), 10);
+    EXPECT_EQ(Way->GetNodeID(1), 12);
+    EXPECT_EQ(Way->GetAttribute("name"), "Main St");
+    EXPECT_EQ(Way->GetAttribute("highway"), "residential");
+}
+
+TEST(PBFReader, BatchTest){
+    std::string File = OSMHeader();
+    for(uint64_t ID = 1; ID <= 5; ID++){
+        std::string Dense = Packed(1, {ZigZag(ID)}) + Packed(8, {0}) + Packed(9, {0});
+        File += Blob("OSMData", StringTable({""}) + BytesField(2, BytesField(2, Dense)), true);
+    }
+    CPBFReader Reader(std::make_shared<CStringDataSource>(File), 2);
+    std::vector<CPBFReader::SBlock> Blocks;
+    std::vector<uint64_t> IDs;
+    std::size_t Batches = 0;
+    while(Reader.ReadBlocks(Blocks, 2)){
+        EXPECT_LE(Blocks.size(), 2);
+        for(auto &Block : Blocks){
+            IDs.insert(IDs.end(), Block.NodeIDs.begin(), Block.NodeIDs.end());
+        }
+        Batches++;
+    }
+    EXPECT_EQ(Batches, 3);
+    EXPECT_EQ(IDs, std::vector<uint64_t>({1, 2, 3, 4, 5}));
+    EXPECT_TRUE(Reader.End());
+    EXPECT_FALSE(Reader.Failed());
+}
+
+TEST(PBFReader, MalformedTest){
+    std::string Dense = Packed(1, {ZigZag(1)}) + Packed(8, {0}) + Packed(9, {0});
+    std::string Data = Blob("OSMData", StringTable({""}) + BytesField(2, BytesField(2, Dense)), true);
+    std::vector<CPBFReader::SBlock> Blocks;
+
+    CPBFReader Truncated(std::make_shared<CStringDataSource>(OSMHeader() + Data.substr(0, Data.size() - 3)));
+    EXPECT_FALSE(Truncated.ReadBlocks(Blocks));
+    EXPECT_TRUE(Truncated.Failed());
+
+    CPBFReader Unsupported(std::make_shared<CStringDataSource>(OSMHeader("HistoricalInformation") + Data));
+    EXPECT_FALSE(Unsupported.ReadBlocks(Blocks));
+    EXPECT_TRUE(Unsupported.Failed());
+
+    // a tag pointing past the string table
+    std::string BadTag = Packed(1, {ZigZag(1)}) + Packed(8, {0}) + Packed(9, {0}) + Packed(10, {5, 6, 0});
+    CPBFReader BadString(std::make_shared<CStringDataSource>(OSMHeader() + Blob("OSMData", StringTable({""}) + BytesField(2, BytesField(2, BadTag)), true)));
+    EXPECT_FALSE(BadString.ReadBlocks(Blocks));
+    EXPECT_TRUE(BadString.Failed());
+
+    CPBFReader Empty(std::make_shared<CStringDataSource>(""));
+    EXPECT_FALSE(Empty.ReadBlocks(Blocks));
+    EXPECT_FALSE(Empty.Failed());
+    EXPECT_TRUE(Empty.End());
+}
+
+TEST(PBFReader, TruncatedFileTest){
+    // cut off half way through a blob, the map keeps what came before but
+    // says it isn't the whole file
+    std::string Contents;
+    {
+        CMappedFileDataSource Source("data/davis.osm.pbf");
+        Contents.assign(Source.Data(), Source.Size());
+    }
+    for(std::size_t Threads : {1, 4}){
+        COpenStreetMap Map(std::make_shared<CPBFReader>(std::make_shared<CStringDataSource>(Contents.substr(0, Contents.size() / 2)), Threads));
+        EXPECT_FALSE(Map.IsValid());
+        EXPECT_LT(Map.NodeCount(), 10259);
+    }
+    COpenStreetMap Whole(std::make_shared<CPBFReader>(std::make_shared<CStringDataSource>(Contents)));
+    EXPECT_TRUE(Whole.IsValid());
+}
@@ -0,0 +1,79 @@
+#include "ParallelDSVReader.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+// reads every row of the input with both readers and compares them
+static void ExpectSameRows(const std::string &input, char delimiter, std::size_t threads, std::size_t chunksize) {
+    CDSVReader reader(std::make_shared<CStringDataSource>(input), delimiter);
+    CParallelDSVReader parallelReader(std::make_shared<CStringDataSource>(input), delimiter, threads, chunksize);
+
+    std::vector<std::string> row, parallelRow;
+    std::size_t rowIndex = 0;
+    while (true) {
+        bool read = reader.ReadRow(row);
+        bool parallelRead = parallelReader.ReadRow(parallelRow);
+        ASSERT_EQ(read, parallelRead) << "row " << rowIndex << " of \"" << input << "\"";
+        if (!read) {
+            break;
+        }
+        ASSERT_EQ(row, parallelRow) << "row " << rowIndex << " of \"" << input << "\"";
+        rowIndex++;
+    }
+    EXPECT_TRUE(parallelReader.End());
+}
+
+TEST(ParallelDSVReaderTest, BasicRows) {
+    CParallelDSVReader reader(std::make_shared<CStringDataSource>("a,b,c\n1,\"2,\"\"x\"\"\",3\r\n\nlast"), ',', 2, 4);
+
+    std::vector<std::string> row;
+    EXPECT_FALSE(reader.End());
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"a", "b", "c"}));
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"1", "2,\"x\"", "3"}));
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_TRUE(row.empty());
+    EXPECT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"last"}));
+    EXPECT_TRUE(reader.End());
+    EXPECT_FALSE(reader.ReadRow(row));
+}
+
+TEST(ParallelDSVReaderTest, EmptyInput) {
+    CParallelDSVReader reader(std::make_shared<CStringDataSource>(""), ',', 4, 16);
+
+    std::vector<std::string> row;
+    EXPECT_TRUE(reader.End());
+    EXPECT_FALSE(reader.ReadRow(row));
+}
+
+TEST(ParallelDSVReaderTest, MatchesSequentialReaderOnRandomInput) {
+    // small chunks put boundaries inside quoted sections, quote runs and \r\n pairs
+    std::mt19937 generator(12345);
+    const char alphabet[] = "ab,\"\r\n|";
+    for (int iteration = 0; iteration < 3000; iteration++) {
+        std::string input;
+        std::size_t length = generator() % 60;
+        for (std::size_t index = 0; index < length; index++) {
+            input += alphabet[generator() % (sizeof(alphabet) - 1)];
+        }
+        ExpectSameRows(input, iteration % 5 ? ',' : '|', 1 + generator() % 4, 1 + generator() % 8);
+        if (HasFatalFailure()) {
+            return;
+        }
+    }
+}
+
+TEST(ParallelDSVReaderTest, MatchesSequentialReaderOnDataFiles) {
+    for (auto filename : {"data/stops.csv", "data/routes.csv"}) {
+        std::ifstream file(filename);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        ExpectSameRows(contents.str(), ',', 3, 100);
+        ExpectSameRows(contents.str(), ',', 4, 1 << 20);
+    }
+}
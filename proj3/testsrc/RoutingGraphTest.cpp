@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "RoutingGraph.h"
+#include "ShortestPathSearch.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "MappedFileDataSource.h"
+#include "TestUtils.h"
+#include <queue>
+#include <random>
+
+// the textbook Dijkstra with a binary heap of copies, to check against
+static double ReferenceDijkstra(const CRoutingGraph &graph, CRoutingGraph::TVertexID src, CRoutingGraph::TVertexID dest){
+    std::vector<double> Distance(graph.VertexCount(), CShortestPathSearch::NoPathExists);
+    using TEntry = std::pair<double, CRoutingGraph::TVertexID>;
+    std::priority_queue<TEntry, std::vector<TEntry>, std::greater<TEntry>> Queue;
+    Distance[src] = 0.0;
+    Queue.push({0.0, src});
+    while(!Queue.empty()){
+        auto Entry = Queue.top();
+        Queue.pop();
+        if(Entry.first > Distance[Entry.second]){
+            continue;
+        }
+        if(Entry.second == dest){
+            return Entry.first;
+        }
+        for(auto Edge = graph.EdgeOffsets()[Entry.second]; Edge < graph.EdgeOffsets()[Entry.second + 1]; Edge++){
+            double NewDistance = Entry.first + graph.EdgeLengths()[Edge];
+            auto Target = graph.EdgeTargets()[Edge];
+            if(NewDistance < Distance[Target]){
+                Distance[Target] = NewDistance;
+                Queue.push({NewDistance, Target});
+            }
+        }
+    }
+    return CShortestPathSearch::NoPathExists;
+}
+
+TEST(RoutingGraph, SmallMapTest){
+    auto Map = TestUtils::SmallMap();
+    CRoutingGraph Graph(*Map);
+    ASSERT_EQ(Graph.VertexCount(), 6);
+    // 1-2 and 2-3 both ways, 3->4, 4->5, 5-6 isn't connected through the missing node
+    EXPECT_EQ(Graph.EdgeCount(), 6);
+    auto V1 = Graph.VertexByNodeID(1), V2 = Graph.VertexByNodeID(2), V3 = Graph.VertexByNodeID(3);
+    auto V4 = Graph.VertexByNodeID(4), V5 = Graph.VertexByNodeID(5), V6 = Graph.VertexByNodeID(6);
+    EXPECT_EQ(V1, 0);
+    EXPECT_EQ(V6, 5);
+    EXPECT_EQ(Graph.VertexByNodeID(99), CRoutingGraph::InvalidVertexID);
+    EXPECT_EQ(Graph.NodeID(V4), 4);
+    EXPECT_EQ(Graph.NodeID(100), +CStreetMap::InvalidNodeID);
+    EXPECT_EQ(Graph.Location(V2), CStreetMap::TLocation(38.51, -121.70));
+    // a hundredth of a degree of latitude is about 1112 m
+    EXPECT_NEAR(Graph.EdgeLengths()[Graph.EdgeOffsets()[V1]], 1111.95, 0.01);
+    EXPECT_LE(Graph.ChordDistance(V1, V3), Graph.EdgeLengths()[0] + Graph.EdgeLengths()[Graph.EdgeOffsets()[V2] + 1]);
+
+    CShortestPathSearch Search(std::make_shared<CRoutingGraph>(*Map));
+    std::vector<CRoutingGraph::TVertexID> Path;
+    double Distance = Search.Dijkstra(V1, V5, Path);
+    EXPECT_EQ(Path, std::vector<CRoutingGraph::TVertexID>({V1, V2, V3, V4, V5}));
+    EXPECT_DOUBLE_EQ(Distance, TestUtils::PathLength(Graph, Path));
+    EXPECT_DOUBLE_EQ(Search.AStar(V1, V5, Path), Distance);
+    EXPECT_EQ(Path.size(), 5);
+    // against the one way streets, and to the disconnected node
+    EXPECT_EQ(Search.Dijkstra(V5, V1, Path), CShortestPathSearch::NoPathExists);
+    EXPECT_TRUE(Path.empty());
+    EXPECT_EQ(Search.AStar(V1, V6, Path), CShortestPathSearch::NoPathExists);
+    EXPECT_EQ(Search.Dijkstra(V3, V3, Path), 0.0);
+    EXPECT_EQ(Path, std::vector<CRoutingGraph::TVertexID>({V3}));
+    EXPECT_EQ(Search.Dijkstra(V1, 100, Path), CShortestPathSearch::NoPathExists);
+}
+
+TEST(RoutingGraph, DavisRandomPairsTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    auto Graph = std::make_shared<CRoutingGraph>(Map);
+    ASSERT_GT(Graph->VertexCount(), 0);
+    CShortestPathSearch Search(Graph);
+    std::mt19937 Generator(12);
+    std::uniform_int_distribution<CRoutingGraph::TVertexID> Pick(0, Graph->VertexCount() - 1);
+    std::vector<CRoutingGraph::TVertexID> Path;
+    std::size_t Connected = 0;
+    for(int Query = 0; Query < 200; Query++){
+        auto Source = Pick(Generator), Destination = Pick(Generator);
+        double Expected = ReferenceDijkstra(*Graph, Source, Destination);
+        double Dijkstra = Search.Dijkstra(Source, Destination, Path);
+        ASSERT_EQ(Dijkstra == CShortestPathSearch::NoPathExists, Expected == CShortestPathSearch::NoPathExists);
+        if(Expected == CShortestPathSearch::NoPathExists){
+            continue;
+        }
+        Connected++;
+        EXPECT_NEAR(Dijkstra, Expected, 1e-6);
+        ASSERT_EQ(Path.front(), Source);
+        ASSERT_EQ(Path.back(), Destination);
+        EXPECT_NEAR(TestUtils::PathLength(*Graph, Path), Expected, 1e-6);
+        double AStar = Search.AStar(Source, Destination, Path);
+        EXPECT_NEAR(AStar, Expected, 1e-6);
+        EXPECT_NEAR(TestUtils::PathLength(*Graph, Path), Expected, 1e-6);
+    }
+    // most of davis is one connected network
+    EXPECT_GT(Connected, 100);
+}
+
+TEST(RoutingGraph, OneToManyTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    auto Graph = std::make_shared<CRoutingGraph>(Map);
+    CShortestPathSearch Search(Graph);
+    std::mt19937 Generator(4);
+    std::uniform_int_distribution<CRoutingGraph::TVertexID> Pick(0, Graph->VertexCount() - 1);
+    std::vector<CRoutingGraph::TVertexID> Targets;
+    for(int Index = 0; Index < 50; Index++){
+        Targets.push_back(Pick(Generator));
+    }
+    // repeated and out of range targets
+    Targets.push_back(Targets[0]);
+    Targets.push_back(Graph->VertexCount());
+    std::vector<double> Distances;
+    for(int Query = 0; Query < 10; Query++){
+        auto Source = Pick(Generator);
+        Search.OneToMany(Source, Targets, Distances);
+        ASSERT_EQ(Distances.size(), Targets.size());
+        for(std::size_t Index = 0; Index + 1 < Targets.size(); Index++){
+            EXPECT_EQ(Distances[Index], ReferenceDijkstra(*Graph, Source, Targets[Index]));
+        }
+        EXPECT_EQ(Distances.back(), CShortestPathSearch::NoPathExists);
+    }
+    Search.OneToMany(Graph->VertexCount(), Targets, Distances);
+    EXPECT_EQ(Distances, std::vector<double>(Targets.size(), CShortestPathSearch::NoPathExists));
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include "SpatialIndex.h"
+#include "RoutingGraph.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "StringDataSource.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+
+// every node with its distance from location, nearest first with ties by index
+static std::vector<CSpatialIndex::SResult> BruteForce(const CStreetMap &map, const CStreetMap::TLocation &location, const CRoutingGraph *routable = nullptr){
+    std::vector<CSpatialIndex::SResult> Results;
+    for(std::size_t Index = 0; Index < map.NodeCount(); Index++){
+        auto Node = map.NodeByIndex(Index);
+        if(routable && routable->VertexByNodeID(Node->ID()) == CRoutingGraph::InvalidVertexID){
+            continue;
+        }
+        Results.push_back({Index, Node->ID(), CRoutingGraph::Haversine(location, Node->Location())});
+    }
+    std::sort(Results.begin(), Results.end(), [](const CSpatialIndex::SResult &left, const CSpatialIndex::SResult &right){
+        return left.Distance < right.Distance || (left.Distance == right.Distance && left.Index < right.Index);
+    });
+    return Results;
+}
+
+static void ExpectSameResults(const std::vector<CSpatialIndex::SResult> &actual, const std::vector<CSpatialIndex::SResult> &expected){
+    ASSERT_EQ(actual.size(), expected.size());
+    for(std::size_t Index = 0; Index < actual.size(); Index++){
+        EXPECT_EQ(actual[Index].Index, expected[Index].Index);
+        EXPECT_EQ(actual[Index].NodeID, expected[Index].NodeID);
+        EXPECT_NEAR(actual[Index].Distance, expected[Index].Distance, 1e-6);
+    }
+}
+
+TEST(SpatialIndex, EmptyMapTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>("<osm></osm>")));
+    CSpatialIndex Index(Map);
+    std::vector<CSpatialIndex::SResult> Results;
+    CSpatialIndex::SResult Result;
+    EXPECT_EQ(Index.NodeCount(), 0);
+    EXPECT_FALSE(Index.Nearest({38.5, -121.7}, Result));
+    Index.Nearest({38.5, -121.7}, 3, Results);
+    EXPECT_TRUE(Results.empty());
+    Index.WithinRadius({38.5, -121.7}, 1000.0, Results);
+    EXPECT_TRUE(Results.empty());
+    Index.InBoundingBox({38.0, -122.0}, {39.0, -121.0}, Results);
+    EXPECT_TRUE(Results.empty());
+}
+
+TEST(SpatialIndex, SmallMapTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(
+        "<osm>"
+        "<node id=\"1\" lat=\"38.50\" lon=\"-121.70\"/>"
+        "<node id=\"2\" lat=\"38.51\" lon=\"-121.70\"/>"
+        "<node id=\"3\" lat=\"38.50\" lon=\"-121.70\"/>"
+        "<node id=\"4\" lat=\"38.60\" lon=\"-121.80\"/>"
+        "<way id=\"10\"><nd ref=\"2\"/><nd ref=\"3\"/></way>"
+        "</osm>")));
+    CSpatialIndex Index(Map);
+    EXPECT_EQ(Index.NodeCount(), 4);
+    EXPECT_EQ(Index.RoutableNodeCount(), 2);
+    CSpatialIndex::SResult Result;
+    ASSERT_TRUE(Index.Nearest({38.5, -121.7}, Result));
+    // nodes 1 and 3 are at the same spot, the lower index wins
+    EXPECT_EQ(Result.NodeID, 1);
+    EXPECT_EQ(Result.Index, 0);
+    EXPECT_EQ(Result.Distance, 0.0);
+    ASSERT_TRUE(Index.Nearest({38.5, -121.7}, Result, true));
+    EXPECT_EQ(Result.NodeID, 3);
+    // far outside the nodes
+    ASSERT_TRUE(Index.Nearest({40.0, -120.0}, Result));
+    EXPECT_EQ(Result.NodeID, 4);
+    std::vector<CSpatialIndex::SResult> Results;
+    Index.Nearest({38.5, -121.7}, 10, Results);
+    ASSERT_EQ(Results.size(), 4);
+    EXPECT_EQ(Results[3].NodeID, 4);
+    Index.WithinRadius({38.5, -121.7}, 1200.0, Results);
+    ASSERT_EQ(Results.size(), 3);
+    EXPECT_EQ(Results[2].NodeID, 2);
+    Index.WithinRadius({38.5, -121.7}, 1000.0, Results, true);
+    ASSERT_EQ(Results.size(), 1);
+    EXPECT_EQ(Results[0].NodeID, 3);
+    Index.InBoundingBox({38.505, -121.8}, {38.6, -121.7}, Results);
+    std::vector<CStreetMap::TNodeID> IDs;
+    for(auto &Found : Results){
+        IDs.push_back(Found.NodeID);
+    }
+    std::sort(IDs.begin(), IDs.end());
+    EXPECT_EQ(IDs, std::vector<CStreetMap::TNodeID>({2, 4}));
+    Index.InBoundingBox({38.6, -121.7}, {38.5, -121.8}, Results);
+    EXPECT_TRUE(Results.empty());
+}
+
+TEST(SpatialIndex, DavisTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    CRoutingGraph Graph(Map);
+    CSpatialIndex Index(Map);
+    ASSERT_EQ(Index.NodeCount(), Map.NodeCount());
+    EXPECT_EQ(Index.RoutableNodeCount(), Graph.VertexCount());
+    std::mt19937 Generator(21);
+    std::uniform_real_distribution<double> Latitude(38.50, 38.58), Longitude(-121.80, -121.68);
+    std::vector<CSpatialIndex::SResult> Results;
+    for(int Query = 0; Query < 40; Query++){
+        CStreetMap::TLocation Location(Latitude(Generator), Longitude(Generator));
+        bool Routable = Query % 2;
+        auto Expected = BruteForce(Map, Location, Routable ? &Graph : nullptr);
+
+        Index.Nearest(Location, 7, Results, Routable);
+        ExpectSameResults(Results, std::vector<CSpatialIndex::SResult>(Expected.begin(), Expected.begin() + 7));
+        CSpatialIndex::SResult Result;
+        ASSERT_TRUE(Index.Nearest(Location, Result, Routable));
+        EXPECT_EQ(Result.Index, Expected[0].Index);
+
+        double Radius = 50.0 + Query * 20.0;
+        Index.WithinRadius(Location, Radius, Results, Routable);
+        std::size_t Inside = 0;
+        while(Inside < Expected.size() && Expected[Inside].Distance <= Radius){
+            Inside++;
+        }
+        ExpectSameResults(Results, std::vector<CSpatialIndex::SResult>(Expected.begin(), Expected.begin() + Inside));
+
+        CStreetMap::TLocation Southwest(Location.first - 0.004, Location.second - 0.006), Northeast(Location.first + 0.003, Location.second + 0.002);
+        Index.InBoundingBox(Southwest, Northeast, Results, Routable);
+        std::vector<std::size_t> Found, Wanted;
+        for(auto &Entry : Results){
+            Found.push_back(Entry.Index);
+        }
+        for(auto &Entry : Expected){
+            auto NodeLocation = Map.NodeByIndex(Entry.Index)->Location();
+            if(NodeLocation.first >= Southwest.first && NodeLocation.first <= Northeast.first && NodeLocation.second >= Southwest.second && NodeLocation.second <= Northeast.second){
+                Wanted.push_back(Entry.Index);
+            }
+        }
+        std::sort(Found.begin(), Found.end());
+        std::sort(Wanted.begin(), Wanted.end());
+        EXPECT_EQ(Found, Wanted);
+    }
+}
+
+TEST(SpatialIndex, ConcurrentQueryTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    CSpatialIndex Index(Map);
+    std::vector<CStreetMap::TLocation> Locations;
+    std::vector<std::size_t> Expected;
+    std::mt19937 Generator(8);
+    std::uniform_real_distribution<double> Latitude(38.50, 38.58), Longitude(-121.80, -121.68);
+    for(int Query = 0; Query < 200; Query++){
+        Locations.push_back({Latitude(Generator), Longitude(Generator)});
+        CSpatialIndex::SResult Result;
+        Index.Nearest(Locations.back(), Result);
+        Expected.push_back(Result.Index);
+    }
+    std::vector<std::vector<std::size_t>> Found(4);
+    std::vector<std::thread> Threads;
+    for(std::size_t Thread = 0; Thread < Found.size(); Thread++){
+        Threads.emplace_back([&, Thread](){
+            for(auto &Location : Locations){
+                CSpatialIndex::SResult Result;
+                Index.Nearest(Location, Result);
+                Found[Thread].push_back(Result.Index);
+            }
+        });
+    }
+    for(auto &Thread : Threads){
+        Thread.join();
+    }
+    for(auto &Results : Found){
+        EXPECT_EQ(Results, Expected);
+    }
+}
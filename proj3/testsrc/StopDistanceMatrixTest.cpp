@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "StopDistanceMatrix.h"
+#include "ShortestPathSearch.h"
+#include "CSVBusSystem.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "StringDataSource.h"
+#include "FileDataSink.h"
+#include <cstdio>
+#include <random>
+
+static std::shared_ptr<CRoutingGraph> DavisGraph(){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    return std::make_shared<CRoutingGraph>(Map);
+}
+
+static CCSVBusSystem DavisBusSystem(){
+    return CCSVBusSystem(std::make_shared<CDSVReader>(std::make_shared<CMappedFileDataSource>("data/stops.csv"), ','),
+                         std::make_shared<CDSVReader>(std::make_shared<CMappedFileDataSource>("data/routes.csv"), ','));
+}
+
+// checks random entries against point to point searches
+static void ExpectMatchesDijkstra(const CStopDistanceMatrix &matrix, std::shared_ptr<const CRoutingGraph> graph){
+    CShortestPathSearch Search(graph);
+    std::mt19937 Generator(7);
+    std::uniform_int_distribution<std::size_t> Pick(0, matrix.StopCount() - 1);
+    std::vector<CRoutingGraph::TVertexID> Path;
+    for(int Query = 0; Query < 200; Query++){
+        auto Source = Pick(Generator), Destination = Pick(Generator);
+        auto SourceVertex = graph->VertexByNodeID(matrix.StopNodeID(Source));
+        auto DestinationVertex = graph->VertexByNodeID(matrix.StopNodeID(Destination));
+        double Expected = Search.Dijkstra(SourceVertex, DestinationVertex, Path);
+        if(Source == Destination){
+            EXPECT_EQ(matrix.Distance(Source, Destination), 0.0f);
+        }
+        else if(Expected == CShortestPathSearch::NoPathExists){
+            EXPECT_EQ(matrix.Distance(Source, Destination), CStopDistanceMatrix::NoPathExists);
+        }
+        else{
+            EXPECT_FLOAT_EQ(matrix.Distance(Source, Destination), static_cast<float>(Expected));
+        }
+    }
+}
+
+TEST(StopDistanceMatrix, DavisTest){
+    auto Graph = DavisGraph();
+    auto BusSystem = DavisBusSystem();
+    ASSERT_GT(BusSystem.StopCount(), 0);
+    CStopDistanceMatrix Matrix(BusSystem, Graph, 3);
+    ASSERT_TRUE(Matrix.IsValid());
+    ASSERT_EQ(Matrix.StopCount(), BusSystem.StopCount());
+    for(std::size_t Index = 0; Index < Matrix.StopCount(); Index++){
+        EXPECT_EQ(Matrix.StopID(Index), BusSystem.StopByIndex(Index)->ID());
+        EXPECT_EQ(Matrix.StopIndex(Matrix.StopID(Index)), Index);
+        EXPECT_EQ(Matrix.Row(Index), Matrix.Row(0) + Index * Matrix.StopCount());
+    }
+    EXPECT_EQ(Matrix.StopIndex(1), CStopDistanceMatrix::InvalidIndex);
+    EXPECT_EQ(Matrix.Row(Matrix.StopCount()), nullptr);
+    EXPECT_EQ(Matrix.Distance(0, Matrix.StopCount()), CStopDistanceMatrix::NoPathExists);
+    ExpectMatchesDijkstra(Matrix, Graph);
+
+    // the thread count doesn't change the result
+    CStopDistanceMatrix SingleThreaded(BusSystem, Graph, 1);
+    for(std::size_t Index = 0; Index < Matrix.StopCount(); Index++){
+        ASSERT_TRUE(std::equal(Matrix.Row(Index), Matrix.Row(Index) + Matrix.StopCount(), SingleThreaded.Row(Index)));
+    }
+}
+
+TEST(StopDistanceMatrix, UnknownNodeTest){
+    auto Graph = DavisGraph();
+    CCSVBusSystem BusSystem(std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("stop_id,node_id\n1,2849810514\n2,1\n3,2849805223\n"), ','),
+                            std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("route,stop_id\n"), ','));
+    ASSERT_EQ(BusSystem.StopCount(), 3);
+    CStopDistanceMatrix Matrix(BusSystem, Graph);
+    EXPECT_EQ(Matrix.Distance(1, 1), 0.0f);
+    EXPECT_EQ(Matrix.Distance(0, 1), CStopDistanceMatrix::NoPathExists);
+    EXPECT_EQ(Matrix.Distance(1, 2), CStopDistanceMatrix::NoPathExists);
+    EXPECT_LT(Matrix.Distance(0, 2), CStopDistanceMatrix::NoPathExists);
+    EXPECT_GT(Matrix.Distance(0, 2), 0.0f);
+}
+
+TEST(StopDistanceMatrix, SaveLoadRecomputeTest){
+    auto Graph = DavisGraph();
+    auto BusSystem = DavisBusSystem();
+    CStopDistanceMatrix Matrix(BusSystem, Graph);
+    std::string Filename = "/tmp/StopDistanceMatrixTest.dist";
+    ASSERT_TRUE(Matrix.Save(Filename));
+    CStopDistanceMatrix Loaded(Filename);
+    ASSERT_TRUE(Loaded.IsValid());
+    ASSERT_EQ(Loaded.StopCount(), Matrix.StopCount());
+    for(std::size_t Index = 0; Index < Matrix.StopCount(); Index++){
+        EXPECT_EQ(Loaded.StopID(Index), Matrix.StopID(Index));
+        EXPECT_EQ(Loaded.StopNodeID(Index), Matrix.StopNodeID(Index));
+        ASSERT_TRUE(std::equal(Matrix.Row(Index), Matrix.Row(Index) + Matrix.StopCount(), Loaded.Row(Index)));
+    }
+    EXPECT_EQ(Loaded.StopIndex(Matrix.StopID(5)), 5);
+
+    // a loaded matrix needs a graph before it can recompute
+    EXPECT_FALSE(Loaded.RecomputeRow(0));
+    EXPECT_TRUE(Loaded.RecomputeRows({0, 5}, Graph));
+    EXPECT_TRUE(Loaded.RecomputeRow(7));
+    EXPECT_FALSE(Loaded.RecomputeRow(Loaded.StopCount()));
+    for(std::size_t Index = 0; Index < Matrix.StopCount(); Index++){
+        ASSERT_TRUE(std::equal(Matrix.Row(Index), Matrix.Row(Index) + Matrix.StopCount(), Loaded.Row(Index)));
+    }
+    std::remove(Filename.c_str());
+
+    // a file that doesn't hold a whole matrix isn't loaded
+    {
+        CFileDataSink Sink(Filename, CFileDataSink::EFlushPolicy::WhenFull);
+        Sink.Write("STOPDIST", 8);
+    }
+    EXPECT_FALSE(CStopDistanceMatrix(Filename).IsValid());
+    std::remove(Filename.c_str());
+    EXPECT_FALSE(CStopDistanceMatrix(Filename).IsValid());
+}
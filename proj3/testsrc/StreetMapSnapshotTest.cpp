@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "StreetMapSnapshot.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "MappedFileDataSource.h"
+#include "TestUtils.h"
+#include <cstdio>
+
+TEST(StreetMapSnapshot, SmallMapTest){
+    auto Source = std::make_shared<CStringDataSource>(
+        "<osm>"
+        "<node id=\"7\" lat=\"38.5\" lon=\"-121.75\"><tag k=\"name\" v=\"Cafe\"/><tag k=\"amenity\" v=\"cafe\"/></node>"
+        "<node id=\"3\" lat=\"1\" lon=\"2\"/>"
+        "<way id=\"9\"><nd ref=\"7\"/><nd ref=\"3\"/><tag k=\"name\" v=\"Cafe\"/></way>"
+        "<way id=\"4\"/>"
+        "</osm>");
+    COpenStreetMap Map(std::make_shared<CXMLReader>(Source));
+    std::string Name = TestUtils::TemporaryFile();
+    std::shared_ptr<CStreetMap::SNode> Node;
+    {
+        ASSERT_TRUE(CStreetMapSnapshot::Save(Map, Name));
+        CStreetMapSnapshot Snapshot(Name);
+        ASSERT_TRUE(Snapshot.IsOpen());
+        EXPECT_TRUE(Snapshot.Verify());
+        TestUtils::ExpectSameMap(Map, Snapshot);
+        EXPECT_EQ(Snapshot.NodeByID(5), nullptr);
+        EXPECT_EQ(Snapshot.WayByID(5), nullptr);
+        EXPECT_EQ(Snapshot.NodeByIndex(2), nullptr);
+        EXPECT_EQ(Snapshot.WayByID(4)->NodeCount(), 0);
+        Node = Snapshot.NodeByID(7);
+    }
+    // views keep the file mapped
+    ASSERT_NE(Node, nullptr);
+    EXPECT_EQ(Node->GetAttribute("name"), "Cafe");
+    EXPECT_EQ(Node->GetAttributeKey(1), "amenity");
+    std::remove(Name.c_str());
+}
+
+TEST(StreetMapSnapshot, EmptyMapTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>("<osm></osm>")));
+    std::string Name = TestUtils::TemporaryFile();
+    ASSERT_TRUE(CStreetMapSnapshot::Save(Map, Name));
+    CStreetMapSnapshot Snapshot(Name);
+    ASSERT_TRUE(Snapshot.IsOpen());
+    EXPECT_TRUE(Snapshot.Verify());
+    EXPECT_EQ(Snapshot.NodeCount(), 0);
+    EXPECT_EQ(Snapshot.WayCount(), 0);
+    EXPECT_EQ(Snapshot.NodeByID(1), nullptr);
+    std::remove(Name.c_str());
+}
+
+TEST(StreetMapSnapshot, DavisTest){
+    auto Source = std::make_shared<CMappedFileDataSource>("data/davis.osm");
+    ASSERT_TRUE(Source->IsOpen());
+    COpenStreetMap Map(std::make_shared<CXMLReader>(Source));
+    std::string Name = TestUtils::TemporaryFile();
+    ASSERT_TRUE(CStreetMapSnapshot::Save(Map, Name));
+    CStreetMapSnapshot Snapshot(Name);
+    ASSERT_TRUE(Snapshot.IsOpen());
+    EXPECT_TRUE(Snapshot.Verify());
+    TestUtils::ExpectSameMap(Map, Snapshot);
+    std::remove(Name.c_str());
+}
+
+TEST(StreetMapSnapshot, DamagedFileTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(
+        "<osm><node id=\"1\" lat=\"1\" lon=\"2\"><tag k=\"a\" v=\"b\"/></node></osm>")));
+    std::string Name = TestUtils::TemporaryFile();
+    ASSERT_TRUE(CStreetMapSnapshot::Save(Map, Name));
+    std::string Contents = TestUtils::FileContents(Name);
+
+    // a flipped byte past the header opens but fails verification
+    std::string Damaged = Contents;
+    Damaged[Damaged.size() - 1] ^= 0x40;
+    TestUtils::SaveContents(Name, Damaged);
+    {
+        CStreetMapSnapshot Snapshot(Name);
+        EXPECT_TRUE(Snapshot.IsOpen());
+        EXPECT_FALSE(Snapshot.Verify());
+    }
+
+    // a damaged header or a truncated file doesn't open at all
+    Damaged = Contents;
+    Damaged[20] ^= 0x01;
+    TestUtils::SaveContents(Name, Damaged);
+    {
+        CStreetMapSnapshot Snapshot(Name);
+        EXPECT_FALSE(Snapshot.IsOpen());
+        EXPECT_FALSE(Snapshot.Verify());
+        EXPECT_EQ(Snapshot.NodeCount(), 0);
+        EXPECT_EQ(Snapshot.NodeByID(1), nullptr);
+    }
+    TestUtils::SaveContents(Name, Contents.substr(0, Contents.size() - 8));
+    {
+        CStreetMapSnapshot Snapshot(Name);
+        EXPECT_FALSE(Snapshot.IsOpen());
+    }
+    TestUtils::SaveContents(Name, "not a snapshot");
+    {
+        CStreetMapSnapshot Snapshot(Name);
+        EXPECT_FALSE(Snapshot.IsOpen());
+    }
+    std::remove(Name.c_str());
+    CStreetMapSnapshot Missing(Name);
+    EXPECT_FALSE(Missing.IsOpen());
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "StreetNameIndex.h"
+#include "StringUtils.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "MappedFileDataSource.h"
+#include "StringDataSource.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+
+// scans every name tag of every way, what the geocoder did before the index
+static std::vector<CStreetNameIndex::SResult> BruteForce(const CStreetMap &map, const std::string &name, int maxdistance){
+    std::string Query = CStreetNameIndex::Normalize(name);
+    std::vector<CStreetNameIndex::SResult> Results;
+    for(std::size_t Index = 0; Index < map.WayCount(); Index++){
+        auto Way = map.WayByIndex(Index);
+        CStreetNameIndex::SResult Best{Index, Way->ID(), maxdistance + 1, ""};
+        for(const char *Key : {"name", "name_1", "ref"}){
+            for(auto &Part : StringUtils::Split(Way->GetAttribute(Key), ";")){
+                std::string Name = CStreetNameIndex::Normalize(Part);
+                int Distance = StringUtils::EditDistance(Query, Name);
+                if(!Name.empty() && (Distance < Best.Distance || (Distance == Best.Distance && Name < Best.Name))){
+                    Best.Distance = Distance;
+                    Best.Name = Name;
+                }
+            }
+        }
+        if(!Query.empty() && Best.Distance <= maxdistance){
+            Results.push_back(Best);
+        }
+    }
+    std::stable_sort(Results.begin(), Results.end(), [](const CStreetNameIndex::SResult &left, const CStreetNameIndex::SResult &right){
+        return left.Distance < right.Distance;
+    });
+    return Results;
+}
+
+static void ExpectSameResults(const std::vector<CStreetNameIndex::SResult> &actual, const std::vector<CStreetNameIndex::SResult> &expected){
+    ASSERT_EQ(actual.size(), expected.size());
+    for(std::size_t Index = 0; Index < actual.size(); Index++){
+        EXPECT_EQ(actual[Index].Index, expected[Index].Index);
+        EXPECT_EQ(actual[Index].WayID, expected[Index].WayID);
+        EXPECT_EQ(actual[Index].Distance, expected[Index].Distance);
+        EXPECT_EQ(actual[Index].Name, expected[Index].Name);
+    }
+}
+
+TEST(StreetNameIndex, NormalizeTest){
+    EXPECT_EQ(CStreetNameIndex::Normalize("  Russell   Blvd. "), "russell blvd");
+    EXPECT_EQ(CStreetNameIndex::Normalize("I-80"), "i 80");
+    EXPECT_EQ(CStreetNameIndex::Normalize("O'Neill St"), "o neill st");
+    EXPECT_EQ(CStreetNameIndex::Normalize("--"), "");
+    EXPECT_EQ(CStreetNameIndex::Normalize(""), "");
+}
+
+TEST(StreetNameIndex, SmallMapTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(
+        "<osm>"
+        "<way id=\"10\"><tag k=\"name\" v=\"Russell Boulevard\"/></way>"
+        "<way id=\"11\"><tag k=\"name\" v=\"Russel Blvd\"/><tag k=\"name_1\" v=\"Russell Boulevard\"/></way>"
+        "<way id=\"12\"><tag k=\"name\" v=\"Anderson Road\"/></way>"
+        "<way id=\"13\"><tag k=\"ref\" v=\"I 80;CA 113\"/></way>"
+        "<way id=\"14\"><tag k=\"highway\" v=\"service\"/></way>"
+        "<way id=\"15\"><tag k=\"name\" v=\"russell boulevard\"/></way>"
+        "</osm>")));
+    CStreetNameIndex Index(Map);
+    // russell boulevard, russel blvd, anderson road, i 80 and ca 113
+    EXPECT_EQ(Index.NameCount(), 5);
+    EXPECT_EQ(Index.WayCount(), 5);
+    std::vector<CStreetNameIndex::SResult> Results;
+    Index.Search("Russel Boulevard", 1, 10, Results);
+    ASSERT_EQ(Results.size(), 3);
+    EXPECT_EQ(Results[0].WayID, 10);
+    EXPECT_EQ(Results[0].Distance, 1);
+    EXPECT_EQ(Results[0].Name, "russell boulevard");
+    // way 11 matches through name_1
+    EXPECT_EQ(Results[1].WayID, 11);
+    EXPECT_EQ(Results[2].WayID, 15);
+    Index.Search("RUSSEL BLVD", 0, 10, Results);
+    ASSERT_EQ(Results.size(), 1);
+    EXPECT_EQ(Results[0].WayID, 11);
+    EXPECT_EQ(Results[0].Index, 1);
+    // the count keeps the closest
+    Index.Search("russell boulevrd", 2, 1, Results);
+    ASSERT_EQ(Results.size(), 1);
+    EXPECT_EQ(Results[0].WayID, 10);
+    Index.Search("ca-113", 0, 10, Results);
+    ASSERT_EQ(Results.size(), 1);
+    EXPECT_EQ(Results[0].WayID, 13);
+    // short enough that every name of a close length is checked
+    Index.Search("I 8", 1, 10, Results);
+    ASSERT_EQ(Results.size(), 1);
+    EXPECT_EQ(Results[0].Name, "i 80");
+    Index.Search("Andersen Rd", 1, 10, Results);
+    EXPECT_TRUE(Results.empty());
+    Index.Search("", 3, 10, Results);
+    EXPECT_TRUE(Results.empty());
+    Index.Search("anderson road", -1, 10, Results);
+    EXPECT_TRUE(Results.empty());
+}
+
+TEST(StreetNameIndex, DavisTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    CStreetNameIndex Index(Map);
+    ASSERT_GT(Index.NameCount(), 100);
+    std::vector<std::string> Names;
+    for(std::size_t WayIndex = 0; WayIndex < Map.WayCount(); WayIndex++){
+        auto Way = Map.WayByIndex(WayIndex);
+        if(Way->HasAttribute("name")){
+            Names.push_back(Way->GetAttribute("name"));
+        }
+    }
+    // real names with a few random typos
+    std::mt19937 Generator(19);
+    std::uniform_int_distribution<std::size_t> PickName(0, Names.size() - 1);
+    std::uniform_int_distribution<int> Letter('a', 'z'), Edit(0, 2), Typos(0, 3);
+    std::vector<CStreetNameIndex::SResult> Results;
+    for(int Query = 0; Query < 60; Query++){
+        std::string Name = Names[PickName(Generator)];
+        for(int Typo = Typos(Generator); Typo > 0 && !Name.empty(); Typo--){
+            std::size_t Position = std::uniform_int_distribution<std::size_t>(0, Name.size() - 1)(Generator);
+            switch(Edit(Generator)){
+                case 0: Name[Position] = Letter(Generator); break;
+                case 1: Name.erase(Position, 1); break;
+                default: Name.insert(Name.begin() + Position, Letter(Generator)); break;
+            }
+        }
+        int MaxDistance = Query % 4;
+        Index.Search(Name, MaxDistance, Map.WayCount(), Results);
+        ExpectSameResults(Results, BruteForce(Map, Name, MaxDistance));
+    }
+}
+
+TEST(StreetNameIndex, ConcurrentSearchTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    CStreetNameIndex Index(Map);
+    std::vector<std::string> Queries = {"Russel Blvd", "anderson rd", "covell boulevrd", "f street", "i 80", "fifth st"};
+    std::vector<std::vector<CStreetNameIndex::SResult>> Expected(Queries.size());
+    for(std::size_t Query = 0; Query < Queries.size(); Query++){
+        Index.Search(Queries[Query], 2, 20, Expected[Query]);
+    }
+    std::vector<int> Mismatches(4, 0);
+    std::vector<std::thread> Threads;
+    for(std::size_t Thread = 0; Thread < Mismatches.size(); Thread++){
+        Threads.emplace_back([&, Thread](){
+            std::vector<CStreetNameIndex::SResult> Results;
+            for(int Round = 0; Round < 50; Round++){
+                std::size_t Query = (Round + Thread) % Queries.size();
+                Index.Search(Queries[Query], 2, 20, Results);
+                if(Results.size() != Expected[Query].size() || !std::equal(Results.begin(), Results.end(), Expected[Query].begin(), [](const auto &left, const auto &right){
+                    return left.Index == right.Index && left.Distance == right.Distance;
+                })){
+                    Mismatches[Thread]++;
+                }
+            }
+        });
+    }
+    for(auto &Thread : Threads){
+        Thread.join();
+    }
+    EXPECT_EQ(Mismatches, std::vector<int>(Mismatches.size(), 0));
+}
@@ -30,3 +30,15 @@ TEST(StringDataSink, WriteTest){
     EXPECT_TRUE(Sink.Write(TempVector2));
     EXPECT_EQ(Sink.String(),"Hello World");   
 }
+
+TEST(StringDataSink, SpanWriteTest){
+    const char *Text = "Hello World";
+    CStringDataSink Sink;
+
+    EXPECT_TRUE(Sink.Write(Text,5));
+    EXPECT_EQ(Sink.String(),"Hello");
+    EXPECT_TRUE(Sink.Write(Text + 5,6));
+    EXPECT_EQ(Sink.String(),"Hello World");
+    EXPECT_TRUE(Sink.Write(Text,0));
+    EXPECT_EQ(Sink.String(),"Hello World");
+}
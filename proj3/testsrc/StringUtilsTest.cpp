@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "StringUtils.h"
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <vector>
 
 TEST(StringUtilsTest, Slice) {
     EXPECT_EQ(StringUtils::Slice("hello world", 0, 5), "hello");
@@ -100,4 +104,163 @@ TEST(StringUtilsTest, EditDistance) {
     EXPECT_EQ(StringUtils::EditDistance("flaw", "lawn"), 2);
     EXPECT_EQ(StringUtils::EditDistance("same", "same"), 0);
     EXPECT_EQ(StringUtils::EditDistance("hello", "HELLO", true), 0);
-}
\ No newline at end of file
+}
+TEST(StringUtilsTest, SplitSeparator) {
+    EXPECT_EQ(StringUtils::Split("a,,b,", ","), std::vector<std::string>({"a", "", "b", ""}));
+    EXPECT_EQ(StringUtils::Split("a::b", "::"), std::vector<std::string>({"a", "b"}));
+    EXPECT_EQ(StringUtils::Split("  a \t b\n"), std::vector<std::string>({"a", "b"}));
+    EXPECT_TRUE(StringUtils::Split("").empty());
+    EXPECT_TRUE(StringUtils::Split("   ").empty());
+}
+
+TEST(StringUtilsTest, ReplaceSinglePass) {
+    EXPECT_EQ(StringUtils::Replace("aaaa", "aa", "a"), "aa");
+    EXPECT_EQ(StringUtils::Replace("abab", "ab", "abab"), "abababab");
+    EXPECT_EQ(StringUtils::Replace("hello", "", "x"), "hello");
+    EXPECT_EQ(StringUtils::Replace("xhellox", "x", ""), "hello");
+    EXPECT_EQ(StringUtils::Replace(std::string(10000, 'a'), "a", "bc"), [] {
+        std::string expected;
+        for (int i = 0; i < 10000; i++) {
+            expected += "bc";
+        }
+        return expected;
+    }());
+}
+
+TEST(StringUtilsTest, SliceView) {
+    std::string text = "hello world";
+    EXPECT_EQ(StringUtils::SliceView(text, 0, 5), "hello");
+    EXPECT_EQ(StringUtils::SliceView(text, -5), "world");
+    EXPECT_EQ(StringUtils::SliceView(text, 2, -3), "llo wo");
+    // the view points into the string instead of a copy
+    EXPECT_EQ(StringUtils::SliceView(text, 6).data(), text.data() + 6);
+    // out of range indices are clamped
+    EXPECT_EQ(StringUtils::SliceView(text, 4, 2), "");
+    EXPECT_EQ(StringUtils::SliceView(text, -100, 100), "hello world");
+    EXPECT_EQ(StringUtils::SliceView(text, 20), "");
+    EXPECT_EQ(StringUtils::Slice(text, 8, 3), "");
+}
+
+TEST(StringUtilsTest, StripView) {
+    std::string text = " \t hello \r\n";
+    EXPECT_EQ(StringUtils::LStripView(text), "hello \r\n");
+    EXPECT_EQ(StringUtils::RStripView(text), " \t hello");
+    EXPECT_EQ(StringUtils::StripView(text), "hello");
+    EXPECT_EQ(StringUtils::StripView(text).data(), text.data() + 3);
+    EXPECT_EQ(StringUtils::StripView("   "), "");
+    EXPECT_EQ(StringUtils::StripView(""), "");
+}
+
+TEST(StringUtilsTest, SplitView) {
+    std::string text = "this is  a test";
+    auto pieces = StringUtils::SplitView(text);
+    ASSERT_EQ(pieces.size(), 4);
+    EXPECT_EQ(pieces[2], "a");
+    EXPECT_EQ(pieces[3].data(), text.data() + 11);
+    EXPECT_EQ(StringUtils::SplitView("a,,b", ","), std::vector<std::string_view>({"a", "", "b"}));
+    // the callback sees the same pieces as Split
+    for (std::string separator : {"", ",", ", "}) {
+        std::string csv = " one, two,,three ,";
+        std::vector<std::string> seen;
+        StringUtils::SplitView(csv, separator, [&seen](std::string_view piece) {
+            seen.emplace_back(piece);
+        });
+        EXPECT_EQ(seen, StringUtils::Split(csv, separator));
+    }
+    int calls = 0;
+    StringUtils::SplitView("", ",", [&calls](std::string_view) {
+        calls++;
+    });
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(StringUtilsTest, JoinView) {
+    std::string text = "a-b-c";
+    EXPECT_EQ(StringUtils::JoinView(", ", StringUtils::SplitView(text, "-")), "a, b, c");
+    EXPECT_EQ(StringUtils::JoinView(",", {}), "");
+    EXPECT_EQ(StringUtils::JoinView(",", {"only"}), "only");
+    EXPECT_EQ(StringUtils::JoinView(",", {"", ""}), ",");
+    // braced lists of literals still go to the std::string version
+    EXPECT_EQ(StringUtils::Join(",", {"a", "b"}), "a,b");
+}
+
+// the textbook dynamic program, to check the bit-parallel version against
+static int ReferenceEditDistance(const std::string &left, const std::string &right, bool ignorecase) {
+    std::vector<int> previous(right.size() + 1), current(right.size() + 1);
+    for (size_t j = 0; j <= right.size(); j++) {
+        previous[j] = j;
+    }
+    for (size_t i = 1; i <= left.size(); i++) {
+        current[0] = i;
+        for (size_t j = 1; j <= right.size(); j++) {
+            char l = left[i - 1], r = right[j - 1];
+            if (ignorecase) {
+                l = std::tolower(static_cast<unsigned char>(l));
+                r = std::tolower(static_cast<unsigned char>(r));
+            }
+            current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + (l == r ? 0 : 1)});
+        }
+        std::swap(previous, current);
+    }
+    return previous[right.size()];
+}
+
+TEST(StringUtilsTest, EditDistanceEmptyAndLong) {
+    EXPECT_EQ(StringUtils::EditDistance("", ""), 0);
+    EXPECT_EQ(StringUtils::EditDistance("", "abc"), 3);
+    EXPECT_EQ(StringUtils::EditDistance("abc", ""), 3);
+    // one and two blocks of the pattern, and across the block boundary
+    std::string Long(64, 'a');
+    EXPECT_EQ(StringUtils::EditDistance(Long, Long), 0);
+    EXPECT_EQ(StringUtils::EditDistance(Long, Long + "b"), 1);
+    EXPECT_EQ(StringUtils::EditDistance(Long + "b", Long + "c"), 1);
+    EXPECT_EQ(StringUtils::EditDistance(std::string(200, 'x'), std::string(150, 'y')), 200);
+    EXPECT_EQ(StringUtils::EditDistance(std::string(130, 'Q'), std::string(130, 'q'), true), 0);
+}
+
+TEST(StringUtilsTest, EditDistanceMatchesReference) {
+    std::mt19937 Generator(18);
+    std::uniform_int_distribution<int> Length(0, 150);
+    // a small alphabet with both cases so matches and case folding happen often
+    const std::string Alphabet = "abcdABCD";
+    std::uniform_int_distribution<size_t> Pick(0, Alphabet.size() - 1);
+    auto RandomString = [&]() {
+        std::string Result(Length(Generator), ' ');
+        for (auto &ch : Result) {
+            ch = Alphabet[Pick(Generator)];
+        }
+        return Result;
+    };
+    for (int Trial = 0; Trial < 500; Trial++) {
+        std::string Left = RandomString(), Right = RandomString();
+        bool IgnoreCase = Trial % 2;
+        int Expected = ReferenceEditDistance(Left, Right, IgnoreCase);
+        ASSERT_EQ(StringUtils::EditDistance(Left, Right, IgnoreCase), Expected) << Left << " " << Right;
+        EXPECT_EQ(StringUtils::EditDistance(Right, Left, IgnoreCase), Expected);
+        // within the bound the exact distance, beyond it one more than the bound
+        EXPECT_EQ(StringUtils::EditDistance(Left, Right, IgnoreCase, Expected), Expected);
+        EXPECT_EQ(StringUtils::EditDistance(Left, Right, IgnoreCase, Expected + 5), Expected);
+        if (Expected > 0) {
+            EXPECT_EQ(StringUtils::EditDistance(Left, Right, IgnoreCase, Expected - 1), Expected);
+            EXPECT_EQ(StringUtils::EditDistance(Left, Right, IgnoreCase, Expected / 2), Expected / 2 + 1);
+        }
+    }
+}
+
+TEST(StringUtilsTest, EditDistanceBounded) {
+    EXPECT_EQ(StringUtils::EditDistance("kitten", "sitting", false, 3), 3);
+    EXPECT_EQ(StringUtils::EditDistance("kitten", "sitting", false, 2), 3);
+    EXPECT_EQ(StringUtils::EditDistance("kitten", "sitting", false, 0), 1);
+    EXPECT_EQ(StringUtils::EditDistance("same", "same", false, 0), 0);
+    // the length difference alone is over the bound
+    EXPECT_EQ(StringUtils::EditDistance("a", std::string(100, 'a'), false, 10), 11);
+    EXPECT_EQ(StringUtils::EditDistance("", "abc", false, 1), 2);
+}
+
+TEST(StringUtilsTest, EditDistances) {
+    std::vector<std::string> Candidates = {"kitten", "sitting", "KITTEN", "", "mitten", "written"};
+    EXPECT_EQ(StringUtils::EditDistances("kitten", Candidates), std::vector<int>({0, 3, 6, 6, 1, 2}));
+    EXPECT_EQ(StringUtils::EditDistances("kitten", Candidates, true), std::vector<int>({0, 3, 0, 6, 1, 2}));
+    EXPECT_EQ(StringUtils::EditDistances("kitten", Candidates, true, 1), std::vector<int>({0, 2, 0, 2, 1, 2}));
+    EXPECT_TRUE(StringUtils::EditDistances("kitten", {}).empty());
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "TestUtils.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace TestUtils{
+
+std::shared_ptr<COpenStreetMap> SmallMap(){
+    return std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(
+        "<osm>"
+        "<node id=\"1\" lat=\"38.50\" lon=\"-121.70\"/>"
+        "<node id=\"2\" lat=\"38.51\" lon=\"-121.70\"/>"
+        "<node id=\"3\" lat=\"38.51\" lon=\"-121.71\"/>"
+        "<node id=\"4\" lat=\"38.52\" lon=\"-121.71\"/>"
+        "<node id=\"5\" lat=\"38.52\" lon=\"-121.72\"/>"
+        "<node id=\"6\" lat=\"38.60\" lon=\"-121.80\"/>"
+        "<way id=\"10\"><nd ref=\"1\"/><nd ref=\"2\"/><nd ref=\"3\"/></way>"
+        "<way id=\"11\"><nd ref=\"3\"/><nd ref=\"4\"/><tag k=\"oneway\" v=\"yes\"/></way>"
+        "<way id=\"12\"><nd ref=\"5\"/><nd ref=\"4\"/><tag k=\"oneway\" v=\"-1\"/></way>"
+        "<way id=\"13\"><nd ref=\"5\"/><nd ref=\"99\"/><nd ref=\"6\"/></way>"
+        "</osm>")));
+}
+
+double PathLength(const CRoutingGraph &graph, const std::vector<CRoutingGraph::TVertexID> &path){
+    double Length = 0.0;
+    for(std::size_t Index = 1; Index < path.size(); Index++){
+        auto Begin = graph.EdgeTargets().begin() + graph.EdgeOffsets()[path[Index - 1]];
+        auto End = graph.EdgeTargets().begin() + graph.EdgeOffsets()[path[Index - 1] + 1];
+        auto Found = std::lower_bound(Begin, End, path[Index]);
+        EXPECT_TRUE(Found != End && *Found == path[Index]);
+        if(Found == End){
+            return -1.0;
+        }
+        Length += graph.EdgeLengths()[Found - graph.EdgeTargets().begin()];
+    }
+    return Length;
+}
+
+void ExpectSameMap(const CStreetMap &expected, const CStreetMap &actual){
+    ASSERT_EQ(expected.NodeCount(), actual.NodeCount());
+    ASSERT_EQ(expected.WayCount(), actual.WayCount());
+    for(std::size_t Index = 0; Index < expected.NodeCount(); Index++){
+        auto Expected = expected.NodeByIndex(Index);
+        auto Actual = actual.NodeByIndex(Index);
+        ASSERT_EQ(Expected->ID(), Actual->ID());
+        ASSERT_EQ(Expected->Location(), Actual->Location());
+        ASSERT_EQ(Expected->AttributeCount(), Actual->AttributeCount());
+        for(std::size_t Attribute = 0; Attribute < Expected->AttributeCount(); Attribute++){
+            auto Key = Expected->GetAttributeKey(Attribute);
+            ASSERT_EQ(Key, Actual->GetAttributeKey(Attribute));
+            ASSERT_EQ(Expected->GetAttribute(Key), Actual->GetAttribute(Key));
+        }
+        ASSERT_EQ(actual.NodeByID(Expected->ID())->ID(), Expected->ID());
+    }
+    for(std::size_t Index = 0; Index < expected.WayCount(); Index++){
+        auto Expected = expected.WayByIndex(Index);
+        auto Actual = actual.WayByIndex(Index);
+        ASSERT_EQ(Expected->ID(), Actual->ID());
+        ASSERT_EQ(Expected->NodeCount(), Actual->NodeCount());
+        for(std::size_t Node = 0; Node < Expected->NodeCount(); Node++){
+            ASSERT_EQ(Expected->GetNodeID(Node), Actual->GetNodeID(Node));
+        }
+        ASSERT_EQ(Expected->AttributeCount(), Actual->AttributeCount());
+        for(std::size_t Attribute = 0; Attribute < Expected->AttributeCount(); Attribute++){
+            auto Key = Expected->GetAttributeKey(Attribute);
+            ASSERT_EQ(Key, Actual->GetAttributeKey(Attribute));
+            ASSERT_EQ(Expected->GetAttribute(Key), Actual->GetAttribute(Key));
+        }
+        ASSERT_EQ(actual.WayByID(Expected->ID())->ID(), Expected->ID());
+    }
+}
+
+std::string TemporaryFile(const std::string &contents){
+    char Name[] = "/tmp/TestUtilsXXXXXX";
+    int FileDescriptor = mkstemp(Name);
+    if(FileDescriptor >= 0){
+        if(!contents.empty()){
+            if(write(FileDescriptor, contents.data(), contents.size()) != static_cast<ssize_t>(contents.size())){
+                ADD_FAILURE() << "unable to write " << Name;
+            }
+        }
+        close(FileDescriptor);
+    }
+    return Name;
+}
+
+std::string FileContents(const std::string &filename){
+    std::ifstream Input(filename, std::ios::binary);
+    std::stringstream Contents;
+    Contents << Input.rdbuf();
+    return Contents.str();
+}
+
+void SaveContents(const std::string &filename, const std::string &contents){
+    std::ofstream Output(filename, std::ios::binary | std::ios::trunc);
+    Output.write(contents.data(), contents.size());
+}
+
+}
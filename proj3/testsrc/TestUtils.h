@@ -0,0 +1,32 @@
+#ifndef TESTUTILS_H
+#define TESTUTILS_H
+
+#include "OpenStreetMap.h"
+#include "RoutingGraph.h"
+#include "StreetMap.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// fixtures and checks shared by more than one test file
+namespace TestUtils{
+
+// a small map: 1 - 2 - 3 in both directions, 3 -> 4 one way, 5 <- 4 one way
+// against its node order, and a way through a node that isn't in the map
+std::shared_ptr<COpenStreetMap> SmallMap();
+
+// sums the path, failing the test if a step isn't an edge
+double PathLength(const CRoutingGraph &graph, const std::vector<CRoutingGraph::TVertexID> &path);
+
+// compares every node and way, including attribute order and the lookups by ID
+void ExpectSameMap(const CStreetMap &expected, const CStreetMap &actual);
+
+// creates a fresh temporary file holding contents and returns its name
+std::string TemporaryFile(const std::string &contents = "");
+std::string FileContents(const std::string &filename);
+// replaces the contents of a file
+void SaveContents(const std::string &filename, const std::string &contents);
+
+}
+
+#endif
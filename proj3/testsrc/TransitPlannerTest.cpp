@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include "TransitPlanner.h"
+#include "CSVBusSystem.h"
+#include "OpenStreetMap.h"
+#include "RoutingGraph.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "MappedFileDataSource.h"
+#include <random>
+#include <tuple>
+#include <unordered_map>
+
+// stops 1 to 5 about 555 m apart going north, 6 far to the east, 7 just
+// past 5 and 8 on a node that isn't in the map
+class TransitPlannerTest : public ::testing::Test{
+    protected:
+        std::shared_ptr<COpenStreetMap> Map;
+        std::shared_ptr<CCSVBusSystem> BusSystem;
+        CTransitPlanner::SOptions Options;
+
+        void SetUp() override{
+            Map = std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(
+                "<osm>"
+                "<node id=\"1\" lat=\"38.500\" lon=\"-121.70\"/>"
+                "<node id=\"2\" lat=\"38.505\" lon=\"-121.70\"/>"
+                "<node id=\"3\" lat=\"38.510\" lon=\"-121.70\"/>"
+                "<node id=\"4\" lat=\"38.515\" lon=\"-121.70\"/>"
+                "<node id=\"5\" lat=\"38.520\" lon=\"-121.70\"/>"
+                "<node id=\"6\" lat=\"38.510\" lon=\"-121.60\"/>"
+                "<node id=\"7\" lat=\"38.5205\" lon=\"-121.70\"/>"
+                "</osm>")));
+            BusSystem = std::make_shared<CCSVBusSystem>(
+                std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("stop_id,node_id\n11,1\n12,2\n13,3\n14,4\n15,5\n16,6\n17,7\n18,99\n"), ','),
+                std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("route,stop_id\nA,11\nA,12\nA,13\nB,13\nB,14\nB,15\nC,11\nC,16\nC,15\nD,18\nD,11\nD,19\n"), ','));
+            Options.MaxWalkMeters = 100.0;
+            Options.WalkMetersPerSecond = 1.0;
+            Options.BusMetersPerSecond = 10.0;
+            Options.DwellSeconds = 0.0;
+            Options.BoardSeconds = 60.0;
+        }
+};
+
+// checks that the legs join up, start and end at the right stops and add up
+static void ExpectConsistent(const CTransitPlanner::SJourney &journey, CBusSystem::TStopID src, CBusSystem::TStopID dest){
+    CBusSystem::TStopID Current = src;
+    double Seconds = 0.0;
+    std::size_t Rides = 0;
+    for(auto &Leg : journey.Legs){
+        EXPECT_EQ(Leg.FromStopID, Current);
+        Current = Leg.ToStopID;
+        Seconds += Leg.Seconds;
+        Rides += Leg.RouteIndex != CTransitPlanner::InvalidRouteIndex;
+    }
+    EXPECT_EQ(Current, dest);
+    EXPECT_NEAR(Seconds, journey.Seconds, 1e-6);
+    EXPECT_EQ(Rides, journey.Rides);
+}
+
+TEST_F(TransitPlannerTest, ParetoJourneysTest){
+    CTransitPlanner Planner(*BusSystem, *Map, Options);
+    // the 8 listed stops and 19 from route D
+    EXPECT_EQ(Planner.StopCount(), 9);
+    // 15 and 17 both ways
+    EXPECT_EQ(Planner.FootpathCount(), 2);
+
+    std::vector<CTransitPlanner::SJourney> Journeys;
+    ASSERT_TRUE(Planner.FindJourneys(11, 15, Journeys));
+    // the long way round on C with one ride, or A then B faster with two
+    ASSERT_EQ(Journeys.size(), 2);
+    EXPECT_EQ(Journeys[0].Rides, 1);
+    ASSERT_EQ(Journeys[0].Legs.size(), 1);
+    EXPECT_EQ(Journeys[0].Legs[0].RouteIndex, 2);
+    EXPECT_EQ(Journeys[0].Legs[0].BoardPosition, 0);
+    EXPECT_EQ(Journeys[0].Legs[0].AlightPosition, 2);
+    EXPECT_EQ(Journeys[0].StopCount, 2);
+    EXPECT_EQ(Journeys[1].Rides, 2);
+    ASSERT_EQ(Journeys[1].Legs.size(), 2);
+    EXPECT_EQ(Journeys[1].Legs[0].RouteIndex, 0);
+    EXPECT_EQ(Journeys[1].Legs[1].RouteIndex, 1);
+    EXPECT_EQ(Journeys[1].Legs[1].FromStopID, 13);
+    EXPECT_EQ(Journeys[1].StopCount, 4);
+    EXPECT_LT(Journeys[1].Seconds, Journeys[0].Seconds);
+    // two boardings and 2 km of riding at 10 m/s
+    double Riding = CRoutingGraph::Haversine({38.5, -121.7}, {38.52, -121.7}) / 10.0;
+    EXPECT_NEAR(Journeys[1].Seconds, 120.0 + Riding, 1e-6);
+    for(auto &Journey : Journeys){
+        ExpectConsistent(Journey, 11, 15);
+    }
+
+    // no transfers allowed leaves only C
+    ASSERT_TRUE(Planner.FindJourneys(11, 15, Journeys, 0));
+    ASSERT_EQ(Journeys.size(), 1);
+    EXPECT_EQ(Journeys[0].Rides, 1);
+}
+
+TEST_F(TransitPlannerTest, FootpathTest){
+    CTransitPlanner Planner(*BusSystem, *Map, Options);
+    std::vector<CTransitPlanner::SJourney> Journeys;
+    // ride to 15 and walk the last 55 m
+    ASSERT_TRUE(Planner.FindJourneys(11, 17, Journeys));
+    ASSERT_EQ(Journeys.size(), 2);
+    ASSERT_EQ(Journeys[1].Legs.size(), 3);
+    EXPECT_EQ(Journeys[1].Legs[2].RouteIndex, CTransitPlanner::InvalidRouteIndex);
+    EXPECT_EQ(Journeys[1].Legs[2].FromStopID, 15);
+    EXPECT_NEAR(Journeys[1].Legs[2].Seconds, CRoutingGraph::Haversine({38.52, -121.7}, {38.5205, -121.7}), 1e-6);
+    ExpectConsistent(Journeys[1], 11, 17);
+
+    // close enough to walk without riding at all
+    ASSERT_TRUE(Planner.FindJourneys(17, 15, Journeys));
+    ASSERT_EQ(Journeys.size(), 1);
+    EXPECT_EQ(Journeys[0].Rides, 0);
+    ASSERT_EQ(Journeys[0].Legs.size(), 1);
+    ExpectConsistent(Journeys[0], 17, 15);
+}
+
+TEST_F(TransitPlannerTest, UnreachableAndUnknownTest){
+    CTransitPlanner Planner(*BusSystem, *Map, Options);
+    std::vector<CTransitPlanner::SJourney> Journeys;
+    // nothing goes back south
+    EXPECT_FALSE(Planner.FindJourneys(15, 11, Journeys));
+    EXPECT_TRUE(Journeys.empty());
+    EXPECT_FALSE(Planner.FindJourneys(11, 1000, Journeys));
+    EXPECT_FALSE(Planner.FindJourneys(1000, 11, Journeys));
+    ASSERT_TRUE(Planner.FindJourneys(13, 13, Journeys));
+    ASSERT_EQ(Journeys.size(), 1);
+    EXPECT_TRUE(Journeys[0].Legs.empty());
+    EXPECT_EQ(Journeys[0].Seconds, 0.0);
+
+    // 18 isn't in the map and 19 isn't in the stop list, riding from them
+    // only costs the boarding
+    ASSERT_TRUE(Planner.FindJourneys(18, 19, Journeys));
+    ASSERT_EQ(Journeys.size(), 1);
+    EXPECT_EQ(Journeys[0].Seconds, 60.0);
+    ExpectConsistent(Journeys[0], 18, 19);
+    ASSERT_TRUE(Planner.FindJourneys(18, 12, Journeys));
+    EXPECT_EQ(Journeys.back().Rides, 2);
+}
+
+// the best time with at most k rides by trying every boarding and alighting
+// position of every route each round
+class CReferencePlanner{
+    private:
+        const CBusSystem &DBusSystem;
+        CTransitPlanner::SOptions DOptions;
+        std::unordered_map<CBusSystem::TStopID, std::size_t> DIndices;
+        // every pair of stops close enough to walk between with the seconds it takes
+        std::vector<std::tuple<std::size_t, std::size_t, double>> DFootpaths;
+        // stop indices and riding seconds from the start of each route
+        std::vector<std::vector<std::size_t>> DRouteStops;
+        std::vector<std::vector<double>> DRouteSeconds;
+
+    public:
+        CReferencePlanner(const CBusSystem &bussystem, const CStreetMap &map, const CTransitPlanner::SOptions &options) : DBusSystem(bussystem), DOptions(options){
+            std::vector<CStreetMap::TLocation> Locations;
+            for(std::size_t Index = 0; Index < bussystem.StopCount(); Index++){
+                auto Stop = bussystem.StopByIndex(Index);
+                DIndices[Stop->ID()] = Index;
+                Locations.push_back(map.NodeByID(Stop->NodeID())->Location());
+            }
+            for(std::size_t From = 0; From < Locations.size(); From++){
+                for(std::size_t To = 0; To < Locations.size(); To++){
+                    double Meters = CRoutingGraph::Haversine(Locations[From], Locations[To]);
+                    if(From != To && Meters <= options.MaxWalkMeters){
+                        DFootpaths.push_back({From, To, Meters / options.WalkMetersPerSecond});
+                    }
+                }
+            }
+            for(std::size_t RouteIndex = 0; RouteIndex < bussystem.RouteCount(); RouteIndex++){
+                auto Route = bussystem.RouteByIndex(RouteIndex);
+                DRouteStops.emplace_back();
+                DRouteSeconds.emplace_back();
+                for(std::size_t Position = 0; Position < Route->StopCount(); Position++){
+                    DRouteStops.back().push_back(DIndices.at(Route->GetStopID(Position)));
+                    double Seconds = 0.0;
+                    if(Position){
+                        Seconds = DRouteSeconds.back().back() + options.DwellSeconds + CRoutingGraph::Haversine(Locations[DRouteStops.back()[Position - 1]], Locations[DRouteStops.back()[Position]]) / options.BusMetersPerSecond;
+                    }
+                    DRouteSeconds.back().push_back(Seconds);
+                }
+            }
+        }
+
+        std::vector<double> BestTimes(CBusSystem::TStopID src, CBusSystem::TStopID dest, std::size_t maxrides) const{
+            const double Inf = std::numeric_limits<double>::infinity();
+            std::size_t Count = DBusSystem.StopCount();
+            // walking after the rides of a round
+            auto Walk = [&](const std::vector<double> &rides){
+                std::vector<double> Result = rides;
+                for(auto &Footpath : DFootpaths){
+                    Result[std::get<1>(Footpath)] = std::min(Result[std::get<1>(Footpath)], rides[std::get<0>(Footpath)] + std::get<2>(Footpath));
+                }
+                return Result;
+            };
+            std::vector<double> Rides(Count, Inf);
+            Rides[DIndices.at(src)] = 0.0;
+            std::vector<double> Arrival = Walk(Rides);
+            std::vector<double> Best(1, Arrival[DIndices.at(dest)]);
+            for(std::size_t Round = 1; Round <= maxrides; Round++){
+                std::fill(Rides.begin(), Rides.end(), Inf);
+                for(std::size_t Route = 0; Route < DRouteStops.size(); Route++){
+                    const auto &Stops = DRouteStops[Route];
+                    const auto &Seconds = DRouteSeconds[Route];
+                    for(std::size_t Board = 0; Board < Stops.size(); Board++){
+                        double Boarded = Arrival[Stops[Board]] + DOptions.BoardSeconds;
+                        for(std::size_t Alight = Board + 1; Alight < Stops.size() && Boarded != Inf; Alight++){
+                            Rides[Stops[Alight]] = std::min(Rides[Stops[Alight]], Boarded + Seconds[Alight] - Seconds[Board]);
+                        }
+                    }
+                }
+                auto Walked = Walk(Rides);
+                for(std::size_t Index = 0; Index < Count; Index++){
+                    Arrival[Index] = std::min(Arrival[Index], Walked[Index]);
+                }
+                Best.push_back(Arrival[DIndices.at(dest)]);
+            }
+            return Best;
+        }
+};
+
+TEST(TransitPlanner, DavisReferenceTest){
+    COpenStreetMap Map(std::make_shared<CXMLReader>(std::make_shared<CMappedFileDataSource>("data/davis.osm")));
+    CCSVBusSystem BusSystem(std::make_shared<CDSVReader>(std::make_shared<CMappedFileDataSource>("data/stops.csv"), ','),
+                            std::make_shared<CDSVReader>(std::make_shared<CMappedFileDataSource>("data/routes.csv"), ','));
+    CTransitPlanner::SOptions Options;
+    CTransitPlanner Planner(BusSystem, Map, Options);
+    EXPECT_EQ(Planner.StopCount(), BusSystem.StopCount());
+    EXPECT_GT(Planner.FootpathCount(), 0);
+    CReferencePlanner Reference(BusSystem, Map, Options);
+    std::mt19937 Generator(3);
+    std::uniform_int_distribution<std::size_t> Pick(0, BusSystem.StopCount() - 1);
+    std::vector<CTransitPlanner::SJourney> Journeys;
+    std::size_t Found = 0;
+    for(int Query = 0; Query < 100; Query++){
+        auto Source = BusSystem.StopByIndex(Pick(Generator))->ID();
+        auto Destination = BusSystem.StopByIndex(Pick(Generator))->ID();
+        auto Expected = Reference.BestTimes(Source, Destination, 3);
+        bool Any = Planner.FindJourneys(Source, Destination, Journeys, 2);
+        EXPECT_EQ(Any, Expected.back() != std::numeric_limits<double>::infinity());
+        // the journeys are where the reference improves on fewer rides
+        std::size_t Next = 0;
+        for(std::size_t Rides = 0; Rides < Expected.size(); Rides++){
+            if(Expected[Rides] == std::numeric_limits<double>::infinity() || (Rides && Expected[Rides] >= Expected[Rides - 1])){
+                continue;
+            }
+            ASSERT_LT(Next, Journeys.size());
+            EXPECT_EQ(Journeys[Next].Rides, Rides);
+            EXPECT_NEAR(Journeys[Next].Seconds, Expected[Rides], 1e-6);
+            ExpectConsistent(Journeys[Next], Source, Destination);
+            Next++;
+        }
+        EXPECT_EQ(Next, Journeys.size());
+        Found += Any;
+    }
+    EXPECT_GT(Found, 40);
+}
@@ -2,6 +2,7 @@
 #include "XMLWriter.h"
 #include "StringDataSource.h"
 #include "StringDataSink.h"
+#include "AllocationCounter.h"
 #include <gtest/gtest.h>
 
 TEST(XMLTest, BasicReadWrite) {
@@ -104,4 +105,248 @@ TEST(XMLTest, SpecialCharacterEscaping) {
     }
 
     EXPECT_EQ(sink->String(), "<tag>value &amp; more</tag>");
-}
\ No newline at end of file
+}
+TEST(XMLTest, SmallChunkSize) {
+    std::shared_ptr<CStringDataSource> src = std::make_shared<CStringDataSource>("<root><child attr=\"value\">data</child></root>");
+    std::shared_ptr<CStringDataSink> sink = std::make_shared<CStringDataSink>();
+
+    CXMLReader reader(src, 3);
+    CXMLWriter writer(sink);
+
+    SXMLEntity entity;
+    while (!reader.End()) {
+        if (reader.ReadEntity(entity)) {
+            writer.WriteEntity(entity);
+        }
+    }
+
+    EXPECT_EQ(sink->String(), "<root><child attr=\"value\">data</child></root>");
+}
+
+// writes every callback down as text so the order can be checked
+class CRecordingVisitor : public CXMLVisitor {
+public:
+    std::string Events;
+
+    void StartElement(std::string_view name, SXMLEntity::TAtom atom, const SXMLAttributes &attributes) override {
+        Events += "<" + std::string(name);
+        for (std::size_t i = 0; i < attributes.Count(); i++) {
+            Events += " " + std::string(attributes.Name(i)) + "=" + std::string(attributes.Value(i));
+        }
+        Events += ">";
+    }
+
+    void EndElement(std::string_view name, SXMLEntity::TAtom atom) override {
+        Events += "</" + std::string(name) + ">";
+    }
+
+    void CharData(std::string_view data) override {
+        Events += data;
+    }
+};
+
+TEST(XMLTest, ParseVisitor) {
+    for (std::size_t chunkSize : {3, 4096}) {
+        auto src = std::make_shared<CStringDataSource>("<root><child a=\"1\" b=\"x &amp; y\">data</child><empty/></root>");
+        CXMLReader reader(src, chunkSize);
+        CRecordingVisitor visitor;
+        EXPECT_TRUE(reader.Parse(visitor));
+        EXPECT_EQ(visitor.Events, "<root><child a=1 b=x & y>data</child><empty></empty></root>");
+        EXPECT_TRUE(reader.End());
+    }
+}
+
+TEST(XMLTest, ParseFilter) {
+    auto src = std::make_shared<CStringDataSource>("<osm><bounds/><node id=\"1\">text<tag k=\"a\" v=\"b\"/></node><relation/></osm>");
+    CXMLReader reader(src);
+    CRecordingVisitor visitor;
+    EXPECT_TRUE(reader.Parse(visitor, {"node", "tag"}));
+    // no character data and nothing outside the filter
+    EXPECT_EQ(visitor.Events, "<node id=1><tag k=a v=b></tag></node>");
+}
+
+TEST(XMLTest, ParseAfterReadEntity) {
+    auto src = std::make_shared<CStringDataSource>("<root><a x=\"1\">text</a><b/></root>");
+    CXMLReader reader(src);
+    SXMLEntity entity;
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameData, "root");
+    CRecordingVisitor visitor;
+    EXPECT_TRUE(reader.Parse(visitor));
+    EXPECT_EQ(visitor.Events, "<a x=1>text</a><b></b></root>");
+    EXPECT_FALSE(reader.ReadEntity(entity));
+}
+
+TEST(XMLTest, ParseError) {
+    auto src = std::make_shared<CStringDataSource>("<root><a></b></root>");
+    CXMLReader reader(src);
+    CRecordingVisitor visitor;
+    EXPECT_FALSE(reader.Parse(visitor));
+    EXPECT_EQ(visitor.Events, "<root><a>");
+}
+
+TEST(XMLTest, SXMLAttributesLookup) {
+    const char *pairs[] = {"k", "highway", "v", "", nullptr};
+    SXMLAttributes attributes{pairs};
+    EXPECT_EQ(attributes.Count(), 2);
+    EXPECT_TRUE(attributes.AttributeExists("v"));
+    EXPECT_FALSE(attributes.AttributeExists("x"));
+    EXPECT_EQ(attributes.AttributeValue("k"), "highway");
+    EXPECT_EQ(attributes.AttributeValue("x"), "");
+    SXMLAttributes none{nullptr};
+    EXPECT_EQ(none.Count(), 0);
+    EXPECT_FALSE(none.AttributeExists("k"));
+}
+
+TEST(XMLTest, EntityAtoms) {
+    auto src = std::make_shared<CStringDataSource>("<osm><node id=\"1\" lat=\"2\"/><way id=\"3\"/></osm>");
+    CXMLReader reader(src);
+    // names interned first get the first atoms
+    auto nodeAtom = reader.NameAtom("node");
+    auto idAtom = reader.NameAtom("id");
+    EXPECT_EQ(nodeAtom, 0);
+    EXPECT_EQ(idAtom, 1);
+    EXPECT_EQ(reader.NameAtom("node"), nodeAtom);
+    SXMLEntity entity;
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(reader.AtomName(entity.DNameAtom), "osm");
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameAtom, nodeAtom);
+    ASSERT_EQ(entity.DAttributeAtoms.size(), 2);
+    EXPECT_EQ(entity.DAttributeAtoms[0], idAtom);
+    EXPECT_EQ(entity.AttributeValue(idAtom), "1");
+    EXPECT_EQ(entity.AttributeValue(reader.NameAtom("lat")), "2");
+    EXPECT_TRUE(entity.AttributeExists(idAtom));
+    EXPECT_FALSE(entity.AttributeExists(reader.NameAtom("lon")));
+    EXPECT_EQ(entity.AttributeValue(reader.NameAtom("lon")), "");
+    // the value by name is a reference into the entity, not a copy
+    EXPECT_EQ(&entity.AttributeValue("id"), &entity.AttributeValue(idAtom));
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(entity.DNameAtom, nodeAtom);
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(reader.AtomName(entity.DNameAtom), "way");
+    EXPECT_EQ(entity.AttributeValue(idAtom), "3");
+    EXPECT_EQ(reader.AtomName(1000), "");
+}
+
+TEST(XMLTest, SetAttributeKeepsAtomsAligned) {
+    SXMLEntity entity{SXMLEntity::EType::StartElement, "node"};
+    EXPECT_EQ(entity.DNameAtom, SXMLEntity::InvalidAtom);
+    entity.SetAttribute("id", "1");
+    entity.SetAttribute("lat", "2");
+    ASSERT_EQ(entity.DAttributeAtoms.size(), 2);
+    EXPECT_FALSE(entity.AttributeExists(0));
+    EXPECT_EQ(entity.AttributeValue("lat"), "2");
+}
+
+// hands out the entities of another reader, so their atoms are that reader's
+class CForwardingReader : public CXMLReader {
+public:
+    CXMLReader Inner;
+    CForwardingReader(std::shared_ptr<CDataSource> src) : CXMLReader(nullptr), Inner(src) {}
+    bool ReadEntity(SXMLEntity &entity, bool skipcdata = false) override {
+        return Inner.ReadEntity(entity, skipcdata);
+    }
+};
+
+// a reader with a real data source that renames every element as it reads it
+class CRenamingReader : public CXMLReader {
+public:
+    int Calls = 0;
+    CRenamingReader(std::shared_ptr<CDataSource> src) : CXMLReader(src) {}
+    bool ReadEntity(SXMLEntity &entity, bool skipcdata = false) override {
+        if (!CXMLReader::ReadEntity(entity, skipcdata)) {
+            return false;
+        }
+        Calls++;
+        if (entity.DType != SXMLEntity::EType::CharData) {
+            entity.DNameData = "x" + entity.DNameData;
+            entity.DNameAtom = NameAtom(entity.DNameData);
+        }
+        return true;
+    }
+};
+
+TEST(XMLTest, ParseUsesOverriddenReadEntity) {
+    CRenamingReader reader(std::make_shared<CStringDataSource>("<root><a/>text</root>"));
+    CRecordingVisitor visitor;
+    EXPECT_TRUE(reader.Parse(visitor));
+    EXPECT_EQ(visitor.Events, "<xroot><xa></xa>text</xroot>");
+    EXPECT_EQ(reader.Calls, 5);
+}
+
+// checks the atoms against the reader the visitor was given
+class CAtomCheckingVisitor : public CXMLVisitor {
+public:
+    CXMLReader &Reader;
+    int Mismatches = 0;
+    int Elements = 0;
+    CAtomCheckingVisitor(CXMLReader &reader) : Reader(reader) {}
+
+    void StartElement(std::string_view name, SXMLEntity::TAtom atom, const SXMLAttributes &attributes) override {
+        Elements++;
+        Mismatches += Reader.NameAtom(name) != atom;
+        for (std::size_t i = 0; i < attributes.Count(); i++) {
+            Mismatches += Reader.NameAtom(attributes.Name(i)) != attributes.Atom(i);
+            Mismatches += attributes.AttributeValue(attributes.Atom(i)) != attributes.Value(i);
+        }
+    }
+
+    void EndElement(std::string_view name, SXMLEntity::TAtom atom) override {
+        Mismatches += Reader.NameAtom(name) != atom;
+    }
+};
+
+TEST(XMLTest, ParseAtoms) {
+    const std::string document = "<osm><node id=\"1\" lat=\"2\"><tag k=\"a\" v=\"b\"/></node><way id=\"3\"/></osm>";
+    CXMLReader reader(std::make_shared<CStringDataSource>(document));
+    // one entity read first so Parse hands over a queued entity too
+    SXMLEntity entity;
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    CAtomCheckingVisitor visitor(reader);
+    EXPECT_TRUE(reader.Parse(visitor));
+    EXPECT_EQ(visitor.Elements, 3);
+    EXPECT_EQ(visitor.Mismatches, 0);
+
+    CForwardingReader forwarding(std::make_shared<CStringDataSource>(document));
+    // intern in a different order than the inner reader sees the names
+    forwarding.NameAtom("v");
+    forwarding.NameAtom("tag");
+    CAtomCheckingVisitor forwardingVisitor(forwarding);
+    EXPECT_TRUE(forwarding.Parse(forwardingVisitor));
+    EXPECT_EQ(forwardingVisitor.Elements, 4);
+    EXPECT_EQ(forwardingVisitor.Mismatches, 0);
+}
+
+TEST(XMLTest, ReadEntitySteadyStateAllocations) {
+    // long attribute values and character data so none of the strings fit
+    // in the small string buffer
+    std::string document = "<osm>";
+    for (int i = 0; i < 20000; i++) {
+        document += "<node id=\"" + std::to_string(1000000 + i) + "\" timestamp=\"2019-05-12T18:20:31Z\" user=\"a mapper with a long user name\">";
+        if (i % 3 == 0) {
+            document += "<tag k=\"highway\" v=\"traffic_signals_with_a_long_value\"/>";
+        }
+        if (i % 5 == 0) {
+            document += "some character data that is long enough";
+        }
+        document += "</node>\n";
+    }
+    document += "</osm>";
+    CXMLReader reader(std::make_shared<CStringDataSource>(document), 4096);
+    SXMLEntity entity;
+    std::size_t entities = 0;
+    // warm up until the ring, the spare attributes and the strings in them
+    // have all grown to fit
+    while (entities < 20000 && reader.ReadEntity(entity)) {
+        entities++;
+    }
+    std::size_t before = AllocationCounter::Count();
+    while (reader.ReadEntity(entity)) {
+        entities++;
+    }
+    std::size_t allocations = AllocationCounter::Count() - before;
+    EXPECT_GT(entities, 60000);
+    EXPECT_EQ(allocations, 0);
+}